@@ -39,87 +39,116 @@ void jpeg_error_handler(j_common_ptr ptr)
 
 void init_destination(j_compress_ptr cinfo)
 {
-	JOCTET * next_output_byte;
-	if (jpeg_buffer != NULL) { free(jpeg_buffer); }
-	if ((jpeg_buffer = malloc(MAX_BUFFER)) == NULL) { ILIBCRITICALEXIT(254); }
-	jpeg_buffer_length = 0;
-	next_output_byte = jpeg_buffer;
-	cinfo->dest->next_output_byte = next_output_byte;
+	JPEG_encoder *encoder = (JPEG_encoder*)cinfo;
+	if (encoder->buffer != NULL) { free(encoder->buffer); }
+	if ((encoder->buffer = malloc(MAX_BUFFER)) == NULL) { ILIBCRITICALEXIT(254); }
+	encoder->bufferLength = 0;
+	cinfo->dest->next_output_byte = encoder->buffer;
 	cinfo->dest->free_in_buffer = MAX_BUFFER;
 }
 
 boolean empty_output_buffer(j_compress_ptr cinfo)
 {
-	JOCTET * next_output_byte;
+	JPEG_encoder *encoder = (JPEG_encoder*)cinfo;
 
-	jpeg_buffer_length += MAX_BUFFER;
-	if ((jpeg_buffer = (unsigned char *)realloc(jpeg_buffer, jpeg_buffer_length + MAX_BUFFER)) == NULL) { ILIBCRITICALEXIT(254); }
-	next_output_byte = jpeg_buffer + jpeg_buffer_length;
-	cinfo->dest->next_output_byte = next_output_byte;
+	encoder->bufferLength += MAX_BUFFER;
+	if ((encoder->buffer = (unsigned char *)realloc(encoder->buffer, encoder->bufferLength + MAX_BUFFER)) == NULL) { ILIBCRITICALEXIT(254); }
+	cinfo->dest->next_output_byte = encoder->buffer + encoder->bufferLength;
 	cinfo->dest->free_in_buffer = MAX_BUFFER;
 
 #if MAX_TILE_SIZE > 0
-	if ( jpeg_buffer_length > MAX_TILE_SIZE) return FALSE;
+	if (encoder->bufferLength > MAX_TILE_SIZE) return FALSE;
 #endif
 	return TRUE;
 }
 
 void term_destination (j_compress_ptr cinfo)
 {
+	JPEG_encoder *encoder = (JPEG_encoder*)cinfo;
 	int remaining_buff_length = MAX_BUFFER - cinfo->dest->free_in_buffer;
 
-	jpeg_buffer_length += remaining_buff_length;
+	encoder->bufferLength += remaining_buff_length;
 
 #if MAX_TILE_SIZE > 0
-	if (jpeg_buffer_length > MAX_TILE_SIZE)
+	if (encoder->bufferLength > MAX_TILE_SIZE)
 	{
-		free(jpeg_buffer);
-		jpeg_buffer = NULL;
+		free(encoder->buffer);
+		encoder->buffer = NULL;
 	}
 	else 
 #endif
 	{
-		if ((jpeg_buffer = (unsigned char *)realloc(jpeg_buffer, jpeg_buffer_length)) == NULL) { ILIBCRITICALEXIT(254); }
+		if ((encoder->buffer = (unsigned char *)realloc(encoder->buffer, encoder->bufferLength)) == NULL) { ILIBCRITICALEXIT(254); }
 	}
 }
 
-int write_JPEG_buffer (JSAMPLE * image_buffer, int image_width, int image_height, int quality)
+JPEG_encoder* JPEG_encoder_create()
 {
-	struct jpeg_compress_struct cinfo;
-	struct jpeg_error_mgr jerr;
-	JSAMPROW row_pointer[1];
-	int row_stride;
-
-	cinfo.err = jpeg_std_error(&jerr);
-	if (default_JPEG_error_handler != NULL) { jerr.error_exit = jpeg_error_handler; }
-
-	jpeg_create_compress(&cinfo);
-	cinfo.dest = (struct jpeg_destination_mgr *) malloc (sizeof(struct jpeg_destination_mgr));
-	cinfo.dest->init_destination = &init_destination;
-	cinfo.dest->empty_output_buffer = &empty_output_buffer;
-	cinfo.dest->term_destination = &term_destination;
-
-	cinfo.image_width = image_width;
-	cinfo.image_height = image_height;
-	cinfo.input_components = 3;
-	cinfo.in_color_space = JCS_RGB;
-	jpeg_set_defaults(&cinfo);
-	jpeg_set_quality(&cinfo, quality, TRUE);
-	jpeg_start_compress(&cinfo, TRUE);
-	row_stride = image_width * 3;
-
-	while (cinfo.next_scanline < cinfo.image_height)
+	JPEG_encoder *encoder;
+	if ((encoder = (JPEG_encoder*)calloc(1, sizeof(JPEG_encoder))) == NULL) { ILIBCRITICALEXIT(254); }
+
+	encoder->cinfo.err = jpeg_std_error(&(encoder->jerr));
+	if (default_JPEG_error_handler != NULL) { encoder->jerr.error_exit = jpeg_error_handler; }
+
+	jpeg_create_compress(&(encoder->cinfo));
+	encoder->dest.init_destination = &init_destination;
+	encoder->dest.empty_output_buffer = &empty_output_buffer;
+	encoder->dest.term_destination = &term_destination;
+	encoder->cinfo.dest = &(encoder->dest);
+	return(encoder);
+}
+void JPEG_encoder_destroy(JPEG_encoder *encoder)
+{
+	encoder->cinfo.dest = NULL;
+	jpeg_destroy_compress(&(encoder->cinfo));
+	if (encoder->buffer != NULL) { free(encoder->buffer); }
+	free(encoder);
+}
+
+// Encodes the image into encoder->buffer/encoder->bufferLength. The compressor is kept for the next image.
+// The rows of the image are row_stride bytes apart, and the pixels are laid out as specified by color_space.
+int write_JPEG_bufferEx2(JPEG_encoder *encoder, JSAMPLE * image_buffer, int row_stride, J_COLOR_SPACE color_space, int components, int image_width, int image_height, int quality)
+{
+	struct jpeg_compress_struct *cinfo = &(encoder->cinfo);
+	JSAMPROW row_pointer[32];
+	int i;
+
+	cinfo->image_width = image_width;
+	cinfo->image_height = image_height;
+	cinfo->input_components = components;
+	cinfo->in_color_space = color_space;
+	jpeg_set_defaults(cinfo);
+	jpeg_set_quality(cinfo, quality, TRUE);
+	jpeg_start_compress(cinfo, TRUE);
+
+	while (cinfo->next_scanline < cinfo->image_height)
 	{
-		row_pointer[0] = & image_buffer[cinfo.next_scanline * row_stride];
-		(void) jpeg_write_scanlines(&cinfo, row_pointer, 1);
+		for (i = 0; i < 32 && cinfo->next_scanline + i < cinfo->image_height; ++i) { row_pointer[i] = &image_buffer[(long long)(cinfo->next_scanline + i) * row_stride]; }
+		(void) jpeg_write_scanlines(cinfo, row_pointer, i);
 	}
 
-	jpeg_finish_compress(&cinfo);
+	jpeg_finish_compress(cinfo);
+	jpeg_abort_compress(cinfo);		// Make sure the compressor is idle, even if the output was suspended
+	return 0;
+}
 
-	free(cinfo.dest);
-	cinfo.dest = NULL;
-	jpeg_destroy_compress(&cinfo);
+// Encodes the image into encoder->buffer/encoder->bufferLength. The compressor is kept for the next image.
+int write_JPEG_bufferEx(JPEG_encoder *encoder, JSAMPLE * image_buffer, int image_width, int image_height, int quality)
+{
+	return(write_JPEG_bufferEx2(encoder, image_buffer, image_width * 3, JCS_RGB, 3, image_width, image_height, quality));
+}
+
+// Encodes the image into jpeg_buffer/jpeg_buffer_length. Only for use by a single thread.
+int write_JPEG_buffer (JSAMPLE * image_buffer, int image_width, int image_height, int quality)
+{
+	static JPEG_encoder *encoder = NULL;
+	if (encoder == NULL) { encoder = JPEG_encoder_create(); }
+
+	write_JPEG_bufferEx(encoder, image_buffer, image_width, image_height, quality);
 
+	if (jpeg_buffer != NULL) { free(jpeg_buffer); }
+	jpeg_buffer = encoder->buffer;
+	jpeg_buffer_length = encoder->bufferLength;
+	encoder->buffer = NULL;
 	return 0;
 }
-
@@ -31,7 +31,21 @@ limitations under the License.
 
 typedef void(*JPEG_error_handler)(char *msg);
 
+// A libjpeg compressor, with its own output buffer. Reused for every image, and owned by a single thread.
+typedef struct JPEG_encoder
+{
+	struct jpeg_compress_struct cinfo;		// Must be first
+	struct jpeg_error_mgr jerr;
+	struct jpeg_destination_mgr dest;
+	unsigned char *buffer;					// Encoded image, NULL if it was too large
+	int bufferLength;
+}JPEG_encoder;
+
 extern int write_JPEG_buffer (JSAMPLE * image_buffer, int image_width, int image_height, int quality);
+extern JPEG_encoder* JPEG_encoder_create();
+extern void JPEG_encoder_destroy(JPEG_encoder *encoder);
+extern int write_JPEG_bufferEx(JPEG_encoder *encoder, JSAMPLE * image_buffer, int image_width, int image_height, int quality);
+extern int write_JPEG_bufferEx2(JPEG_encoder *encoder, JSAMPLE * image_buffer, int row_stride, J_COLOR_SPACE color_space, int components, int image_width, int image_height, int quality);
 extern JPEG_error_handler default_JPEG_error_handler;
 
 #endif // LINUX_COMPRESSION_H_ 
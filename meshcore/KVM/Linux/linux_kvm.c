@@ -23,6 +23,8 @@ limitations under the License.
 #include <sys/wait.h>
 #include <limits.h>
 #include <time.h>
+#include <errno.h>
+#include <sys/ioctl.h>
 
 #include <sys/ipc.h>
 #include <sys/shm.h>
@@ -72,7 +74,14 @@ typedef enum KVM_MouseCursors
 }KVM_MouseCursors;
 
 int curcursor = KVM_MouseCursor_HELP;
+
+// XDamage change tracking. When the extension is available, only the tiles the X server reports as damaged are captured and checked.
+Display *damagedisplay = NULL;
+int g_damageDisplayNumber = -1;
+int g_damageFullFrame = 1;				// Set when every tile must be checked, such as after a refresh or a resolution change
+XRectangle g_damageCursor = { 0 };		// Area the mouse cursor was drawn into, in the last frame
 int SLAVELOG = 0;
+int g_kvmCopyRect = 0;					// Set from the kvmCopyRect setting. Scrolled areas are sent as MNG_KVM_COPY
 
 int SCREEN_NUM = 0;
 int SCREEN_WIDTH = 0;
@@ -150,6 +159,10 @@ typedef struct x11_struct
 }x11_struct;
 x11_struct *x11_exports = NULL;
 
+typedef XID kvm_XserverRegion;
+typedef XID kvm_Damage;
+#define KVM_XDamageReportNonEmpty 3
+
 typedef struct xfixes_struct
 {
 	void *xfixes_lib;
@@ -157,9 +170,22 @@ typedef struct xfixes_struct
 	Bool(*XFixesQueryExtension)(Display *d, int *eventbase, int *errorbase);
 	void*(*XFixesGetCursorImage)(Display *d);
 	void*(*XFixesGetCursorImageAndName)(Display *d);
+	kvm_XserverRegion(*XFixesCreateRegion)(Display *d, XRectangle *rectangles, int nrectangles);
+	void(*XFixesDestroyRegion)(Display *d, kvm_XserverRegion region);
+	XRectangle*(*XFixesFetchRegion)(Display *d, kvm_XserverRegion region, int *nrectangles);
 }xfixes_struct;
 xfixes_struct *xfixes_exports = NULL;
 
+typedef struct xdamage_struct
+{
+	void *xdamage_lib;
+	Bool(*XDamageQueryExtension)(Display *d, int *eventbase, int *errorbase);
+	kvm_Damage(*XDamageCreate)(Display *d, Drawable drawable, int level);
+	void(*XDamageDestroy)(Display *d, kvm_Damage damage);
+	void(*XDamageSubtract)(Display *d, kvm_Damage damage, kvm_XserverRegion repair, kvm_XserverRegion parts);
+}xdamage_struct;
+xdamage_struct *xdamage_exports = NULL;
+
 void kvm_keyboard_unmap_unicode_key(Display *display, int keycode)
 {
 	// Delete a keymapping that we created previously
@@ -524,12 +550,21 @@ char Location_X11LIB[NAME_MAX];
 char Location_X11TST[NAME_MAX];
 char Location_X11EXT[NAME_MAX];
 char Location_X11FIXES[NAME_MAX];
+char Location_X11DAMAGE[NAME_MAX];
 void kvm_set_x11_locations(char *libx11, char *libx11tst, char *libx11ext, char *libxfixes)
 {
+	char *libxdamage = getenv("Location_X11DAMAGE");
+	char *dir = libxfixes != NULL ? strrchr(libxfixes, '/') : NULL;
+
 	if (libx11 != NULL) { strcpy_s(Location_X11LIB, sizeof(Location_X11LIB), libx11); } else { strcpy_s(Location_X11LIB, sizeof(Location_X11LIB), "libX11.so"); }
 	if (libx11tst != NULL) { strcpy_s(Location_X11TST, sizeof(Location_X11TST), libx11tst); } else { strcpy_s(Location_X11TST, sizeof(Location_X11TST), "libXtst.so"); }
 	if (libx11ext != NULL) { strcpy_s(Location_X11EXT, sizeof(Location_X11EXT), libx11ext); } else { strcpy_s(Location_X11EXT, sizeof(Location_X11EXT), "libXext.so"); }		
 	if (libxfixes != NULL) { strcpy_s(Location_X11FIXES, sizeof(Location_X11FIXES), libxfixes); } else { strcpy_s(Location_X11FIXES, sizeof(Location_X11FIXES), "libXfixes.so"); }
+
+	// libXdamage isn't located by monitor-info, so look next to libXfixes, unless it was specified
+	if (libxdamage != NULL) { strcpy_s(Location_X11DAMAGE, sizeof(Location_X11DAMAGE), libxdamage); }
+	else if (dir != NULL && (dir - libxfixes) + 17 < (int)sizeof(Location_X11DAMAGE)) { sprintf_s(Location_X11DAMAGE, sizeof(Location_X11DAMAGE), "%.*slibXdamage.so.1", (int)(dir - libxfixes) + 1, libxfixes); }
+	else { strcpy_s(Location_X11DAMAGE, sizeof(Location_X11DAMAGE), "libXdamage.so.1"); }
 }
 
 int kvm_init(int displayNo)
@@ -607,6 +642,22 @@ int kvm_init(int displayNo)
 			((void**)xfixes_exports)[2] = (void*)dlsym(xfixes_exports->xfixes_lib, "XFixesQueryExtension");
 			((void**)xfixes_exports)[3] = (void*)dlsym(xfixes_exports->xfixes_lib, "XFixesGetCursorImage");
 			((void**)xfixes_exports)[4] = (void*)dlsym(xfixes_exports->xfixes_lib, "XFixesGetCursorImageAndName");
+			((void**)xfixes_exports)[5] = (void*)dlsym(xfixes_exports->xfixes_lib, "XFixesCreateRegion");
+			((void**)xfixes_exports)[6] = (void*)dlsym(xfixes_exports->xfixes_lib, "XFixesDestroyRegion");
+			((void**)xfixes_exports)[7] = (void*)dlsym(xfixes_exports->xfixes_lib, "XFixesFetchRegion");
+		}
+	}
+	if (xdamage_exports == NULL)
+	{
+		xdamage_exports = ILibMemory_SmartAllocate(sizeof(xdamage_struct));
+		xdamage_exports->xdamage_lib = dlopen(Location_X11DAMAGE, RTLD_NOW);
+		if (xdamage_exports->xdamage_lib == NULL) { xdamage_exports->xdamage_lib = dlopen("libXdamage.so", RTLD_NOW); }
+		if (xdamage_exports->xdamage_lib)
+		{
+			((void**)xdamage_exports)[1] = (void*)dlsym(xdamage_exports->xdamage_lib, "XDamageQueryExtension");
+			((void**)xdamage_exports)[2] = (void*)dlsym(xdamage_exports->xdamage_lib, "XDamageCreate");
+			((void**)xdamage_exports)[3] = (void*)dlsym(xdamage_exports->xdamage_lib, "XDamageDestroy");
+			((void**)xdamage_exports)[4] = (void*)dlsym(xdamage_exports->xdamage_lib, "XDamageSubtract");
 		}
 	}
 
@@ -668,6 +719,7 @@ int kvm_init(int displayNo)
 	kvm_send_display();
 
 	reset_tile_info(old_height_count);
+	g_damageFullFrame = 1;
 
 	return 0;
 }
@@ -755,6 +807,7 @@ int kvm_server_inputdata(char* block, int blocklen)
 					g_tileInfo[row][col].flag = 0;
 				}
 			}
+			g_damageFullFrame = 1;
 			break;
 		}
 	case MNG_KVM_PAUSE: // Pause
@@ -956,29 +1009,348 @@ void kvm_server_sighandler(int signum, siginfo_t *info, void *context)
 {
 	g_shutdown = 1;
 }
+
+kvm_Damage g_damage = 0;
+kvm_XserverRegion g_damageRegion = 0;
+
+void kvm_damage_close()
+{
+	if (damagedisplay == NULL) { return; }
+	if (g_damageRegion != 0) { xfixes_exports->XFixesDestroyRegion(damagedisplay, g_damageRegion); g_damageRegion = 0; }
+	if (g_damage != 0) { xdamage_exports->XDamageDestroy(damagedisplay, g_damage); g_damage = 0; }
+	x11_exports->XCloseDisplay(damagedisplay);
+	damagedisplay = NULL;
+}
+
+// Start tracking damage on the specified display. If XDamage isn't available, the full frame CRC scan is used instead.
+void kvm_damage_open(char *displayString, int displayNumber)
+{
+	int event_base, error_base;
+
+	if (damagedisplay != NULL && g_damageDisplayNumber == displayNumber) { return; }
+	kvm_damage_close();
+	if (g_damageDisplayNumber == displayNumber) { return; }	// Already tried this display
+	g_damageDisplayNumber = displayNumber;
+	g_damageFullFrame = 1;
+
+	if (xdamage_exports->xdamage_lib == NULL || xdamage_exports->XDamageCreate == NULL || xfixes_exports->XFixesFetchRegion == NULL) { return; }
+	if ((damagedisplay = x11_exports->XOpenDisplay(displayString)) == NULL) { return; }
+	if (!xdamage_exports->XDamageQueryExtension(damagedisplay, &event_base, &error_base) || !xfixes_exports->XFixesQueryExtension(damagedisplay, &event_base, &error_base))
+	{
+		if (logFile) { fprintf(logFile, "XDamage not available, using CRC scan\n"); fflush(logFile); }
+		x11_exports->XCloseDisplay(damagedisplay);
+		damagedisplay = NULL;
+		return;
+	}
+
+	g_damage = xdamage_exports->XDamageCreate(damagedisplay, x11_exports->XRootWindow(damagedisplay, DefaultScreen(damagedisplay)), KVM_XDamageReportNonEmpty);
+	g_damageRegion = xfixes_exports->XFixesCreateRegion(damagedisplay, NULL, 0);
+	x11_exports->XSync(damagedisplay, 0);
+}
+
+// Reads the accumulated damage, and marks the damaged tiles TILE_TODO. All other tiles are marked TILE_DONT_SEND.
+// cursor is the area the mouse cursor will be drawn into, in this frame. Returns the number of tiles to check.
+int kvm_damage_collect(XRectangle *cursor)
+{
+	XEvent XE;
+	XRectangle *rects;
+	int i, r, c, count = 0, tiles = 0;
+
+	// The notifications only say that there is damage, the damage itself is read from the region
+	while (x11_exports->XPending(damagedisplay)) { x11_exports->XNextEvent(damagedisplay, &XE); }
+	xdamage_exports->XDamageSubtract(damagedisplay, g_damage, None, g_damageRegion);
+	rects = xfixes_exports->XFixesFetchRegion(damagedisplay, g_damageRegion, &count);
+
+	for (r = 0; r < TILE_HEIGHT_COUNT; r++) {
+		for (c = 0; c < TILE_WIDTH_COUNT; c++) {
+			g_tileInfo[r][c].flag = TILE_DONT_SEND;
+		}
+	}
+	for (i = 0; i < count; ++i) { tiles += mark_tiles_todo(rects[i].x, rects[i].y, rects[i].width, rects[i].height); }
+	if (rects != NULL) { x11_exports->XFree(rects); }
+
+	// The cursor isn't part of the damage, so the area it was drawn into, and the area it will be drawn into, are checked too
+	tiles += mark_tiles_todo(g_damageCursor.x, g_damageCursor.y, g_damageCursor.width, g_damageCursor.height);
+	if (cursor != NULL) { tiles += mark_tiles_todo(cursor->x, cursor->y, cursor->width, cursor->height); }
+	memset(&g_damageCursor, 0, sizeof(g_damageCursor));
+
+	return(tiles);
+}
+// Returns non-zero if any tile in the row needs to be checked
+int kvm_tile_row_todo(int row)
+{
+	int col;
+	for (col = 0; col < TILE_WIDTH_COUNT; col++) { if (g_tileInfo[row][col].flag == TILE_TODO) { return 1; } }
+	return 0;
+}
+
+// Capture session. The display connection, the XImage and its shared memory segment are kept for as long as the
+// display and resolution stay the same, instead of being created and destroyed for every frame.
+typedef struct kvm_capture_session
+{
+	Display *display;
+	XImage *image;
+	XShmSegmentInfo shminfo;
+	int displayNumber;
+	int width, height, depth;
+}kvm_capture_session;
+kvm_capture_session g_capture = { 0 };
+
+void kvm_capture_release_image()
+{
+	if (g_capture.image == NULL) { return; }
+	x11ext_exports->XShmDetach(g_capture.display, &(g_capture.shminfo));
+	XDestroyImage(g_capture.image);
+	g_capture.image = NULL;
+	shmdt(g_capture.shminfo.shmaddr);
+}
+void kvm_capture_close()
+{
+	kvm_capture_release_image();
+	if (g_capture.display != NULL) { x11_exports->XCloseDisplay(g_capture.display); g_capture.display = NULL; }
+	g_capture.displayNumber = -1;
+}
+
+// Opens the capture connection to the specified display, unless it is already open. Returns 0 on success.
+int kvm_capture_open(char *displayString, int displayNumber)
+{
+	if (g_capture.display != NULL && g_capture.displayNumber == displayNumber) { return 0; }
+	kvm_capture_close();
+	if ((g_capture.display = x11_exports->XOpenDisplay(displayString)) == NULL) { return 1; }
+	g_capture.displayNumber = displayNumber;
+	return 0;
+}
+
+// Makes sure the shared image matches the screen. The image is only rebuilt when the size or depth changed, and then
+// every tile is captured and checked, because the tiles are read from the image itself. Returns the image, or NULL on failure.
+XImage* kvm_capture_image(int screen_num, int width, int height, int depth)
+{
+	if (g_capture.image != NULL && g_capture.width == width && g_capture.height == height && g_capture.depth == depth) { return(g_capture.image); }
+	kvm_capture_release_image();
+
+	g_capture.image = x11ext_exports->XShmCreateImage(g_capture.display, DefaultVisual(g_capture.display, screen_num), depth, ZPixmap, NULL, &(g_capture.shminfo), width, height);
+	if (g_capture.image == NULL) { return(NULL); }
+	g_capture.shminfo.shmid = shmget(IPC_PRIVATE, g_capture.image->bytes_per_line * g_capture.image->height, IPC_CREAT | 0777);
+	if (g_capture.shminfo.shmid == -1 || (g_capture.shminfo.shmaddr = shmat(g_capture.shminfo.shmid, 0, 0)) == (char*)-1)
+	{
+		if (g_capture.shminfo.shmid != -1) { shmctl(g_capture.shminfo.shmid, IPC_RMID, 0); }
+		XDestroyImage(g_capture.image);
+		g_capture.image = NULL;
+		return(NULL);
+	}
+	g_capture.image->data = g_capture.shminfo.shmaddr;
+	g_capture.shminfo.readOnly = False;
+	x11ext_exports->XShmAttach(g_capture.display, &(g_capture.shminfo));
+
+	// Once the X server has attached, the segment is marked for removal, so it can't outlive this process
+	x11_exports->XSync(g_capture.display, 0);
+	shmctl(g_capture.shminfo.shmid, IPC_RMID, 0);
+
+	g_capture.width = width;
+	g_capture.height = height;
+	g_capture.depth = depth;
+	g_damageFullFrame = 1;
+	return(g_capture.image);
+}
+
+// Stage timing, written to the debug log every KVM_TIMING_INTERVAL microseconds
+#define KVM_TIMING_INTERVAL 5000000
+int g_timingFrames = 0;
+long long g_timingStart = 0;
+
+void kvm_timing_frame()
+{
+	long long now = tile_time_us();
+
+	++g_timingFrames;
+	if (g_timingStart == 0) { g_timingStart = now; }
+	if (now - g_timingStart < KVM_TIMING_INTERVAL) { return; }
+
+	if (logFile)
+	{
+		fprintf(logFile, "KVM: %d frames in %lld ms, average us per frame: capture %lld, convert %lld, diff %lld, encode %lld, write %lld\n",
+			g_timingFrames, (now - g_timingStart) / 1000, g_tileTiming.capture / g_timingFrames, g_tileTiming.convert / g_timingFrames,
+			g_tileTiming.diff / g_timingFrames, g_tileTiming.encode / g_timingFrames, g_tileTiming.write / g_timingFrames);
+		fflush(logFile);
+	}
+	memset(&g_tileTiming, 0, sizeof(g_tileTiming));
+	g_timingFrames = 0;
+	g_timingStart = now;
+}
+
+// Rate control. The master stops reading the pipe while the connection to the viewer is backed up, so the bytes still
+// in the pipe after a frame, and the time spent blocked writing it, show how far behind the viewer is. While it is
+// behind, the frame interval goes up, then the JPEG quality goes down, so that what the viewer sees stays recent.
+// Both go back to what the viewer asked for (FRAME_RATE_TIMER and COMPRESSION_QUALITY) once the pipe drains.
+#define KVM_RATE_PENDING_HIGH 32768			// Bytes left in the pipe that count as backed up. A pipe holds 64K by default.
+#define KVM_RATE_PENDING_LOW 4096
+#define KVM_RATE_MAX_INTERVAL 1000			// Milliseconds
+#define KVM_RATE_MIN_QUALITY 20
+#define KVM_RATE_QUALITY_STEP 10
+typedef struct kvm_rate_control
+{
+	int interval;							// Frame interval in use, in milliseconds
+	int degraded;							// Set if tiles were sent at a lower quality than the viewer asked for
+}kvm_rate_control;
+kvm_rate_control g_rate = { 0 };
+
+// Called after each frame is written. busy is the time spent capturing and encoding, blocked the time spent waiting
+// on the pipe, both in microseconds.
+void kvm_rate_frame(long long busy, long long blocked)
+{
+	int pending = 0, interval = g_rate.interval, quality = g_tileQualityLimit, r, c;
+
+	if (ioctl(slave2master[1], FIONREAD, &pending) != 0) { pending = 0; }
+	if (interval < FRAME_RATE_TIMER) { interval = FRAME_RATE_TIMER; }
+
+	if (pending >= KVM_RATE_PENDING_HIGH || blocked > interval * 500LL)
+	{
+		// Falling behind. Slow down first, and only give up quality once the frame rate is halved.
+		if (interval < KVM_RATE_MAX_INTERVAL) { interval = (interval * 3 / 2) + 1; }
+		if (interval > KVM_RATE_MAX_INTERVAL) { interval = FRAME_RATE_TIMER > KVM_RATE_MAX_INTERVAL ? FRAME_RATE_TIMER : KVM_RATE_MAX_INTERVAL; }
+		if (interval >= 2 * FRAME_RATE_TIMER || interval >= KVM_RATE_MAX_INTERVAL)
+		{
+			quality = tile_quality() - KVM_RATE_QUALITY_STEP;
+			if (quality < KVM_RATE_MIN_QUALITY) { quality = KVM_RATE_MIN_QUALITY; }
+			if (quality < COMPRESSION_QUALITY) { g_rate.degraded = 1; }
+		}
+
+		// Fewer, larger regions save bytes, as long as the encoders have time to spare
+		g_tileCoalesceRows = busy < interval * 500LL ? TILE_HEIGHT_COUNT : 0;
+	}
+	else if (pending <= KVM_RATE_PENDING_LOW)
+	{
+		// Caught up. Quality comes back first, then the frame rate.
+		if (quality < COMPRESSION_QUALITY)
+		{
+			quality += (KVM_RATE_QUALITY_STEP / 2);
+			if (quality >= COMPRESSION_QUALITY) { quality = 100; }
+		}
+		else if (interval > FRAME_RATE_TIMER)
+		{
+			interval = interval * 7 / 8;
+			if (interval < FRAME_RATE_TIMER) { interval = FRAME_RATE_TIMER; }
+		}
+		else
+		{
+			quality = 100;
+			g_tileCoalesceRows = 0;
+			if (g_rate.degraded != 0)
+			{
+				// Send the whole screen again, at the quality the viewer asked for
+				g_rate.degraded = 0;
+				for (r = 0; r < TILE_HEIGHT_COUNT; r++) { for (c = 0; c < TILE_WIDTH_COUNT; c++) { g_tileInfo[r][c].crc = 0xff; } }
+				g_damageFullFrame = 1;
+			}
+		}
+	}
+
+	if (logFile && (interval != g_rate.interval || quality != g_tileQualityLimit))
+	{
+		fprintf(logFile, "KVM: Rate control, pending %d bytes, busy %lld us, blocked %lld us, interval %d ms, quality %d\n", pending, busy, blocked, interval, quality < COMPRESSION_QUALITY ? quality : COMPRESSION_QUALITY);
+		fflush(logFile);
+	}
+	g_rate.interval = interval;
+	g_tileQualityLimit = quality;
+}
+
+// We can't go full speed here, we need to slow this down.
+void kvm_server_frame_wait()
+{
+	int maxsleep, remaining = g_rate.interval > FRAME_RATE_TIMER ? g_rate.interval : FRAME_RATE_TIMER;
+	while (!g_shutdown && remaining > 0)
+	{
+		if (remaining > 50)
+		{
+			remaining -= 50;
+			maxsleep = 50000;
+		}
+		else 
+		{
+			maxsleep = remaining * 1000;
+			remaining = 0;
+		}
+
+		usleep(maxsleep);
+	}
+}
+
+// Output of the current frame. The tile packets and cursor messages of a frame are collected here, and written to the
+// master together, instead of with a write per packet. Past KVM_FRAME_OUTPUT_FLUSH bytes, the output is written early,
+// so the master can start relaying a large frame while the rest of it is encoded.
+#define KVM_FRAME_OUTPUT_FLUSH 262144
+typedef struct kvm_frame_output
+{
+	char *buffer;
+	size_t length, size;
+}kvm_frame_output;
+kvm_frame_output g_frameOutput = { 0 };
+
+void kvm_frame_append(void *buffer, size_t bufferSize)
+{
+	if (g_frameOutput.length + bufferSize > g_frameOutput.size)
+	{
+		g_frameOutput.size = g_frameOutput.size == 0 ? 65536 : g_frameOutput.size * 2;
+		if (g_frameOutput.size < g_frameOutput.length + bufferSize) { g_frameOutput.size = g_frameOutput.length + bufferSize; }
+		if ((g_frameOutput.buffer = (char*)realloc(g_frameOutput.buffer, g_frameOutput.size)) == NULL) { ILIBCRITICALEXIT(254); }
+	}
+	memcpy_s(g_frameOutput.buffer + g_frameOutput.length, g_frameOutput.size - g_frameOutput.length, buffer, bufferSize);
+	g_frameOutput.length += bufferSize;
+}
+
+// Writes the collected output to the master. Returns non-zero if the master is gone.
+int kvm_frame_flush()
+{
+	size_t offset = 0;
+	ssize_t written;
+
+	while (offset < g_frameOutput.length)
+	{
+		written = write(slave2master[1], g_frameOutput.buffer + offset, g_frameOutput.length - offset);
+		if (written < 0 && errno == EINTR) { continue; }
+		if (written <= 0) { /*ILIBMESSAGE("KVMBREAK-K2\r\n");*/ g_shutdown = 1; break; }
+		offset += (size_t)written;
+	}
+	g_frameOutput.length = 0;
+	return(g_shutdown);
+}
+
+// Adds an encoded tile to the frame output. Returns non-zero to stop the frame.
+int kvm_server_write_tile(void *buffer, long long bufferSize, void *user)
+{
+	UNREFERENCED_PARAMETER(user);
+
+	if (g_shutdown) { return 1; }
+	kvm_frame_append(buffer, (size_t)bufferSize);
+	if (g_frameOutput.length >= KVM_FRAME_OUTPUT_FLUSH) { return(kvm_frame_flush()); }
+	return 0;
+}
+
 void* kvm_server_mainloop(void* parm)
 {
-	int maxsleep;
 	Window rr, cr;
 	int rx, ry, wx, wy, rs;
 	unsigned int mr;
 	char *cimage;
 
-	int x, y, height, width, r, c, count = 0;
+	int y, height, r, c, count = 0;
 	int sentHideCursor = 0;
+	int damaged, drawCursor, bandEnd;
+	unsigned short cursorW = 64, cursorH = 64;
+	XRectangle cursorRect;
+	XImage *band;
 	long long desktopsize = 0;
-	long long tilesize = 0;
+	tile_source source;
 
 	void *desktop = NULL;
 	XImage *image = NULL;
 	eventdisplay = NULL;
 	Display *imagedisplay = NULL, *cursordisplay = NULL;
-	void *buf = NULL;
 	char displayString[256] = "";
 	int event_base = 0, error_base = 0, cursor_descriptor = -1;
 	int screen_height, screen_width, screen_depth, screen_num;
-	ssize_t written;
-	XShmSegmentInfo shminfo;
+	XWindowAttributes rootAttributes;
+	long long stageStart, frameStart, frameWrite;
 	default_JPEG_error_handler = kvm_server_jpegerror;
 
 	struct timeval tv;
@@ -1006,6 +1378,7 @@ void* kvm_server_mainloop(void* parm)
 	// Init the kvm
 	//fprintf(logFile, "Before kvm_init.\n"); fflush(logFile);
 	if (kvm_init(current_display) != 0) { return (void*)-1; }
+	start_tile_encoders(0);
 	kvm_send_display_list();
 	//fprintf(logFile, "After kvm_init.\n"); fflush(logFile);
 
@@ -1044,19 +1417,19 @@ void* kvm_server_mainloop(void* parm)
 		//fprintf(logFile, "After CheckDesktopSwitch.\n"); fflush(logFile);
 
 		sprintf_s(displayString, sizeof(displayString), ":%d", (int)current_display);
-		imagedisplay = x11_exports->XOpenDisplay(displayString);
+		kvm_capture_open(displayString, current_display);
+		imagedisplay = g_capture.display;
 
 		count = 0;
 
 		if (imagedisplay == NULL && count++ < 100) 
 		{
 			change_display = 1;
-			if (getNextDisplay() == -1) { return (void*)-1; }
+			if (getNextDisplay() == -1) { kvm_capture_close(); stop_tile_encoders(); return (void*)-1; }
 			//fprintf(logFile, "Before kvm_init1.\n"); fflush(logFile);
 			kvm_init(current_display);
 			//fprintf(logFile, "After kvm_init1.\n"); fflush(logFile);
 			change_display = 0;
-			if (image != NULL) { XDestroyImage(image); image = NULL; }
 			continue;
 		}
 
@@ -1165,18 +1538,19 @@ void* kvm_server_mainloop(void* parm)
 							((unsigned short*)buffer)[0] = (unsigned short)htons((unsigned short)MNG_KVM_MOUSE_CURSOR);	// Write the type
 							((unsigned short*)buffer)[1] = (unsigned short)htons((unsigned short)5);					// Write the size
 							buffer[4] = (char)curcursor;																// Cursor Type
-							written = write(slave2master[1], buffer, 5);
-							fsync(slave2master[1]);
+							ignore_result(write(slave2master[1], buffer, 5));
 						}
 					}
 				}
 			}
 		}
 
+		// The connection is kept open, so the screen values it cached when it was opened can be out of date. The root window isn't.
 		screen_num = DefaultScreen(imagedisplay);
-		screen_height = DisplayHeight(imagedisplay, screen_num);
-		screen_width = DisplayWidth(imagedisplay, screen_num);
-		screen_depth = DefaultDepth(imagedisplay, screen_num);
+		if (x11_exports->XGetWindowAttributes(imagedisplay, RootWindow(imagedisplay, screen_num), &rootAttributes) == 0) { kvm_capture_close(); kvm_server_frame_wait(); continue; }
+		screen_height = rootAttributes.height;
+		screen_width = rootAttributes.width;
+		screen_depth = rootAttributes.depth;
 
 		if (screen_depth <= 15) {
 			//fprintf(logFile, "We do not support display depth %d < 15.\n", screen_depth); fflush(logFile);
@@ -1187,28 +1561,81 @@ void* kvm_server_mainloop(void* parm)
 		if ((SCREEN_HEIGHT != screen_height || SCREEN_WIDTH != screen_width || SCREEN_DEPTH != screen_depth || SCREEN_NUM != screen_num)) 
 		{
 			kvm_init(current_display);
-			if (image != NULL) { XDestroyImage(image); image = NULL; }
 			continue;
 		}
 
+		// The pointer is queried before the capture, so the area the cursor is drawn into can be checked
+		rs = x11_exports->XQueryPointer(imagedisplay, RootWindowOfScreen(DefaultScreenOfDisplay(imagedisplay)),
+			&rr, &cr, &rx, &ry, &wx, &wy, &mr);
+		drawCursor = (rs == 1 && cursordisplay != NULL && (gRemoteMouseRenderDefault != 0 || (remoteMouseX != rx && remoteMouseY != ry)));
+
+		if ((image = kvm_capture_image(screen_num, screen_width, screen_height, screen_depth)) == NULL)
+		{
+			g_shutdown = 1;
+			break;
+		}
+
+		// With XDamage, only the damaged tiles are captured and checked. Otherwise, every tile is captured and checked.
+		damaged = -1;
+		kvm_damage_open(displayString, current_display);
+		if (damagedisplay != NULL)
+		{
+			cursorRect.x = (short)(rx - cursorW);
+			cursorRect.y = (short)(ry - cursorH);
+			cursorRect.width = cursorW * 2;
+			cursorRect.height = cursorH * 2;
+			damaged = kvm_damage_collect(drawCursor ? &cursorRect : NULL);
+			if (g_damageFullFrame != 0)
+			{
+				for (r = 0; r < TILE_HEIGHT_COUNT; r++) {
+					for (c = 0; c < TILE_WIDTH_COUNT; c++) {
+						g_tileInfo[r][c].flag = TILE_TODO;
+					}
+				}
+				g_damageFullFrame = 0;
+				damaged = -1;
+			}
+			if (damaged == 0)
+			{
+				// Nothing changed, but the rate control still sees the pipe drain
+				kvm_rate_frame(0, 0);
+				kvm_server_frame_wait();
+				continue;
+			}
+		}
 
-		image = x11ext_exports->XShmCreateImage(imagedisplay,
-			DefaultVisual(imagedisplay, screen_num), // Use a correct visual. Omitted for brevity     
-			screen_depth,
-			ZPixmap, NULL, &shminfo, screen_width, screen_height);
-		shminfo.shmid = shmget(IPC_PRIVATE,
-			image->bytes_per_line * image->height,
-			IPC_CREAT | 0777);
-		shminfo.shmaddr = image->data = shmat(shminfo.shmid, 0, 0);
-		shminfo.readOnly = False;
-		x11ext_exports->XShmAttach(imagedisplay, &shminfo);
-		
-		x11ext_exports->XShmGetImage(imagedisplay,
-			RootWindowOfScreen(DefaultScreenOfDisplay(imagedisplay)),
-			image,
-			0,
-			0,
-			AllPlanes);
+		stageStart = frameStart = tile_time_us();
+		frameWrite = g_tileTiming.write;
+		if (damaged < 0)
+		{
+			x11ext_exports->XShmGetImage(imagedisplay,
+				RootWindowOfScreen(DefaultScreenOfDisplay(imagedisplay)),
+				image,
+				0,
+				0,
+				AllPlanes);
+		}
+		else
+		{
+			// Capture each band of tile rows with damaged tiles, into its place in the shared image
+			for (r = 0; r < TILE_HEIGHT_COUNT; r = bandEnd)
+			{
+				bandEnd = r + 1;
+				if (!kvm_tile_row_todo(r)) { continue; }
+				while (bandEnd < TILE_HEIGHT_COUNT && kvm_tile_row_todo(bandEnd)) { ++bandEnd; }
+
+				y = r * TILE_HEIGHT;
+				height = (bandEnd * TILE_HEIGHT > screen_height ? screen_height : bandEnd * TILE_HEIGHT) - y;
+				band = x11ext_exports->XShmCreateImage(imagedisplay, DefaultVisual(imagedisplay, screen_num), screen_depth, ZPixmap,
+					image->data + ((long long)y * image->bytes_per_line), &(g_capture.shminfo), screen_width, height);
+				if (band != NULL)
+				{
+					x11ext_exports->XShmGetImage(imagedisplay, RootWindowOfScreen(DefaultScreenOfDisplay(imagedisplay)), band, 0, y, AllPlanes);
+					XDestroyImage(band);
+				}
+			}
+		}
+		g_tileTiming.capture += (tile_time_us() - stageStart);
 
 		//image = XGetImage(imagedisplay,
 		//		RootWindowOfScreen(DefaultScreenOfDisplay(imagedisplay))
@@ -1220,11 +1647,9 @@ void* kvm_server_mainloop(void* parm)
 		}
 		else 
 		{
-			rs = x11_exports->XQueryPointer(imagedisplay, RootWindowOfScreen(DefaultScreenOfDisplay(imagedisplay)),
-				&rr, &cr, &rx, &ry, &wx, &wy, &mr);
 			if (rs == 1 && cursordisplay != NULL)
 			{
-				if (gRemoteMouseRenderDefault != 0 || (remoteMouseX != rx && remoteMouseY != ry))
+				if (drawCursor)
 				{
 					cimage = (char*)xfixes_exports->XFixesGetCursorImage(cursordisplay);
 					unsigned short w = ((unsigned short*)(cimage + 4))[0];
@@ -1241,6 +1666,10 @@ void* kvm_server_mainloop(void* parm)
 					if (yhot > ry) { my = 0; } else if ((my + h) > screen_height) { my = screen_height - h; }
 
 					bitblt(pixels, (int)w, (int)h, 0, 0, (int)w, (int)h, image->data, screen_width, screen_height, mx, my, 1);
+					g_damageCursor.x = (short)mx; g_damageCursor.y = (short)my;
+					g_damageCursor.width = w; g_damageCursor.height = h;
+					if (w > cursorW) { cursorW = w; }
+					if (h > cursorH) { cursorH = h; }
 
 					if (sentHideCursor == 0)
 					{
@@ -1249,8 +1678,7 @@ void* kvm_server_mainloop(void* parm)
 						((unsigned short*)tmpbuffer)[0] = (unsigned short)htons((unsigned short)MNG_KVM_MOUSE_CURSOR);	// Write the type
 						((unsigned short*)tmpbuffer)[1] = (unsigned short)htons((unsigned short)5);						// Write the size
 						tmpbuffer[4] = (char)KVM_MouseCursor_NONE;														// Cursor Type
-						written = write(slave2master[1], tmpbuffer, 5);
-						fsync(slave2master[1]);
+						kvm_frame_append(tmpbuffer, 5);
 					}
 				}
 				else
@@ -1262,70 +1690,40 @@ void* kvm_server_mainloop(void* parm)
 						((unsigned short*)tmpbuffer)[0] = (unsigned short)htons((unsigned short)MNG_KVM_MOUSE_CURSOR);	// Write the type
 						((unsigned short*)tmpbuffer)[1] = (unsigned short)htons((unsigned short)5);						// Write the size
 						tmpbuffer[4] = (char)curcursor;																	// Cursor Type
-						written = write(slave2master[1], tmpbuffer, 5);
-						fsync(slave2master[1]);
+						kvm_frame_append(tmpbuffer, 5);
 					}
 					sentHideCursor = 0;
 				}
 			}
-			getScreenBuffer((char **)&desktop, &desktopsize, image);
-
-			for (y = 0; y < TILE_HEIGHT_COUNT; y++) {
-				for (x = 0; x < TILE_WIDTH_COUNT; x++) {
-					height = TILE_HEIGHT * y;
-					width = TILE_WIDTH * x;
-
-					if (g_shutdown) { x = TILE_WIDTH_COUNT; y = TILE_HEIGHT_COUNT; break; }
-
-					if (g_tileInfo[y][x].flag == TILE_SENT || g_tileInfo[y][x].flag == TILE_DONT_SEND) {
-						continue;
-					}
-
-					getTileAt(width, height, &buf, &tilesize, desktop, desktopsize, y, x);
-
-					if (buf && !g_shutdown)
-					{
-						// Write the reply to the pipe.
-						//fprintf(logFile, "Writing to master in kvm_server_mainloop\n");
-						written = write(slave2master[1], buf, tilesize);
-						fsync(slave2master[1]);
-						//fprintf(logFile, "Wrote %d bytes to master in kvm_server_mainloop\n", written);
-						free(buf);
-						if (written == -1) { /*ILIBMESSAGE("KVMBREAK-K2\r\n");*/ g_shutdown = 1; height = SCREEN_HEIGHT; width = SCREEN_WIDTH; break; }
-					}
+			// The tiles are read straight from the image, unless libjpeg can't read its pixel layout
+			stageStart = tile_time_us();
+			if (tile_source_image(&source, image) != 0)
+			{
+				if (damaged < 0)
+				{
+					getScreenBuffer((char **)&desktop, &desktopsize, image);
+				}
+				else
+				{
+					for (r = 0; r < TILE_HEIGHT_COUNT; r++) { if (kvm_tile_row_todo(r)) { getScreenBufferRows((char*)desktop, image, r * TILE_HEIGHT, TILE_HEIGHT); } }
 				}
+				tile_source_buffer(&source, (char*)desktop);
 			}
-		}
-		
-		x11ext_exports->XShmDetach(imagedisplay, &shminfo);
-		XDestroyImage(image); image = NULL;
-		shmdt(shminfo.shmaddr);
-		shmctl(shminfo.shmid, IPC_RMID, 0);
-		
-		if (imagedisplay != NULL) 
-		{
-			x11_exports->XCloseDisplay(imagedisplay);
-			imagedisplay = NULL;
+			g_tileTiming.convert += (tile_time_us() - stageStart);
+
+			// Encode the changed tiles, and write them to the master in order, with the rest of the frame. Moves must come first.
+			if (g_kvmCopyRect != 0) { getTileMoves(&source, kvm_server_write_tile, NULL); }
+			getTiles(&source, kvm_server_write_tile, NULL);
+			stageStart = tile_time_us();
+			kvm_frame_flush();
+			g_tileTiming.write += (tile_time_us() - stageStart);
+			kvm_rate_frame((tile_time_us() - frameStart) - (g_tileTiming.write - frameWrite), g_tileTiming.write - frameWrite);
+			kvm_timing_frame();
 		}
 
-		// We can't go full speed here, we need to slow this down.
-		height = FRAME_RATE_TIMER;
-		while (!g_shutdown && height > 0)
-		{
-			if (height > 50)
-			{
-				height -= 50;
-				maxsleep = 50000;
-			}
-			else 
-			{
-				maxsleep = height * 1000;
-				height = 0;
-			}
-
-			usleep(maxsleep);
-		}
+		kvm_server_frame_wait();
 	}
+	kvm_capture_close();
 
 	close(slave2master[1]);
 	close(master2slave[0]);
@@ -1343,6 +1741,8 @@ void* kvm_server_mainloop(void* parm)
 		x11_exports->XCloseDisplay(cursordisplay);
 		cursordisplay = NULL;
 	}
+	kvm_damage_close();
+	g_damageDisplayNumber = -1;
 
 	if (g_tileInfo != NULL)
 	{
@@ -1351,42 +1751,40 @@ void* kvm_server_mainloop(void* parm)
 		g_tileInfo = NULL;
 	}
 	if(tilebuffer != NULL) { free(tilebuffer); tilebuffer = NULL; }
+	if (desktop != NULL) { free(desktop); }
+	if (g_frameOutput.buffer != NULL) { free(g_frameOutput.buffer); memset(&g_frameOutput, 0, sizeof(g_frameOutput)); }
+	stop_tile_encoders();
 	return (void*)0;
 }
 
+// Forwards every complete packet in the buffer. A frame from the slave usually arrives as many packets at once, but each
+// one is written on its own, because the viewer expects one command per message.
 void kvm_relay_readSink(ILibProcessPipe_Pipe sender, char *buffer, size_t bufferLen, size_t* bytesConsumed)
 {
 	ILibKVM_WriteHandler writeHandler = (ILibKVM_WriteHandler)((void**)ILibMemory_Extra(sender))[0];
 	void *reserved = ((void**)ILibMemory_Extra(sender))[1];
-	unsigned short size;
+	unsigned char *packet;
+	size_t len = 0, size;
 
-	if (bufferLen > 4)
+	// The packets aren't aligned, so the headers are read a byte at a time
+	while (bufferLen - len >= 4)
 	{
-		if (ntohs(((unsigned short*)(buffer))[0]) == (unsigned short)MNG_JUMBO)
+		packet = (unsigned char*)buffer + len;
+		if (((packet[0] << 8) | packet[1]) == MNG_JUMBO)
 		{
-			if (bufferLen > 8)
-			{
-				if (bufferLen >= (8 + (int)ntohl(((unsigned int*)(buffer))[1])))
-				{
-					*bytesConsumed = 8 + (int)ntohl(((unsigned int*)(buffer))[1]);
-					writeHandler(buffer, *bytesConsumed, reserved);
-					return;
-				}
-			}
+			if (bufferLen - len < 8) { break; }
+			size = 8 + (((size_t)packet[4] << 24) | ((size_t)packet[5] << 16) | ((size_t)packet[6] << 8) | (size_t)packet[7]);
 		}
 		else
 		{
-			size = ntohs(((unsigned short*)(buffer))[1]);
-			if (size <= bufferLen)
-			{
-				*bytesConsumed = size;
-				writeHandler(buffer, size, reserved);
-				return;
-			}
+			size = (packet[2] << 8) | packet[3];
 		}
+		if (size < 4 || size > bufferLen - len) { break; }
+		writeHandler((char*)packet, (int)size, reserved);
+		len += size;
 	}
-	*bytesConsumed = 0;
 
+	*bytesConsumed = len;
 }
 
 void kvm_relay_brokenPipeSink(ILibProcessPipe_Pipe sender)
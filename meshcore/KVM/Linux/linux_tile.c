@@ -17,6 +17,9 @@ limitations under the License.
 #include "linux_tile.h"
 #include "meshcore/meshdefines.h"
 #include "microstack/ILibParsers.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
 
 #if defined(JPEGMAXBUF)
 	#define MAX_TILE_SIZE JPEGMAXBUF
@@ -40,44 +43,92 @@ extern int jpeg_buffer_length;
 int tilebuffersize = 0;
 void* tilebuffer = NULL;
 int COMPRESSION_QUALITY = 50;
+int g_tileQualityLimit = 100;			// Upper bound on COMPRESSION_QUALITY, lowered by the KVM rate control when the connection falls behind
+int g_tileCoalesceRows = 0;				// Tile rows per encoder job, or 0 to split a frame evenly between the encoders
+tile_stage_timing g_tileTiming = { 0 };
+
+// JPEG quality to encode with: what the viewer asked for, unless the rate control lowered it
+int tile_quality()
+{
+	return(COMPRESSION_QUALITY < g_tileQualityLimit ? COMPRESSION_QUALITY : g_tileQualityLimit);
+}
+
+// Monotonic time in microseconds, for the stage timing
+long long tile_time_us()
+{
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) { return(0); }
+	return(((long long)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000));
+}
 
 /******************************************************************************
  * INTERNAL FUNCTIONS
  ******************************************************************************/
 
-//Extracts the required tile buffer from the desktop buffer
-int get_tile_buffer(int x, int y, void **buffer, long long bufferSize, void *desktop, long long desktopsize, int tilewidth, int tileheight)
+//Copies the region into a packed buffer. Whatever is past the edge of the source is padded with black.
+int get_tile_buffer(int x, int y, char *buffer, tile_source *source, int tilewidth, int tileheight)
 {
-	char *target = *buffer;
-	int height = 0;
+	int row, rowbytes = tilewidth * source->pixelSize;
+	int copybytes = (x + tilewidth > source->width ? source->width - x : tilewidth) * source->pixelSize;
 
-	for (height = y; height < y + tileheight; height++) {
-		memcpy_s(target, (size_t)bufferSize, (const void *)(((char *)desktop) + (3 * ((height * adjust_screen_size(SCREEN_WIDTH)) + x))), (size_t)(tilewidth * 3));
-		target = (char *) (target + (3 * tilewidth));
+	for (row = y; row < y + tileheight; row++) {
+		if (row < source->height && copybytes > 0) {
+			memcpy_s(buffer, (size_t)rowbytes, source->data + ((long long)row * source->stride) + (x * source->pixelSize), (size_t)copybytes);
+			memset(buffer + copybytes, 0, rowbytes - copybytes);
+		}
+		else {
+			memset(buffer, 0, rowbytes);
+		}
+		buffer += rowbytes;
 	}
 
 	return 0;
 }
 
+//Encodes the region. A region inside the source is read in place, one that reaches past its edge is copied into the tile buffer and padded first.
+void tile_encode_region(JPEG_encoder *encoder, void **tilebuffer, int *tilebuffersize, tile_source *source, int x, int y, int width, int height, int quality)
+{
+	char *pixels;
+	int stride;
+
+	if (x + width <= source->width && y + height <= source->height)
+	{
+		pixels = source->data + ((long long)y * source->stride) + (x * source->pixelSize);
+		stride = source->stride;
+	}
+	else
+	{
+		// Make sure a tile buffer is available. Most of the time, this is skipped.
+		if (*tilebuffersize < width * height * source->pixelSize)
+		{
+			if (*tilebuffer != NULL) { free(*tilebuffer); }
+			*tilebuffersize = width * height * source->pixelSize;
+			if ((*tilebuffer = malloc(*tilebuffersize)) == NULL) { ILIBCRITICALEXIT(254); }
+		}
+		get_tile_buffer(x, y, (char*)*tilebuffer, source, width, height);
+		pixels = (char*)*tilebuffer;
+		stride = width * source->pixelSize;
+	}
+
+	write_JPEG_bufferEx2(encoder, (JSAMPLE*)pixels, stride, source->colorSpace, source->pixelSize, width, height, quality);
+}
+
 //This function returns 0 and *buffer != NULL if everything was good. retval = jpegsize if the captured image was too large.
-int calc_opt_compr_send(int x, int y, int captureWidth, int captureHeight, void* desktop, long long desktopsize, void ** buffer, long long *bufferSize)
+int calc_opt_compr_send(int x, int y, int captureWidth, int captureHeight, tile_source *source, void ** buffer, long long *bufferSize)
 {
+	static JPEG_encoder *encoder = NULL;
 
 	*buffer = NULL;
 	*bufferSize = 0;
 
-	// Make sure a tile buffer is available. Most of the time, this is skipped.
-	if (tilebuffersize != captureWidth * captureHeight * 3)
-	{
-		if (tilebuffer != NULL) free(tilebuffer);
-		tilebuffersize = captureWidth * captureHeight * 3;
-		if ((tilebuffer = malloc(tilebuffersize)) == NULL) return 0;
-	}
-
-	//Get the final coalesced tile
-	get_tile_buffer(x, y, &tilebuffer, tilebuffersize, desktop, desktopsize, captureWidth, captureHeight);
+	if (encoder == NULL) { encoder = JPEG_encoder_create(); }
+	tile_encode_region(encoder, &tilebuffer, &tilebuffersize, source, x, y, captureWidth, captureHeight, tile_quality());
 
-	write_JPEG_buffer(tilebuffer, captureWidth, captureHeight, COMPRESSION_QUALITY);
+	// The jpeg is handed over in jpeg_buffer, as write_JPEG_buffer() does
+	if (jpeg_buffer != NULL) { free(jpeg_buffer); }
+	jpeg_buffer = encoder->buffer;
+	jpeg_buffer_length = encoder->bufferLength;
+	encoder->buffer = NULL;
 
 #if MAX_TILE_SIZE > 0
 	if (jpeg_buffer_length > MAX_TILE_SIZE)
@@ -140,16 +191,23 @@ void dump32bit (const XImage * input)
 #endif
 
 // Really fast CRC-like method. Used for the KVM.
-int util_crc(int x, int y, long long bufferSize, void *desktop, long long desktopsize, int tilewidth, int tileheight)
+// The fingerprint of a tile is only ever compared with an earlier fingerprint of the same tile, so any kernel
+// can be used, as long as the same one is used for the lifetime of the process. The kernel is picked at runtime.
+typedef int(*util_crc_kernel)(const char *tile, int stride, int rowbytes, int rows);
+util_crc_kernel g_util_crc = NULL;
+char *g_util_crc_name = NULL;
+
+// Scalar kernel, hashes 32 bit words
+int util_crc_scalar(const char *tile, int stride, int rowbytes, int rows)
 {
     int hval = 0;
     int *bp = NULL;
     int *be = NULL;
     int height = 0;
 
-    for (height = y; height < y + tileheight; height++) {
-    	bp = (int *)(((char *)desktop) + (3 * ((height * adjust_screen_size(SCREEN_WIDTH)) + x)));
-    	be = (int *)(((char *)desktop) + (3 * ((height * adjust_screen_size(SCREEN_WIDTH)) + x + tilewidth)));
+    for (height = 0; height < rows; height++) {
+    	bp = (int *)(tile + (height * stride));
+    	be = (int *)(tile + (height * stride) + rowbytes);
     	while ((bp + 1) <= be)
 		{
 			// hval *= 0x01000193;
@@ -166,6 +224,137 @@ int util_crc(int x, int y, long long bufferSize, void *desktop, long long deskto
     return hval;
 }
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define UTIL_CRC_X86
+#include <immintrin.h>
+
+#define UTIL_CRC_ROTL32(v, r) (((uint32_t)(v) << (r)) | ((uint32_t)(v) >> (32 - (r))))
+
+// SSE4.2 kernel. Three independent crc32c streams per row, to keep the crc32 unit busy.
+__attribute__((target("sse4.2")))
+int util_crc_sse42(const char *tile, int stride, int rowbytes, int rows)
+{
+	const char *p;
+	int row, i;
+#if defined(__x86_64__)
+	uint64_t a = 0, b = 0x9E3779B9, c = 0x7F4A7C15, v0, v1, v2;
+	for (row = 0; row < rows; ++row)
+	{
+		p = tile + (row * stride);
+		for (i = 0; i + 24 <= rowbytes; i += 24)
+		{
+			memcpy(&v0, p + i, 8); memcpy(&v1, p + i + 8, 8); memcpy(&v2, p + i + 16, 8);
+			a = _mm_crc32_u64(a, v0);
+			b = _mm_crc32_u64(b, v1);
+			c = _mm_crc32_u64(c, v2);
+		}
+		for (; i + 8 <= rowbytes; i += 8) { memcpy(&v0, p + i, 8); a = _mm_crc32_u64(a, v0); }
+		for (; i < rowbytes; ++i) { a = _mm_crc32_u8((uint32_t)a, (unsigned char)p[i]); }
+	}
+#else
+	uint32_t a = 0, b = 0x9E3779B9, c = 0x7F4A7C15, v0, v1, v2;
+	for (row = 0; row < rows; ++row)
+	{
+		p = tile + (row * stride);
+		for (i = 0; i + 12 <= rowbytes; i += 12)
+		{
+			memcpy(&v0, p + i, 4); memcpy(&v1, p + i + 4, 4); memcpy(&v2, p + i + 8, 4);
+			a = _mm_crc32_u32(a, v0);
+			b = _mm_crc32_u32(b, v1);
+			c = _mm_crc32_u32(c, v2);
+		}
+		for (; i + 4 <= rowbytes; i += 4) { memcpy(&v0, p + i, 4); a = _mm_crc32_u32(a, v0); }
+		for (; i < rowbytes; ++i) { a = _mm_crc32_u8(a, (unsigned char)p[i]); }
+	}
+#endif
+	return((int)((uint32_t)a ^ UTIL_CRC_ROTL32(b, 11) ^ UTIL_CRC_ROTL32(c, 22)));
+}
+
+// AVX2 kernel. Each 32 byte stripe is mixed into an accumulator with a 32x32->64 multiply, using a key
+// that depends on the position of the stripe in the row, and on the row.
+#define UTIL_CRC_AVX2_ACCUMULATE(acc, src, key) \
+	{ \
+		__m256i d = _mm256_loadu_si256((const __m256i*)(src)); \
+		__m256i dk = _mm256_xor_si256(d, (key)); \
+		acc = _mm256_add_epi64(acc, _mm256_shuffle_epi32(d, 0x4E)); \
+		acc = _mm256_add_epi64(acc, _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32))); \
+	}
+__attribute__((target("avx2")))
+int util_crc_avx2(const char *tile, int stride, int rowbytes, int rows)
+{
+	const __m256i k0 = _mm256_set_epi64x(0x1CAD21F72C81017CLL, 0xDB979083E96DD4DELL, 0x1F67B3B7A4A44072LL, 0x78E5C0CC4EE679CBLL);
+	const __m256i k1 = _mm256_set_epi64x(0x2172FFCC7DD05A82LL, 0x8E2443F7744608B8LL, 0x4C263A81E69035E0LL, 0xCB00C391BB52283CLL);
+	const __m256i k2 = _mm256_set_epi64x(0xA32E531B8B65D088LL, 0x4EF90DA297486471LL, 0xD8ACDEA946EF1938LL, 0x3F349CE33F76FAA8LL);
+	__m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256(), acc2 = _mm256_setzero_si256(), rk;
+	uint64_t lanes[4], h;
+	uint32_t tail;
+	const char *p;
+	int row, i;
+
+	for (row = 0; row < rows; ++row)
+	{
+		p = tile + (row * stride);
+		rk = _mm256_set1_epi32((int)(0x9E3779B1u * (uint32_t)(row + 1)));
+		for (i = 0; i + 96 <= rowbytes; i += 96)
+		{
+			UTIL_CRC_AVX2_ACCUMULATE(acc0, p + i, _mm256_add_epi32(k0, rk));
+			UTIL_CRC_AVX2_ACCUMULATE(acc1, p + i + 32, _mm256_add_epi32(k1, rk));
+			UTIL_CRC_AVX2_ACCUMULATE(acc2, p + i + 64, _mm256_add_epi32(k2, rk));
+		}
+		for (; i + 32 <= rowbytes; i += 32) { UTIL_CRC_AVX2_ACCUMULATE(acc0, p + i, _mm256_add_epi32(k1, rk)); }
+		if (i < rowbytes)
+		{
+			for (tail = 0x811C9DC5; i < rowbytes; ++i) { tail = (tail ^ (unsigned char)p[i]) * 0x01000193; }
+			acc1 = _mm256_add_epi64(acc1, _mm256_set1_epi64x((long long)tail * (row + 1)));
+		}
+	}
+
+	_mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(_mm256_add_epi64(acc0, _mm256_slli_epi64(acc1, 1)), _mm256_slli_epi64(acc2, 2)));
+	h = lanes[0] ^ ((lanes[1] << 17) | (lanes[1] >> 47)) ^ ((lanes[2] << 31) | (lanes[2] >> 33)) ^ ((lanes[3] << 47) | (lanes[3] >> 17));
+	h ^= h >> 33; h *= 0xFF51AFD7ED558CCDULL; h ^= h >> 33;
+	return((int)(uint32_t)(h ^ (h >> 32)));
+}
+#endif
+
+// Selects the kernel used by util_crc. UTIL_CRC_AUTO picks the fastest kernel the CPU supports.
+// Returns the kernel that was selected, which is UTIL_CRC_SCALAR if the requested kernel isn't supported.
+int util_crc_select(int kernel)
+{
+#ifdef UTIL_CRC_X86
+	__builtin_cpu_init();
+	if ((kernel == UTIL_CRC_AUTO || kernel == UTIL_CRC_AVX2) && __builtin_cpu_supports("avx2"))
+	{
+		g_util_crc_name = "avx2";
+		g_util_crc = util_crc_avx2;
+		return(UTIL_CRC_AVX2);
+	}
+	if ((kernel == UTIL_CRC_AUTO || kernel == UTIL_CRC_SSE42) && __builtin_cpu_supports("sse4.2"))
+	{
+		g_util_crc_name = "sse4.2";
+		g_util_crc = util_crc_sse42;
+		return(UTIL_CRC_SSE42);
+	}
+#endif
+	g_util_crc_name = "scalar";
+	g_util_crc = util_crc_scalar;
+	return(UTIL_CRC_SCALAR);
+}
+char* util_crc_name()
+{
+	if (g_util_crc == NULL) { util_crc_select(UTIL_CRC_AUTO); }
+	return(g_util_crc_name);
+}
+
+// Fingerprint of the tile at (x, y). A tile that reaches past the edge of the source only covers the pixels inside it.
+int util_crc(tile_source *source, int x, int y, int tilewidth, int tileheight)
+{
+	if (g_util_crc == NULL) { util_crc_select(UTIL_CRC_AUTO); }
+	if (x + tilewidth > source->width) { tilewidth = source->width - x; }
+	if (y + tileheight > source->height) { tileheight = source->height - y; }
+	if (tilewidth <= 0 || tileheight <= 0) { return(0); }
+	return(g_util_crc(source->data + ((long long)y * source->stride) + (x * source->pixelSize), source->stride, source->pixelSize * tilewidth, tileheight));
+}
+
 /******************************************************************************
  * EXTERNAL FUNCTIONS
  ******************************************************************************/
@@ -204,10 +393,11 @@ int reset_tile_info(int old_height_count) {
 	return 0;
 }
 
-//Fetches the encoded jpeg tile at the given location. The neighboring tiles are coalesced to form a larger jpeg before returning.
-int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop, long long desktopsize, int row, int col)
+//Finds the changed tiles that can be coalesced with the tile at the given location, and marks them TILE_MARKED_NOT_SENT.
+//The region is at most maxRows tiles high. Returns 0 if the tile hasn't changed, otherwise the region is (row, col) to (*botrowOut, *rightcolOut).
+int coalesce_tiles(int x, int y, tile_source *source, int row, int col, int maxRows, int *botrowOut, int *rightcolOut)
 {
-	int CRC, rcol, i, r, c;
+	int CRC, rcol, i;
 	int rightcol = col; //Used in coalescing. Indicates the rightmost column to be coalesced.
 	int botrow = row; //Used in coalescing. Indicates the bottom most row to be coalesced.
 	int r_x = x;
@@ -215,11 +405,8 @@ int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop,
 	int captureWidth = TILE_WIDTH;
 	int captureHeight = TILE_HEIGHT;
 
-	*buffer = NULL; // If anything fails, this will be the indication.
-	*bufferSize = 0;
-
 	if (g_tileInfo[row][col].flag == TILE_TODO) { //First check whether the tile-crc needs to be calculated or not.
-		if ((CRC = util_crc(x, y, TILE_HEIGHT * TILE_WIDTH * 3, desktop, desktopsize, TILE_WIDTH, TILE_HEIGHT)) == g_tileInfo[row][col].crc) return 0;
+		if ((CRC = util_crc(source, x, y, TILE_WIDTH, TILE_HEIGHT)) == g_tileInfo[row][col].crc) return 0;
 		g_tileInfo[row][col].crc = CRC; //Update the tile CRC in the global data structure.
 	}
 
@@ -235,7 +422,7 @@ int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop,
 		CRC = g_tileInfo[row][rightcol].crc;
 
 		if (g_tileInfo[row][rightcol].flag == TILE_TODO) {
-			CRC = util_crc(r_x, y, TILE_HEIGHT * TILE_WIDTH * 3, desktop, desktopsize, TILE_WIDTH, TILE_HEIGHT);
+			CRC = util_crc(source, r_x, y, TILE_WIDTH, TILE_HEIGHT);
 		}
 
 		if (CRC != g_tileInfo[row][rightcol].crc || g_tileInfo[row][rightcol].flag == TILE_MARKED_NOT_SENT) { //If the tile has changed, increment the capturewidth.
@@ -265,9 +452,9 @@ int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop,
 
 	// Now go to the bottom tiles, check if they have changed and record them
 #if MAX_TILE_SIZE > 0
-	while ((botrow + 1 < TILE_HEIGHT_COUNT) && ((captureHeight + TILE_HEIGHT) * captureWidth * 3 / COMPRESSION_RATIO <= MAX_TILE_SIZE))
+	while ((botrow + 1 < TILE_HEIGHT_COUNT) && (botrow + 1 - row < maxRows) && ((captureHeight + TILE_HEIGHT) * captureWidth * 3 / COMPRESSION_RATIO <= MAX_TILE_SIZE))
 #else
-	while ((botrow + 1 < TILE_HEIGHT_COUNT))
+	while ((botrow + 1 < TILE_HEIGHT_COUNT) && (botrow + 1 - row < maxRows))
 #endif
 	{
 		botrow++;
@@ -281,7 +468,7 @@ int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop,
 
 			CRC = g_tileInfo[botrow][rcol].crc;
 			if (g_tileInfo[botrow][rcol].flag == TILE_TODO) {
-				CRC = util_crc(r_x, r_y, TILE_HEIGHT * TILE_WIDTH * 3, desktop, desktopsize, TILE_WIDTH, TILE_HEIGHT);
+				CRC = util_crc(source, r_x, r_y, TILE_WIDTH, TILE_HEIGHT);
 			}
 
 			if (CRC != g_tileInfo[botrow][rcol].crc || g_tileInfo[botrow][rcol].flag == TILE_MARKED_NOT_SENT) {
@@ -330,16 +517,65 @@ int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop,
 		}
 	}
 
+	*botrowOut = botrow;
+	*rightcolOut = rightcol;
+	return 1;
+}
+
+//Builds the MNG_KVM_PICTURE packet for an encoded jpeg, using MNG_JUMBO if it is too large for a regular packet
+void tile_packet(int x, int y, unsigned char *jpeg, int jpegLength, void **buffer, long long *bufferSize)
+{
+	*bufferSize = jpegLength + (jpegLength > 65500 ? 16 : 8);
+	if ((*buffer = malloc(*bufferSize)) == NULL) { ILIBCRITICALEXIT(254); }
+
+	if (jpegLength > 65500)
+	{
+		((unsigned short*)*buffer)[0] = (unsigned short)htons((unsigned short)MNG_JUMBO);		// Write the type
+		((unsigned short*)*buffer)[1] = (unsigned short)htons((unsigned short)8);				// Write the size
+		((unsigned int*)*buffer)[1] = (unsigned int)htonl(jpegLength + 8);						// Size of the Next Packet
+		((unsigned short*)*buffer)[4] = (unsigned short)htons((unsigned short)MNG_KVM_PICTURE);	// Write the type
+		((unsigned short*)*buffer)[5] = 0;														// RESERVED
+		((unsigned short*)*buffer)[6] = (unsigned short)htons((unsigned short)x);				// X position
+		((unsigned short*)*buffer)[7] = (unsigned short)htons((unsigned short)y);				// Y position
+		memcpy_s((char *)(*buffer) + 16, *bufferSize -16, jpeg, jpegLength);
+	}
+	else
+	{
+		((unsigned short*)*buffer)[0] = (unsigned short)htons((unsigned short)MNG_KVM_PICTURE);	// Write the type
+		((unsigned short*)*buffer)[1] = (unsigned short)htons((unsigned short)*bufferSize);		// Write the size
+		((unsigned short*)*buffer)[2] = (unsigned short)htons((unsigned short)x);				// X position
+		((unsigned short*)*buffer)[3] = (unsigned short)htons((unsigned short)y);				// Y position
+		memcpy_s((char *)(*buffer) + 8, *bufferSize -8, jpeg, jpegLength);
+	}
+}
+
+//Fetches the encoded jpeg tile at the given location. The neighboring tiles are coalesced to form a larger jpeg before returning.
+int getTileAt(int x, int y, void** buffer, long long *bufferSize, tile_source *source, int row, int col)
+{
+	int r, c, botrow, rightcol;
+	int captureWidth, captureHeight;
+	long long start = tile_time_us(), coalesced;
+
+	*buffer = NULL; // If anything fails, this will be the indication.
+	*bufferSize = 0;
+
+	r = coalesce_tiles(x, y, source, row, col, TILE_HEIGHT_COUNT, &botrow, &rightcol);
+	coalesced = tile_time_us();
+	g_tileTiming.diff += (coalesced - start);
+	if (r == 0) { return 0; }
+	captureWidth = (rightcol - col + 1) * TILE_WIDTH;
+	captureHeight = (botrow - row + 1) * TILE_HEIGHT;
+
 	int retval = 0;
 #if MAX_TILE_SIZE == 0
-	retval = calc_opt_compr_send(x, y, captureWidth, captureHeight, desktop, desktopsize, buffer, bufferSize);
+	retval = calc_opt_compr_send(x, y, captureWidth, captureHeight, source, buffer, bufferSize);
 #else
 	int firstTime = 1;
 
 	//This loop is used to adjust the COMPRESSION_RATIO. This loop runs only once most of the time.
 	do {
 		//retval here is 0 if everything was good. It is > 0 if it contains the size of the jpeg that was created and not sent.
-		retval = calc_opt_compr_send(x, y, captureWidth, captureHeight, desktop, desktopsize, buffer, bufferSize);
+		retval = calc_opt_compr_send(x, y, captureWidth, captureHeight, source, buffer, bufferSize);
 		if (retval != 0) {
 			if (firstTime) {
 				// Re-adjust the compression ratio.
@@ -368,28 +604,7 @@ int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop,
 	//Set the flags to TILE_SENT
 	if (jpeg_buffer != NULL) 
 	{
-		*bufferSize = jpeg_buffer_length + (jpeg_buffer_length > 65500 ? 16 : 8);
-		*buffer = malloc(*bufferSize);
-
-		if (jpeg_buffer_length > 65500)
-		{
-			((unsigned short*)*buffer)[0] = (unsigned short)htons((unsigned short)MNG_JUMBO);		// Write the type
-			((unsigned short*)*buffer)[1] = (unsigned short)htons((unsigned short)8);				// Write the size
-			((unsigned int*)*buffer)[1] = (unsigned int)htonl(jpeg_buffer_length + 8);				// Size of the Next Packet
-			((unsigned short*)*buffer)[4] = (unsigned short)htons((unsigned short)MNG_KVM_PICTURE);	// Write the type
-			((unsigned short*)*buffer)[5] = 0;														// RESERVED
-			((unsigned short*)*buffer)[6] = (unsigned short)htons((unsigned short)x);				// X position
-			((unsigned short*)*buffer)[7] = (unsigned short)htons((unsigned short)y);				// Y position
-			memcpy_s((char *)(*buffer) + 16, *bufferSize -16, jpeg_buffer, jpeg_buffer_length);
-		}
-		else
-		{
-			((unsigned short*)*buffer)[0] = (unsigned short)htons((unsigned short)MNG_KVM_PICTURE);	// Write the type
-			((unsigned short*)*buffer)[1] = (unsigned short)htons((unsigned short)*bufferSize);		// Write the size
-			((unsigned short*)*buffer)[2] = (unsigned short)htons((unsigned short)x);				// X position
-			((unsigned short*)*buffer)[3] = (unsigned short)htons((unsigned short)y);				// Y position
-			memcpy_s((char *)(*buffer) + 8, *bufferSize -8, jpeg_buffer, jpeg_buffer_length);
-		}
+		tile_packet(x, y, jpeg_buffer, jpeg_buffer_length, buffer, bufferSize);
 
 		free(jpeg_buffer);
 		jpeg_buffer = NULL;
@@ -402,83 +617,610 @@ int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop,
 		}
 	}
 
+	g_tileTiming.encode += (tile_time_us() - coalesced);
 	return retval;
 }
 
 
-// Get screen buffer from the XImage structure
-int getScreenBuffer(char **desktop, long long *desktopsize, XImage *image)
+/******************************************************************************
+ * MOVE DETECTION
+ ******************************************************************************/
+// Scrolled content is found by matching the fingerprints of single pixel rows, in each column of tiles, with the rows
+// of the last frame. The viewer is told to copy what it already has with MNG_KVM_COPY, and only the tiles that aren't
+// completely covered by a copy are encoded.
+
+#define TILE_MOVE_SAMPLES 16
+#define TILE_MOVE_MAX 256
+
+typedef struct tile_move
 {
-	long long size = adjust_screen_size(SCREEN_WIDTH) * adjust_screen_size(SCREEN_HEIGHT) * 3;
-	int row, col, i, width_padding_size = 0, height_padding_size = 0;
-	char *output;
-	register unsigned char* tmpPtr2 = (unsigned char *)image->data;
-	register unsigned short* tmpPtr3 = (unsigned short *)image->data;
-	register unsigned int
-		rm = image->red_mask,
-		gm = image->green_mask,
-		bm = image->blue_mask,
-		rs = 16,
-		gs = 8,
-		bs = 0, *tmpPtr = (unsigned int *) image->data;
-	int bpp = image->bits_per_pixel;
+	int col, cols;					// Columns of tiles
+	int shift;						// Rows [top, bottom) are copied from [top + shift, bottom + shift)
+	int top, bottom;
+	int merged;
+}tile_move;
+
+int *g_rowHash = NULL;				// Fingerprint of every pixel row of every column of tiles, as the viewer has it
+int *g_rowHashNew = NULL;			// Same, for the changed tiles of this frame
+int g_rowHashCols = 0;
+int g_rowHashRows = 0;
+
+// Finds the vertical shift of the content of rows [top, bottom) of the column since the last frame. Returns the number of
+// rows in the longest run that matched, which is [*matchTop, *matchBottom), or 0 if there is no shift.
+int tile_move_find(int col, int top, int bottom, int *shift, int *matchTop, int *matchBottom)
+{
+	int *old = g_rowHash + ((long long)col * g_rowHashRows);
+	int *cur = g_rowHashNew + ((long long)col * g_rowHashRows);
+	int dy[TILE_MOVE_SAMPLES * 2], votes[TILE_MOVE_SAMPLES * 2];
+	int candidates = 0, best = -1, i, y, s, d, step, run, runTop = 0;
+
+	*matchTop = *matchBottom = 0;
+	step = (bottom - top) / TILE_MOVE_SAMPLES;
+	if (step < 1) { step = 1; }
+
+	// Rows that look like the row above could match almost anywhere, so only the others are sampled. A match has to
+	// include the row above as well.
+	for (y = top + 1; y < bottom; y += step)
+	{
+		if (cur[y] == cur[y - 1]) { continue; }
+		for (s = top + 1; s < bottom; ++s)
+		{
+			if (s == y || old[s] != cur[y] || old[s - 1] != cur[y - 1]) { continue; }
+			d = s - y;
+			for (i = 0; i < candidates && dy[i] != d; ++i);
+			if (i == candidates)
+			{
+				if (candidates == (int)(sizeof(dy) / sizeof(dy[0]))) { continue; }
+				dy[candidates] = d;
+				votes[candidates++] = 0;
+			}
+			++votes[i];
+		}
+	}
+	for (i = 0; i < candidates; ++i) { if (votes[i] > 1 && (best < 0 || votes[i] > votes[best])) { best = i; } }
+	if (best < 0) { return 0; }
 
-	if (*desktopsize != size) {
-		if (*desktop != NULL) { free(*desktop); }
-		*desktopsize = size;
-		if ((*desktop = (char *) malloc (*desktopsize + 4)) == NULL) ILIBCRITICALEXIT(254);
+	// The longest run of rows that match with that shift
+	d = dy[best];
+	for (y = top, run = 0; y < bottom; ++y)
+	{
+		if (y + d >= top && y + d < bottom && cur[y] == old[y + d])
+		{
+			if (run++ == 0) { runTop = y; }
+			if (run > *matchBottom - *matchTop) { *matchTop = runTop; *matchBottom = y + 1; }
+		}
+		else
+		{
+			run = 0;
+		}
 	}
+	*shift = d;
+	return(*matchBottom - *matchTop);
+}
 
-	if (bpp == 16) {
-		rs = 11;
-		gs = 5;
+// Builds an MNG_KVM_COPY packet: [type][size][x][y][source x][source y][width][height], each a 16 bit value in network order.
+// The viewer copies the area of its own screen at (source x, source y) to (x, y).
+void tile_move_packet(tile_move *move, int width, char *buffer)
+{
+	int x = move->col * TILE_WIDTH, w = move->cols * TILE_WIDTH;
+	if (x + w > width) { w = width - x; }
+
+	((unsigned short*)buffer)[0] = (unsigned short)htons((unsigned short)MNG_KVM_COPY);		// Write the type
+	((unsigned short*)buffer)[1] = (unsigned short)htons((unsigned short)16);				// Write the size
+	((unsigned short*)buffer)[2] = (unsigned short)htons((unsigned short)x);				// X position
+	((unsigned short*)buffer)[3] = (unsigned short)htons((unsigned short)move->top);		// Y position
+	((unsigned short*)buffer)[4] = (unsigned short)htons((unsigned short)x);				// Source X position
+	((unsigned short*)buffer)[5] = (unsigned short)htons((unsigned short)(move->top + move->shift));	// Source Y position
+	((unsigned short*)buffer)[6] = (unsigned short)htons((unsigned short)w);				// Width
+	((unsigned short*)buffer)[7] = (unsigned short)htons((unsigned short)(move->bottom - move->top));	// Height
+}
+
+// Checks every tile that is TILE_TODO, and finds the changed areas that were scrolled. The moves are passed to the writer as
+// MNG_KVM_COPY packets, and must reach the viewer before the tiles from getTiles(). Afterwards, the changed tiles are
+// TILE_MARKED_NOT_SENT, and the others, including the ones the moves cover, are TILE_DONT_SEND. Returns the number of moves.
+int getTileMoves(tile_source *source, tile_write_handler writer, void *user)
+{
+	tile_move moves[TILE_MOVE_MAX];
+	int r, c, i, j, y, top, bottom, shift, valid, count = 0, sent = 0;
+	int height = TILE_HEIGHT_COUNT * TILE_HEIGHT < source->height ? TILE_HEIGHT_COUNT * TILE_HEIGHT : source->height;
+	long long start = tile_time_us(), offset;
+	char packet[16];
+
+	valid = (g_rowHash != NULL && g_rowHashCols == TILE_WIDTH_COUNT && g_rowHashRows == TILE_HEIGHT_COUNT * TILE_HEIGHT);
+	if (!valid)
+	{
+		// Nothing to match with until the next frame
+		if (g_rowHash != NULL) { free(g_rowHash); }
+		if (g_rowHashNew != NULL) { free(g_rowHashNew); }
+		g_rowHashCols = TILE_WIDTH_COUNT;
+		g_rowHashRows = TILE_HEIGHT_COUNT * TILE_HEIGHT;
+		if ((g_rowHash = (int*)calloc((size_t)g_rowHashCols * g_rowHashRows, sizeof(int))) == NULL) { ILIBCRITICALEXIT(254); }
+		if ((g_rowHashNew = (int*)calloc((size_t)g_rowHashCols * g_rowHashRows, sizeof(int))) == NULL) { ILIBCRITICALEXIT(254); }
+	}
+
+	// Fingerprint the tiles, and the rows of the ones that changed
+	for (r = 0; r < TILE_HEIGHT_COUNT; r++) {
+		for (c = 0; c < TILE_WIDTH_COUNT; c++) {
+			if (g_tileInfo[r][c].flag != TILE_TODO) { continue; }
+			y = util_crc(source, c * TILE_WIDTH, r * TILE_HEIGHT, TILE_WIDTH, TILE_HEIGHT);
+			if (y == g_tileInfo[r][c].crc) { g_tileInfo[r][c].flag = TILE_DONT_SEND; continue; }
+			g_tileInfo[r][c].crc = y;
+			g_tileInfo[r][c].flag = TILE_MARKED_NOT_SENT;
+
+			offset = ((long long)c * g_rowHashRows);
+			for (y = r * TILE_HEIGHT; y < (r + 1) * TILE_HEIGHT; ++y) { g_rowHashNew[offset + y] = y < height ? util_crc(source, c * TILE_WIDTH, y, TILE_WIDTH, 1) : 0; }
+		}
 	}
-	output = *desktop;
 
-	for (row = 0; row < image->height; row++) {
-		for (col = 0; col < image->width; col++) {
-			if (bpp == 16) {
-				*output++ = ((*tmpPtr3 >> rs) & 0x01f) << 3;
-				*output++ = ((*tmpPtr3 >> gs) & 0x03f) << 2;
-				*output++ = ((*tmpPtr3 >> bs) & 0x01f) << 3;
-				tmpPtr3++;
+	// Look for a shift in each run of changed tiles, in each column
+	for (c = 0; valid && c < TILE_WIDTH_COUNT; c++) {
+		for (r = 0; r < TILE_HEIGHT_COUNT && count < TILE_MOVE_MAX; r++) {
+			if (g_tileInfo[r][c].flag != TILE_MARKED_NOT_SENT) { continue; }
+			for (i = r; i + 1 < TILE_HEIGHT_COUNT && g_tileInfo[i + 1][c].flag == TILE_MARKED_NOT_SENT; ++i);
+
+			bottom = (i + 1) * TILE_HEIGHT < height ? (i + 1) * TILE_HEIGHT : height;
+			if (tile_move_find(c, r * TILE_HEIGHT, bottom, &shift, &top, &bottom) >= TILE_HEIGHT)
+			{
+				// Only worth it if at least one tile is covered
+				if (((bottom / TILE_HEIGHT) - ((top + TILE_HEIGHT - 1) / TILE_HEIGHT)) > 0)
+				{
+					moves[count].col = c; moves[count].cols = 1;
+					moves[count].shift = shift;
+					moves[count].top = top; moves[count].bottom = bottom;
+					moves[count++].merged = 0;
+				}
 			}
-			else if (bpp == 24) {
-				*output++ = *(tmpPtr2 + 2);
-				*output++ = *(tmpPtr2 + 1);
-				*output++ = *tmpPtr2;
-				tmpPtr2 += 3;
+			r = i;
+		}
+	}
+
+	// The rows the viewer will have are the rows of this frame
+	for (r = 0; r < TILE_HEIGHT_COUNT; r++) {
+		for (c = 0; c < TILE_WIDTH_COUNT; c++) {
+			if (g_tileInfo[r][c].flag != TILE_MARKED_NOT_SENT) { continue; }
+			offset = ((long long)c * g_rowHashRows) + (r * TILE_HEIGHT);
+			memcpy(g_rowHash + offset, g_rowHashNew + offset, TILE_HEIGHT * sizeof(int));
+		}
+	}
+
+	// Neighbouring columns that moved the same way are copied together. The moves are in column order.
+	for (i = 0; i < count; ++i)
+	{
+		if (moves[i].merged) { continue; }
+		for (j = i + 1; j < count; ++j)
+		{
+			if (!moves[j].merged && moves[j].col == moves[i].col + moves[i].cols && moves[j].shift == moves[i].shift && moves[j].top == moves[i].top && moves[j].bottom == moves[i].bottom)
+			{
+				++moves[i].cols;
+				moves[j].merged = 1;
 			}
-			else {
-				*output++ = ((*tmpPtr & rm) >> rs);
-				*output++ = ((*tmpPtr & gm) >> gs);
-				*output++ = ((*tmpPtr & bm) >> bs);
-				tmpPtr = (unsigned int *) (((char *)tmpPtr) + (image->bits_per_pixel >> 3));
-				//tmpPtr++;		     // ignore alpha values
+		}
+
+		// The tiles the copy covers completely don't have to be encoded
+		for (r = (moves[i].top + TILE_HEIGHT - 1) / TILE_HEIGHT; r < moves[i].bottom / TILE_HEIGHT; ++r) {
+			for (c = moves[i].col; c < moves[i].col + moves[i].cols; ++c) {
+				g_tileInfo[r][c].flag = TILE_DONT_SEND;
 			}
 		}
-		//
-		// eat padded bytes, for better speed we use shifting,
-		// (bytes_per_line - bits_per_pixel / 8 * width ) / 4
+		++sent;
+	}
+	g_tileTiming.diff += (tile_time_us() - start);
+
+	start = tile_time_us();
+	for (i = 0; i < count; ++i)
+	{
+		if (moves[i].merged) { continue; }
+		tile_move_packet(&moves[i], source->width, packet);
+		if (writer(packet, sizeof(packet), user) != 0) { break; }
+	}
+	g_tileTiming.write += (tile_time_us() - start);
+	return(sent);
+}
+
+
+/******************************************************************************
+ * TILE ENCODER POOL
+ ******************************************************************************/
+// The coalesced regions of a frame are planned on the KVM thread, then encoded in parallel by the worker threads,
+// each with its own libjpeg compressor. The packets are handed to the writer in the order the regions were planned.
+
+typedef struct tile_job
+{
+	int x, y, row, col, botrow, rightcol;	// Coalesced region, botrow/rightcol are updated if the region had to be reduced
+	int captureWidth, captureHeight;
+	int captureWidthPlanned, captureHeightPlanned;
+	int quality;
+	int oversize;							// Size of the first jpeg that was too large, 0 if none
+	void *buffer;							// Encoded packet, NULL if encoding failed
+	long long bufferSize;
+	int done;
+}tile_job;
+
+typedef struct tile_encoder
+{
+	pthread_t thread;
+	JPEG_encoder *jpeg;
+	void *tilebuffer;
+	int tilebuffersize;
+}tile_encoder;
+
+typedef struct tile_pool
+{
+	pthread_mutex_t lock;
+	pthread_cond_t jobReady;				// Workers wait on this for jobs
+	pthread_cond_t jobDone;					// The KVM thread waits on this for results
+	tile_encoder *encoders;
+	int encoderCount;
+	tile_job *jobs;
+	int jobSize, jobCount, nextJob;
+	tile_source source;
+	int shutdown;
+}tile_pool;
+
+tile_pool *g_tilePool = NULL;
+
+void tile_job_encode(tile_encoder *encoder, tile_job *job, tile_source *source)
+{
+	do
+	{
+		tile_encode_region(encoder->jpeg, &(encoder->tilebuffer), &(encoder->tilebuffersize), source, job->x, job->y, job->captureWidth, job->captureHeight, job->quality);
+
+#if MAX_TILE_SIZE > 0
+		if (encoder->jpeg->bufferLength > MAX_TILE_SIZE)
+		{
+			if (job->oversize == 0) { job->oversize = encoder->jpeg->bufferLength; }
+			if (job->botrow > job->row) { //First time, try reducing the height.
+				job->botrow = job->row + ((job->botrow - job->row + 1) / 2);
+				job->captureHeight = (job->botrow - job->row + 1) * TILE_HEIGHT;
+			}
+			else if (job->rightcol > job->col) { //If it is not possible, reduce the width
+				job->rightcol = job->col + ((job->rightcol - job->col + 1) / 2);
+				job->captureWidth = (job->rightcol - job->col + 1) * TILE_WIDTH;
+			}
+			else { //This never happens in any case.
+				break;
+			}
+			continue;
+		}
+#endif
+		break;
+	} while (1);
+
+	if (encoder->jpeg->buffer != NULL)
+	{
+		tile_packet(job->x, job->y, encoder->jpeg->buffer, encoder->jpeg->bufferLength, &(job->buffer), &(job->bufferSize));
+		free(encoder->jpeg->buffer);
+		encoder->jpeg->buffer = NULL;
+	}
+}
+
+void* tile_encoder_thread(void *param)
+{
+	tile_encoder *encoder = (tile_encoder*)param;
+	tile_pool *pool = g_tilePool;
+	tile_job *job;
+
+	pthread_mutex_lock(&(pool->lock));
+	while (pool->shutdown == 0)
+	{
+		if (pool->nextJob < pool->jobCount)
+		{
+			job = &(pool->jobs[pool->nextJob++]);
+			pthread_mutex_unlock(&(pool->lock));
+
+			tile_job_encode(encoder, job, &(pool->source));
+
+			pthread_mutex_lock(&(pool->lock));
+			job->done = 1;
+			pthread_cond_broadcast(&(pool->jobDone));
+		}
+		else
+		{
+			pthread_cond_wait(&(pool->jobReady), &(pool->lock));
+		}
+	}
+	pthread_mutex_unlock(&(pool->lock));
+	return(NULL);
+}
+
+// Starts the tile encoder threads. If count is 0, one thread per CPU is started. With a single CPU, no threads are
+// started, and getTiles() encodes on the calling thread. Returns the number of threads started.
+int start_tile_encoders(int count)
+{
+	int i;
+
+	if (g_tilePool != NULL) { return(g_tilePool->encoderCount); }
+	if (count <= 0)
+	{
+		count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		if (count > TILE_ENCODERS_MAX) { count = TILE_ENCODERS_MAX; }
+		if (count < 2) { return(0); }
+	}
+
+	if ((g_tilePool = (tile_pool*)calloc(1, sizeof(tile_pool))) == NULL) { ILIBCRITICALEXIT(254); }
+	if ((g_tilePool->encoders = (tile_encoder*)calloc(count, sizeof(tile_encoder))) == NULL) { ILIBCRITICALEXIT(254); }
+	pthread_mutex_init(&(g_tilePool->lock), NULL);
+	pthread_cond_init(&(g_tilePool->jobReady), NULL);
+	pthread_cond_init(&(g_tilePool->jobDone), NULL);
+
+	for (i = 0; i < count; ++i)
+	{
+		g_tilePool->encoders[i].jpeg = JPEG_encoder_create();
+		if (pthread_create(&(g_tilePool->encoders[i].thread), NULL, tile_encoder_thread, &(g_tilePool->encoders[i])) != 0)
+		{
+			JPEG_encoder_destroy(g_tilePool->encoders[i].jpeg);
+			break;
+		}
+		g_tilePool->encoderCount = i + 1;
+	}
+	if (g_tilePool->encoderCount == 0) { stop_tile_encoders(); return(0); }
+	return(g_tilePool->encoderCount);
+}
+
+void stop_tile_encoders()
+{
+	int i;
+	if (g_tilePool == NULL) { return; }
+
+	pthread_mutex_lock(&(g_tilePool->lock));
+	g_tilePool->shutdown = 1;
+	pthread_cond_broadcast(&(g_tilePool->jobReady));
+	pthread_mutex_unlock(&(g_tilePool->lock));
+
+	for (i = 0; i < g_tilePool->encoderCount; ++i)
+	{
+		pthread_join(g_tilePool->encoders[i].thread, NULL);
+		JPEG_encoder_destroy(g_tilePool->encoders[i].jpeg);
+		if (g_tilePool->encoders[i].tilebuffer != NULL) { free(g_tilePool->encoders[i].tilebuffer); }
+	}
+
+	pthread_cond_destroy(&(g_tilePool->jobDone));
+	pthread_cond_destroy(&(g_tilePool->jobReady));
+	pthread_mutex_destroy(&(g_tilePool->lock));
+	if (g_tilePool->jobs != NULL) { free(g_tilePool->jobs); }
+	free(g_tilePool->encoders);
+	free(g_tilePool);
+	g_tilePool = NULL;
+}
+
+// Waits for the job, then applies its result to the tile state, as getTileAt() would have.
+// Returns 1 if some of the region was left for another pass.
+int tile_job_complete(tile_job *job, int *ratioAdjusted)
+{
+	int r, c, ret = 0;
+
+	pthread_mutex_lock(&(g_tilePool->lock));
+	while (job->done == 0) { pthread_cond_wait(&(g_tilePool->jobDone), &(g_tilePool->lock)); }
+	pthread_mutex_unlock(&(g_tilePool->lock));
+
+#if MAX_TILE_SIZE > 0
+	if (job->oversize != 0 && *ratioAdjusted == 0)
+	{
+		// Re-adjust the compression ratio. All the regions of this pass were planned with the same ratio, so only the first one counts.
+		COMPRESSION_RATIO = (int)(((double)COMPRESSION_RATIO / (double)job->oversize) * (0.92 * MAX_TILE_SIZE)); //Magic number: 92% of MAX_TILE_SIZE
+		if (COMPRESSION_RATIO <= 1) { COMPRESSION_RATIO = 2; }
+		*ratioAdjusted = 1;
+	}
+#else
+	UNREFERENCED_PARAMETER(ratioAdjusted);
+#endif
 
-		tmpPtr += (image->bytes_per_line - (image->bits_per_pixel >> 3)
-			* image->width) >> 2;
+	// The region was marked TILE_SENT when it was planned. Whatever wasn't sent goes back to TILE_MARKED_NOT_SENT.
+	for (r = job->row; r < job->row + (job->captureHeightPlanned / TILE_HEIGHT); r++) {
+		for (c = job->col; c < job->col + (job->captureWidthPlanned / TILE_WIDTH); c++) {
+			if (job->buffer == NULL || r > job->botrow || c > job->rightcol)
+			{
+				g_tileInfo[r][c].flag = TILE_MARKED_NOT_SENT;
+				if (job->buffer != NULL) { ret = 1; }
+			}
+		}
+	}
+	return(ret);
+}
 
-		width_padding_size = (adjust_screen_size(SCREEN_WIDTH) - image->width) * 3;
+// Encodes every tile that needs to be sent, and passes the packets to the writer in order. The writer returns non-zero
+// to stop. Returns non-zero if the writer stopped the frame.
+int getTiles(tile_source *source, tile_write_handler writer, void *user)
+{
+	int x, y, r, c, i, again, ratioAdjusted, maxRows, stopped = 0;
+	void *buf;
+	long long tilesize, start;
+	tile_job *job;
 
-		if (width_padding_size != 0) {
-			for (i = 0; i < width_padding_size; i++) {
-				*output++ = 0;
+	if (g_tilePool == NULL)
+	{
+		for (y = 0; y < TILE_HEIGHT_COUNT && stopped == 0; y++) {
+			for (x = 0; x < TILE_WIDTH_COUNT; x++) {
+				if (g_tileInfo[y][x].flag == TILE_SENT || g_tileInfo[y][x].flag == TILE_DONT_SEND) { continue; }
+
+				getTileAt(TILE_WIDTH * x, TILE_HEIGHT * y, &buf, &tilesize, source, y, x);
+				if (buf != NULL)
+				{
+					start = tile_time_us();
+					stopped = writer(buf, tilesize, user);
+					g_tileTiming.write += (tile_time_us() - start);
+					free(buf);
+					if (stopped != 0) { break; }
+				}
 			}
 		}
+		return(stopped);
+	}
+
+	if (g_tilePool->jobSize < TILE_WIDTH_COUNT * TILE_HEIGHT_COUNT)
+	{
+		if (g_tilePool->jobs != NULL) { free(g_tilePool->jobs); }
+		g_tilePool->jobSize = TILE_WIDTH_COUNT * TILE_HEIGHT_COUNT;
+		if ((g_tilePool->jobs = (tile_job*)malloc(g_tilePool->jobSize * sizeof(tile_job))) == NULL) { ILIBCRITICALEXIT(254); }
+	}
+	g_tilePool->source = *source;
+
+	// Split large changes into bands, so that every encoder gets a share of a full screen update. Larger regions compress
+	// a little better, so the rate control can ask for them when bandwidth matters more than encode time.
+	maxRows = g_tileCoalesceRows > 0 ? g_tileCoalesceRows : (TILE_HEIGHT_COUNT + g_tilePool->encoderCount - 1) / g_tilePool->encoderCount;
+
+	do
+	{
+		again = ratioAdjusted = 0;
+		pthread_mutex_lock(&(g_tilePool->lock));
+		g_tilePool->jobCount = g_tilePool->nextJob = 0;
+		pthread_mutex_unlock(&(g_tilePool->lock));
+
+		// Plan the regions, and hand each one to the workers as soon as it is known
+		start = tile_time_us();
+		for (y = 0; y < TILE_HEIGHT_COUNT; y++) {
+			for (x = 0; x < TILE_WIDTH_COUNT; x++) {
+				if (g_tileInfo[y][x].flag == TILE_SENT || g_tileInfo[y][x].flag == TILE_DONT_SEND) { continue; }
+
+				job = &(g_tilePool->jobs[g_tilePool->jobCount]);
+				if (coalesce_tiles(TILE_WIDTH * x, TILE_HEIGHT * y, &(g_tilePool->source), y, x, maxRows, &(job->botrow), &(job->rightcol)) == 0) { continue; }
+
+				job->x = TILE_WIDTH * x; job->y = TILE_HEIGHT * y;
+				job->row = y; job->col = x;
+				job->captureWidth = job->captureWidthPlanned = (job->rightcol - x + 1) * TILE_WIDTH;
+				job->captureHeight = job->captureHeightPlanned = (job->botrow - y + 1) * TILE_HEIGHT;
+				job->quality = tile_quality();
+				job->oversize = 0;
+				job->buffer = NULL;
+				job->bufferSize = 0;
+				job->done = 0;
+				for (r = y; r <= job->botrow; r++) {
+					for (c = x; c <= job->rightcol; c++) {
+						g_tileInfo[r][c].flag = TILE_SENT;
+					}
+				}
+
+				pthread_mutex_lock(&(g_tilePool->lock));
+				++g_tilePool->jobCount;
+				pthread_cond_signal(&(g_tilePool->jobReady));
+				pthread_mutex_unlock(&(g_tilePool->lock));
+			}
+		}
+		g_tileTiming.diff += (tile_time_us() - start);
+
+		// Collect the packets in order. After the writer stops, the remaining jobs still have to finish, because they read the source pixels.
+		for (i = 0; i < g_tilePool->jobCount; ++i)
+		{
+			job = &(g_tilePool->jobs[i]);
+			start = tile_time_us();
+			again |= tile_job_complete(job, &ratioAdjusted);
+			g_tileTiming.encode += (tile_time_us() - start);
+			if (job->buffer != NULL)
+			{
+				start = tile_time_us();
+				if (stopped == 0) { stopped = writer(job->buffer, job->bufferSize, user); }
+				g_tileTiming.write += (tile_time_us() - start);
+				free(job->buffer);
+			}
+		}
+	} while (again != 0 && stopped == 0);
+
+	return(stopped);
+}
+
+// Points the source at the XImage, if libjpeg can read its pixel layout as is. Returns non-zero if it can't, in which
+// case the image has to be converted with getScreenBuffer() first.
+int tile_source_image(tile_source *source, XImage *image)
+{
+#ifdef JCS_EXTENSIONS
+	int lsb = image->byte_order == LSBFirst;
+	int rgb = image->red_mask == 0xFF0000 && image->green_mask == 0xFF00 && image->blue_mask == 0xFF;
+	int bgr = image->red_mask == 0xFF && image->green_mask == 0xFF00 && image->blue_mask == 0xFF0000;
+
+	if (image->bits_per_pixel == 32 && rgb) { source->colorSpace = lsb ? JCS_EXT_BGRX : JCS_EXT_XRGB; }
+	else if (image->bits_per_pixel == 32 && bgr) { source->colorSpace = lsb ? JCS_EXT_RGBX : JCS_EXT_XBGR; }
+	else if (image->bits_per_pixel == 24 && rgb) { source->colorSpace = lsb ? JCS_EXT_BGR : JCS_EXT_RGB; }
+	else if (image->bits_per_pixel == 24 && bgr) { source->colorSpace = lsb ? JCS_EXT_RGB : JCS_EXT_BGR; }
+	else { return 1; }
+
+	source->data = image->data;
+	source->stride = image->bytes_per_line;
+	source->pixelSize = image->bits_per_pixel >> 3;
+	source->width = image->width;
+	source->height = image->height;
+	return 0;
+#else
+	UNREFERENCED_PARAMETER(source);
+	UNREFERENCED_PARAMETER(image);
+	return 1;
+#endif
+}
+
+// Points the source at the 24 bit desktop buffer from getScreenBuffer()
+void tile_source_buffer(tile_source *source, char *desktop)
+{
+	source->data = desktop;
+	source->stride = 3 * adjust_screen_size(SCREEN_WIDTH);
+	source->pixelSize = 3;
+	source->width = adjust_screen_size(SCREEN_WIDTH);
+	source->height = adjust_screen_size(SCREEN_HEIGHT);
+	source->colorSpace = JCS_RGB;
+}
+
+// Converts the XImage into the 24 bit desktop buffer. This is only needed for the layouts tile_source_image() can't use as is.
+int getScreenBuffer(char **desktop, long long *desktopsize, XImage *image)
+{
+	long long size = adjust_screen_size(SCREEN_WIDTH) * adjust_screen_size(SCREEN_HEIGHT) * 3;
+
+	if (*desktopsize != size) {
+		if (*desktop != NULL) { free(*desktop); }
+		*desktopsize = size;
+		if ((*desktop = (char *) calloc (1, *desktopsize + 4)) == NULL) ILIBCRITICALEXIT(254);	// The padding past the image stays black
 	}
 
-	height_padding_size = adjust_screen_size(SCREEN_HEIGHT) - image->height;
+	return(getScreenBufferRows(*desktop, image, 0, image->height));
+}
 
-	if (height_padding_size != 0) {
-		for (row = 0; row < height_padding_size; row++) {
-			for (col = 0; col < (image->width * 3) + width_padding_size; col++) {
-				*output++ = 0;
+// Returns the shift that moves the top 8 bits of the channel mask into the low byte
+int getScreenBufferShift(unsigned long mask)
+{
+	int shift = 0;
+	if (mask == 0) { return 0; }
+	while ((mask >> shift) > 0xFF) { ++shift; }
+	return shift;
+}
+
+// Converts rows [y, y + height) of the XImage into the desktop buffer. The rest of the desktop buffer is left as is.
+int getScreenBufferRows(char *desktop, XImage *image, int y, int height)
+{
+	int row, col;
+	int bpp = image->bits_per_pixel;
+	unsigned int rm = image->red_mask, gm = image->green_mask, bm = image->blue_mask;
+	int rs = getScreenBufferShift(rm), gs = getScreenBufferShift(gm), bs = getScreenBufferShift(bm);
+	unsigned char *src;
+	unsigned int px;
+	char *output;
+
+	if (y + height > image->height) { height = image->height - y; }
+	for (row = y; row < y + height; ++row)
+	{
+		src = (unsigned char*)image->data + ((long long)row * image->bytes_per_line);
+		output = desktop + (3 * ((long long)row * adjust_screen_size(SCREEN_WIDTH)));
+
+		for (col = 0; col < image->width; ++col)
+		{
+			if (bpp == 16)
+			{
+				px = ((unsigned short*)src)[0];
+				*output++ = ((px >> 11) & 0x01f) << 3;
+				*output++ = ((px >> 5) & 0x03f) << 2;
+				*output++ = (px & 0x01f) << 3;
+				src += 2;
+			}
+			else if (bpp == 24)
+			{
+				*output++ = src[2];
+				*output++ = src[1];
+				*output++ = src[0];
+				src += 3;
+			}
+			else
+			{
+				px = ((unsigned int*)src)[0];
+				*output++ = ((px & rm) >> rs);
+				*output++ = ((px & gm) >> gs);
+				*output++ = ((px & bm) >> bs);
+				src += (bpp >> 3);
 			}
 		}
 	}
@@ -486,6 +1228,32 @@ int getScreenBuffer(char **desktop, long long *desktopsize, XImage *image)
 	return 0;
 }
 
+// Marks the tiles that intersect the specified area as TILE_TODO, so they are checked and sent if they changed.
+// Returns the number of tiles that were marked.
+int mark_tiles_todo(int x, int y, int width, int height)
+{
+	int row, col, count = 0;
+	int firstrow, lastrow, firstcol, lastcol;
+
+	if (x < 0) { width += x; x = 0; }
+	if (y < 0) { height += y; y = 0; }
+	if (width <= 0 || height <= 0 || g_tileInfo == NULL) { return 0; }
+
+	firstcol = x / TILE_WIDTH;
+	firstrow = y / TILE_HEIGHT;
+	lastcol = (x + width - 1) / TILE_WIDTH;
+	lastrow = (y + height - 1) / TILE_HEIGHT;
+	if (lastcol >= TILE_WIDTH_COUNT) { lastcol = TILE_WIDTH_COUNT - 1; }
+	if (lastrow >= TILE_HEIGHT_COUNT) { lastrow = TILE_HEIGHT_COUNT - 1; }
+
+	for (row = firstrow; row <= lastrow; row++) {
+		for (col = firstcol; col <= lastcol; col++) {
+			if (g_tileInfo[row][col].flag != TILE_TODO) { g_tileInfo[row][col].flag = TILE_TODO; ++count; }
+		}
+	}
+
+	return count;
+}
 
 // Set the compression quality
 void set_tile_compression(int type, int level)
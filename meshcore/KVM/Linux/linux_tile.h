@@ -32,16 +32,66 @@ enum TILE_FLAGS_ENUM {
 	//TILE_SKIPPED		  //CRC has been calculated, tile need not be sent, but was skipped to include a greater region
 };
 
+#define TILE_ENCODERS_MAX 8
+
+// Receives each encoded tile packet from getTiles(). Returns non-zero to stop the frame.
+typedef int(*tile_write_handler)(void *buffer, long long bufferSize, void *user);
+
+enum UTIL_CRC_KERNELS {
+	UTIL_CRC_AUTO,					//Fastest kernel the CPU supports
+	UTIL_CRC_SCALAR,
+	UTIL_CRC_SSE42,
+	UTIL_CRC_AVX2
+};
+
 struct tileInfo_t {
 	int crc;
 	enum TILE_FLAGS_ENUM flag;
 };
 
+// The pixels the tiles are fingerprinted and encoded from. This is the captured XImage itself when libjpeg can read
+// its layout, otherwise it is the 24 bit desktop buffer that getScreenBuffer() converts the image into.
+typedef struct tile_source {
+	char *data;
+	int stride;						//Bytes per row
+	int pixelSize;					//Bytes per pixel
+	int width, height;				//Tiles that reach past these are padded with black
+	J_COLOR_SPACE colorSpace;		//Layout of the pixels, as a libjpeg input color space
+}tile_source;
+
+// Time spent in each stage of the KVM loop, in microseconds. getTiles() adds to diff, encode and write, the
+// KVM loop adds capture and convert. The owner resets it.
+typedef struct tile_stage_timing {
+	long long capture;				//Reading the screen from the X server
+	long long convert;				//Converting the screen to the desktop buffer
+	long long diff;					//Fingerprinting and coalescing the tiles
+	long long encode;				//JPEG encoding, or waiting for the encoder threads
+	long long write;				//Writing the packets
+}tile_stage_timing;
+
+extern tile_stage_timing g_tileTiming;
+extern int COMPRESSION_QUALITY;
+extern int g_tileQualityLimit;
+extern int g_tileCoalesceRows;
+
 extern int reset_tile_info(int old_height_count);
 extern int adjust_screen_size(int pixles);
-extern int getTileAt(int x, int y, void** buffer, long long *bufferSize, void *desktop, long long desktopsize, int row, int col);
+extern int getTileAt(int x, int y, void** buffer, long long *bufferSize, tile_source *source, int row, int col);
 extern int getScreenBuffer(char **desktop, long long *desktopsize, XImage *image);
+extern int getScreenBufferRows(char *desktop, XImage *image, int y, int height);
+extern int tile_source_image(tile_source *source, XImage *image);
+extern void tile_source_buffer(tile_source *source, char *desktop);
+extern int mark_tiles_todo(int x, int y, int width, int height);
 extern void set_tile_compression(int type, int level);
+extern int getTiles(tile_source *source, tile_write_handler writer, void *user);
+extern int getTileMoves(tile_source *source, tile_write_handler writer, void *user);
+extern int start_tile_encoders(int count);
+extern void stop_tile_encoders();
+extern int util_crc(tile_source *source, int x, int y, int tilewidth, int tileheight);
+extern int util_crc_select(int kernel);
+extern char* util_crc_name();
+extern long long tile_time_us();
+extern int tile_quality();
 
 
 #endif /* LINUX_TILE_H_ */
@@ -106,11 +106,14 @@ int ILibDuktape_HECI_Debug = 0;
 	extern char **environ;
 #ifndef __APPLE__
 	extern int SLAVELOG;
+	extern int g_kvmCopyRect;
 #endif
 #endif
 
 extern int gEventEmitterReferenceHold;
 extern int ILibDuktape_ModSearch_ShowNames;
+extern int ILibDuktape_ModSearch_Trace;
+extern int ILibDuktape_ModSearch_BytecodeCache;
 char* MeshAgentHost_BatteryInfo_STRINGS[] = { "UNKNOWN", "HIGH_CHARGE", "LOW_CHARGE", "NO_BATTERY", "CRITICAL_CHARGE", "", "", "", "CHARGING" };
 JS_ENGINE_CONTEXT MeshAgent_JavaCore_ContextGuid = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0 };
 extern int ILibInflate(char *buffer, size_t bufferLen, char *decompressed, size_t *decompressedLen, uint32_t crc);
@@ -2332,6 +2335,7 @@ char* ScriptEngine_Restart(MeshAgentHostContainer *agent, char *contextGUID, cha
 			duk_pop(ctx);
 			return(ILibScratchPad);
 		}
+		ILibDuktape_ModSearch_TraceMark(ctx, "CoreModule started");
 		return(NULL);
 	}
 	else
@@ -2498,6 +2502,7 @@ void MeshServer_ServerAuthenticated(ILibWebClient_StateObject WebStateObject, Me
 	// TODO: Verify with Bryan that only the core module will get this. No other modules should.
 	if (agent->serverAuthState == 3) 
 	{
+		ILibDuktape_ModSearch_TraceMark(agent->meshCoreCtx, "Server authenticated");
 		ILibDuktape_MeshAgent_PUSH(agent->meshCoreCtx, agent->chain);				// [agent]
 		duk_get_prop_string(agent->meshCoreCtx, -1, "emit");						// [agent][emit]
 		duk_swap_top(agent->meshCoreCtx, -2);										// [emit][this]
@@ -3083,7 +3088,7 @@ void MeshServer_ProcessCommand(ILibWebClient_StateObject WebStateObject, MeshAge
 					}
 
 					// Since we did a big write to the data store, good time to compact the store
-					ILibSimpleDataStore_Compact(agent->masterDb);
+					ILibSimpleDataStore_CompactAsync(agent->masterDb, agent->chain);
 				}
 
 				// Create the server confirmation message that we are running the new core
@@ -3411,6 +3416,7 @@ void MeshServer_OnResponse(ILibWebClient_StateObject WebStateObject, int Interru
 			break;
 		case ILibWebClient_ReceiveStatus_Connection_Established: // New connection established.
 		{
+			ILibDuktape_ModSearch_TraceMark(agent->meshCoreCtx, "Control Channel connected");
 			if (agent->controlChannelDebug != 0)
 			{
 				printf("Control Channel Connection Established [%d]...\n", ILibWebClient_GetDescriptorValue_FromStateObject(WebStateObject));
@@ -4022,6 +4028,7 @@ void MeshServer_Connect(MeshAgentHostContainer *agent)
 
 #if defined(_LINKVM) && defined(_POSIX) && !defined(__APPLE__)
 	SLAVELOG = ILibSimpleDataStore_Get(agent->masterDb, "slaveKvmLog", NULL, 0);
+	g_kvmCopyRect = ILibSimpleDataStore_Get(agent->masterDb, "kvmCopyRect", NULL, 0);
 #endif
 
 	if (agent->logUpdate != 0) { ILIBLOGMESSAGEX("PLATFORM_TYPE: %d", agent->platformType); }
@@ -4140,6 +4147,7 @@ int importSettings(MeshAgentHostContainer *agent, char* fileName)
 
 	pr = ILibParseString(importFile, 0, importFileLen, "\n", 1);
 	f = pr->FirstResult;
+	ILibSimpleDataStore_BeginBatch(agent->masterDb);
 	while (f != NULL)
 	{
 		f->datalength = ILibTrimString(&(f->data), f->datalength);
@@ -4186,6 +4194,7 @@ int importSettings(MeshAgentHostContainer *agent, char* fileName)
 		}
 		f = f->NextResult;
 	}
+	ILibSimpleDataStore_CommitBatch(agent->masterDb);
 	ILibDestructParserResults(pr);
 	free(importFile);
 
@@ -4550,6 +4559,7 @@ int MeshAgent_AgentMode(MeshAgentHostContainer *agentHost, int paramLen, char **
 		}
 	}
 	paramLen -= ixr;
+	if (agentHost->masterDb != NULL) { ILibDuktape_ModSearch_Trace = ILibSimpleDataStore_Get(agentHost->masterDb, "startupTrace", NULL, 0); }
 	if (fetchstate != 0)
 	{
 		duk_context *ctxx = ILibDuktape_ScriptContainer_InitializeJavaScriptEngineEx(0, 0, agentHost->chain, NULL, NULL, agentHost->exePath, NULL, MeshAgent_AgentInstallerCTX_Finalizer, agentHost->chain);
@@ -4697,7 +4707,7 @@ int MeshAgent_AgentMode(MeshAgentHostContainer *agentHost, int paramLen, char **
 #endif
 
 #if !defined(MICROSTACK_NOTLS) || defined(_POSIX)
-	duk_context *tmpCtx = ILibDuktape_ScriptContainer_InitializeJavaScriptEngineEx(0, 0, agentHost->chain, NULL, NULL, agentHost->exePath, NULL, NULL, NULL);
+	duk_context *tmpCtx = ILibDuktape_ScriptContainer_InitializeJavaScriptEngineEx(0, 0, agentHost->chain, NULL, agentHost->masterDb, agentHost->exePath, NULL, NULL, NULL);
 	duk_peval_string_noresult(tmpCtx, "require('linux-pathfix')();");
 	int msnlen;
 	char *tmpString;
@@ -4820,6 +4830,7 @@ int MeshAgent_AgentMode(MeshAgentHostContainer *agentHost, int paramLen, char **
 			}
 		}
 	}
+	ILibDuktape_ModSearch_TraceMark(tmpCtx, "Platform checks done");
 	Duktape_SafeDestroyHeap(tmpCtx);
 
 	// Load the mesh agent certificates
@@ -5075,6 +5086,7 @@ int MeshAgent_AgentMode(MeshAgentHostContainer *agentHost, int paramLen, char **
 		}
 		agentHost->agentMode = 1;
 		ILibDuktape_ModSearch_ShowNames = ILibSimpleDataStore_Get(agentHost->masterDb, "showModuleNames", NULL, 0);
+		ILibDuktape_ModSearch_BytecodeCache = ILibSimpleDataStore_Get(agentHost->masterDb, "noModuleBytecode", NULL, 0) == 0 ? 1 : 0;
 
 		if (agentHost->meshCoreCtx != NULL)
 		{
@@ -5122,6 +5134,7 @@ int MeshAgent_AgentMode(MeshAgentHostContainer *agentHost, int paramLen, char **
 							ILibRemoteLogging_Flags_VerbosityLevel_1, "Error Executing MeshCore: %s", duk_safe_to_string(agentHost->meshCoreCtx, -1));
 						duk_pop(agentHost->meshCoreCtx);
 					}
+					ILibDuktape_ModSearch_TraceMark(agentHost->meshCoreCtx, "CoreModule started");
 
 					free(CoreModule);
 				}
@@ -5526,6 +5539,11 @@ void MeshAgent_ScriptMode(MeshAgentHostContainer *agentHost, int argc, char **ar
 					agentHost->masterDb = ILibSimpleDataStore_Create(MeshAgent_MakeAbsolutePath(agentHost->exePath, ".db"));
 				}
 			}
+			else if (strcmp(argv[i], "--script-trace") == 0)
+			{
+				// Print the startup trace (per module load times)
+				ILibDuktape_ModSearch_Trace = 1;
+			}
 			else if (strncmp(argv[i], "--eventemitter-refhold=", 23) == 0)
 			{
 				char *tmp = strstr(argv[i], "=");
@@ -273,15 +273,18 @@ controlChannelIdleTimeout:  Integer value specifying the idle timeout in seconds
 coreDumpEnabled:			If set, a dump file will be written when the agent crashes
 disableUpdate:				If set, will prevent the agent from self-updating
 noUpdateCoreModule:			If set, will prevent the agent from taking a new meshcore from the server
+noModuleBytecode:			If set, will disable caching the compiled bytecode of embedded modules
 enableILibRemoteLogging:	Integer value specifying the port number to enable Web Logging. Disabled otherwise
 fakeUpdate:					If set, when the agent self-updates, it will update to the same version. Will set disableUpdate upon completion
 forceUpdate:				If set, will cause the agent to perform a self-update on next start.
 ignoreProxyFile:			If set, will cause the agent to ignore any proxy settings
 logUpdate:					If set, will cause the agent to log self-update status
 jsDebugPort:				Specify a JS Debugger Port
+kvmCopyRect:				[Linux] If set, scrolled areas are sent to the viewer as MNG_KVM_COPY. The viewer must support it.
 remoteMouseRender:			If set, will always render the remote mouse cursor for KVM
 showModuleNames:			If set, will display the name of modules when they are loaded for the first time
 slaveKvmLog:				[Linux] If set, will enable logging inside the Child KVM Process.
+startupTrace:				If set, will display the time spent loading each module, and the agent startup milestones
 WebProxy:					Manually specify proxy configuration
 webSocketMaskOverride:		If set, will disable the optimzation to skip WebSocket Masking for TLS protected Web Sockets
 *
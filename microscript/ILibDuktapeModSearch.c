@@ -23,6 +23,7 @@ limitations under the License.
 #include "microstack/ILibParsers.h"
 #include "microscript/ILibDuktape_Helpers.h"
 #include "microscript/duk_module_duktape.h"
+#include "microstack/ILibCrypto.h"
 
 #if defined(WIN32) && !defined(_WIN32_WCE) && !defined(_MINCORE)
 #define _CRTDBG_MAP_ALLOC
@@ -31,10 +32,57 @@ limitations under the License.
 
 #define ILibDuktape_ModSearch_ModuleFile	(void*)0xFF
 #define ILibDuktape_ModSearch_ModuleObject	(void*)0xFE
+#define ILibDuktape_ModSearch_ModuleCompressed	(void*)0xFD
+#define ILibDuktape_ModSearch_ModuleLoaded	(void*)0xFC
 #define ILibDuktape_ModSearch_JSInclude		"\xFF_ModSearch_JSINCLUDE"
 #define ILibDuktape_ModSearch_ModulePath	"\xFF_ModSearch_Path"
+#define ILibDuktape_ModSearch_Source		"\xFF_ModSearch_Source"
+#define ILibDuktape_ModSearch_TraceTable	"\xFF_ModSearch_Trace"
+#define ILibDuktape_ModSearch_LazyID		"\xFF_ModSearch_LazyID"
+#define ILibDuktape_ModSearch_LazyName		"\xFF_ModSearch_LazyName"
+#define ILibDuktape_ModSearch_SetSource(ctx, src) if (ILibDuktape_ModSearch_Trace != 0) { duk_push_string(ctx, src); duk_put_prop_string(ctx, 3, ILibDuktape_ModSearch_Source); }
 
 int ILibDuktape_ModSearch_ShowNames = 0;
+int ILibDuktape_ModSearch_BytecodeCache = 1;
+int ILibDuktape_ModSearch_Trace = 0;
+duk_double_t ILibDuktape_ModSearch_TraceStart = 0;
+duk_double_t ILibDuktape_ModSearch_TraceSearchTotal = 0;
+int ILibDuktape_ModSearch_TraceCount = 0;
+
+extern int ILibInflate(char *buffer, size_t bufferLen, char *decompressed, size_t *decompressedLen, uint32_t crc);
+
+//
+// Compiled module wrappers are saved in the data store as [header][bytecode]. The bytecode is only used if the
+// header matches, so it is recompiled whenever the embedded module changes, or the agent is built with a different Duktape.
+//
+typedef struct ILibDuktape_ModSearch_BytecodeHeader
+{
+	uint32_t dukVersion;
+	uint32_t pointerSize;
+	char moduleHash[UTIL_SHA256_HASHSIZE];
+}ILibDuktape_ModSearch_BytecodeHeader;
+
+//
+// Inflates a compressed module, and pushes the source string. Returns non-zero if the module could not be inflated.
+//
+int ILibDuktape_ModSearch_Inflate(duk_context *ctx, char *compressed, size_t compressedLen)
+{
+	size_t sourceLen = 0;
+	char *source;
+
+	// Embedded modules are zlib streams, so skip the zlib header, because ILibInflate() expects raw deflate
+	if (compressedLen > 2 && (compressed[0] & 0x0F) == 8 && (((unsigned char)compressed[0] << 8) | (unsigned char)compressed[1]) % 31 == 0)
+	{
+		compressed += 2;
+		compressedLen -= 2;
+	}
+	if (ILibInflate(compressed, compressedLen, NULL, &sourceLen, 0) != 0 || sourceLen == 0) { return(1); }
+
+	source = (char*)duk_push_fixed_buffer(ctx, sourceLen);	// [buffer]
+	if (ILibInflate(compressed, compressedLen, source, &sourceLen, 0) != 0) { duk_pop(ctx); return(1); }
+	duk_buffer_to_string(ctx, -1);							// [source]
+	return(0);
+}
 
 duk_ret_t ILibDuktape_ModSearch_GetJSModule(duk_context *ctx, char *id)
 {
@@ -82,15 +130,17 @@ duk_ret_t ILibDuktape_ModSearch_GetJSModule(duk_context *ctx, char *id)
 	else
 	{
 		retVal = ILibHashtable_Get(table, ILibDuktape_ModSearch_ModuleFile, id, idLen);
-		if (retVal == NULL)
+		if (retVal != NULL)
 		{
-			return(0);
+			duk_push_string(ctx, retVal);
+			return(1);
 		}
-		else
+		retVal = ILibHashtable_Get(table, ILibDuktape_ModSearch_ModuleCompressed, id, idLen);
+		if (retVal != NULL && ILibDuktape_ModSearch_Inflate(ctx, retVal, ILibMemory_Size(retVal)) == 0)
 		{
-			duk_push_string(ctx, retVal);
 			return(1);
 		}
+		return(0);
 	}
 }
 void ILibDuktape_ModSearch_AddModuleObject(duk_context *ctx, char *id, void *heapptr)
@@ -148,6 +198,40 @@ int ILibDuktape_ModSearch_AddModule(duk_context *ctx, char *id, char *module, in
 	newModule[moduleLen] = 0;
 
 	ILibHashtable_Put(table, ILibDuktape_ModSearch_ModuleFile, id, idLen, newModule);
+	ILibHashtable_Remove(table, ILibDuktape_ModSearch_ModuleCompressed, id, idLen);
+	return 0;
+}
+//
+// Adds a compressed module. The module is only inflated when it is required, and not at all if its bytecode is cached.
+//
+int ILibDuktape_ModSearch_AddModuleCompressed(duk_context *ctx, char *id, char *module, size_t moduleLen)
+{
+	ILibHashtable table = NULL;
+	int idLen = (int)strnlen_s(id, 1024);
+	char *newModule;
+
+	if (moduleLen == 0 || !ILibMemory_Size_Validate(moduleLen, 0)) { return(1); }
+
+	duk_push_heap_stash(ctx);								// [stash]
+	if (duk_has_prop_string(ctx, -1, "ModSearchTable"))
+	{
+		duk_get_prop_string(ctx, -1, "ModSearchTable");		// [stash][ptr]
+		table = (ILibHashtable)duk_to_pointer(ctx, -1);
+		duk_pop(ctx);										// [stash]
+	}
+	else
+	{
+		table = ILibHashtable_Create();
+		duk_push_pointer(ctx, table);						// [stash][ptr]
+		duk_put_prop_string(ctx, -2, "ModSearchTable");		// [stash]
+	}
+	duk_pop(ctx);											// ...
+
+	newModule = (char*)ILibMemory_Init(ILibDuktape_Memory_Alloc(ctx, moduleLen + sizeof(ILibMemory_Header)), moduleLen, 0, ILibMemory_Types_OTHER);
+	memcpy_s(newModule, moduleLen, module, moduleLen);
+
+	ILibHashtable_Put(table, ILibDuktape_ModSearch_ModuleCompressed, id, idLen, newModule);
+	ILibHashtable_Remove(table, ILibDuktape_ModSearch_ModuleFile, id, idLen);
 	return 0;
 }
 int ILibDuktape_ModSearch_AddHandler(duk_context *ctx, char *id, ILibDuktape_ModSearch_PUSH_Object handler)
@@ -170,11 +254,52 @@ int ILibDuktape_ModSearch_AddHandler(duk_context *ctx, char *id, ILibDuktape_Mod
 	}
 	duk_pop(ctx);											// ...
 
-	if (ILibHashtable_Get(table, NULL, id, idLen) != NULL || ILibHashtable_Get(table, ILibDuktape_ModSearch_ModuleFile, id, idLen) != NULL) { return 1; }
+	if (ILibHashtable_Get(table, NULL, id, idLen) != NULL || ILibHashtable_Get(table, ILibDuktape_ModSearch_ModuleFile, id, idLen) != NULL || ILibHashtable_Get(table, ILibDuktape_ModSearch_ModuleCompressed, id, idLen) != NULL) { return 1; }
 	ILibHashtable_Put(table, NULL, id, idLen, handler);
 	return 0;
 }
 
+//
+// Adds a handler that is called with the module's exports on the top of the stack, after the module is loaded. This allows native
+// code to extend a JavaScript module, without having to require the module up front.
+//
+void ILibDuktape_ModSearch_AddLoadHandler(duk_context *ctx, char *id, ILibDuktape_ModSearch_PUSH_Object handler)
+{
+	ILibHashtable table = NULL;
+	int idLen = (int)strnlen_s(id, 1024);
+
+	duk_push_heap_stash(ctx);								// [stash]
+	if (duk_has_prop_string(ctx, -1, "ModSearchTable"))
+	{
+		duk_get_prop_string(ctx, -1, "ModSearchTable");		// [stash][ptr]
+		table = (ILibHashtable)duk_to_pointer(ctx, -1);
+		duk_pop(ctx);										// [stash]
+	}
+	else
+	{
+		table = ILibHashtable_Create();
+		duk_push_pointer(ctx, table);						// [stash][ptr]
+		duk_put_prop_string(ctx, -2, "ModSearchTable");		// [stash]
+	}
+	duk_pop(ctx);											// ...
+	ILibHashtable_Put(table, ILibDuktape_ModSearch_ModuleLoaded, id, idLen, handler);
+
+	// If the module is already loaded, run the handler now
+	duk_get_global_string(ctx, "Duktape");					// [Duktape]
+	duk_get_prop_string(ctx, -1, "modLoaded");				// [Duktape][modLoaded]
+	if (duk_is_object(ctx, -1))
+	{
+		if (duk_get_prop_string(ctx, -1, id) && duk_is_object(ctx, -1))
+		{
+			duk_get_prop_string(ctx, -1, "exports");		// [Duktape][modLoaded][module][exports]
+			handler(ctx, duk_ctx_chain(ctx));
+			duk_pop(ctx);									// [Duktape][modLoaded][module]
+		}
+		duk_pop(ctx);										// [Duktape][modLoaded]
+	}
+	duk_pop_2(ctx);											// ...
+}
+
 duk_ret_t mod_Search_Files(duk_context *ctx, char* id)
 {
 	char fileName[255];
@@ -214,6 +339,77 @@ void ILibDuktape_ModSearch_AddHandler_AlsoIncludeJS(duk_context *ctx, char *js,
 	duk_pop(ctx);													// ...
 }
 
+//
+// Pushes the wrapped module function for an embedded module. The wrapper is loaded from bytecode cached in the data store
+// if possible, otherwise it is compiled from source, and the bytecode is saved for next time. Returns non-zero if the bytecode was used.
+//
+int ILibDuktape_ModSearch_PushModule(duk_context *ctx, ILibSimpleDataStore mDS, char *id, char *module, size_t moduleLen, int compressed)
+{
+	ILibDuktape_ModSearch_BytecodeHeader header;
+	char key[255];
+	int keyLen = 0, valueLen;
+	char *value;
+	duk_size_t bytecodeLen;
+	char *bytecode;
+
+	if (mDS != NULL && ILibDuktape_ModSearch_BytecodeCache != 0)
+	{
+		memset(&header, 0, sizeof(header));
+		header.dukVersion = (uint32_t)DUK_VERSION;
+		header.pointerSize = (uint32_t)sizeof(void*);
+		util_sha256(module, moduleLen, header.moduleHash);
+
+		keyLen = sprintf_s(key, sizeof(key), "__BYTECODE:%s", id);
+		valueLen = ILibSimpleDataStore_GetEx(mDS, key, keyLen, NULL, 0);
+		if (valueLen > (int)sizeof(header))
+		{
+			value = (char*)duk_push_dynamic_buffer(ctx, valueLen);							// [buffer]
+			if (ILibSimpleDataStore_GetEx(mDS, key, keyLen, value, valueLen) == valueLen && memcmp(value, &header, sizeof(header)) == 0)
+			{
+				memmove(value, value + sizeof(header), valueLen - sizeof(header));
+				duk_resize_buffer(ctx, -1, valueLen - sizeof(header));						// [bytecode]
+				duk_load_function(ctx);														// [func]
+				return(1);
+			}
+			duk_pop(ctx);																	// ...
+		}
+	}
+
+	if (compressed != 0)
+	{
+		if (ILibDuktape_ModSearch_Inflate(ctx, module, moduleLen) != 0)						// [source]
+		{
+			ILibDuktape_Error(ctx, "Module: %s (Could not be inflated)", id);
+			return(0);
+		}
+	}
+	else
+	{
+		duk_push_lstring(ctx, module, moduleLen);											// [source]
+	}
+	if (keyLen == 0) { return(0); }
+
+	// Compile the wrapper the same way duk_module_duktape does, so that it can be saved as bytecode
+	duk_push_string(ctx, "(function(require,exports,module){");								// [source][prefix]
+	duk_swap_top(ctx, -2);																	// [prefix][source]
+	duk_push_string(ctx, "\n})");															// [prefix][source][suffix]
+	duk_concat(ctx, 3);																		// [wrappedSource]
+	duk_push_string(ctx, id);																// [wrappedSource][fileName]
+	if (duk_pcompile(ctx, DUK_COMPILE_EVAL) != 0 || duk_pcall(ctx, 0) != 0) { (void)duk_throw(ctx); }
+																							// [func]
+	duk_dup(ctx, -1);																		// [func][func]
+	duk_dump_function(ctx);																	// [func][bytecode]
+	bytecode = (char*)duk_get_buffer(ctx, -1, &bytecodeLen);
+
+	value = (char*)ILibMemory_SmartAllocate(sizeof(header) + bytecodeLen);
+	memcpy_s(value, ILibMemory_Size(value), &header, sizeof(header));
+	memcpy_s(value + sizeof(header), ILibMemory_Size(value) - sizeof(header), bytecode, bytecodeLen);
+	ILibSimpleDataStore_PutCompressed(mDS, key, keyLen, value, ILibMemory_Size(value));
+	ILibMemory_Free(value);
+	duk_pop(ctx);																			// [func]
+	return(0);
+}
+
 duk_ret_t mod_Search(duk_context *ctx)
 {
 	duk_size_t idLen;
@@ -224,6 +420,7 @@ duk_ret_t mod_Search(duk_context *ctx)
 	ILibSimpleDataStore mDS = NULL;
 	char *module;
 	void *j;
+	int fromBytecode;
 
 	if (!duk_is_string(ctx, 0)) { return ILibDuktape_Error(ctx, "mod_search(): Invalid 'ID' parameter"); }
 	id = (char*)duk_get_lstring(ctx, 0, &idLen);
@@ -247,6 +444,7 @@ duk_ret_t mod_Search(duk_context *ctx)
 	{
 		duk_push_heapptr(ctx, j);
 		duk_put_prop_string(ctx, 3, "exports");
+		ILibDuktape_ModSearch_SetSource(ctx, "object");
 		return(0);
 	}
 	 
@@ -257,6 +455,7 @@ duk_ret_t mod_Search(duk_context *ctx)
 		// then check the local filesystem, becuase if present, those should take precedence
 		if(mod_Search_Files(ctx, id) == 1)
 		{
+			ILibDuktape_ModSearch_SetSource(ctx, "file");
 			return(1);
 		}
 
@@ -264,7 +463,14 @@ duk_ret_t mod_Search(duk_context *ctx)
 		// Next check if a handler was added via ILibDuktape_ModSearch_AddModule()
 		if ((module = (char*)ILibHashtable_Get(table, ILibDuktape_ModSearch_ModuleFile, id, (int)idLen)) != NULL)
 		{
-			duk_push_string(ctx, module);
+			fromBytecode = ILibDuktape_ModSearch_PushModule(ctx, mDS, id, module, strlen(module), 0);
+			ILibDuktape_ModSearch_SetSource(ctx, fromBytecode != 0 ? "bytecode" : "source");
+			return(1);
+		}
+		else if ((module = (char*)ILibHashtable_Get(table, ILibDuktape_ModSearch_ModuleCompressed, id, (int)idLen)) != NULL)
+		{
+			fromBytecode = ILibDuktape_ModSearch_PushModule(ctx, mDS, id, module, ILibMemory_Size(module), 1);
+			ILibDuktape_ModSearch_SetSource(ctx, fromBytecode != 0 ? "bytecode" : "source");
 			return(1);
 		}
 		else if (mDS == NULL)
@@ -287,6 +493,7 @@ duk_ret_t mod_Search(duk_context *ctx)
 				value = ILibMemory_Allocate(valueLen, 0, NULL, NULL);
 				ILibSimpleDataStore_GetEx(mDS, key, keyLen, value, valueLen);
 				duk_push_lstring(ctx, value, valueLen);
+				ILibDuktape_ModSearch_SetSource(ctx, "db");
 				return 1;
 			}
 			else
@@ -350,10 +557,123 @@ duk_ret_t ILibDuktape_ModSearch_setModulePath(duk_context *ctx)
 	return(0);
 }
 
+//
+// Called by duk_module_duktape every time a module finishes loading. Runs the load handler for the module, if one was added,
+// and if the startup trace is enabled, prints and records the time the module started loading (relative to the first script
+// engine), the time spent finding/compiling it, and the time spent running its body.
+//
+void ILibDuktape_ModSearch_OnModuleLoaded(duk_context *ctx, const char *id, duk_idx_t module_idx, duk_double_t start, duk_double_t search, duk_double_t exec)
+{
+	ILibDuktape_ModSearch_PUSH_Object handler = NULL;
+	char *source;
+
+	duk_push_heap_stash(ctx);											// [stash]
+	if (duk_has_prop_string(ctx, -1, "ModSearchTable"))
+	{
+		duk_get_prop_string(ctx, -1, "ModSearchTable");					// [stash][ptr]
+		handler = (ILibDuktape_ModSearch_PUSH_Object)ILibHashtable_Get((ILibHashtable)duk_to_pointer(ctx, -1), ILibDuktape_ModSearch_ModuleLoaded, (char*)id, (int)strnlen_s(id, 1024));
+		duk_pop(ctx);													// [stash]
+	}
+	if (handler != NULL)
+	{
+		duk_get_prop_string(ctx, module_idx, "exports");				// [stash][exports]
+		handler(ctx, duk_ctx_chain(ctx));
+		duk_pop(ctx);													// [stash]
+	}
+	if (ILibDuktape_ModSearch_Trace == 0) { duk_pop(ctx); return; }
+
+	source = Duktape_GetStringPropertyValue(ctx, module_idx, ILibDuktape_ModSearch_Source, "native");
+	++ILibDuktape_ModSearch_TraceCount;
+	ILibDuktape_ModSearch_TraceSearchTotal += search;
+	printf("StartupTrace: [%9.3f ms] %-24s %-8s search: %8.3f ms, exec: %8.3f ms\n", start - ILibDuktape_ModSearch_TraceStart, id, source, search, exec);
+
+	if (!duk_has_prop_string(ctx, -1, ILibDuktape_ModSearch_TraceTable))
+	{
+		duk_push_array(ctx);											// [stash][array]
+		duk_put_prop_string(ctx, -2, ILibDuktape_ModSearch_TraceTable);	// [stash]
+	}
+	duk_get_prop_string(ctx, -1, ILibDuktape_ModSearch_TraceTable);		// [stash][array]
+	duk_push_object(ctx);												// [stash][array][record]
+	duk_push_string(ctx, id);						duk_put_prop_string(ctx, -2, "module");
+	duk_push_string(ctx, source);					duk_put_prop_string(ctx, -2, "source");
+	duk_push_number(ctx, start - ILibDuktape_ModSearch_TraceStart);	duk_put_prop_string(ctx, -2, "start");
+	duk_push_number(ctx, search);					duk_put_prop_string(ctx, -2, "search");
+	duk_push_number(ctx, exec);						duk_put_prop_string(ctx, -2, "exec");
+	duk_put_prop_index(ctx, -2, (duk_uarridx_t)duk_get_length(ctx, -2));	// [stash][array]
+	duk_pop_2(ctx);														// ...
+}
+void ILibDuktape_ModSearch_TraceMark(duk_context *ctx, char *label)
+{
+	if (ILibDuktape_ModSearch_Trace == 0 || ctx == NULL) { return; }
+	printf("StartupTrace: [%9.3f ms] ---- %s (%d modules, %.3f ms searching/compiling)\n", duk_get_now(ctx) - ILibDuktape_ModSearch_TraceStart, label, ILibDuktape_ModSearch_TraceCount, ILibDuktape_ModSearch_TraceSearchTotal);
+}
+duk_ret_t ILibDuktape_ModSearch_getModuleTrace(duk_context *ctx)
+{
+	duk_push_heap_stash(ctx);											// [stash]
+	if (duk_has_prop_string(ctx, -1, ILibDuktape_ModSearch_TraceTable))
+	{
+		duk_get_prop_string(ctx, -1, ILibDuktape_ModSearch_TraceTable);	// [stash][array]
+	}
+	else
+	{
+		duk_push_array(ctx);											// [stash][array]
+	}
+	return(1);
+}
+
+//
+// Lazy module stubs. The property is an accessor until it is first read, at which point the module is required,
+// and the property is redefined as a plain value, so the module isn't compiled or run unless it is actually used.
+//
+duk_ret_t ILibDuktape_ModSearch_LazyModule_Getter(duk_context *ctx)
+{
+	duk_push_current_function(ctx);											// [getter]
+	duk_get_prop_string(ctx, -1, ILibDuktape_ModSearch_LazyName);			// [getter][name]
+	duk_get_global_string(ctx, "require");									// [getter][name][require]
+	duk_get_prop_string(ctx, -3, ILibDuktape_ModSearch_LazyID);				// [getter][name][require][id]
+	duk_call(ctx, 1);														// [getter][name][exports]
+
+	duk_push_this(ctx);														// [getter][name][exports][this]
+	duk_dup(ctx, -3);														// [getter][name][exports][this][name]
+	duk_dup(ctx, -3);														// [getter][name][exports][this][name][exports]
+	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_SET_WRITABLE | DUK_DEFPROP_SET_CONFIGURABLE | DUK_DEFPROP_FORCE);
+	duk_pop(ctx);															// [getter][name][exports]
+	return(1);
+}
+duk_ret_t ILibDuktape_ModSearch_LazyModule_Setter(duk_context *ctx)
+{
+	duk_push_current_function(ctx);											// [setter]
+	duk_push_this(ctx);														// [setter][this]
+	duk_get_prop_string(ctx, -2, ILibDuktape_ModSearch_LazyName);			// [setter][this][name]
+	duk_dup(ctx, 0);														// [setter][this][name][value]
+	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_SET_WRITABLE | DUK_DEFPROP_SET_CONFIGURABLE | DUK_DEFPROP_FORCE);
+	return(0);
+}
+void ILibDuktape_ModSearch_AddLazyModule(duk_context *ctx, duk_idx_t i, char *propName, char *id)
+{
+	i = duk_normalize_index(ctx, i);
+
+	duk_push_string(ctx, propName);											// [name]
+	duk_push_c_function(ctx, ILibDuktape_ModSearch_LazyModule_Getter, 0);	// [name][getter]
+	duk_push_string(ctx, propName); duk_put_prop_string(ctx, -2, ILibDuktape_ModSearch_LazyName);
+	duk_push_string(ctx, id); duk_put_prop_string(ctx, -2, ILibDuktape_ModSearch_LazyID);
+	duk_push_c_function(ctx, ILibDuktape_ModSearch_LazyModule_Setter, 1);	// [name][getter][setter]
+	duk_push_string(ctx, propName); duk_put_prop_string(ctx, -2, ILibDuktape_ModSearch_LazyName);
+	duk_def_prop(ctx, i, DUK_DEFPROP_HAVE_GETTER | DUK_DEFPROP_HAVE_SETTER | DUK_DEFPROP_SET_CONFIGURABLE | DUK_DEFPROP_FORCE);
+}
+duk_ret_t ILibDuktape_ModSearch_defineLazyModule(duk_context *ctx)
+{
+	duk_require_object(ctx, 0);
+	ILibDuktape_ModSearch_AddLazyModule(ctx, 0, (char*)duk_require_string(ctx, 1), (char*)(duk_is_string(ctx, 2) ? duk_get_string(ctx, 2) : duk_get_string(ctx, 1)));
+	return(0);
+}
+
 void ILibDuktape_ModSearch_Init(duk_context * ctx, void * chain, ILibSimpleDataStore mDB)
 {
 	duk_module_duktape_init(ctx);
 	if (duk_ctx_chain(ctx) == NULL) { duk_ctx_context_data(ctx)->chain = chain; }
+	if (ILibDuktape_ModSearch_TraceStart == 0) { ILibDuktape_ModSearch_TraceStart = duk_get_now(ctx); }
+	duk_module_duktape_loaded = ILibDuktape_ModSearch_OnModuleLoaded;
 
 	duk_get_global_string(ctx, "Duktape");		// [globalString]
 	duk_push_c_function(ctx, mod_Search, 4);	// [globalString][func]
@@ -371,6 +691,8 @@ void ILibDuktape_ModSearch_Init(duk_context * ctx, void * chain, ILibSimpleDataS
 
 	duk_push_global_object(ctx);				// [g]
 	ILibDuktape_CreateInstanceMethod(ctx, "setModulePath", ILibDuktape_ModSearch_setModulePath, 1);
+	ILibDuktape_CreateInstanceMethod(ctx, "defineLazyModule", ILibDuktape_ModSearch_defineLazyModule, DUK_VARARGS);
+	ILibDuktape_CreateInstanceMethod(ctx, "getModuleTrace", ILibDuktape_ModSearch_getModuleTrace, 0);
 	duk_pop(ctx);								// ...
 
 
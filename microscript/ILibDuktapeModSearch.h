@@ -25,7 +25,11 @@ typedef void (*ILibDuktape_ModSearch_PUSH_Object)(duk_context *ctx, void *chain)
 int ILibDuktape_ModSearch_AddHandler(duk_context *ctx, char *id, ILibDuktape_ModSearch_PUSH_Object handler);
 void ILibDuktape_ModSearch_AddHandler_AlsoIncludeJS(duk_context *ctx, char *js, size_t jsLen);
 int ILibDuktape_ModSearch_AddModule(duk_context *ctx, char *id, char *module, int moduleLen);
+int ILibDuktape_ModSearch_AddModuleCompressed(duk_context *ctx, char *id, char *module, size_t moduleLen);
 void ILibDuktape_ModSearch_AddModuleObject(duk_context *ctx, char *id, void *heapptr);
+void ILibDuktape_ModSearch_AddLoadHandler(duk_context *ctx, char *id, ILibDuktape_ModSearch_PUSH_Object handler);
+void ILibDuktape_ModSearch_AddLazyModule(duk_context *ctx, duk_idx_t i, char *propName, char *id);
+void ILibDuktape_ModSearch_TraceMark(duk_context *ctx, char *label);
 duk_ret_t ILibDuktape_ModSearch_GetJSModule(duk_context *ctx, char *id);
 void ILibDuktape_ModSearch_Init(duk_context *ctx, void *chain, ILibSimpleDataStore mDB);
 
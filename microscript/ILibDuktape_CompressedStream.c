@@ -390,6 +390,623 @@ duk_ret_t ILibDuktape_CompressedStream_inflate(duk_context *ctx)
 	duk_get_prop_string(ctx, -2, "_buf");												// [decompressor][val][buffer]
 	return(1);
 }
+
+//
+// Native archive stream, used by zip-writer.js and tar-encoder.js. A worker thread reads the files in large blocks,
+// and does the compression and CRC, then hands the archive to the chain in chunks, where they are written to a
+// ReadableStream. The worker stops producing while the stream is paused, or when too many chunks are still queued.
+//
+#define ILibDuktape_CompressedStream_Archive_ptr		"\xFF_CompressedStream_Archive_ptr"
+#define ILibDuktape_CompressedStream_Pending		"\xFF_CompressedStream_Pending"
+#define ILibDuktape_Archive_BlockSize				262144
+#define ILibDuktape_Archive_ChunkSize				65536
+#define ILibDuktape_Archive_MaxPendingChunks		4
+#define ILibDuktape_Archive_ZIP_LFR					0x04034b50
+#define ILibDuktape_Archive_ZIP_CDR					0x02014b50
+#define ILibDuktape_Archive_ZIP_EOCDR				0x06054b50
+#define ILibDuktape_Archive_TAR_BlockSize			512
+
+typedef enum ILibDuktape_Archive_Format
+{
+	ILibDuktape_Archive_Format_ZIP = 0,
+	ILibDuktape_Archive_Format_TAR = 1
+}ILibDuktape_Archive_Format;
+
+typedef struct ILibDuktape_Archive_Entry
+{
+	char *path;
+	char *name;					// ZIP: Name of the entry in the archive
+	char *header;				// TAR: USTAR header, generated by tar-encoder.js
+	size_t nameLen;
+	uint64_t size;
+	uint16_t dosTime;
+	uint16_t dosDate;
+	int skipped;
+	uint32_t crc;
+	uint32_t compressedSize;
+	uint32_t offset;
+}ILibDuktape_Archive_Entry;
+
+typedef struct ILibDuktape_Archive
+{
+	duk_context *ctx;
+	uintptr_t ctxnonce;
+	void *chain;
+	void *object;
+	void *moduleObject;
+	ILibDuktape_readableStream *stream;
+	ILibDuktape_EventEmitter *emitter;
+	ILibDuktape_Archive_Format format;
+
+	ILibSpinLock lock;
+	sem_t wake;
+	sem_t workerExited;
+	int workerStarted;
+	int waiting;
+	int paused;
+	int pendingChunks;
+	int stop;
+	int finalized;
+
+	// Only used on the chain
+	int cancelled;
+	int endPending;
+	int lastEntry;
+	int lastPercent;
+
+	// Only used by the worker
+	z_stream Z;
+	uint32_t offset;
+	int currentEntry;
+	int currentPercent;
+
+	int entryCount;
+	ILibDuktape_Archive_Entry *entries;
+}ILibDuktape_Archive;
+
+typedef struct ILibDuktape_Archive_Chunk
+{
+	ILibDuktape_Archive *archive;
+	int end;
+	int entry;
+	int percent;
+	size_t len;
+	char *buffer;
+}ILibDuktape_Archive_Chunk;
+
+static void ILibDuktape_Archive_PutUInt16(char *dest, uint16_t val)
+{
+	dest[0] = (char)(val & 0xFF);
+	dest[1] = (char)(val >> 8);
+}
+static void ILibDuktape_Archive_PutUInt32(char *dest, uint32_t val)
+{
+	dest[0] = (char)(val & 0xFF);
+	dest[1] = (char)((val >> 8) & 0xFF);
+	dest[2] = (char)((val >> 16) & 0xFF);
+	dest[3] = (char)(val >> 24);
+}
+void ILibDuktape_Archive_Wake(ILibDuktape_Archive *archive)
+{
+	// Caller must be holding the lock
+	if (archive->waiting != 0)
+	{
+		archive->waiting = 0;
+		sem_post(&(archive->wake));
+	}
+}
+void ILibDuktape_Archive_Stop(ILibDuktape_Archive *archive)
+{
+	ILibSpinLock_Lock(&(archive->lock));
+	archive->stop = 1;
+	ILibDuktape_Archive_Wake(archive);
+	ILibSpinLock_UnLock(&(archive->lock));
+}
+void ILibDuktape_Archive_End(ILibDuktape_Archive *archive)
+{
+	duk_context *ctx = archive->ctx;
+
+	ILibDuktape_readableStream_WriteEnd(archive->stream);
+
+	// The archive object can be collected now
+	duk_push_heapptr(ctx, archive->moduleObject);								// [compressed-stream]
+	duk_get_prop_string(ctx, -1, ILibDuktape_CompressedStream_Pending);		// [compressed-stream][table]
+	duk_push_pointer(ctx, archive);											// [compressed-stream][table][key]
+	duk_del_prop(ctx, -2);
+	duk_pop_2(ctx);															// ...
+}
+void ILibDuktape_Archive_Chunk_Abort(void *chain, void *user)
+{
+	UNREFERENCED_PARAMETER(chain);
+	ILibMemory_Free(user);
+}
+void ILibDuktape_Archive_Chunk_Sink(void *chain, void *user)
+{
+	ILibDuktape_Archive_Chunk *chunk = (ILibDuktape_Archive_Chunk*)user;
+	ILibDuktape_Archive *archive = chunk->archive;
+	duk_context *ctx = archive->ctx;
+
+	UNREFERENCED_PARAMETER(chain);
+
+	if (archive->cancelled == 0 && chunk->entry >= 0 && (chunk->entry != archive->lastEntry || chunk->percent != archive->lastPercent))
+	{
+		archive->lastEntry = chunk->entry;
+		archive->lastPercent = chunk->percent;
+		ILibDuktape_EventEmitter_SetupEmit(ctx, archive->object, "progress");		// [emit][this][progress]
+		duk_push_string(ctx, archive->entries[chunk->entry].path);					// [emit][this][progress][path]
+		duk_push_int(ctx, chunk->percent);											// [emit][this][progress][path][percent]
+		if (duk_pcall_method(ctx, 3) != 0) { ILibDuktape_Process_UncaughtExceptionEx(ctx, "compressedStream.archive.onProgress(): "); }
+		duk_pop(ctx);																// ...
+	}
+	if (archive->cancelled == 0 && chunk->len > 0)
+	{
+		ILibDuktape_readableStream_WriteData(archive->stream, chunk->buffer, chunk->len);
+	}
+
+	ILibSpinLock_Lock(&(archive->lock));
+	--archive->pendingChunks;
+	ILibDuktape_Archive_Wake(archive);
+	ILibSpinLock_UnLock(&(archive->lock));
+
+	if (chunk->end != 0)
+	{
+		if (archive->cancelled != 0)
+		{
+			ILibDuktape_EventEmitter_SetupEmit(ctx, archive->object, "cancel");	// [emit][this][cancel]
+			if (duk_pcall_method(ctx, 1) != 0) { ILibDuktape_Process_UncaughtExceptionEx(ctx, "compressedStream.archive.onCancel(): "); }
+			duk_pop(ctx);															// ...
+			ILibDuktape_Archive_End(archive);
+		}
+		else if (archive->stream->paused != 0)
+		{
+			// The end must not overtake the data that is still buffered in the stream
+			archive->endPending = 1;
+		}
+		else
+		{
+			ILibDuktape_Archive_End(archive);
+		}
+	}
+	ILibMemory_Free(chunk);
+}
+void ILibDuktape_Archive_Pause(ILibDuktape_readableStream *sender, void *user)
+{
+	ILibDuktape_Archive *archive = (ILibDuktape_Archive*)user;
+	UNREFERENCED_PARAMETER(sender);
+
+	ILibSpinLock_Lock(&(archive->lock));
+	archive->paused = 1;
+	ILibSpinLock_UnLock(&(archive->lock));
+}
+void ILibDuktape_Archive_Resume(ILibDuktape_readableStream *sender, void *user)
+{
+	ILibDuktape_Archive *archive = (ILibDuktape_Archive*)user;
+	UNREFERENCED_PARAMETER(sender);
+
+	ILibSpinLock_Lock(&(archive->lock));
+	archive->paused = 0;
+	ILibDuktape_Archive_Wake(archive);
+	ILibSpinLock_UnLock(&(archive->lock));
+
+	if (archive->endPending != 0)
+	{
+		archive->endPending = 0;
+		ILibDuktape_Archive_End(archive);
+	}
+}
+
+//
+// Worker
+//
+ILibDuktape_Archive_Chunk* ILibDuktape_Archive_Chunk_New(ILibDuktape_Archive *archive)
+{
+	ILibDuktape_Archive_Chunk *chunk = (ILibDuktape_Archive_Chunk*)ILibMemory_SmartAllocateEx(sizeof(ILibDuktape_Archive_Chunk), ILibDuktape_Archive_ChunkSize);
+	if (chunk == NULL) { ILIBCRITICALEXIT(254); }
+	chunk->archive = archive;
+	chunk->buffer = (char*)ILibMemory_Extra(chunk);
+	return(chunk);
+}
+int ILibDuktape_Archive_Post(ILibDuktape_Archive *archive, ILibDuktape_Archive_Chunk **chunk, int end)
+{
+	int stop, discard;
+
+	if (*chunk == NULL) { *chunk = ILibDuktape_Archive_Chunk_New(archive); }
+	(*chunk)->end = end;
+	(*chunk)->entry = archive->currentEntry;
+	(*chunk)->percent = archive->currentPercent;
+
+	ILibSpinLock_Lock(&(archive->lock));
+	while (archive->stop == 0 && (archive->paused != 0 || archive->pendingChunks >= ILibDuktape_Archive_MaxPendingChunks))
+	{
+		archive->waiting = 1;
+		ILibSpinLock_UnLock(&(archive->lock));
+		sem_wait(&(archive->wake));
+		ILibSpinLock_Lock(&(archive->lock));
+	}
+	stop = archive->stop;
+
+	// Once stopped, only the end is delivered, so the chain can emit 'cancel'. Nothing is delivered once the finalizer has run.
+	discard = archive->finalized != 0 || (stop != 0 && end == 0);
+	if (discard == 0) { ++archive->pendingChunks; }
+	ILibSpinLock_UnLock(&(archive->lock));
+
+	if (discard != 0)
+	{
+		ILibMemory_Free(*chunk);
+	}
+	else
+	{
+		Duktape_RunOnEventLoop(archive->chain, archive->ctxnonce, archive->ctx, ILibDuktape_Archive_Chunk_Sink, ILibDuktape_Archive_Chunk_Abort, *chunk);
+	}
+	*chunk = NULL;
+	return(stop);
+}
+int ILibDuktape_Archive_Write(ILibDuktape_Archive *archive, ILibDuktape_Archive_Chunk **chunk, char *buffer, size_t bufferLen)
+{
+	size_t len;
+
+	// A NULL buffer writes zeros
+	while (bufferLen > 0)
+	{
+		if (*chunk == NULL) { *chunk = ILibDuktape_Archive_Chunk_New(archive); }
+		len = ILibDuktape_Archive_ChunkSize - (*chunk)->len;
+		if (len > bufferLen) { len = bufferLen; }
+		if (buffer != NULL)
+		{
+			memcpy_s((*chunk)->buffer + (*chunk)->len, ILibDuktape_Archive_ChunkSize - (*chunk)->len, buffer, len);
+			buffer += len;
+		}
+		else
+		{
+			memset((*chunk)->buffer + (*chunk)->len, 0, len);
+		}
+		(*chunk)->len += len;
+		archive->offset += (uint32_t)len;
+		bufferLen -= len;
+		if ((*chunk)->len == ILibDuktape_Archive_ChunkSize && ILibDuktape_Archive_Post(archive, chunk, 0) != 0) { return(1); }
+	}
+	return(0);
+}
+int ILibDuktape_Archive_Deflate(ILibDuktape_Archive *archive, ILibDuktape_Archive_Chunk **chunk, char *buffer, size_t bufferLen, int flush, uint32_t *compressedSize)
+{
+	size_t avail;
+	int res, full;
+
+	archive->Z.next_in = (Bytef*)(buffer != NULL ? buffer : ILibScratchPad);
+	archive->Z.avail_in = (uInt)bufferLen;
+	do
+	{
+		if (*chunk == NULL) { *chunk = ILibDuktape_Archive_Chunk_New(archive); }
+		avail = ILibDuktape_Archive_ChunkSize - (*chunk)->len;
+		archive->Z.next_out = (Bytef*)((*chunk)->buffer + (*chunk)->len);
+		archive->Z.avail_out = (uInt)avail;
+		if ((res = deflate(&(archive->Z), flush)) != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR) { return(1); }
+
+		avail -= archive->Z.avail_out;
+		(*chunk)->len += avail;
+		archive->offset += (uint32_t)avail;
+		*compressedSize += (uint32_t)avail;
+		full = archive->Z.avail_out == 0;
+		if (full != 0 && ILibDuktape_Archive_Post(archive, chunk, 0) != 0) { return(1); }
+	} while (flush == Z_FINISH ? res != Z_STREAM_END : (full != 0 || archive->Z.avail_in > 0));
+	return(0);
+}
+FILE* ILibDuktape_Archive_Open(char *path)
+{
+	FILE *f = NULL;
+#ifdef WIN32
+	WCHAR wpath[4096];
+	_wfopen_s(&f, ILibUTF8ToWideEx(path, -1, wpath, (int)(sizeof(wpath) / sizeof(WCHAR))), L"rb");
+#else
+	f = fopen(path, "rb");
+#endif
+	return(f);
+}
+void ILibDuktape_Archive_SetProgress(ILibDuktape_Archive *archive, uint64_t bytesRead, uint64_t size)
+{
+	archive->currentPercent = (size == 0 || bytesRead >= size) ? 100 : (int)((bytesRead * 100) / size);
+}
+int ILibDuktape_Archive_ZipEntry(ILibDuktape_Archive *archive, ILibDuktape_Archive_Chunk **chunk, char *block, ILibDuktape_Archive_Entry *entry)
+{
+	FILE *f;
+	char header[30];
+	size_t bytesRead;
+	uint64_t total = 0;
+	uint32_t crc = 0, compressedSize = 0;
+
+	// Files that went away since the list was made are left out, like zip-writer.js used to do
+	if ((f = ILibDuktape_Archive_Open(entry->path)) == NULL) { entry->skipped = 1; return(0); }
+
+	// Local File Header. The CRC and sizes are in the Data Descriptor after the data.
+	memset(header, 0, sizeof(header));
+	ILibDuktape_Archive_PutUInt32(header, ILibDuktape_Archive_ZIP_LFR);		// Signature
+	ILibDuktape_Archive_PutUInt16(header + 4, 20);							// Version needed to extract
+	ILibDuktape_Archive_PutUInt16(header + 6, 0x08);						// General Purpose Bit Flag
+	ILibDuktape_Archive_PutUInt16(header + 8, 8);							// Compression Method
+	ILibDuktape_Archive_PutUInt16(header + 10, entry->dosTime);				// File Last Modification Time
+	ILibDuktape_Archive_PutUInt16(header + 12, entry->dosDate);				// File Last Modification Date
+	ILibDuktape_Archive_PutUInt32(header + 22, (uint32_t)entry->size);		// Uncompressed size
+	ILibDuktape_Archive_PutUInt16(header + 26, (uint16_t)entry->nameLen);	// File name length
+
+	entry->offset = archive->offset;
+	if (ILibDuktape_Archive_Write(archive, chunk, header, sizeof(header)) != 0 || ILibDuktape_Archive_Write(archive, chunk, entry->name, entry->nameLen) != 0) { fclose(f); return(1); }
+
+	deflateReset(&(archive->Z));
+	while ((bytesRead = fread(block, 1, ILibDuktape_Archive_BlockSize, f)) > 0)
+	{
+		crc = crc32(crc, (unsigned char*)block, (uint32_t)bytesRead);
+		total += bytesRead;
+		ILibDuktape_Archive_SetProgress(archive, total, entry->size);
+		if (ILibDuktape_Archive_Deflate(archive, chunk, block, bytesRead, Z_NO_FLUSH, &compressedSize) != 0) { fclose(f); return(1); }
+	}
+	fclose(f);
+	if (ILibDuktape_Archive_Deflate(archive, chunk, NULL, 0, Z_FINISH, &compressedSize) != 0) { return(1); }
+
+	// Data Descriptor
+	entry->crc = crc;
+	entry->compressedSize = compressedSize;
+	entry->size = total;
+	ILibDuktape_Archive_PutUInt32(header, crc);
+	ILibDuktape_Archive_PutUInt32(header + 4, compressedSize);
+	ILibDuktape_Archive_PutUInt32(header + 8, (uint32_t)total);
+	return(ILibDuktape_Archive_Write(archive, chunk, header, 12));
+}
+int ILibDuktape_Archive_ZipFinish(ILibDuktape_Archive *archive, ILibDuktape_Archive_Chunk **chunk)
+{
+	ILibDuktape_Archive_Entry *entry;
+	char record[46];
+	uint32_t cdOffset = archive->offset;
+	int i, count = 0;
+
+	// Central Directory
+	for (i = 0; i < archive->entryCount; ++i)
+	{
+		entry = &(archive->entries[i]);
+		if (entry->skipped != 0) { continue; }
+
+		memset(record, 0, sizeof(record));
+		ILibDuktape_Archive_PutUInt32(record, ILibDuktape_Archive_ZIP_CDR);		// Signature
+		ILibDuktape_Archive_PutUInt16(record + 4, 20);							// Version
+		ILibDuktape_Archive_PutUInt16(record + 6, 20);							// Minimum
+		ILibDuktape_Archive_PutUInt16(record + 8, 0x08);						// General Purpose Bit Flag
+		ILibDuktape_Archive_PutUInt16(record + 10, 8);							// Compression Method
+		ILibDuktape_Archive_PutUInt16(record + 12, entry->dosTime);				// File Last Modification Time
+		ILibDuktape_Archive_PutUInt16(record + 14, entry->dosDate);				// File Last Modification Date
+		ILibDuktape_Archive_PutUInt32(record + 16, entry->crc);					// CRC
+		ILibDuktape_Archive_PutUInt32(record + 20, entry->compressedSize);		// Compressed Size
+		ILibDuktape_Archive_PutUInt32(record + 24, (uint32_t)entry->size);		// Uncompressed Size
+		ILibDuktape_Archive_PutUInt16(record + 28, (uint16_t)entry->nameLen);	// File Name Length
+		ILibDuktape_Archive_PutUInt16(record + 36, 1);							// Internal Attributes
+		ILibDuktape_Archive_PutUInt32(record + 38, 32);							// External Attributes
+		ILibDuktape_Archive_PutUInt32(record + 42, entry->offset);				// Relative Offset
+		if (ILibDuktape_Archive_Write(archive, chunk, record, sizeof(record)) != 0 || ILibDuktape_Archive_Write(archive, chunk, entry->name, entry->nameLen) != 0) { return(1); }
+		++count;
+	}
+
+	// End of Central Directory
+	memset(record, 0, sizeof(record));
+	ILibDuktape_Archive_PutUInt32(record, ILibDuktape_Archive_ZIP_EOCDR);		// Signature
+	ILibDuktape_Archive_PutUInt16(record + 8, (uint16_t)count);					// Number of CD Records on this disk
+	ILibDuktape_Archive_PutUInt16(record + 10, (uint16_t)count);				// Total number of CD Records
+	ILibDuktape_Archive_PutUInt32(record + 12, archive->offset - cdOffset);		// Size of CD Records in bytes
+	ILibDuktape_Archive_PutUInt32(record + 16, cdOffset);						// Offset start of CDR
+	return(ILibDuktape_Archive_Write(archive, chunk, record, 22));
+}
+int ILibDuktape_Archive_TarEntry(ILibDuktape_Archive *archive, ILibDuktape_Archive_Chunk **chunk, char *block, ILibDuktape_Archive_Entry *entry)
+{
+	FILE *f = NULL;
+	size_t bytesRead;
+	uint64_t remaining = entry->size;
+
+	if (entry->size > 0 && (f = ILibDuktape_Archive_Open(entry->path)) == NULL) { entry->skipped = 1; return(0); }
+	if (ILibDuktape_Archive_Write(archive, chunk, entry->header, ILibDuktape_Archive_TAR_BlockSize) != 0) { if (f != NULL) { fclose(f); } return(1); }
+
+	// The header already has the size, so exactly that much is written, even if the file changed in the meantime
+	while (remaining > 0 && (bytesRead = fread(block, 1, remaining < ILibDuktape_Archive_BlockSize ? (size_t)remaining : ILibDuktape_Archive_BlockSize, f)) > 0)
+	{
+		remaining -= bytesRead;
+		ILibDuktape_Archive_SetProgress(archive, entry->size - remaining, entry->size);
+		if (ILibDuktape_Archive_Write(archive, chunk, block, bytesRead) != 0) { fclose(f); return(1); }
+	}
+	if (f != NULL) { fclose(f); }
+	if (ILibDuktape_Archive_Write(archive, chunk, NULL, (size_t)remaining) != 0) { return(1); }
+	return(ILibDuktape_Archive_Write(archive, chunk, NULL, (size_t)((ILibDuktape_Archive_TAR_BlockSize - (entry->size % ILibDuktape_Archive_TAR_BlockSize)) % ILibDuktape_Archive_TAR_BlockSize)));
+}
+void ILibDuktape_Archive_WorkerRunLoop(void *arg)
+{
+	ILibDuktape_Archive *archive = (ILibDuktape_Archive*)arg;
+	ILibDuktape_Archive_Chunk *chunk = NULL;
+	char *block;
+	int i, stopped = 0;
+
+	if ((block = (char*)malloc(ILibDuktape_Archive_BlockSize)) == NULL) { ILIBCRITICALEXIT(254); }
+	for (i = 0; stopped == 0 && i < archive->entryCount; ++i)
+	{
+		archive->currentEntry = i;
+		archive->currentPercent = 0;
+		if (archive->format == ILibDuktape_Archive_Format_ZIP)
+		{
+			stopped = ILibDuktape_Archive_ZipEntry(archive, &chunk, block, &(archive->entries[i]));
+		}
+		else
+		{
+			stopped = ILibDuktape_Archive_TarEntry(archive, &chunk, block, &(archive->entries[i]));
+		}
+	}
+	free(block);
+
+	archive->currentEntry = -1;
+	if (stopped == 0)
+	{
+		if (archive->format == ILibDuktape_Archive_Format_ZIP)
+		{
+			ignore_result(ILibDuktape_Archive_ZipFinish(archive, &chunk));
+		}
+		else
+		{
+			// End of archive is two zero blocks
+			ignore_result(ILibDuktape_Archive_Write(archive, &chunk, NULL, 2 * ILibDuktape_Archive_TAR_BlockSize));
+		}
+	}
+	ILibDuktape_Archive_Post(archive, &chunk, 1);
+	sem_post(&(archive->workerExited));
+}
+
+duk_ret_t ILibDuktape_Archive_cancel(duk_context *ctx)
+{
+	int nargs = duk_get_top(ctx);
+	ILibDuktape_Archive *archive;
+
+	duk_push_this(ctx);																	// [archive]
+	archive = (ILibDuktape_Archive*)Duktape_GetPointerProperty(ctx, -1, ILibDuktape_CompressedStream_Archive_ptr);
+	if (archive != NULL && archive->cancelled == 0)
+	{
+		if (nargs > 0 && duk_is_function(ctx, 0)) { ILibDuktape_EventEmitter_AddOnce(archive->emitter, "cancel", duk_get_heapptr(ctx, 0)); }
+		archive->cancelled = 1;
+		ILibDuktape_Archive_Stop(archive);
+	}
+	return(0);
+}
+duk_ret_t ILibDuktape_Archive_Finalizer(duk_context *ctx)
+{
+	ILibDuktape_Archive *archive = (ILibDuktape_Archive*)Duktape_GetPointerProperty(ctx, 0, ILibDuktape_CompressedStream_Archive_ptr);
+	if (archive == NULL) { return(0); }
+	duk_del_prop_string(ctx, 0, ILibDuktape_CompressedStream_Archive_ptr);
+
+	ILibSpinLock_Lock(&(archive->lock));
+	archive->finalized = 1;
+	ILibSpinLock_UnLock(&(archive->lock));
+	ILibDuktape_Archive_Stop(archive);
+	if (archive->workerStarted != 0) { sem_wait(&(archive->workerExited)); }
+
+	if (archive->format == ILibDuktape_Archive_Format_ZIP) { ignore_result(deflateEnd(&(archive->Z))); }
+	sem_destroy(&(archive->wake));
+	sem_destroy(&(archive->workerExited));
+	ILibMemory_Free(archive);
+	return(0);
+}
+
+// require('compressed-stream').createArchive('zip', [{ path: path, name: name, size: size, time: msdosTime, date: msdosDate }, ...])
+// require('compressed-stream').createArchive('tar', [{ path: path, size: size, header: ustarHeader }, ...])
+duk_ret_t ILibDuktape_CompressedStream_createArchive(duk_context *ctx)
+{
+	char *format = (char*)duk_require_string(ctx, 0);
+	ILibDuktape_Archive_Format fmt;
+	ILibDuktape_Archive *archive;
+	ILibDuktape_Archive_Entry *entry;
+	duk_size_t len, headerLen;
+	char *str, *header, *extra;
+	size_t extraLen, pos;
+	int i, count;
+
+	if (strcmp(format, "zip") == 0) { fmt = ILibDuktape_Archive_Format_ZIP; }
+	else if (strcmp(format, "tar") == 0) { fmt = ILibDuktape_Archive_Format_TAR; }
+	else { return(ILibDuktape_Error(ctx, "createArchive(): Unsupported format: %s", format)); }
+	if (!duk_is_array(ctx, 1)) { return(ILibDuktape_Error(ctx, "createArchive(): Entries must be an array")); }
+	count = (int)duk_get_length(ctx, 1);
+
+	// Everything is validated before anything is allocated
+	extraLen = count * sizeof(ILibDuktape_Archive_Entry);
+	for (i = 0; i < count; ++i)
+	{
+		duk_get_prop_index(ctx, 1, i);												// [entry]
+		if (!duk_is_object(ctx, -1)) { return(ILibDuktape_Error(ctx, "createArchive(): Invalid entry at index %d", i)); }
+		str = Duktape_GetStringPropertyValueEx(ctx, -1, "path", NULL, &len);
+		if (str == NULL || len == 0) { return(ILibDuktape_Error(ctx, "createArchive(): Entry %d has no path", i)); }
+		extraLen += (len + 1);
+		if (fmt == ILibDuktape_Archive_Format_ZIP)
+		{
+			str = Duktape_GetStringPropertyValueEx(ctx, -1, "name", NULL, &len);
+			if (str == NULL || len == 0 || len > 0xFFFF) { return(ILibDuktape_Error(ctx, "createArchive(): Entry %d has an invalid name", i)); }
+			extraLen += (len + 1);
+		}
+		else
+		{
+			header = Duktape_GetBufferPropertyEx(ctx, -1, "header", &headerLen);
+			if (header == NULL || headerLen != ILibDuktape_Archive_TAR_BlockSize) { return(ILibDuktape_Error(ctx, "createArchive(): Entry %d has an invalid header", i)); }
+			extraLen += ILibDuktape_Archive_TAR_BlockSize;
+		}
+		duk_pop(ctx);																// ...
+	}
+
+	archive = (ILibDuktape_Archive*)ILibMemory_SmartAllocateEx(sizeof(ILibDuktape_Archive), extraLen);
+	if (archive == NULL) { ILIBCRITICALEXIT(254); }
+	extra = (char*)ILibMemory_Extra(archive);
+	archive->entries = (ILibDuktape_Archive_Entry*)extra;
+	archive->entryCount = count;
+	pos = count * sizeof(ILibDuktape_Archive_Entry);
+	for (i = 0; i < count; ++i)
+	{
+		entry = &(archive->entries[i]);
+		duk_get_prop_index(ctx, 1, i);												// [entry]
+		str = Duktape_GetStringPropertyValueEx(ctx, -1, "path", NULL, &len);
+		entry->path = extra + pos;
+		memcpy_s(entry->path, extraLen - pos, str, len + 1); pos += (len + 1);
+		duk_get_prop_string(ctx, -1, "size");										// [entry][size]
+		entry->size = (uint64_t)duk_get_number_default(ctx, -1, 0);
+		duk_pop(ctx);																// [entry]
+		if (fmt == ILibDuktape_Archive_Format_ZIP)
+		{
+			str = Duktape_GetStringPropertyValueEx(ctx, -1, "name", NULL, &len);
+			entry->name = extra + pos;
+			entry->nameLen = len;
+			memcpy_s(entry->name, extraLen - pos, str, len + 1); pos += (len + 1);
+			entry->dosTime = (uint16_t)Duktape_GetIntPropertyValue(ctx, -1, "time", 0);
+			entry->dosDate = (uint16_t)Duktape_GetIntPropertyValue(ctx, -1, "date", 0);
+		}
+		else
+		{
+			header = Duktape_GetBufferPropertyEx(ctx, -1, "header", &headerLen);
+			entry->header = extra + pos;
+			memcpy_s(entry->header, extraLen - pos, header, headerLen); pos += headerLen;
+		}
+		duk_pop(ctx);																// ...
+	}
+
+	archive->ctx = ctx;
+	archive->ctxnonce = duk_ctx_nonce(ctx);
+	archive->chain = duk_ctx_chain(ctx);
+	archive->format = fmt;
+	archive->paused = 1;
+	archive->lastEntry = -1;
+	ILibSpinLock_Init(&(archive->lock));
+	sem_init(&(archive->wake), 0, 0);
+	sem_init(&(archive->workerExited), 0, 0);
+	if (fmt == ILibDuktape_Archive_Format_ZIP && deflateInit2(&(archive->Z), Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		sem_destroy(&(archive->wake));
+		sem_destroy(&(archive->workerExited));
+		ILibMemory_Free(archive);
+		return(ILibDuktape_Error(ctx, "zlib error"));
+	}
+
+	duk_push_object(ctx);															// [archive]
+	ILibDuktape_WriteID(ctx, "compressedStream.archive");
+	archive->object = duk_get_heapptr(ctx, -1);
+	duk_push_pointer(ctx, archive); duk_put_prop_string(ctx, -2, ILibDuktape_CompressedStream_Archive_ptr);
+	archive->stream = ILibDuktape_ReadableStream_Init(ctx, ILibDuktape_Archive_Pause, ILibDuktape_Archive_Resume, archive);
+	archive->stream->paused = 1;
+	archive->emitter = ILibDuktape_EventEmitter_Create(ctx);
+	ILibDuktape_EventEmitter_CreateEventEx(archive->emitter, "progress");
+	ILibDuktape_EventEmitter_CreateEventEx(archive->emitter, "cancel");
+	ILibDuktape_CreateProperty_InstanceMethod(ctx, "cancel", ILibDuktape_Archive_cancel, DUK_VARARGS);		// Replaces the event property, like addMethod() does
+	ILibDuktape_CreateFinalizer(ctx, ILibDuktape_Archive_Finalizer);
+	duk_events_newListener2(ctx, -1, "data", ILibDuktape_CompressedStream_resume_newListener);
+
+	// The archive object is kept alive until the stream has ended
+	duk_push_this(ctx);																// [archive][compressed-stream]
+	archive->moduleObject = duk_get_heapptr(ctx, -1);
+	duk_get_prop_string(ctx, -1, ILibDuktape_CompressedStream_Pending);			// [archive][compressed-stream][table]
+	duk_push_pointer(ctx, archive);													// [archive][compressed-stream][table][key]
+	duk_dup(ctx, -4);																// [archive][compressed-stream][table][key][archive]
+	duk_put_prop(ctx, -3);															// [archive][compressed-stream][table]
+	duk_pop_2(ctx);																	// [archive]
+
+	// The worker does not produce anything until the stream is resumed
+	if (ILibSpawnNormalThread(ILibDuktape_Archive_WorkerRunLoop, archive) == NULL) { return(ILibDuktape_Error(ctx, "createArchive(): Unable to start worker")); }
+	archive->workerStarted = 1;
+	return(1);
+}
 void ILibDuktape_CompressedStream_PUSH(duk_context *ctx, void *chain)
 {
 	duk_push_object(ctx);							// [compressed-stream]
@@ -398,6 +1015,8 @@ void ILibDuktape_CompressedStream_PUSH(duk_context *ctx, void *chain)
 	ILibDuktape_CreateInstanceMethod(ctx, "createDecompressor", ILibDuktape_CompressedStream_decompressor, DUK_VARARGS);
 	ILibDuktape_CreateInstanceMethod(ctx, "deflate", ILibDuktape_CompressedStream_deflate, DUK_VARARGS);
 	ILibDuktape_CreateInstanceMethod(ctx, "inflate", ILibDuktape_CompressedStream_inflate, DUK_VARARGS);
+	ILibDuktape_CreateInstanceMethod(ctx, "createArchive", ILibDuktape_CompressedStream_createArchive, 2);
+	duk_push_object(ctx); duk_put_prop_string(ctx, -2, ILibDuktape_CompressedStream_Pending);
 }
 
 void ILibDuktape_CompressedStream_init(duk_context * ctx)
@@ -139,13 +139,17 @@ void Duktape_RunOnEventLoop_Sink(void *chain, void *user)
 #ifdef WIN32
 void __stdcall Duktape_RunOnEventLoop_SanityCheck(ULONG_PTR u)
 {
-	if (!ILibMemory_CanaryOK((void*)u)) { return; }
+	// u is the work item token, accessed as void*[4]: [0] chain, [1] handler, [2] user, [3] abortHandler
+	if (!ILibMemory_CanaryOK((void*)u) || ILibChain_WorkQueue_IsClosed(((void**)u)[0])) { return; }
 	Duktape_EventLoopDispatchData* d = (Duktape_EventLoopDispatchData*)((void**)u)[2];
 	if (ILibMemory_CanaryOK(d) && ILibMemory_CanaryOK(d->ctxd))
 	{
 		if ((d->ctxd->flags & duk_destroy_heap_in_progress) == duk_destroy_heap_in_progress)
 		{
-			if (d->abortHandler != NULL) { d->abortHandler(d->chain, d->user); }
+			// Disarm the work item before aborting, so the chain only frees it when it gets to it, instead of aborting it a second time
+			((void**)u)[1] = NULL;
+			((void**)u)[3] = NULL;
+			Duktape_RunOnEventLoop_AbortSink(d->chain, d);
 		}
 	}
 }
@@ -163,7 +167,11 @@ void Duktape_RunOnEventLoop(void *chain, uintptr_t nonce, duk_context *ctx, Dukt
 
 #ifdef WIN32
 	void *tobj = ILibChain_RunOnMicrostackThreadEx3(chain, Duktape_RunOnEventLoop_Sink, Duktape_RunOnEventLoop_AbortSink, tmp);
-	QueueUserAPC((PAPCFUNC)Duktape_RunOnEventLoop_SanityCheck, ILibChain_GetMicrostackThreadHandle(chain), (ULONG_PTR)tobj);
+	if (tobj != NULL && !ILibChain_WorkQueue_IsClosed(chain))
+	{
+		// A closed queue has already aborted (and freed) the work item, or is about to
+		QueueUserAPC((PAPCFUNC)Duktape_RunOnEventLoop_SanityCheck, ILibChain_GetMicrostackThreadHandle(chain), (ULONG_PTR)tobj);
+	}
 #else
 	ILibChain_RunOnMicrostackThreadEx3(chain, Duktape_RunOnEventLoop_Sink, Duktape_RunOnEventLoop_AbortSink, tmp);
 #endif
@@ -770,6 +778,7 @@ ILibDuktape_ContextData* ILibDuktape_GetContextData(duk_context *ctx)
 	return((ILibDuktape_ContextData*)mfuncs.udata);
 }
 
+extern void ILibDuktape_ScriptContainer_Arena_Destroy(void *arena);
 void Duktape_SafeDestroyHeap(duk_context *ctx)
 {
 	void *process = ILibDuktape_GetProcessObject(ctx);
@@ -789,6 +798,8 @@ void Duktape_SafeDestroyHeap(duk_context *ctx)
 
 	duk_require_stack(ctx, 2 * DUK_API_ENTRY_STACK);				
 	duk_destroy_heap(ctx);
+	ILibDuktape_ScriptContainer_Arena_Destroy(ctxd->arena);
+	ctxd->arena = NULL;
 
 	if (ctxd->fakechain != 0 && ctxd->chain != NULL)
 	{
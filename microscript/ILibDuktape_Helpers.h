@@ -61,6 +61,7 @@ typedef struct ILibDuktape_ContextData
 	int fakechain;
 	void *chain;
 	void *user;
+	void *arena;
 }ILibDuktape_ContextData;
 
 #define DUKTAPE_DEFAULT_MAX_EXECUTION_TIMEOUT 0
@@ -33,11 +33,11 @@ limitations under the License.
 
 #include "../microstack/ILibWebClient.h"
 #include "../microstack/ILibRemoteLogging.h"
+#include "../meshcore/zlib/zlib.h"
 
 struct ILibWebClientDataObject;
 extern int ILibWebServer_WebSocket_CreateHeader(char* header, unsigned short FLAGS, unsigned short OPCODE, int payloadLength);
 extern void ILibWebClient_ResetWCDO(struct ILibWebClientDataObject *wcdo);
-extern int ILibDeflate(char *buffer, size_t bufferLen, char *compressed, size_t *compressedLen, uint32_t *crc);
 
 #define ILibDuktape_Agent_SocketJustCreated "\xFF_Agent_SocketJustCreated"
 #define ILibDuktape_ClientRequest			"\xFF_CR"
@@ -84,7 +84,7 @@ extern int ILibDeflate(char *buffer, size_t bufferLen, char *compressed, size_t
 #define ILibDuktape_WebSocket_Client		((void*)0x01)
 #define ILibDuktape_WebSocket_Server		((void*)0x02)
 #define ILibDuktape_WebSocket_StatePtr		"\xFF_WebSocketState"
-#define ILibDuktape_WebSocket_Decompressor	"\xFF_WebSocket_Decompressor"
+#define ILibDuktape_CR_DeflateMemoryLimit	"\xFF_CR_DeflateMemoryLimit"
 #define ILibDuktape_WSENC2WS				"\xFF_WSENC2WS"
 #define ILibDuktape_WS2CR					"\xFF_WS2ClientRequest"
 #define ILibDuktape_WSDEC2WS				"\xFF_WSDEC2WS"
@@ -169,6 +169,15 @@ typedef struct ILibDuktape_WebSocket_State
 	int skipCount;
 	int nonCompressibleCount;
 	int sWBITS, cWBITS;
+	int memLevel;
+	int clientNoContextTakeover, serverNoContextTakeover;
+	int deflateTakeover;					// Non-zero if the deflate context is kept across messages
+	int inflating;							// Non-zero while receiving the fragments of a compressed message
+	int deflaterInit, inflaterInit;
+	z_stream deflater, inflater;
+	char *inflateBuffer;
+	size_t inflateBufferSize, inflateBufferLength;
+	size_t zlibMemory;						// Bytes currently allocated by the deflate/inflate contexts
 
 	uint64_t uncompressedSent, uncompressedReceived;
 	uint64_t actualSent, actualReceived;
@@ -177,6 +186,27 @@ typedef struct ILibDuktape_WebSocket_State
 	ILibDuktape_DuplexStream *decodedStream;
 }ILibDuktape_WebSocket_State;
 
+//
+// permessage-deflate (RFC 7692). When context takeover is negotiated, the deflate/inflate contexts live as long as
+// the WebSocket, so that small, repetitive messages can refer back to the ones before them. Those contexts are
+// what costs memory per socket, so their window size is chosen to fit perMessageDeflateMemoryLimit.
+//
+#define ILibDuktape_WebSocket_DefaultDeflateMemoryLimit		65536
+#define ILibDuktape_WebSocket_DeflateMemory(wbits, memLevel)	((1 << ((wbits) + 2)) + (1 << ((memLevel) + 9)) + 6144)	// See "Memory Usage" in zconf.h
+#define ILibDuktape_WebSocket_InflateMemory(wbits)				((1 << (wbits)) + 7168)
+
+// Largest window (9 - 15) for which a deflate and an inflate context both fit in memoryLimit, or 0 if none does. A memoryLimit of 0 means no limit
+int ILibDuktape_WebSocket_WindowBits(int memoryLimit)
+{
+	int wbits;
+	if (memoryLimit <= 0) { return(15); }
+	for (wbits = 15; wbits >= 9; --wbits)
+	{
+		if (ILibDuktape_WebSocket_DeflateMemory(wbits, wbits - 7) + ILibDuktape_WebSocket_InflateMemory(wbits) <= memoryLimit) { return(wbits); }
+	}
+	return(0);
+}
+
 typedef struct ILibDuktape_Http_Server
 {
 	duk_context *ctx;
@@ -328,6 +358,8 @@ void ILibDuktape_HttpStream_http_ConvertOptionToSend(duk_context *ctx, void *Obj
 	if (strcmp(protocol, "ws:") == 0 || strcmp(protocol, "wss:") == 0)
 	{
 		int permessagedeflate = Duktape_GetBooleanProperty(ctx, -1, "perMessageDeflate", 0);
+		int memoryLimit = Duktape_GetIntPropertyValue(ctx, -1, "perMessageDeflateMemoryLimit", ILibDuktape_WebSocket_DefaultDeflateMemoryLimit);
+		int wbits = ILibDuktape_WebSocket_WindowBits(memoryLimit);
 		if (duk_has_prop_string(ctx, -1, "headers"))
 		{
 			duk_get_prop_string(ctx, -1, "headers");					// [stream][Options][headers]
@@ -359,8 +391,27 @@ void ILibDuktape_HttpStream_http_ConvertOptionToSend(duk_context *ctx, void *Obj
 
 		if (permessagedeflate != 0)
 		{
-			duk_push_string(ctx, "permessage-deflate; server_no_context_takeover; client_no_context_takeover");
+			if (wbits == 0)
+			{
+				// The memory limit is too small to keep the contexts around, so ask for a fresh context per message
+				duk_push_string(ctx, "permessage-deflate; server_no_context_takeover; client_no_context_takeover");
+			}
+			else if (wbits == 15)
+			{
+				duk_push_string(ctx, "permessage-deflate; client_max_window_bits");
+			}
+			else
+			{
+				duk_push_sprintf(ctx, "permessage-deflate; client_max_window_bits=%d; server_max_window_bits=%d", wbits, wbits);
+			}
 			duk_put_prop_string(ctx, -2, "Sec-WebSocket-Extensions");
+
+			// The WebSocket is created by the upgrade event, so save the limit where it can find it
+			duk_push_int(ctx, memoryLimit);								// [stream][Options][headers][limit]
+			duk_get_prop_string(ctx, -3, ILibDuktape_Options2ClientRequest);	// [stream][Options][headers][limit][CR]
+			duk_swap_top(ctx, -2);										// [stream][Options][headers][CR][limit]
+			duk_put_prop_string(ctx, -2, ILibDuktape_CR_DeflateMemoryLimit);	// [stream][Options][headers][CR]
+			duk_pop(ctx);												// [stream][Options][headers]
 		}
 		duk_pop(ctx);													// [stream][options]
 	}
@@ -463,6 +514,8 @@ duk_ret_t ILibDuktape_HttpStream_http_onUpgrade(duk_context *ctx)
 	int permessageDeflate = 0;
 	int smwb = 15;
 	int cmwb = 15;
+	int snct = 0, cnct = 0;
+	int memoryLimit = ILibDuktape_WebSocket_DefaultDeflateMemoryLimit;
 
 	duk_get_prop_string(ctx, 0, "headers");						// [headers]
 	duk_get_prop_string(ctx, -1, "Sec-WebSocket-Accept");		// [headers][key]
@@ -478,7 +531,10 @@ duk_ret_t ILibDuktape_HttpStream_http_onUpgrade(duk_context *ctx)
 			duk_array_pop(ctx, -1);									// [headers][key][extensions][array][string]
 			duk_string_split(ctx, -1, "=");							// [headers][key][extensions][array][string][array]
 			duk_array_shift(ctx, -1);								// [headers][key][extensions][array][string][array][val1]
+			duk_trim(ctx, -1);
 			if (strcmp("permessage-deflate", duk_to_string(ctx, -1)) == 0) { permessageDeflate = 1; duk_pop_3(ctx); }
+			else if (strcmp("server_no_context_takeover", duk_to_string(ctx, -1)) == 0) { snct = 1; duk_pop_3(ctx); }
+			else if (strcmp("client_no_context_takeover", duk_to_string(ctx, -1)) == 0) { cnct = 1; duk_pop_3(ctx); }
 			else if (strcmp("server_max_window_bits", duk_to_string(ctx, -1)) == 0)
 			{
 				if (duk_get_length(ctx, -2) > 0)
@@ -512,6 +568,15 @@ duk_ret_t ILibDuktape_HttpStream_http_onUpgrade(duk_context *ctx)
 		}
 	}
 
+	duk_push_this(ctx);															// [HTTPStream]
+	if (duk_has_prop_string(ctx, -1, ILibDuktape_HTTP2CR))
+	{
+		duk_get_prop_string(ctx, -1, ILibDuktape_HTTP2CR);						// [HTTPStream][CR]
+		memoryLimit = Duktape_GetIntPropertyValue(ctx, -1, ILibDuktape_CR_DeflateMemoryLimit, memoryLimit);
+		duk_pop(ctx);															// [HTTPStream]
+	}
+	duk_pop(ctx);																// ...
+
 	decodedKey = ILibMemory_AllocateA(keyLen);
 	decodedKeyLen = ILibBase64Decode((unsigned char*)key, (int)keyLen, (unsigned char**)&decodedKey);
 
@@ -551,6 +616,9 @@ duk_ret_t ILibDuktape_HttpStream_http_onUpgrade(duk_context *ctx)
 	duk_push_int(ctx, permessageDeflate); duk_put_prop_string(ctx, -2, "perMessageDeflate");
 	duk_push_int(ctx, smwb); duk_put_prop_string(ctx, -2, "serverMaxWindowBits");
 	duk_push_int(ctx, cmwb); duk_put_prop_string(ctx, -2, "clientMaxWindowBits");
+	duk_push_int(ctx, snct); duk_put_prop_string(ctx, -2, "serverNoContextTakeover");
+	duk_push_int(ctx, cnct); duk_put_prop_string(ctx, -2, "clientNoContextTakeover");
+	duk_push_int(ctx, memoryLimit); duk_put_prop_string(ctx, -2, "perMessageDeflateMemoryLimit");
 	duk_new(ctx, 2);															// [HTTPStream][readable][ext][websocket]
 	duk_remove(ctx, -2);														// [HTTPStream][readable][websocket]
 	if (strcmp(Duktape_GetStringPropertyValue(ctx, -3, ILibDuktape_OBJID, "http.httpStream"), "https.httpStream") == 0) 
@@ -3847,10 +3915,117 @@ duk_ret_t ILibDuktape_httpStream_parseUri(duk_context *ctx)
 }
 
 
+voidpf ILibDuktape_WebSocket_zalloc(voidpf opaque, uInt items, uInt size)
+{
+	ILibDuktape_WebSocket_State *state = (ILibDuktape_WebSocket_State*)opaque;
+	size_t len = (size_t)items * (size_t)size;
+	size_t *ret = (size_t*)malloc(len + (2 * sizeof(size_t)));	// Two words, so the allocation stays 8/16 byte aligned
+	if (ret == NULL) { return(Z_NULL); }
+	ret[0] = len;
+	state->zlibMemory += len;
+	return((voidpf)(ret + 2));
+}
+void ILibDuktape_WebSocket_zfree(voidpf opaque, voidpf address)
+{
+	ILibDuktape_WebSocket_State *state = (ILibDuktape_WebSocket_State*)opaque;
+	size_t *ptr = ((size_t*)address) - 2;
+	state->zlibMemory -= ptr[0];
+	free(ptr);
+}
+void ILibDuktape_WebSocket_DeflaterEnd(ILibDuktape_WebSocket_State *state)
+{
+	if (state->deflaterInit != 0) { ignore_result(deflateEnd(&(state->deflater))); state->deflaterInit = 0; }
+}
+void ILibDuktape_WebSocket_InflaterEnd(ILibDuktape_WebSocket_State *state)
+{
+	if (state->inflaterInit != 0) { ignore_result(inflateEnd(&(state->inflater))); state->inflaterInit = 0; }
+}
+
+// Compresses an entire message. The output is flushed with Z_SYNC_FLUSH, and the trailing 0x00 0x00 0xFF 0xFF removed, as RFC 7692 specifies.
+// Returns a buffer that must be freed with ILibMemory_Free(), or NULL on error
+char* ILibDuktape_WebSocket_Deflate(ILibDuktape_WebSocket_State *state, char *buffer, size_t bufferLen, size_t *compressedLen)
+{
+	z_stream *Z = &(state->deflater);
+	char *ret;
+	size_t len;
+
+	if (state->deflaterInit == 0)
+	{
+		memset(Z, 0, sizeof(z_stream));
+		Z->zalloc = ILibDuktape_WebSocket_zalloc;
+		Z->zfree = ILibDuktape_WebSocket_zfree;
+		Z->opaque = (voidpf)state;
+		if (deflateInit2(Z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, state->cWBITS, state->memLevel, Z_DEFAULT_STRATEGY) != Z_OK) { return(NULL); }
+		state->deflaterInit = 1;
+	}
+
+	len = (size_t)deflateBound(Z, (uLong)bufferLen) + 16;	// deflateBound() doesn't count the sync flush marker
+	ret = (char*)ILibMemory_SmartAllocate(len);
+	Z->next_in = (Bytef*)buffer;
+	Z->avail_in = (uInt)bufferLen;
+	Z->next_out = (Bytef*)ret;
+	Z->avail_out = (uInt)len;
+	if (deflate(Z, Z_SYNC_FLUSH) != Z_OK || Z->avail_in != 0 || Z->avail_out == 0)
+	{
+		ILibMemory_Free(ret);
+		ILibDuktape_WebSocket_DeflaterEnd(state);
+		return(NULL);
+	}
+	*compressedLen = len - Z->avail_out;
+	if (*compressedLen >= 4 && memcmp(ret + *compressedLen - 4, "\x00\x00\xFF\xFF", 4) == 0) { *compressedLen -= 4; }
+	if (state->deflateTakeover == 0) { ILibDuktape_WebSocket_DeflaterEnd(state); }
+	return(ret);
+}
+
+// Decompresses a fragment of a compressed message, appending to state->inflateBuffer. Returns non-zero on error
+int ILibDuktape_WebSocket_Inflate(ILibDuktape_WebSocket_State *state, char *buffer, size_t bufferLen, int fin)
+{
+	z_stream *Z = &(state->inflater);
+	int i, r = Z_OK;
+
+	if (state->inflaterInit == 0)
+	{
+		memset(Z, 0, sizeof(z_stream));
+		Z->zalloc = ILibDuktape_WebSocket_zalloc;
+		Z->zfree = ILibDuktape_WebSocket_zfree;
+		Z->opaque = (voidpf)state;
+		if (inflateInit2(Z, state->sWBITS) != Z_OK) { return(1); }
+		state->inflaterInit = 1;
+	}
+
+	for (i = 0; i < (fin != 0 ? 2 : 1); ++i)
+	{
+		// The second pass puts back the 0x00 0x00 0xFF 0xFF the sender removed
+		Z->next_in = (Bytef*)(i == 0 ? buffer : "\x00\x00\xFF\xFF");
+		Z->avail_in = (uInt)(i == 0 ? bufferLen : 4);
+
+		do
+		{
+			if (state->inflateBufferLength == state->inflateBufferSize)
+			{
+				state->inflateBufferSize = state->inflateBufferSize == 0 ? 4096 : (state->inflateBufferSize * 2);
+				if ((state->inflateBuffer = (char*)realloc(state->inflateBuffer, state->inflateBufferSize)) == NULL) { ILIBCRITICALEXIT(254); }
+			}
+			Z->next_out = (Bytef*)(state->inflateBuffer + state->inflateBufferLength);
+			Z->avail_out = (uInt)(state->inflateBufferSize - state->inflateBufferLength);
+			r = inflate(Z, Z_SYNC_FLUSH);
+			state->inflateBufferLength = state->inflateBufferSize - Z->avail_out;
+			if (r == Z_STREAM_END)
+			{
+				// The sender finished the deflate stream (BFINAL), which is only allowed without context takeover. Anything after it is just the flush marker
+				ignore_result(inflateReset(Z));
+				return(0);
+			}
+			if (r == Z_BUF_ERROR) { break; }		// Nothing left to do with this input
+			if (r != Z_OK) { return(1); }
+		} while (Z->avail_in > 0 || Z->avail_out == 0);
+	}
+	return(0);
+}
+
 ILibTransport_DoneState ILibDuktape_httpStream_webSocket_WriteWebSocketPacket(ILibDuktape_WebSocket_State *state, int opcode, char *_buffer, int _bufferLen, ILibWebClient_WebSocket_FragmentFlags _bufferFragment)
 {
 	char header[10];
-	int maskKeyInt;
 	int headerLen = 0;
 	unsigned short flags = state->noMasking == 0 ? WEBSOCKET_MASK : 0;
 
@@ -3872,27 +4047,18 @@ ILibTransport_DoneState ILibDuktape_httpStream_webSocket_WriteWebSocketPacket(IL
 		if (state->WebSocketFragmentFlag_Write == 0)
 		{
 			// This is a self contained fragment
-			if (state->permessageDeflate != 0)
+			// A deflate context that is kept across messages can only be used from the Duktape thread, because the messages
+			// have to go out in the order they were compressed. Sending a message uncompressed is always allowed.
+			if (state->permessageDeflate != 0 && (state->deflateTakeover == 0 || ILibIsRunningOnChainThread(state->chain) != 0))
 			{
 				// Compression is enabled
 				if (state->minimumThreshold < bufferLen && state->skipCount == 0)
 				{
-					if (ILibDeflate(buffer, (size_t)bufferLen, NULL, &compressedLen, NULL) == 0)
+					if ((compressedBuffer = ILibDuktape_WebSocket_Deflate(state, buffer, (size_t)bufferLen, &compressedLen)) != NULL)
 					{
 						if (compressedLen < (size_t)bufferLen)
 						{
-							compressedBuffer = (char*)ILibMemory_SmartAllocate(compressedLen);
-							if (ILibDeflate(buffer, (size_t)bufferLen, compressedBuffer, &compressedLen, NULL) == 0)
-							{
-								// Using Compresion
-								state->uncompressedSent += (uint64_t)bufferLen;
-								state->nonCompressibleCount = 0;
-								state->skipCount = 0;
-								buffer = compressedBuffer;
-								bufferLen = (int)compressedLen;
-								headerLen = ILibWebServer_WebSocket_CreateHeader(header, flags | WEBSOCKET_RSV1 | WEBSOCKET_FIN, (unsigned short)opcode, bufferLen);
-								state->uncompressedSent += (uint64_t)headerLen;
-							}
+							state->nonCompressibleCount = 0;
 						}
 						else
 						{
@@ -3903,6 +4069,21 @@ ILibTransport_DoneState ILibDuktape_httpStream_webSocket_WriteWebSocketPacket(IL
 								state->nonCompressibleCount = 0;
 							}
 						}
+
+						if (compressedLen < (size_t)bufferLen || state->deflateTakeover != 0)
+						{
+							// Using Compresion. With context takeover, the message is now part of the deflate history, so it must be sent compressed even if it didn't shrink
+							state->uncompressedSent += (uint64_t)bufferLen;
+							buffer = compressedBuffer;
+							bufferLen = (int)compressedLen;
+							headerLen = ILibWebServer_WebSocket_CreateHeader(header, flags | WEBSOCKET_RSV1 | WEBSOCKET_FIN, (unsigned short)opcode, bufferLen);
+							state->uncompressedSent += (uint64_t)headerLen;
+						}
+						else
+						{
+							ILibMemory_Free(compressedBuffer);
+							compressedBuffer = NULL;
+						}
 					}
 				}
 				else if (state->minimumThreshold < bufferLen && state->skipCount > 0)
@@ -3948,15 +4129,7 @@ ILibTransport_DoneState ILibDuktape_httpStream_webSocket_WriteWebSocketPacket(IL
 
 		// Mask the payload
 		util_random(4, maskKey);
-		maskKeyInt = ((int*)(maskKey))[0];
-		if (bufferLen > 0) 
-		{
-			int x;
-			// Note that the line below will cause a SegFault on Linux when compiled with GCC -O3, the fault happens at the XOR (^) operation.
-			// Compiling with -O2 works also, doing the masking operating byte-by-byte also works with -O3.
-			for (x = 0; x < (bufferLen >> 2); ++x) { ((int*)(dataFrame+headerLen+4))[x] = ((int*)buffer)[x] ^ (int)maskKeyInt; } // Mask 4 bytes at a time (SegFaults with -O3).
-			for (x = (x << 2); x < bufferLen; ++x) { dataFrame[x + headerLen + 4] = buffer[x] ^ maskKey[x % 4]; } // Mask the reminder
-		}
+		if (bufferLen > 0) { ILibWebClient_WebSocket_Mask(dataFrame + headerLen + 4, buffer, (size_t)bufferLen, maskKey); }
 		retVal = ILibDuktape_DuplexStream_WriteData(state->encodedStream, dataFrame, headerLen + 4 + bufferLen) == 0 ? ILibTransport_DoneState_COMPLETE : ILibTransport_DoneState_INCOMPLETE;
 	}
 	else 
@@ -4044,35 +4217,8 @@ ILibTransport_DoneState ILibDuktape_httpStream_webSocket_EncodedWriteSink_Dispat
 	}
 }
 
-duk_ret_t ILibDuktape_WebSocket_DecompressData(duk_context *ctx)
-{
-	duk_push_this(ctx);							// [self]
-	duk_push_array(ctx);						// [self][array]
-	if (duk_has_prop_string(ctx, -2, "_ddata"))
-	{
-		duk_get_prop_string(ctx, -2, "_ddata");	// [self][array][buffer]
-		duk_array_push(ctx, -2);				// [self][array]
-	}
-	duk_dup(ctx, 0);							// [self][array][buffer]
-	duk_array_push(ctx, -2);					// [self][array]
-	duk_buffer_concat(ctx);						// [self][buffer]
-	duk_put_prop_string(ctx, -2, "_ddata");		// [self]
-	return(0);
-}
-duk_ret_t ILibDuktape_WebSocket_DecompressData_End(duk_context *ctx)
-{
-	duk_push_this(ctx);							// [self]
-	ILibDuktape_WebSocket_State *state = (ILibDuktape_WebSocket_State*)Duktape_GetPointerProperty(ctx, -1, "state");
-	int reserved = Duktape_GetIntPropertyValue(ctx, -1, "reserved", 0);
-	duk_size_t bufLen;
-	char *buffer = Duktape_GetBufferPropertyEx(ctx, -1, "_ddata", &bufLen);
-	state->uncompressedReceived += (uint64_t)bufLen;
-	ILibDuktape_DuplexStream_WriteDataEx(state->decodedStream, reserved, buffer, (int)bufLen);
-	return(0);
-}
 ILibTransport_DoneState ILibDuktape_httpStream_webSocket_EncodedWriteSink(ILibDuktape_DuplexStream *stream, char *buffer, int bufferLen, void *user)
 {
-	int x;
 	int i = 2;
 	int plen;
 	unsigned short hdr;
@@ -4145,12 +4291,7 @@ ILibTransport_DoneState ILibDuktape_httpStream_webSocket_EncodedWriteSink(ILibDu
 		// Unmask the data
 		i += 4;	// Move ptr to start of data
 
-		int maskKeyInt = ((int*)(maskingKey))[0];
-		if (plen > 0)
-		{
-			for (x = 0; x < (plen >> 2); ++x) { ((int*)(buffer+i))[x] = ((int*)(buffer+i))[x] ^ (int)maskKeyInt; } // Mask 4 bytes at a time
-			for (x = (x << 2); x < plen; ++x) { buffer[x + i] = buffer[x + i] ^ maskingKey[x % 4]; } // Mask the reminder
-		}
+		if (plen > 0) { ILibWebClient_WebSocket_Mask(buffer + i, buffer + i, (size_t)plen, maskingKey); }
 	}
 
 	if (OPCODE < 0x8)
@@ -4158,63 +4299,42 @@ ILibTransport_DoneState ILibDuktape_httpStream_webSocket_EncodedWriteSink(ILibDu
 		// NON-CONTROL OP-CODE
 		// We will try to automatically re-assemble fragments, up to the max buffer size the user specified
 		if (OPCODE != 0) { state->WebSocketDataFrameType = (int)OPCODE; } // Set the DataFrame Type, so the user can query it
-		if (FIN != 0 && state->WebSocketFragmentIndex == 0) { state->actualReceived += (uint64_t)plen; }
+		state->actualReceived += (uint64_t)plen;
 
-		if (state->permessageDeflate != 0 && RSV1 != 0)
+		if (state->permessageDeflate != 0 && (RSV1 != 0 || (OPCODE == 0 && state->inflating != 0)))
 		{
-			// This is compressed
-			if (state->WebSocketFragmentIndex == 0)
+			// This is compressed. Only the first frame of a message has RSV1 set, so remember it for the continuation frames
+			state->inflating = 1;
+			if (ILibDuktape_WebSocket_Inflate(state, buffer + i, (size_t)plen, FIN) != 0)
 			{
-				duk_context *ctx = state->encodedStream->writableStream->ctx;
-				int ctx_top = duk_get_top(ctx);
-
-				duk_push_heapptr(ctx, state->encodedStream->writableStream->obj);		// [stream]
-				if (duk_has_prop_string(ctx, -1, ILibDuktape_WebSocket_Decompressor))
-				{
-					duk_get_prop_string(ctx, -1, ILibDuktape_WebSocket_Decompressor);	// [stream][decompresor]
-				}
-				else
-				{
-					duk_eval_string(ctx, "require('compressed-stream');");				// [stream][CS]
-					duk_prepare_method_call(ctx, -1, "createDecompressor");				// [stream][CS][createDecompressor][this]
-					duk_remove(ctx, -3);												// [stream][createDecompressor][this]
-					duk_push_object(ctx);												// [stream][createDecompressor][this][options]
-					duk_push_int(ctx, -15); duk_put_prop_string(ctx, -2, "WBITS");		// [stream][createDecompressor][this][options]
-					if (duk_pcall_method(ctx, 1) != 0)									// [stream][decompressor]
-					{
-						ILibDuktape_Process_UncaughtExceptionEx(ctx, "websocket inflate() error ");
-						duk_set_top(ctx, ctx_top);
-						return(ILibTransport_DoneState_ERROR);
-					}
-					duk_dup(ctx, -1);													// [stream][decompressor][dup]
-					duk_put_prop_string(ctx, -3, ILibDuktape_WebSocket_Decompressor);	// [stream][decompressor]
-					duk_push_pointer(ctx, state); duk_put_prop_string(ctx, -2, "state");
-					duk_push_int(ctx, OPCODE == WEBSOCKET_OPCODE_TEXTFRAME ? 1 : 0); duk_put_prop_string(ctx, -2, "reserved");
-					ILibDuktape_EventEmitter_AddOnEx(ctx, -1, "data", ILibDuktape_WebSocket_DecompressData);
-					ILibDuktape_EventEmitter_AddOnEx(ctx, -1, "end", ILibDuktape_WebSocket_DecompressData_End);
-				}
-				duk_prepare_method_call(ctx, -1, FIN != 0 ? "end" : "write");			// [stream][decompressor][write][this]
-				duk_push_external_buffer(ctx);											// [stream][decompressor][write][this][buffer]
-				duk_config_buffer(ctx, -1, buffer + i, (duk_size_t)plen);
-				duk_push_buffer_object(ctx, -1, 0, (duk_size_t)plen, DUK_BUFOBJ_NODEJS_BUFFER); //.[decompressor][write][this][buffer][njsbuffer]
-				duk_remove(ctx, -2);													// [stream][decompressor][write][this][buffer]
-				duk_pcall_method(ctx, 1);												// [stream][decompressor][ret]
-				if (FIN != 0)
-				{
-					duk_del_prop_string(ctx, -3, ILibDuktape_WebSocket_Decompressor);
-				}
-				duk_set_top(ctx, ctx_top);
-				
-				if (bufferLen > (i + plen))
+				char msg[] = "websocket inflate() error";
+				Duktape_Console_Log(state->ctx, state->chain, ILibDuktape_LogType_Error, msg, sizeof(msg) - 1);
+				return(ILibTransport_DoneState_ERROR);
+			}
+			if (FIN != 0)
+			{
+				state->inflating = 0;
+				state->uncompressedReceived += (uint64_t)state->inflateBufferLength;
+				ILibDuktape_DuplexStream_WriteDataEx(state->decodedStream, state->WebSocketDataFrameType == WEBSOCKET_OPCODE_TEXTFRAME ? 1 : 0, state->inflateBuffer, (int)state->inflateBufferLength);
+				state->inflateBufferLength = 0;
+				if (state->inflateBufferSize > 65536)
 				{
-					return(ILibDuktape_httpStream_webSocket_EncodedWriteSink_DispatchUnshift(stream, buffer + i + plen, bufferLen - (i + plen))); // We need at least 10 bytes to read enough of the headers
+					// Don't hold on to the buffer of an unusually large message
+					free(state->inflateBuffer);
+					state->inflateBuffer = NULL;
+					state->inflateBufferSize = 0;
 				}
+				if (state->serverNoContextTakeover != 0) { ILibDuktape_WebSocket_InflaterEnd(state); }
+			}
 
-				return(ILibTransport_DoneState_COMPLETE);
+			if (bufferLen > (i + plen))
+			{
+				return(ILibDuktape_httpStream_webSocket_EncodedWriteSink_DispatchUnshift(stream, buffer + i + plen, bufferLen - (i + plen)));
 			}
+			return(ILibTransport_DoneState_COMPLETE);
 		}
 
-
+		state->uncompressedReceived += (uint64_t)plen;
 		if (FIN != 0 && state->WebSocketFragmentIndex == 0)
 		{
 			// We have an entire fragment, and we didn't save any of it yet... We can just forward it up without copying the buffer
@@ -4477,6 +4597,10 @@ duk_ret_t ILibDuktape_httpStream_webSocketStream_finalizer(duk_context *ctx)
 {
 	duk_get_prop_string(ctx, 0, ILibDuktape_WebSocket_StatePtr);
 	ILibDuktape_WebSocket_State *state = (ILibDuktape_WebSocket_State*)Duktape_GetBuffer(ctx, -1, NULL);
+
+	ILibDuktape_WebSocket_DeflaterEnd(state);
+	ILibDuktape_WebSocket_InflaterEnd(state);
+	if (state->inflateBuffer != NULL) { free(state->inflateBuffer); state->inflateBuffer = NULL; }
 	
 	if (state->encodedStream != NULL && state->encodedStream->writableStream->pipedReadable != NULL)
 	{
@@ -4709,6 +4833,16 @@ duk_ret_t ILibDuktape_WebSocket_bytesReceived_ratio(duk_context *ctx)
 
 	return(1);
 }
+duk_ret_t ILibDuktape_WebSocket_compressionMemory(duk_context *ctx)
+{
+	ILibDuktape_WebSocket_State *ws = NULL;
+	duk_push_this(ctx);														// [WebSocket_Decoded]
+	duk_get_prop_string(ctx, -1, ILibDuktape_WSDEC2WS);						// [WebSocket_Decoded][WebSocket]
+	ws = (ILibDuktape_WebSocket_State*)Duktape_GetBufferProperty(ctx, -1, ILibDuktape_WebSocket_StatePtr);
+
+	duk_push_number(ctx, (duk_double_t)(ws->zlibMemory + ws->inflateBufferSize));
+	return(1);
+}
 duk_ret_t ILibDuktape_httpStream_webSocketStream_new(duk_context *ctx)
 {
 	int narg = duk_get_top(ctx);
@@ -4727,10 +4861,32 @@ duk_ret_t ILibDuktape_httpStream_webSocketStream_new(duk_context *ctx)
 		state->minimumThreshold = Duktape_GetIntPropertyValue(ctx, 1, "minimumThreshold", 64);
 		state->maxSkipCount = Duktape_GetIntPropertyValue(ctx, 1, "maxSkipCount", 128);
 		state->minSkipCount = Duktape_GetIntPropertyValue(ctx, 1, "minSkipCount", 10);
-		state->cWBITS = Duktape_GetIntPropertyValue(ctx, 1, "clientMaxWindowBits", 15) * (-1);
-		state->sWBITS = Duktape_GetIntPropertyValue(ctx, 1, "serverMaxWindowBits", 15) * (-1);
+		state->cWBITS = Duktape_GetIntPropertyValue(ctx, 1, "clientMaxWindowBits", 15);
+		state->sWBITS = Duktape_GetIntPropertyValue(ctx, 1, "serverMaxWindowBits", 15);
+		state->clientNoContextTakeover = Duktape_GetIntPropertyValue(ctx, 1, "clientNoContextTakeover", 1);
+		state->serverNoContextTakeover = Duktape_GetIntPropertyValue(ctx, 1, "serverNoContextTakeover", 1);
 		state->skipCount = 0;
 		state->nonCompressibleCount = 0;
+
+		if (state->permessageDeflate != 0)
+		{
+			int memoryLimit = Duktape_GetIntPropertyValue(ctx, 1, "perMessageDeflateMemoryLimit", ILibDuktape_WebSocket_DefaultDeflateMemoryLimit);
+			int wbits = ILibDuktape_WebSocket_WindowBits(memoryLimit);
+
+			// We can always use a smaller window than was negotiated for our own deflate context, but the inflate
+			// context has to match the peer. If the peer keeps its context, so must we, whatever the limit says.
+			if (state->sWBITS < 8 || state->sWBITS > 15) { state->sWBITS = 15; }
+			if (state->cWBITS < 9 || state->cWBITS > 15) { state->cWBITS = 15; }
+			if (wbits != 0 && wbits < state->cWBITS) { state->cWBITS = wbits; }
+			state->memLevel = state->cWBITS - 7;
+			state->deflateTakeover = state->clientNoContextTakeover == 0 && (memoryLimit <= 0 ||
+				ILibDuktape_WebSocket_DeflateMemory(state->cWBITS, state->memLevel) + (state->serverNoContextTakeover != 0 ? 0 : ILibDuktape_WebSocket_InflateMemory(state->sWBITS)) <= memoryLimit);
+			if (state->deflateTakeover == 0) { state->memLevel = 8; }		// Only lives for a single message
+
+			// zlib takes negative window bits for raw deflate
+			state->cWBITS = -state->cWBITS;
+			state->sWBITS = -state->sWBITS;
+		}
 	}
 
 	duk_push_object(ctx);														// [WebSocket][Encoded]
@@ -4763,6 +4919,7 @@ duk_ret_t ILibDuktape_httpStream_webSocketStream_new(duk_context *ctx)
 	ILibDuktape_CreateEventWithGetter(ctx, "bytesSent_actual", ILibDuktape_WebSocket_bytesSent_actual);
 	ILibDuktape_CreateEventWithGetter(ctx, "bytesSent_ratio", ILibDuktape_WebSocket_bytesSent_ratio);
 	ILibDuktape_CreateEventWithGetter(ctx, "bytesReceived_ratio", ILibDuktape_WebSocket_bytesReceived_ratio);
+	ILibDuktape_CreateEventWithGetter(ctx, "compressionMemory", ILibDuktape_WebSocket_compressionMemory);
 
 
 	ILibDuktape_CreateReadonlyProperty(ctx, "decoded");							// [WebSocket]
@@ -1217,6 +1217,7 @@ duk_ret_t ILibDuktape_Process_chdir(duk_context *ctx)
 	return(0);
 }
 
+duk_ret_t ILibDuktape_ScriptContainer_Process_memoryUsage(duk_context *ctx);
 void ILibDuktape_ScriptContainer_Process_Init(duk_context *ctx, char **argList)
 {
 	int i = 0;
@@ -1233,6 +1234,7 @@ void ILibDuktape_ScriptContainer_Process_Init(duk_context *ctx, char **argList)
 	ILibDuktape_CreateInstanceMethod(ctx, "cwd", ILibDuktape_Process_cwd, 0);
 	ILibDuktape_CreateInstanceMethod(ctx, "chdir", ILibDuktape_Process_chdir, 1);
 	ILibDuktape_CreateInstanceMethod(ctx, "setenv", ILibDuktape_Process_setenv, 2);
+	ILibDuktape_CreateInstanceMethod(ctx, "memoryUsage", ILibDuktape_ScriptContainer_Process_memoryUsage, 0);
 	ILibDuktape_CreateEventWithSetterEx(ctx, "_SemaphoreTracking", ILibDuktape_Process_SemaphoreTracking);
 	ILibDuktape_CreateEventWithGetterAndSetterEx(ctx, "coreDumpLocation", ILibDuktape_ScriptContainer_Process_coreDumpLocation_getter, ILibDuktape_ScriptContainer_Process_coreDumpLocation_setter);
 #ifndef WIN32
@@ -1561,60 +1563,348 @@ duk_context *ILibDuktape_ScriptContainer_InitializeJavaScriptEngineEx2(SCRIPT_EN
 }
 
 size_t ILibDuktape_ScriptContainer_TotalAllocations = 0;
-void *ILibDuktape_ScriptContainer_Engine_malloc(void *udata, duk_size_t size)
+
+//
+// Each Duktape heap gets its own arena. Small allocations are carved out of 64KB slabs, and recycled through
+// per size-class free lists, so the flood of small strings/objects doesn't fragment the process heap. Anything
+// larger than the largest size class goes straight to the system allocator. Blocks keep the ILibMemory layout,
+// with the ContextData pointer in the extra, so duk_ctx_context_data() works on any heap allocation.
+// Arena blocks are tagged ILibMemory_Types_OTHER, system blocks are tagged ILibMemory_Types_HEAP.
+//
+// Slabs are aligned to their size, so the slab of a block is found by masking its address. Each slab counts the
+// blocks that are handed out, and once more than a few slabs are completely free, the extra ones are given back.
+//
+#define ILibDuktape_ScriptContainer_Arena_ClassCount	15
+#define ILibDuktape_ScriptContainer_Arena_MaxClassSize	1024
+#define ILibDuktape_ScriptContainer_Arena_SlabSize		65536
+#define ILibDuktape_ScriptContainer_Arena_MaxEmptySlabs	2
+#define ILibDuktape_ScriptContainer_Arena_SlabHeader	((sizeof(ILibDuktape_ScriptContainer_Arena_Slab) + 15) & ~((size_t)15))
+#define ILibDuktape_ScriptContainer_Arena_SlabOf(raw)	((ILibDuktape_ScriptContainer_Arena_Slab*)((uintptr_t)(raw) & ~((uintptr_t)ILibDuktape_ScriptContainer_Arena_SlabSize - 1)))
+#define ILibDuktape_ScriptContainer_Arena_ClassOf(size) (ILibDuktape_ScriptContainer_Arena_ClassTable[((size) + 15) >> 4])
+
+const size_t ILibDuktape_ScriptContainer_Arena_ClassSizes[ILibDuktape_ScriptContainer_Arena_ClassCount] = { 16, 32, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512, 768, 1024 };
+unsigned char ILibDuktape_ScriptContainer_Arena_ClassTable[(ILibDuktape_ScriptContainer_Arena_MaxClassSize >> 4) + 1];
+size_t ILibDuktape_ScriptContainer_Arena_RawSizes[ILibDuktape_ScriptContainer_Arena_ClassCount];
+
+typedef struct ILibDuktape_ScriptContainer_Arena_Slab
 {
-	ILibDuktape_ScriptContainer_TotalAllocations += size;
-	void *ptr = ILibMemory_SmartAllocateEx(size, sizeof(void*));
+	struct ILibDuktape_ScriptContainer_Arena_Slab *next;
+	struct ILibDuktape_ScriptContainer_Arena_Slab *prev;
+	size_t used;									// Bytes carved out so far, including this header
+	size_t live;									// Blocks that are currently handed out
+}ILibDuktape_ScriptContainer_Arena_Slab;
+
+typedef struct ILibDuktape_ScriptContainer_Arena_FreeBlock
+{
+	struct ILibDuktape_ScriptContainer_Arena_FreeBlock *next;
+	struct ILibDuktape_ScriptContainer_Arena_FreeBlock *prev;
+	size_t sizeClass;
+}ILibDuktape_ScriptContainer_Arena_FreeBlock;
+
+typedef struct ILibDuktape_ScriptContainer_Arena
+{
+	ILibDuktape_ScriptContainer_Arena_FreeBlock *freeList[ILibDuktape_ScriptContainer_Arena_ClassCount];
+	ILibDuktape_ScriptContainer_Arena_Slab *slab;	// The first slab is the one being carved from
+	size_t slabCount;
+	size_t emptySlabs;
+
+	size_t allocated;
+	size_t peak;
+	size_t allocations;
+	uint64_t totalAllocations;
+	size_t largeAllocated;
+	size_t largeCount;
+	size_t classUsed[ILibDuktape_ScriptContainer_Arena_ClassCount];
+	size_t classFree[ILibDuktape_ScriptContainer_Arena_ClassCount];
+}ILibDuktape_ScriptContainer_Arena;
+
+void* ILibDuktape_ScriptContainer_Arena_Create()
+{
+	ILibDuktape_ScriptContainer_Arena *arena = (ILibDuktape_ScriptContainer_Arena*)ILibMemory_SmartAllocate(sizeof(ILibDuktape_ScriptContainer_Arena));
+	size_t rawSize, extraSize = sizeof(void*);
+	int i, c = 0;
+
+	if (ILibDuktape_ScriptContainer_Arena_RawSizes[0] == 0)
+	{
+		for (i = 0; i <= (ILibDuktape_ScriptContainer_Arena_MaxClassSize >> 4); ++i)
+		{
+			while (ILibDuktape_ScriptContainer_Arena_ClassSizes[c] < (size_t)(i << 4)) { ++c; }
+			ILibDuktape_ScriptContainer_Arena_ClassTable[i] = (unsigned char)c;
+		}
+		for (i = 0; i < ILibDuktape_ScriptContainer_Arena_ClassCount; ++i)
+		{
+			rawSize = ILibMemory_Init_Size(ILibDuktape_ScriptContainer_Arena_ClassSizes[i], extraSize);
+			ILibDuktape_ScriptContainer_Arena_RawSizes[i] = (rawSize + 15) & ~((size_t)15);	// Keep every block 16 byte aligned
+		}
+	}
+	return(arena);
+}
+void ILibDuktape_ScriptContainer_Arena_FreeSlab(ILibDuktape_ScriptContainer_Arena_Slab *slab)
+{
+	ILibMemory_SecureZero(slab, ILibDuktape_ScriptContainer_Arena_SlabSize);
+#ifdef WIN32
+	_aligned_free(slab);
+#else
+	free(slab);
+#endif
+}
+void ILibDuktape_ScriptContainer_Arena_Destroy(void *a)
+{
+	ILibDuktape_ScriptContainer_Arena *arena = (ILibDuktape_ScriptContainer_Arena*)a;
+	ILibDuktape_ScriptContainer_Arena_Slab *slab;
+
+	if (arena == NULL) { return; }
+	while ((slab = arena->slab) != NULL)
+	{
+		arena->slab = slab->next;
+		ILibDuktape_ScriptContainer_Arena_FreeSlab(slab);
+	}
+	ILibMemory_Free(arena);
+}
+void ILibDuktape_ScriptContainer_Arena_Unlink(ILibDuktape_ScriptContainer_Arena *arena, ILibDuktape_ScriptContainer_Arena_FreeBlock *block)
+{
+	if (block->prev != NULL) { block->prev->next = block->next; } else { arena->freeList[block->sizeClass] = block->next; }
+	if (block->next != NULL) { block->next->prev = block->prev; }
+	--arena->classFree[block->sizeClass];
+}
+
+//
+// Called when a slab that isn't being carved from has nothing handed out anymore. A few of these are kept, so a heap
+// that frees and then allocates again doesn't go back and forth to the system allocator. Past that, the slab is
+// released, after taking each of its blocks off the free lists.
+//
+void ILibDuktape_ScriptContainer_Arena_SlabEmptied(ILibDuktape_ScriptContainer_Arena *arena, ILibDuktape_ScriptContainer_Arena_Slab *slab)
+{
+	ILibDuktape_ScriptContainer_Arena_FreeBlock *block;
+	size_t offset;
+
+	if (++arena->emptySlabs <= ILibDuktape_ScriptContainer_Arena_MaxEmptySlabs) { return; }
+
+	for (offset = ILibDuktape_ScriptContainer_Arena_SlabHeader; offset < slab->used; offset += ILibDuktape_ScriptContainer_Arena_RawSizes[block->sizeClass])
+	{
+		block = (ILibDuktape_ScriptContainer_Arena_FreeBlock*)((char*)slab + offset);
+		ILibDuktape_ScriptContainer_Arena_Unlink(arena, block);
+	}
+	if (slab->prev != NULL) { slab->prev->next = slab->next; } else { arena->slab = slab->next; }
+	if (slab->next != NULL) { slab->next->prev = slab->prev; }
+	--arena->slabCount;
+	--arena->emptySlabs;
+	ILibDuktape_ScriptContainer_Arena_FreeSlab(slab);
+}
+
+//
+// Writes the primary size and the extra block of an arena block in place, without touching the payload
+//
+void ILibDuktape_ScriptContainer_Arena_SetSize(void *ptr, size_t size, void *udata)
+{
+	ILibMemory_Header *extra;
+
+	((ILibMemory_Header*)ILibMemory_RawPtr(ptr))->size = size;
+	extra = (ILibMemory_Header*)((char*)ptr + size);
+	extra->size = sizeof(void*);
+	extra->extraSize = 0;
+	extra->CANARY = ILibMemory_Canary;
+	extra->memoryType = ILibMemory_Types_OTHER;
 	((void**)ILibMemory_Extra(ptr))[0] = udata;
-	return(ptr);
 }
-void *ILibDuktape_ScriptContainer_Engine_realloc(void *udata, void *ptr, duk_size_t size)
+void *ILibDuktape_ScriptContainer_Arena_Alloc(ILibDuktape_ScriptContainer_Arena *arena, duk_size_t size, void *udata)
 {
-	size_t difference = 0;
-	if (ptr != NULL) 
-	{ 
-		if (ILibMemory_Size(ptr) > size)
+	ILibDuktape_ScriptContainer_Arena_Slab *slab;
+	void *ptr, *raw;
+	int c;
+
+	if (arena == NULL || size > ILibDuktape_ScriptContainer_Arena_MaxClassSize)
+	{
+		ptr = ILibMemory_SmartAllocateEx(size, sizeof(void*));
+		((void**)ILibMemory_Extra(ptr))[0] = udata;
+		if (arena != NULL) { arena->largeAllocated += size; ++arena->largeCount; }
+	}
+	else
+	{
+		c = ILibDuktape_ScriptContainer_Arena_ClassOf(size);
+		if ((raw = arena->freeList[c]) != NULL)
 		{
-			// Memory Shrink
-			difference = ILibMemory_Size(ptr) - size;
-			ILibDuktape_ScriptContainer_TotalAllocations -= difference;
+			ILibDuktape_ScriptContainer_Arena_Unlink(arena, (ILibDuktape_ScriptContainer_Arena_FreeBlock*)raw);
+			slab = ILibDuktape_ScriptContainer_Arena_SlabOf(raw);
+			if (slab->live++ == 0 && slab != arena->slab) { --arena->emptySlabs; }
 		}
 		else
 		{
-			difference = size - ILibMemory_Size(ptr);
-			ILibDuktape_ScriptContainer_TotalAllocations += difference;
+			if ((slab = arena->slab) == NULL || slab->used + ILibDuktape_ScriptContainer_Arena_RawSizes[c] > ILibDuktape_ScriptContainer_Arena_SlabSize)
+			{
+#ifdef WIN32
+				if ((slab = (ILibDuktape_ScriptContainer_Arena_Slab*)_aligned_malloc(ILibDuktape_ScriptContainer_Arena_SlabSize, ILibDuktape_ScriptContainer_Arena_SlabSize)) == NULL) { ILIBCRITICALEXIT(254); }
+#else
+				if (posix_memalign((void**)&slab, ILibDuktape_ScriptContainer_Arena_SlabSize, ILibDuktape_ScriptContainer_Arena_SlabSize) != 0) { ILIBCRITICALEXIT(254); }
+#endif
+				slab->prev = NULL;
+				slab->next = arena->slab;
+				slab->used = ILibDuktape_ScriptContainer_Arena_SlabHeader;
+				slab->live = 0;
+				arena->slab = slab;
+				++arena->slabCount;
+				if (slab->next != NULL)
+				{
+					// The previous slab isn't carved from anymore, so if nothing in it is in use, it is now an empty slab
+					slab->next->prev = slab;
+					if (slab->next->live == 0) { ILibDuktape_ScriptContainer_Arena_SlabEmptied(arena, slab->next); }
+				}
+			}
+			raw = (char*)slab + slab->used;
+			slab->used += ILibDuktape_ScriptContainer_Arena_RawSizes[c];
+			++slab->live;
 		}
-		//if (size == 0)
-		//{
-		//	ILibMemory_Free(ptr);
-		//	ptr = NULL;
-		//}
-		//else
+		ptr = ILibMemory_Init(raw, size, sizeof(void*), ILibMemory_Types_OTHER);
+		((void**)ILibMemory_Extra(ptr))[0] = udata;
+		++arena->classUsed[c];
+	}
+
+	if (arena != NULL)
+	{
+		arena->allocated += size;
+		if (arena->allocated > arena->peak) { arena->peak = arena->allocated; }
+		++arena->allocations;
+		++arena->totalAllocations;
+	}
+	ILibDuktape_ScriptContainer_TotalAllocations += size;
+	return(ptr);
+}
+void ILibDuktape_ScriptContainer_Arena_Release(ILibDuktape_ScriptContainer_Arena *arena, void *ptr, int shuttingDown)
+{
+	size_t sz = ILibMemory_Size(ptr);
+	ILibDuktape_ScriptContainer_Arena_FreeBlock *block;
+	ILibDuktape_ScriptContainer_Arena_Slab *slab;
+	int c;
+
+	ILibDuktape_ScriptContainer_TotalAllocations -= sz;
+	if (arena != NULL)
+	{
+		arena->allocated -= sz;
+		--arena->allocations;
+	}
+
+	if (ILibMemory_MemType(ptr) == ILibMemory_Types_OTHER)
+	{
+		c = ILibDuktape_ScriptContainer_Arena_ClassOf(sz);
+		--arena->classUsed[c];
+		if (shuttingDown) { return; }	// The slabs are zeroed and released all at once, after the heap is gone
+
+		// Zero the whole block, not just the current size, in case it was bigger before it was resized in place
+		block = (ILibDuktape_ScriptContainer_Arena_FreeBlock*)ILibMemory_RawPtr(ptr);
+		ILibMemory_SecureZero(block, ILibDuktape_ScriptContainer_Arena_RawSizes[c]);
+		block->sizeClass = (size_t)c;
+		block->prev = NULL;
+		if ((block->next = arena->freeList[c]) != NULL) { block->next->prev = block; }
+		arena->freeList[c] = block;
+		++arena->classFree[c];
+
+		slab = ILibDuktape_ScriptContainer_Arena_SlabOf(block);
+		if (--slab->live == 0 && slab != arena->slab) { ILibDuktape_ScriptContainer_Arena_SlabEmptied(arena, slab); }
+	}
+	else
+	{
+		if (arena != NULL) { arena->largeAllocated -= sz; --arena->largeCount; }
+		ILibMemory_SecureZero(ptr, sz);
+		ILibMemory_Free(ptr);
+	}
+}
+
+duk_ret_t ILibDuktape_ScriptContainer_Process_memoryUsage(duk_context *ctx)
+{
+	ILibDuktape_ContextData *ctxd = duk_ctx_context_data(ctx);
+	ILibDuktape_ScriptContainer_Arena *arena = ctxd == NULL ? NULL : (ILibDuktape_ScriptContainer_Arena*)ctxd->arena;
+	size_t freeBytes = 0;
+	int i;
+
+	if (arena == NULL) { return(ILibDuktape_Error(ctx, "memoryUsage(): Arena not available")); }
+	for (i = 0; i < ILibDuktape_ScriptContainer_Arena_ClassCount; ++i) { freeBytes += (arena->classFree[i] * ILibDuktape_ScriptContainer_Arena_ClassSizes[i]); }
+
+	duk_push_object(ctx);																							// [usage]
+	duk_push_number(ctx, (duk_double_t)(arena->slabCount * ILibDuktape_ScriptContainer_Arena_SlabSize + arena->largeAllocated));
+	duk_put_prop_string(ctx, -2, "heapTotal");
+	duk_push_number(ctx, (duk_double_t)arena->allocated);		duk_put_prop_string(ctx, -2, "heapUsed");
+	duk_push_number(ctx, (duk_double_t)arena->peak);			duk_put_prop_string(ctx, -2, "heapPeak");
+	duk_push_number(ctx, (duk_double_t)arena->allocations);		duk_put_prop_string(ctx, -2, "allocations");
+	duk_push_number(ctx, (duk_double_t)arena->totalAllocations);	duk_put_prop_string(ctx, -2, "totalAllocations");
+	duk_push_number(ctx, (duk_double_t)arena->slabCount);		duk_put_prop_string(ctx, -2, "arenaSlabs");
+	duk_push_number(ctx, (duk_double_t)arena->emptySlabs);		duk_put_prop_string(ctx, -2, "arenaEmptySlabs");
+	duk_push_number(ctx, (duk_double_t)freeBytes);				duk_put_prop_string(ctx, -2, "arenaFree");
+	duk_push_number(ctx, (duk_double_t)arena->largeAllocated);	duk_put_prop_string(ctx, -2, "largeAllocated");
+	duk_push_number(ctx, (duk_double_t)arena->largeCount);		duk_put_prop_string(ctx, -2, "largeCount");
+
+	duk_push_array(ctx);																							// [usage][classes]
+	for (i = 0; i < ILibDuktape_ScriptContainer_Arena_ClassCount; ++i)
+	{
+		duk_push_object(ctx);																						// [usage][classes][class]
+		duk_push_number(ctx, (duk_double_t)ILibDuktape_ScriptContainer_Arena_ClassSizes[i]);	duk_put_prop_string(ctx, -2, "size");
+		duk_push_number(ctx, (duk_double_t)arena->classUsed[i]);								duk_put_prop_string(ctx, -2, "used");
+		duk_push_number(ctx, (duk_double_t)arena->classFree[i]);								duk_put_prop_string(ctx, -2, "free");
+		duk_put_prop_index(ctx, -2, (duk_uarridx_t)i);																// [usage][classes]
+	}
+	duk_put_prop_string(ctx, -2, "sizeClasses");																	// [usage]
+	return(1);
+}
+
+void *ILibDuktape_ScriptContainer_Engine_malloc(void *udata, duk_size_t size)
+{
+	return(ILibDuktape_ScriptContainer_Arena_Alloc((ILibDuktape_ScriptContainer_Arena*)((ILibDuktape_ContextData*)udata)->arena, size, udata));
+}
+void *ILibDuktape_ScriptContainer_Engine_realloc(void *udata, void *ptr, duk_size_t size)
+{
+	ILibDuktape_ScriptContainer_Arena *arena = (ILibDuktape_ScriptContainer_Arena*)((ILibDuktape_ContextData*)udata)->arena;
+	void *ret;
+
+	if (ptr == NULL) { return(ILibDuktape_ScriptContainer_Arena_Alloc(arena, size, udata)); }
+
+	if (ILibMemory_MemType(ptr) == ILibMemory_Types_OTHER)
+	{
+		if (size <= ILibDuktape_ScriptContainer_Arena_MaxClassSize && ILibDuktape_ScriptContainer_Arena_ClassOf(size) == ILibDuktape_ScriptContainer_Arena_ClassOf(ILibMemory_Size(ptr)))
 		{
-			ptr = ILibMemory_SmartReAllocate(ptr, size);
+			// Still fits the same size class, so just resize in place
+			ILibDuktape_ScriptContainer_TotalAllocations += size;
+			ILibDuktape_ScriptContainer_TotalAllocations -= ILibMemory_Size(ptr);
+			arena->allocated += size;
+			arena->allocated -= ILibMemory_Size(ptr);
+			if (arena->allocated > arena->peak) { arena->peak = arena->allocated; }
+			if (size < ILibMemory_Size(ptr))
+			{
+				// Shrinking, so zero the tail that is given up, along with the old extra block
+				ILibMemory_SecureZero((char*)ptr + size, ILibMemory_Size(ptr) - size + sizeof(ILibMemory_Header) + sizeof(void*));
+			}
+			ILibDuktape_ScriptContainer_Arena_SetSize(ptr, size, udata);
+			return(ptr);
 		}
+
+		ret = ILibDuktape_ScriptContainer_Arena_Alloc(arena, size, udata);
+		memcpy_s(ret, size, ptr, size < ILibMemory_Size(ptr) ? size : ILibMemory_Size(ptr));
+		ILibDuktape_ScriptContainer_Arena_Release(arena, ptr, 0);
+		return(ret);
 	}
 	else
 	{
-		//if (size > 0)
+		if (ILibMemory_Size(ptr) > size)
 		{
-			ptr = ILibMemory_SmartAllocateEx(size, sizeof(void*));
-			((void**)ILibMemory_Extra(ptr))[0] = udata;
-			ILibDuktape_ScriptContainer_TotalAllocations += size;
+			// Memory Shrink. The tail goes back to the system allocator, so zero it first
+			ILibMemory_SecureZero((char*)ptr + size, ILibMemory_Size(ptr) - size);
+			ILibDuktape_ScriptContainer_TotalAllocations -= (ILibMemory_Size(ptr) - size);
+			if (arena != NULL) { arena->allocated -= (ILibMemory_Size(ptr) - size); arena->largeAllocated -= (ILibMemory_Size(ptr) - size); }
+		}
+		else
+		{
+			ILibDuktape_ScriptContainer_TotalAllocations += (size - ILibMemory_Size(ptr));
+			if (arena != NULL) { arena->allocated += (size - ILibMemory_Size(ptr)); arena->largeAllocated += (size - ILibMemory_Size(ptr)); }
 		}
+		if (arena != NULL && arena->allocated > arena->peak) { arena->peak = arena->allocated; }
+		return(ILibMemory_SmartReAllocate(ptr, size));
 	}
-
-	return(ptr);
 }
 void ILibDuktape_ScriptContainer_Engine_free(void *udata, void *ptr)
 {
-	size_t sz = ptr == NULL ? 0 : ILibMemory_Size(ptr);
+	ILibDuktape_ContextData *ctxd = (ILibDuktape_ContextData*)udata;
 
 	if (ptr != NULL && ILibMemory_CanaryOK(ptr))
 	{
-		ILibDuktape_ScriptContainer_TotalAllocations -= ILibMemory_Size(ptr);
-		ILibMemory_SecureZero(ptr, sz);
-		ILibMemory_Free(ptr); 
+		ILibDuktape_ScriptContainer_Arena_Release((ILibDuktape_ScriptContainer_Arena*)ctxd->arena, ptr, (ctxd->flags & duk_destroy_heap_in_progress) == duk_destroy_heap_in_progress);
 	}
 }
 void ILibDuktape_ScriptContainer_Engine_fatal(void *udata, const char *msg)
@@ -2050,6 +2340,7 @@ void ILibDuktape_ScriptContainer_OS_Push(duk_context *ctx, void *chain)
 #endif
 	ILibDuktape_CreateInstanceMethod(ctx, "hostname", ILibDuktape_ScriptContainer_OS_hostname, 0);
 	ILibDuktape_CreateInstanceMethod(ctx, "tmpdir", ILibDuktape_tmpdir, 0);
+	ILibDuktape_ModSearch_AddLazyModule(ctx, -1, "dns", "util-dns");		// Only loaded if it's used
 
 	char jsExtras[] = "exports.getPrimaryDnsSuffix = function getPrimaryDnsSuffix()\
 	{\
@@ -2552,8 +2843,7 @@ void ILibDuktape_ScriptContainer_OS_Push(duk_context *ctx, void *chain)
 				return(tmp);\
 				break;\
 		}\
-	};\
-	exports.dns = require('util-dns');";
+	};";
 
 	ILibDuktape_ModSearch_AddHandler_AlsoIncludeJS(ctx, jsExtras, sizeof(jsExtras) - 1);
 }
@@ -2573,6 +2863,7 @@ duk_context *ILibDuktape_ScriptContainer_InitializeJavaScriptEngine_minimal()
 	util_openssl_uninit();
 #endif
 	ctxd->threads = ILibLinkedList_Create();
+	ctxd->arena = ILibDuktape_ScriptContainer_Arena_Create();
 
 #ifdef DUKTAPE_EXECUTION_MAXTIMEOUT
 	ctxd->maxExecutionTime = DUKTAPE_EXECUTION_MAXTIMEOUT;
@@ -2671,11 +2962,10 @@ duk_ret_t ILibDuktape_Polyfills_promise_wait_impl(duk_context *ctx)
 	}
 	return(ret);
 }
-void ILibDuktape_Polyfills_promise_wait(duk_context *ctx)
+void ILibDuktape_Polyfills_promise_wait(duk_context *ctx, void *chain)
 {
-	duk_eval_string(ctx, "require('promise');");		// [promise]
+	// [promise]
 	ILibDuktape_CreateInstanceMethod(ctx, "wait", ILibDuktape_Polyfills_promise_wait_impl, DUK_VARARGS);
-	duk_pop(ctx);										// ...
 }
 
 duk_context *ILibDuktape_ScriptContainer_InitializeJavaScriptEngineEx3(duk_context *ctx, SCRIPT_ENGINE_SECURITY_FLAGS securityFlags, unsigned int executionTimeout, void *chain, char **argList, ILibSimpleDataStore *db, char *exePath, ILibProcessPipe_Manager pipeManager, ILibDuktape_HelperEvent exitHandler, void *exitUser)
@@ -2776,7 +3066,7 @@ duk_context *ILibDuktape_ScriptContainer_InitializeJavaScriptEngineEx3(duk_conte
 	}
 
 	ILibDuktape_Polyfills_JS_Init(ctx);
-	ILibDuktape_Polyfills_promise_wait(ctx);
+	ILibDuktape_ModSearch_AddLoadHandler(ctx, "promise", ILibDuktape_Polyfills_promise_wait);
 
 	return ctx;
 }
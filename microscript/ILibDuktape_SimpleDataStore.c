@@ -146,6 +146,20 @@ duk_ret_t ILibDuktape_SimpleDataStore_Compact(duk_context *ctx)
 	duk_push_int(ctx, ILibSimpleDataStore_Compact(dataStore));				// [ds][ptr][retVal]
 	return 1;
 }
+duk_ret_t ILibDuktape_SimpleDataStore_BeginBatch(duk_context *ctx)
+{
+	duk_push_this(ctx);														// [ds]
+	duk_get_prop_string(ctx, -1, ILibDuktape_DataStore_PTR);				// [ds][ptr]
+	ILibSimpleDataStore_BeginBatch((ILibSimpleDataStore)duk_to_pointer(ctx, -1));
+	return(0);
+}
+duk_ret_t ILibDuktape_SimpleDataStore_CommitBatch(duk_context *ctx)
+{
+	duk_push_this(ctx);														// [ds]
+	duk_get_prop_string(ctx, -1, ILibDuktape_DataStore_PTR);				// [ds][ptr]
+	duk_push_int(ctx, ILibSimpleDataStore_CommitBatch((ILibSimpleDataStore)duk_to_pointer(ctx, -1)));	// [ds][ptr][retVal]
+	return 1;
+}
 void ILibDuktape_SimpleDataStore_Keys_EnumerationSink(ILibSimpleDataStore sender, char* Key, int KeyLen, void *user)
 {
 	ILibDuktape_SimpleDataStore_Enumerator * en = (ILibDuktape_SimpleDataStore_Enumerator*)user;
@@ -243,6 +257,8 @@ duk_ret_t ILibDuktape_SimpleDataStore_Create(duk_context *ctx)
 		ILibDuktape_CreateInstanceMethodWithBooleanProperty(ctx, "compressed", 0, "Put", ILibDuktape_SimpleDataStore_Put, 2);
 		ILibDuktape_CreateInstanceMethodWithBooleanProperty(ctx, "compressed", 1, "PutCompressed", ILibDuktape_SimpleDataStore_Put, 2);
 		ILibDuktape_CreateInstanceMethod(ctx, "Compact", ILibDuktape_SimpleDataStore_Compact, 0);
+		ILibDuktape_CreateInstanceMethod(ctx, "BeginBatch", ILibDuktape_SimpleDataStore_BeginBatch, 0);
+		ILibDuktape_CreateInstanceMethod(ctx, "CommitBatch", ILibDuktape_SimpleDataStore_CommitBatch, 0);
 	}
 	ILibDuktape_CreateInstanceMethod(ctx, "Get", ILibDuktape_SimpleDataStore_Get, DUK_VARARGS);
 	ILibDuktape_CreateInstanceMethod(ctx, "GetBuffer", ILibDuktape_SimpleDataStore_GetRaw, DUK_VARARGS);
@@ -42,6 +42,10 @@ limitations under the License.
 
 #ifdef _POSIX
 #include <sys/stat.h>
+#include <fnmatch.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
 #if !defined(_NOFSWATCHER) && !defined(__APPLE__) && !defined(_FREEBSD)
 	#include <sys/inotify.h>
 #endif
@@ -67,6 +71,10 @@ limitations under the License.
 #define FS_WATCHER_2_FS				"\xFF_FSWatcher2FS"
 #define FS_PIPEMANAGER_PTR			"\xFF_FSWatcher_PipeMgrPtr"
 #define FS_NOTIFY_DISPATCH_PTR		"\xFF_FSWatcher_NotifyDispatchPtr"
+#define FS_IOPOOL_PTR				"\xFF_IOPoolPtr"
+#define FS_IOPOOL_PENDING			"\xFF_IOPoolPending"
+#define FS_SEARCH_PTR				"\xFF_SearchPtr"
+#define FS_SEARCH_PENDING			"\xFF_SearchPending"
 #define FS_CHAIN_PTR				"\xFF_FSWatcher_ChainPtr"
 #define FS_WATCH_PATH				"\xFF_FSWatcher_Path"
 #define FS_EVENT_R_DESCRIPTORS		"\xFF_FSEventReadDescriptors"
@@ -570,6 +578,790 @@ duk_ret_t ILibDuktape_fs_write_writeset_sink(duk_context *ctx)
 	}
 	return(0);
 }
+#ifndef WIN32
+//
+// Regular files never report EAGAIN, so read/write/open/stat/readdir on them would block the chain.
+// These are run on a small pool of I/O worker threads instead, and the callbacks are dispatched on the chain.
+//
+#ifndef ILibDuktape_fs_IOPool_MaxThreads
+#define ILibDuktape_fs_IOPool_MaxThreads	4
+#endif
+
+typedef enum ILibDuktape_fs_IOType
+{
+	ILibDuktape_fs_IOType_OPEN = 0,
+	ILibDuktape_fs_IOType_READ = 1,
+	ILibDuktape_fs_IOType_WRITE = 2,
+	ILibDuktape_fs_IOType_STAT = 3,
+	ILibDuktape_fs_IOType_READDIR = 4
+}ILibDuktape_fs_IOType;
+
+typedef struct ILibDuktape_fs_IOPool
+{
+	void *chain;
+	ILibQueue work;
+	sem_t workAvailable;
+	sem_t workerExited;
+	int threadCount;
+	int idleCount;
+	int abort;
+	int busyFd[ILibDuktape_fs_IOPool_MaxThreads];		// Descriptors with a read or write in progress, or -1
+}ILibDuktape_fs_IOPool;
+
+typedef struct ILibDuktape_fs_IORequest
+{
+	duk_context *ctx;
+	uintptr_t ctxnonce;
+	void *fsObject;
+	ILibDuktape_fs_IOType type;
+	int fd;
+	int flags;
+	int mode;
+	char *buffer;
+	size_t length;
+	off_t position;
+	ssize_t result;
+	int err;
+	struct stat stats;
+	char *entries;
+	size_t entriesLen;
+	char *path;
+}ILibDuktape_fs_IORequest;
+
+void ILibDuktape_fs_PushStat(duk_context *ctx, struct stat *result);
+
+void ILibDuktape_fs_IORequest_Free(ILibDuktape_fs_IORequest *req)
+{
+	if (req->entries != NULL) { free(req->entries); }
+	ILibMemory_Free(req);
+}
+void ILibDuktape_fs_IORequest_ReadDir(ILibDuktape_fs_IORequest *req)
+{
+	struct dirent *dir;
+	size_t len, allocated = 0;
+	DIR *d = opendir(req->path);
+
+	if (d == NULL) { req->result = -1; return; }
+	while ((dir = readdir(d)) != NULL)
+	{
+		if (strcmp(dir->d_name, ".") == 0 || strcmp(dir->d_name, "..") == 0) { continue; }
+		len = strnlen_s(dir->d_name, sizeof(dir->d_name)) + 1;
+		if (req->entriesLen + len > allocated)
+		{
+			allocated = (allocated == 0 ? 4096 : allocated * 2) + len;
+			if ((req->entries = (char*)realloc(req->entries, allocated)) == NULL) { ILIBCRITICALEXIT(254); }
+		}
+		memcpy_s(req->entries + req->entriesLen, allocated - req->entriesLen, dir->d_name, len);
+		req->entriesLen += len;
+	}
+	closedir(d);
+	req->result = 0;
+}
+void ILibDuktape_fs_IORequest_Execute(ILibDuktape_fs_IORequest *req)
+{
+	ssize_t bytes;
+
+	errno = 0;
+	switch (req->type)
+	{
+		case ILibDuktape_fs_IOType_OPEN:
+			req->result = open(req->path, req->flags, req->mode);
+			break;
+		case ILibDuktape_fs_IOType_READ:
+			// Seek, rather than pread(), so the file offset moves past what was read, as it does on the chain
+			if (req->position >= 0 && lseek(req->fd, req->position, SEEK_SET) < 0) { req->result = -1; break; }
+			do
+			{
+				req->result = read(req->fd, req->buffer, req->length);
+			} while (req->result < 0 && errno == EINTR);
+			break;
+		case ILibDuktape_fs_IOType_WRITE:
+			if (req->position >= 0 && lseek(req->fd, req->position, SEEK_SET) < 0) { req->result = -1; break; }
+			req->result = 0;
+			while ((size_t)req->result < req->length)
+			{
+				bytes = write(req->fd, req->buffer + req->result, req->length - req->result);
+				if (bytes < 0 && errno == EINTR) { continue; }
+				if (bytes <= 0) { if (req->result == 0) { req->result = -1; } break; }
+				req->result += bytes;
+			}
+			break;
+		case ILibDuktape_fs_IOType_STAT:
+			req->result = stat(req->path, &(req->stats));
+			break;
+		case ILibDuktape_fs_IOType_READDIR:
+			ILibDuktape_fs_IORequest_ReadDir(req);
+			break;
+	}
+	req->err = req->result < 0 ? (errno != 0 ? errno : EIO) : 0;
+}
+void ILibDuktape_fs_IOPool_Abort(void *chain, void *user)
+{
+	UNREFERENCED_PARAMETER(chain);
+	ILibDuktape_fs_IORequest_Free((ILibDuktape_fs_IORequest*)user);
+}
+void ILibDuktape_fs_IOPool_PushError(duk_context *ctx, ILibDuktape_fs_IORequest *req, char *name)
+{
+	if (req->err == 0)
+	{
+		duk_push_null(ctx);
+	}
+	else
+	{
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "fs.%s(): %s [%s]", name, strerror(req->err), req->path);
+		duk_push_int(ctx, req->err); duk_put_prop_string(ctx, -2, "errno");
+	}
+}
+void ILibDuktape_fs_IOPool_Complete(void *chain, void *user)
+{
+	ILibDuktape_fs_IORequest *req = (ILibDuktape_fs_IORequest*)user;
+	duk_context *ctx = req->ctx;
+	char *name = NULL, *entry;
+	int nargs = 2, i = 0;
+
+	UNREFERENCED_PARAMETER(chain);
+
+	duk_push_heapptr(ctx, req->fsObject);										// [fs]
+	duk_get_prop_string(ctx, -1, FS_IOPOOL_PENDING);							// [fs][table]
+	duk_push_pointer(ctx, req);													// [fs][table][key]
+	duk_get_prop(ctx, -2);														// [fs][table][pending]
+	duk_push_pointer(ctx, req);													// [fs][table][pending][key]
+	duk_del_prop(ctx, -3);														// [fs][table][pending]
+	duk_get_prop_string(ctx, -1, "callback");									// [fs][table][pending][callback]
+	duk_dup(ctx, -4);															// [fs][table][pending][callback][this]
+
+	switch (req->type)
+	{
+		case ILibDuktape_fs_IOType_OPEN:
+			name = "open";
+			ILibDuktape_fs_IOPool_PushError(ctx, req, name);					// [fs][table][pending][callback][this][err]
+			duk_push_int(ctx, (int)req->result);								// [fs][table][pending][callback][this][err][fd]
+			break;
+		case ILibDuktape_fs_IOType_READ:
+		case ILibDuktape_fs_IOType_WRITE:
+			name = req->type == ILibDuktape_fs_IOType_READ ? "read" : "write";
+			duk_push_int(ctx, req->err);										// [fs][table][pending][callback][this][err]
+			duk_push_int(ctx, (int)req->result);								// [fs][table][pending][callback][this][err][bytes]
+			duk_get_prop_string(ctx, -5, "buffer");								// [fs][table][pending][callback][this][err][bytes][buffer]
+			duk_get_prop_string(ctx, -6, "options");							// [fs][table][pending][callback][this][err][bytes][buffer][options]
+			nargs = 4;
+			break;
+		case ILibDuktape_fs_IOType_STAT:
+			name = "stat";
+			ILibDuktape_fs_IOPool_PushError(ctx, req, name);					// [fs][table][pending][callback][this][err]
+			if (req->err == 0) { ILibDuktape_fs_PushStat(ctx, &(req->stats)); } else { duk_push_undefined(ctx); }
+			break;
+		case ILibDuktape_fs_IOType_READDIR:
+			name = "readdir";
+			ILibDuktape_fs_IOPool_PushError(ctx, req, name);					// [fs][table][pending][callback][this][err]
+			if (req->err != 0) { duk_push_undefined(ctx); break; }
+			duk_push_array(ctx);												// [fs][table][pending][callback][this][err][array]
+			for (entry = req->entries; entry != NULL && entry < req->entries + req->entriesLen; entry += (strlen(entry) + 1))
+			{
+				duk_push_string(ctx, entry);
+				duk_put_prop_index(ctx, -2, i++);
+			}
+			break;
+	}
+
+	if (duk_pcall_method(ctx, nargs) != 0)										// [fs][table][pending][ret]
+	{
+		ILibDuktape_Process_UncaughtExceptionEx(ctx, "fs.%s() Callback Error: %s ", name, duk_safe_to_string(ctx, -1));
+	}
+	duk_pop_n(ctx, 4);															// ...
+	ILibDuktape_fs_IORequest_Free(req);
+}
+//
+// Reads and writes share the file offset of their descriptor, so only one at a time runs for each descriptor, in the
+// order they were queued. Returns the first request that can run, or NULL. The queue must be locked.
+//
+ILibDuktape_fs_IORequest* ILibDuktape_fs_IOPool_Next(ILibDuktape_fs_IOPool *pool, int *slot)
+{
+	ILibDuktape_fs_IORequest *req;
+	void *node;
+	int i, busy;
+
+	*slot = -1;
+	for (node = ILibLinkedList_GetNode_Head(pool->work); node != NULL; node = ILibLinkedList_GetNextNode(node))
+	{
+		req = (ILibDuktape_fs_IORequest*)ILibLinkedList_GetDataFromNode(node);
+		if (req->type != ILibDuktape_fs_IOType_READ && req->type != ILibDuktape_fs_IOType_WRITE)
+		{
+			ILibLinkedList_Remove(node);
+			return(req);
+		}
+		for (i = 0, busy = 0; i < ILibDuktape_fs_IOPool_MaxThreads; ++i)
+		{
+			if (pool->busyFd[i] == req->fd) { busy = 1; }
+			if (pool->busyFd[i] == -1 && *slot < 0) { *slot = i; }
+		}
+		if (busy == 0 && *slot >= 0)
+		{
+			pool->busyFd[*slot] = req->fd;
+			ILibLinkedList_Remove(node);
+			return(req);
+		}
+		*slot = -1;
+	}
+	return(NULL);
+}
+void ILibDuktape_fs_IOPool_WorkerRunLoop(void *arg)
+{
+	ILibDuktape_fs_IOPool *pool = (ILibDuktape_fs_IOPool*)arg;
+	ILibDuktape_fs_IORequest *req;
+	int slot, more;
+
+	while (1)
+	{
+		sem_wait(&(pool->workAvailable));
+		ILibQueue_Lock(pool->work);
+		if (pool->abort != 0) { ILibQueue_UnLock(pool->work); break; }
+		req = ILibDuktape_fs_IOPool_Next(pool, &slot);
+		if (req != NULL) { --pool->idleCount; }
+		ILibQueue_UnLock(pool->work);
+		if (req == NULL) { continue; }	// Everything queued is waiting on a descriptor, and will be posted again when it is free
+
+		ILibDuktape_fs_IORequest_Execute(req);
+		Duktape_RunOnEventLoop(pool->chain, req->ctxnonce, req->ctx, ILibDuktape_fs_IOPool_Complete, ILibDuktape_fs_IOPool_Abort, req);
+
+		ILibQueue_Lock(pool->work);
+		++pool->idleCount;
+		if (slot >= 0) { pool->busyFd[slot] = -1; }
+		more = slot >= 0 && ILibQueue_IsEmpty(pool->work) == 0;
+		ILibQueue_UnLock(pool->work);
+		if (more != 0) { sem_post(&(pool->workAvailable)); }
+	}
+	sem_post(&(pool->workerExited));
+}
+void ILibDuktape_fs_IOPool_Destroy(ILibDuktape_fs_IOPool *pool)
+{
+	ILibDuktape_fs_IORequest *req;
+	int i;
+
+	// Workers finish the request they are on, and anything not yet started is dropped
+	ILibQueue_Lock(pool->work);
+	pool->abort = 1;
+	ILibQueue_UnLock(pool->work);
+	for (i = 0; i < pool->threadCount; ++i) { sem_post(&(pool->workAvailable)); }
+	for (i = 0; i < pool->threadCount; ++i) { sem_wait(&(pool->workerExited)); }
+
+	while ((req = (ILibDuktape_fs_IORequest*)ILibQueue_DeQueue(pool->work)) != NULL) { ILibDuktape_fs_IORequest_Free(req); }
+	ILibQueue_Destroy(pool->work);
+	sem_destroy(&(pool->workAvailable));
+	sem_destroy(&(pool->workerExited));
+	ILibMemory_Free(pool);
+}
+
+//
+// Allocates a request, copying path, because ILibDuktape_fs_fixLinuxPath() returns a shared buffer
+//
+ILibDuktape_fs_IORequest* ILibDuktape_fs_IORequest_New(duk_context *ctx, ILibDuktape_fs_IOType type, char *path)
+{
+	size_t pathLen = path == NULL ? 0 : strnlen_s(path, sizeof(ILibDuktape_fs_linuxPath));
+	ILibDuktape_fs_IORequest *req = (ILibDuktape_fs_IORequest*)ILibMemory_SmartAllocateEx(sizeof(ILibDuktape_fs_IORequest), pathLen + 1);
+	if (req == NULL) { ILIBCRITICALEXIT(254); }
+
+	req->ctx = ctx;
+	req->ctxnonce = duk_ctx_nonce(ctx);
+	req->type = type;
+	req->position = -1;
+	req->path = (char*)ILibMemory_Extra(req);
+	if (pathLen > 0) { memcpy_s(req->path, ILibMemory_ExtraSize(req), path, pathLen); }
+	return(req);
+}
+
+//
+// Queues req on the I/O pool. The [pending] object on top of the stack must hold 'callback', and is kept
+// alive (along with anything else it references, such as the Buffer being read into) until req completes.
+//
+void ILibDuktape_fs_IOPool_Dispatch(duk_context *ctx, ILibDuktape_fs_IORequest *req)
+{
+	ILibDuktape_fs_IOPool *pool;
+	int spawn;
+																				// [pending]
+	duk_push_this(ctx);															// [pending][fs]
+	req->fsObject = duk_get_heapptr(ctx, -1);
+	if ((pool = (ILibDuktape_fs_IOPool*)Duktape_GetPointerProperty(ctx, -1, FS_IOPOOL_PTR)) == NULL)
+	{
+		pool = (ILibDuktape_fs_IOPool*)ILibMemory_SmartAllocate(sizeof(ILibDuktape_fs_IOPool));
+		pool->chain = duk_ctx_chain(ctx);
+		pool->work = ILibQueue_Create();
+		memset(pool->busyFd, 0xFF, sizeof(pool->busyFd));
+		sem_init(&(pool->workAvailable), 0, 0);
+		sem_init(&(pool->workerExited), 0, 0);
+		duk_push_pointer(ctx, pool); duk_put_prop_string(ctx, -2, FS_IOPOOL_PTR);
+	}
+	duk_get_prop_string(ctx, -1, FS_IOPOOL_PENDING);							// [pending][fs][table]
+	duk_push_pointer(ctx, req);													// [pending][fs][table][key]
+	duk_dup(ctx, -4);															// [pending][fs][table][key][pending]
+	duk_put_prop(ctx, -3);														// [pending][fs][table]
+	duk_pop_3(ctx);																// ...
+
+	ILibQueue_Lock(pool->work);
+	ILibQueue_EnQueue(pool->work, req);
+	spawn = ILibQueue_GetCount(pool->work) > pool->idleCount && pool->threadCount < ILibDuktape_fs_IOPool_MaxThreads;
+	if (spawn != 0) { ++pool->threadCount; ++pool->idleCount; }
+	ILibQueue_UnLock(pool->work);
+
+	if (spawn != 0) { ILibSpawnNormalThread(ILibDuktape_fs_IOPool_WorkerRunLoop, pool); }
+	sem_post(&(pool->workAvailable));
+}
+int ILibDuktape_fs_IOPool_IsBlockingFD(int fd)
+{
+	struct stat result;
+	return(fstat(fd, &result) == 0 && (S_ISREG(result.st_mode) || S_ISBLK(result.st_mode)));
+}
+int ILibDuktape_fs_openFlags(char *flags)
+{
+	int retVal;
+	switch (flags[0])
+	{
+		case 'r':
+			retVal = strchr(flags, '+') != NULL ? O_RDWR : O_RDONLY;
+			break;
+		case 'w':
+			retVal = (strchr(flags, '+') != NULL ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC;
+			break;
+		case 'a':
+			retVal = (strchr(flags, '+') != NULL ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND;
+			break;
+		default:
+			return(-1);
+	}
+	if (strchr(flags, 'x') != NULL) { retVal |= O_EXCL; }
+	return(retVal);
+}
+duk_ret_t ILibDuktape_fs_open(duk_context *ctx)
+{
+	int nargs = duk_get_top(ctx);
+	char *path = ILibDuktape_fs_fixLinuxPath((char*)duk_require_string(ctx, 0));
+	int flags, mode = 0666;
+	ILibDuktape_fs_IORequest *req;
+
+	if (nargs < 3 || !duk_is_function(ctx, nargs - 1)) { return(ILibDuktape_Error(ctx, "fs.open(): Invalid Parameters")); }
+	if (path == NULL) { return(ILibDuktape_Error(ctx, "fs.open(): Path too long")); }
+	if (duk_is_string(ctx, 1))
+	{
+		if ((flags = ILibDuktape_fs_openFlags((char*)duk_get_string(ctx, 1))) < 0) { return(ILibDuktape_Error(ctx, "fs.open(): Invalid flags '%s'", duk_get_string(ctx, 1))); }
+	}
+	else
+	{
+		flags = duk_require_int(ctx, 1);
+	}
+	if (nargs > 3 && duk_is_number(ctx, 2)) { mode = duk_require_int(ctx, 2); }
+
+	req = ILibDuktape_fs_IORequest_New(ctx, ILibDuktape_fs_IOType_OPEN, path);
+	req->flags = flags;
+	req->mode = mode;
+	duk_push_object(ctx);																// [pending]
+	duk_dup(ctx, nargs - 1); duk_put_prop_string(ctx, -2, "callback");					// [pending]
+	ILibDuktape_fs_IOPool_Dispatch(ctx, req);
+	return(0);
+}
+duk_ret_t ILibDuktape_fs_stat(duk_context *ctx)
+{
+	char *path = ILibDuktape_fs_fixLinuxPath((char*)duk_require_string(ctx, 0));
+	ILibDuktape_fs_IORequest *req;
+
+	if (!duk_is_function(ctx, 1)) { return(ILibDuktape_Error(ctx, "fs.stat(): Invalid Parameters")); }
+	if (path == NULL) { return(ILibDuktape_Error(ctx, "fs.stat(): Path too long")); }
+
+	req = ILibDuktape_fs_IORequest_New(ctx, ILibDuktape_fs_IOType_STAT, path);
+	duk_push_object(ctx);																// [pending]
+	duk_dup(ctx, 1); duk_put_prop_string(ctx, -2, "callback");							// [pending]
+	ILibDuktape_fs_IOPool_Dispatch(ctx, req);
+	return(0);
+}
+duk_ret_t ILibDuktape_fs_readdir(duk_context *ctx)
+{
+	int nargs = duk_get_top(ctx);
+	char *path = ILibDuktape_fs_fixLinuxPath((char*)duk_require_string(ctx, 0));
+	ILibDuktape_fs_IORequest *req;
+
+	if (nargs < 2 || !duk_is_function(ctx, nargs - 1)) { return(ILibDuktape_Error(ctx, "fs.readdir(): Invalid Parameters")); }
+	if (path == NULL) { return(ILibDuktape_Error(ctx, "fs.readdir(): Path too long")); }
+
+	req = ILibDuktape_fs_IORequest_New(ctx, ILibDuktape_fs_IOType_READDIR, path);
+	duk_push_object(ctx);																// [pending]
+	duk_dup(ctx, nargs - 1); duk_put_prop_string(ctx, -2, "callback");					// [pending]
+	ILibDuktape_fs_IOPool_Dispatch(ctx, req);
+	return(0);
+}
+#endif
+#ifdef _POSIX
+//
+// Native recursive file search, used by file-search.js. Directories are walked by a small pool of threads, and
+// matching regular files and directories are sent to the chain in batches, where they are emitted as 'result' events.
+//
+#ifndef ILibDuktape_fs_search_MaxThreads
+#define ILibDuktape_fs_search_MaxThreads	4
+#endif
+#define ILibDuktape_fs_search_BatchSize		16384
+#define ILibDuktape_fs_search_BatchInterval	100
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+typedef struct ILibDuktape_fs_searchData
+{
+	duk_context *ctx;
+	uintptr_t ctxnonce;
+	void *chain;
+	void *object;
+	void *fsObject;
+	ILibQueue dirs;
+	sem_t workAvailable;
+	sem_t workerExited;
+	int threadsStarted;
+	int threadCount;
+	int activeCount;
+	int stop;
+	int cancelled;
+	int directories;
+	uint32_t limit;
+	uint32_t results;
+	char *patterns;
+	size_t patternsLen;
+}ILibDuktape_fs_searchData;
+
+typedef struct ILibDuktape_fs_search_batch
+{
+	ILibDuktape_fs_searchData *search;
+	long long created;
+	int end;
+	size_t len;
+	char *buffer;
+}ILibDuktape_fs_search_batch;
+
+#if defined(__linux__)
+typedef struct ILibDuktape_fs_search_dirent64
+{
+	uint64_t d_ino;
+	int64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[];
+}ILibDuktape_fs_search_dirent64;
+#endif
+
+ILibDuktape_fs_search_batch* ILibDuktape_fs_search_batch_New(ILibDuktape_fs_searchData *search, int end)
+{
+	size_t bufferSize = end != 0 ? 0 : (ILibDuktape_fs_search_BatchSize + PATH_MAX);
+	ILibDuktape_fs_search_batch *batch = (ILibDuktape_fs_search_batch*)ILibMemory_SmartAllocateEx(sizeof(ILibDuktape_fs_search_batch), bufferSize);
+	if (batch == NULL) { ILIBCRITICALEXIT(254); }
+	batch->search = search;
+	batch->created = ILibGetUptime();
+	batch->end = end;
+	batch->buffer = (char*)ILibMemory_Extra(batch);
+	return(batch);
+}
+void ILibDuktape_fs_search_batch_Abort(void *chain, void *user)
+{
+	UNREFERENCED_PARAMETER(chain);
+	ILibMemory_Free(user);
+}
+void ILibDuktape_fs_search_batch_Sink(void *chain, void *user)
+{
+	ILibDuktape_fs_search_batch *batch = (ILibDuktape_fs_search_batch*)user;
+	ILibDuktape_fs_searchData *search = batch->search;
+	duk_context *ctx = search->ctx;
+	char *entry;
+
+	UNREFERENCED_PARAMETER(chain);
+
+	for (entry = batch->buffer; search->cancelled == 0 && entry < batch->buffer + batch->len; entry += (strlen(entry) + 1))
+	{
+		ILibDuktape_EventEmitter_SetupEmit(ctx, search->object, "result");		// [emit][this][result]
+		duk_push_string(ctx, entry);												// [emit][this][result][path]
+		if (duk_pcall_method(ctx, 2) != 0) { ILibDuktape_Process_UncaughtExceptionEx(ctx, "fs.search.onResult(): "); }
+		duk_pop(ctx);																// ...
+	}
+	if (batch->end != 0)
+	{
+		ILibDuktape_EventEmitter_SetupEmit(ctx, search->object, "end");			// [emit][this][end]
+		if (duk_pcall_method(ctx, 1) != 0) { ILibDuktape_Process_UncaughtExceptionEx(ctx, "fs.search.onEnd(): "); }
+		duk_pop(ctx);																// ...
+
+		// The search object can be collected now
+		duk_push_heapptr(ctx, search->fsObject);									// [fs]
+		duk_get_prop_string(ctx, -1, FS_SEARCH_PENDING);							// [fs][table]
+		duk_push_pointer(ctx, search);												// [fs][table][key]
+		duk_del_prop(ctx, -2);
+		duk_pop_2(ctx);																// ...
+	}
+	ILibMemory_Free(batch);
+}
+void ILibDuktape_fs_search_Flush(ILibDuktape_fs_searchData *search, ILibDuktape_fs_search_batch **batch)
+{
+	if (*batch == NULL || (*batch)->len == 0) { return; }
+	Duktape_RunOnEventLoop(search->chain, search->ctxnonce, search->ctx, ILibDuktape_fs_search_batch_Sink, ILibDuktape_fs_search_batch_Abort, *batch);
+	*batch = NULL;
+}
+void ILibDuktape_fs_search_Stop(ILibDuktape_fs_searchData *search)
+{
+	int i;
+	ILibQueue_Lock(search->dirs);
+	search->stop = 1;
+	ILibQueue_UnLock(search->dirs);
+	for (i = 0; i < search->threadsStarted; ++i) { sem_post(&(search->workAvailable)); }
+}
+int ILibDuktape_fs_search_Match(ILibDuktape_fs_searchData *search, char *name)
+{
+	char *pattern;
+	for (pattern = search->patterns; pattern < search->patterns + search->patternsLen; pattern += (strlen(pattern) + 1))
+	{
+		if (fnmatch(pattern, name, 0) == 0) { return(1); }
+	}
+	return(0);
+}
+void ILibDuktape_fs_search_Result(ILibDuktape_fs_searchData *search, char *path, size_t pathLen, char *name, size_t nameLen, ILibDuktape_fs_search_batch **batch)
+{
+	int limitReached = 0;
+
+	ILibQueue_Lock(search->dirs);
+	if (search->limit > 0 && search->results >= search->limit) { ILibQueue_UnLock(search->dirs); return; }
+	limitReached = (search->limit > 0 && ++search->results == search->limit);
+	ILibQueue_UnLock(search->dirs);
+
+	if (*batch == NULL) { *batch = ILibDuktape_fs_search_batch_New(search, 0); }
+	memcpy_s((*batch)->buffer + (*batch)->len, ILibMemory_ExtraSize(*batch) - (*batch)->len, path, pathLen);
+	(*batch)->buffer[(*batch)->len + pathLen] = '/';
+	memcpy_s((*batch)->buffer + (*batch)->len + pathLen + 1, nameLen + 1, name, nameLen + 1);
+	(*batch)->len += (pathLen + nameLen + 2);
+	if ((*batch)->len >= ILibDuktape_fs_search_BatchSize) { ILibDuktape_fs_search_Flush(search, batch); }
+	if (limitReached != 0) { ILibDuktape_fs_search_Stop(search); }
+}
+void ILibDuktape_fs_search_Entry(ILibDuktape_fs_searchData *search, int dirfd, char *path, size_t pathLen, char *name, unsigned char type, ILibDuktape_fs_search_batch **batch)
+{
+	struct stat result;
+	size_t nameLen;
+	char *child;
+
+	if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) { return; }
+	if (type == DT_UNKNOWN)
+	{
+		// Not every file system fills in d_type
+		if (fstatat(dirfd, name, &result, AT_SYMLINK_NOFOLLOW) != 0) { return; }
+		type = S_ISDIR(result.st_mode) ? DT_DIR : (S_ISREG(result.st_mode) ? DT_REG : DT_UNKNOWN);
+	}
+	if (type != DT_DIR && type != DT_REG) { return; }
+
+	nameLen = strlen(name);
+	if (pathLen + nameLen + 2 > PATH_MAX) { return; }
+
+	// Like 'find -name', a directory whose name matches is a result too, and is still searched
+	if ((type == DT_REG || search->directories != 0) && ILibDuktape_fs_search_Match(search, name) != 0)
+	{
+		ILibDuktape_fs_search_Result(search, path, pathLen, name, nameLen, batch);
+	}
+	if (type == DT_DIR && search->stop == 0)
+	{
+		if ((child = (char*)malloc(pathLen + nameLen + 2)) == NULL) { ILIBCRITICALEXIT(254); }
+		memcpy_s(child, pathLen + nameLen + 2, path, pathLen);
+		child[pathLen] = '/';
+		memcpy_s(child + pathLen + 1, nameLen + 1, name, nameLen + 1);
+
+		ILibQueue_Lock(search->dirs);
+		ILibQueue_EnQueue(search->dirs, child);
+		ILibQueue_UnLock(search->dirs);
+		sem_post(&(search->workAvailable));
+	}
+}
+void ILibDuktape_fs_search_Walk(ILibDuktape_fs_searchData *search, char *path, ILibDuktape_fs_search_batch **batch)
+{
+	size_t pathLen = strlen(path);
+	int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0) { return; }
+	if (pathLen > 0 && path[pathLen - 1] == '/') { --pathLen; }
+
+#if defined(__linux__)
+	ILibDuktape_fs_search_dirent64 *ent;
+	long long buffer[1024];
+	long n, pos;
+
+	while (search->stop == 0 && (n = (long)syscall(SYS_getdents64, fd, buffer, sizeof(buffer))) > 0)
+	{
+		for (pos = 0; search->stop == 0 && pos < n; pos += ent->d_reclen)
+		{
+			ent = (ILibDuktape_fs_search_dirent64*)((char*)buffer + pos);
+			ILibDuktape_fs_search_Entry(search, fd, path, pathLen, ent->d_name, ent->d_type, batch);
+		}
+	}
+	close(fd);
+#else
+	struct dirent *ent;
+	DIR *d = fdopendir(fd);
+	if (d == NULL) { close(fd); return; }
+	while (search->stop == 0 && (ent = readdir(d)) != NULL)
+	{
+		ILibDuktape_fs_search_Entry(search, fd, path, pathLen, ent->d_name, ent->d_type, batch);
+	}
+	closedir(d);
+#endif
+}
+void ILibDuktape_fs_search_WorkerRunLoop(void *arg)
+{
+	ILibDuktape_fs_searchData *search = (ILibDuktape_fs_searchData*)arg;
+	ILibDuktape_fs_search_batch *batch = NULL;
+	char *path;
+	int stop, last;
+
+	while (1)
+	{
+		sem_wait(&(search->workAvailable));
+		ILibQueue_Lock(search->dirs);
+		stop = search->stop;
+		path = stop != 0 ? NULL : (char*)ILibQueue_DeQueue(search->dirs);
+		if (path != NULL) { ++search->activeCount; }
+		ILibQueue_UnLock(search->dirs);
+		if (stop != 0) { break; }
+		if (path == NULL) { continue; }
+
+		ILibDuktape_fs_search_Walk(search, path, &batch);
+		free(path);
+
+		// The walk is complete when no directories are queued, and nobody is walking one that could add more
+		ILibQueue_Lock(search->dirs);
+		last = (--search->activeCount == 0 && ILibQueue_IsEmpty(search->dirs) != 0);
+		ILibQueue_UnLock(search->dirs);
+		if (last != 0) { ILibDuktape_fs_search_Stop(search); }
+
+		if (batch != NULL && ILibGetUptime() - batch->created >= ILibDuktape_fs_search_BatchInterval) { ILibDuktape_fs_search_Flush(search, &batch); }
+	}
+	ILibDuktape_fs_search_Flush(search, &batch);
+	if (batch != NULL) { ILibMemory_Free(batch); }
+
+	ILibQueue_Lock(search->dirs);
+	last = (--search->threadCount == 0);
+	ILibQueue_UnLock(search->dirs);
+	if (last != 0)
+	{
+		Duktape_RunOnEventLoop(search->chain, search->ctxnonce, search->ctx, ILibDuktape_fs_search_batch_Sink, ILibDuktape_fs_search_batch_Abort, ILibDuktape_fs_search_batch_New(search, 1));
+	}
+	sem_post(&(search->workerExited));
+}
+duk_ret_t ILibDuktape_fs_search_cancel(duk_context *ctx)
+{
+	duk_push_this(ctx);
+	ILibDuktape_fs_searchData *search = (ILibDuktape_fs_searchData*)Duktape_GetPointerProperty(ctx, -1, FS_SEARCH_PTR);
+	if (search != NULL && search->cancelled == 0)
+	{
+		search->cancelled = 1;
+		ILibDuktape_fs_search_Stop(search);
+	}
+	return(0);
+}
+duk_ret_t ILibDuktape_fs_search_finalizer(duk_context *ctx)
+{
+	ILibDuktape_fs_searchData *search = (ILibDuktape_fs_searchData*)Duktape_GetPointerProperty(ctx, 0, FS_SEARCH_PTR);
+	char *path;
+	int i;
+
+	if (search == NULL) { return(0); }
+	duk_del_prop_string(ctx, 0, FS_SEARCH_PTR);
+
+	search->cancelled = 1;
+	ILibDuktape_fs_search_Stop(search);
+	for (i = 0; i < search->threadsStarted; ++i) { sem_wait(&(search->workerExited)); }
+
+	while ((path = (char*)ILibQueue_DeQueue(search->dirs)) != NULL) { free(path); }
+	ILibQueue_Destroy(search->dirs);
+	sem_destroy(&(search->workAvailable));
+	sem_destroy(&(search->workerExited));
+	ILibMemory_Free(search);
+	return(0);
+}
+duk_ret_t ILibDuktape_fs_search(duk_context *ctx)
+{
+	int nargs = duk_get_top(ctx);
+	duk_size_t rootLen;
+	char *root = (char*)duk_require_lstring(ctx, 0, &rootLen);
+	char *pattern, *rootCopy;
+	size_t patternsLen = 0, len;
+	int i, patternCount = 1, threads = ILibDuktape_fs_search_MaxThreads, directories = 1;
+	uint32_t limit = 0;
+	ILibDuktape_fs_searchData *search;
+	ILibDuktape_EventEmitter *emitter;
+
+	if (rootLen == 0 || rootLen >= PATH_MAX) { return(ILibDuktape_Error(ctx, "fs.search(): Invalid root")); }
+	if (nargs > 1 && duk_is_array(ctx, 1)) { patternCount = (int)duk_get_length(ctx, 1); }
+	if (nargs > 2 && duk_is_object(ctx, 2))
+	{
+		limit = (uint32_t)Duktape_GetIntPropertyValue(ctx, 2, "limit", 0);
+		threads = Duktape_GetIntPropertyValue(ctx, 2, "threads", threads);
+		directories = Duktape_GetBooleanProperty(ctx, 2, "directories", directories);
+		if (threads < 1) { threads = 1; }
+		if (threads > ILibDuktape_fs_search_MaxThreads) { threads = ILibDuktape_fs_search_MaxThreads; }
+	}
+
+	// Criteria is a glob, or an array of globs. An entry matches if its name matches any of them
+	for (i = 0; i < patternCount; ++i)
+	{
+		if (nargs > 1 && duk_is_array(ctx, 1)) { duk_get_prop_index(ctx, 1, i); } else if (nargs > 1 && duk_is_string(ctx, 1)) { duk_dup(ctx, 1); } else { duk_push_string(ctx, "*"); }
+		patternsLen += (strlen(duk_require_string(ctx, -1)) + 1);
+		duk_pop(ctx);
+	}
+
+	search = (ILibDuktape_fs_searchData*)ILibMemory_SmartAllocateEx(sizeof(ILibDuktape_fs_searchData), patternsLen);
+	if (search == NULL) { ILIBCRITICALEXIT(254); }
+	search->patterns = (char*)ILibMemory_Extra(search);
+	for (i = 0; i < patternCount; ++i)
+	{
+		if (nargs > 1 && duk_is_array(ctx, 1)) { duk_get_prop_index(ctx, 1, i); } else if (nargs > 1 && duk_is_string(ctx, 1)) { duk_dup(ctx, 1); } else { duk_push_string(ctx, "*"); }
+		pattern = (char*)duk_get_string(ctx, -1);
+		len = strlen(pattern) + 1;
+		memcpy_s(search->patterns + search->patternsLen, ILibMemory_ExtraSize(search) - search->patternsLen, pattern, len);
+		search->patternsLen += len;
+		duk_pop(ctx);
+	}
+
+	search->ctx = ctx;
+	search->ctxnonce = duk_ctx_nonce(ctx);
+	search->chain = duk_ctx_chain(ctx);
+	search->limit = limit;
+	search->directories = directories;
+	search->dirs = ILibQueue_Create();
+	sem_init(&(search->workAvailable), 0, 0);
+	sem_init(&(search->workerExited), 0, 0);
+
+	duk_push_object(ctx);													// [search]
+	ILibDuktape_WriteID(ctx, "fs.search");
+	search->object = duk_get_heapptr(ctx, -1);
+	duk_push_pointer(ctx, search); duk_put_prop_string(ctx, -2, FS_SEARCH_PTR);
+	emitter = ILibDuktape_EventEmitter_Create(ctx);
+	ILibDuktape_EventEmitter_CreateEventEx(emitter, "result");
+	ILibDuktape_EventEmitter_CreateEventEx(emitter, "end");
+	ILibDuktape_CreateInstanceMethod(ctx, "cancel", ILibDuktape_fs_search_cancel, 0);
+	ILibDuktape_CreateFinalizer(ctx, ILibDuktape_fs_search_finalizer);
+
+	// Workers block until the root is queued, so the counts can be fixed up after they are started
+	search->threadCount = threads;
+	for (i = 0; i < threads; ++i)
+	{
+		if (ILibSpawnNormalThread(ILibDuktape_fs_search_WorkerRunLoop, search) == NULL) { break; }
+		++search->threadsStarted;
+	}
+	search->threadCount = search->threadsStarted;
+	if (search->threadsStarted == 0) { return(ILibDuktape_Error(ctx, "fs.search(): Unable to start worker")); }
+
+	// The search object is kept alive until 'end' is emitted
+	duk_push_this(ctx);														// [search][fs]
+	search->fsObject = duk_get_heapptr(ctx, -1);
+	duk_get_prop_string(ctx, -1, FS_SEARCH_PENDING);						// [search][fs][table]
+	duk_push_pointer(ctx, search);											// [search][fs][table][key]
+	duk_dup(ctx, -4);														// [search][fs][table][key][search]
+	duk_put_prop(ctx, -3);													// [search][fs][table]
+	duk_pop_2(ctx);															// [search]
+
+	if ((rootCopy = (char*)malloc(rootLen + 1)) == NULL) { ILIBCRITICALEXIT(254); }
+	memcpy_s(rootCopy, rootLen + 1, root, rootLen + 1);
+	ILibQueue_Lock(search->dirs);
+	ILibQueue_EnQueue(search->dirs, rootCopy);
+	ILibQueue_UnLock(search->dirs);
+	sem_post(&(search->workAvailable));
+	return(1);
+}
+#endif
 #ifdef WIN32
 BOOL ILibDuktape_fs_write_WindowsSink(void *chain, HANDLE h, ILibWaitHandle_ErrorStatus status, DWORD bytesWritten, void* user)
 {
@@ -650,6 +1442,21 @@ duk_ret_t ILibDuktape_fs_write(duk_context *ctx)
 #else
 	int e;
 	int fd = (int)duk_require_int(ctx, 0);
+	if (offset < 0 || length < 0 || (duk_size_t)offset + (duk_size_t)length > bufferLen) { return(ILibDuktape_Error(ctx, "fs.write(): Buffer of size: %llu bytes, but attempting to write %d bytes at offset %d", (uint64_t)bufferLen, length, offset)); }
+	if (ILibDuktape_fs_IOPool_IsBlockingFD(fd))
+	{
+		ILibDuktape_fs_IORequest *req = ILibDuktape_fs_IORequest_New(ctx, ILibDuktape_fs_IOType_WRITE, NULL);
+		req->fd = fd;
+		req->buffer = buffer + offset;
+		req->length = (size_t)length;
+		req->position = (off_t)position;
+		duk_push_object(ctx);																// [pending]
+		duk_dup(ctx, cbx); duk_put_prop_string(ctx, -2, "callback");
+		duk_dup(ctx, 1); duk_put_prop_string(ctx, -2, "buffer");
+		duk_dup(ctx, cbx + 1); duk_put_prop_string(ctx, -2, "options");
+		ILibDuktape_fs_IOPool_Dispatch(ctx, req);
+		return(0);
+	}
 	if (position >= 0)
 	{
 		if (lseek(fd, (off_t)position, SEEK_SET) < 0) { return(ILibDuktape_Error(ctx, "Unable to seek to Position")); }
@@ -877,6 +1684,23 @@ duk_ret_t ILibDuktape_fs_read(duk_context *ctx)
 	duk_size_t offset = (duk_size_t)Duktape_GetIntPropertyValue(ctx, 1, "offset", 0);
 	duk_size_t length = (duk_size_t)Duktape_GetIntPropertyValue(ctx, 1, "length", (int)bufferLen);
 	int position = Duktape_GetIntPropertyValue(ctx, 1, "position", -1);
+	if (offset + length > bufferLen) { return(ILibDuktape_Error(ctx, "fs.read(): Buffer of size: %llu bytes, but attempting to read %llu bytes at offset %llu", (uint64_t)bufferLen, (uint64_t)length, (uint64_t)offset)); }
+#ifndef WIN32
+	if (ILibDuktape_fs_IOPool_IsBlockingFD(fd))
+	{
+		ILibDuktape_fs_IORequest *req = ILibDuktape_fs_IORequest_New(ctx, ILibDuktape_fs_IOType_READ, NULL);
+		req->fd = fd;
+		req->buffer = buffer + offset;
+		req->length = length;
+		req->position = (off_t)position;
+		duk_push_object(ctx);																// [pending]
+		duk_dup(ctx, 2); duk_put_prop_string(ctx, -2, "callback");
+		duk_get_prop_string(ctx, 1, "buffer"); duk_put_prop_string(ctx, -2, "buffer");
+		duk_dup(ctx, 1); duk_put_prop_string(ctx, -2, "options");
+		ILibDuktape_fs_IOPool_Dispatch(ctx, req);
+		return(0);
+	}
+#endif
 	if (position >= 0)
 	{
 #ifdef WIN32
@@ -1274,6 +2098,14 @@ duk_ret_t ILibDuktape_fs_createReadStream(duk_context *ctx)
 }
 duk_ret_t ILibDuktape_fs_Finalizer(duk_context *ctx)
 {
+#ifndef WIN32
+	ILibDuktape_fs_IOPool *pool = (ILibDuktape_fs_IOPool*)Duktape_GetPointerProperty(ctx, 0, FS_IOPOOL_PTR);
+	if (pool != NULL)
+	{
+		ILibDuktape_fs_IOPool_Destroy(pool);
+		duk_del_prop_string(ctx, 0, FS_IOPOOL_PTR);
+	}
+#endif
 	if (duk_has_prop_string(ctx, 0, FS_PIPEMANAGER_PTR) && duk_has_prop_string(ctx, 0, FS_CHAIN_PTR))
 	{
 		duk_get_prop_string(ctx, 0, FS_PIPEMANAGER_PTR);		// [pipeMgr]
@@ -1457,32 +2289,36 @@ duk_ret_t ILibDuktape_fs_statSync(duk_context *ctx)
 	memset(&result, 0, sizeof(struct stat));
 	if (stat(path, &result) != 0) { return(ILibDuktape_Error(ctx, "fs.statSync(): Path Error [%s]", path)); }
 
+	ILibDuktape_fs_PushStat(ctx, &result);
+	return 1;
+#endif
+}
+#ifndef WIN32
+void ILibDuktape_fs_PushStat(duk_context *ctx, struct stat *result)
+{
 	duk_push_object(ctx);
-	duk_push_number(ctx, result.st_size);
+	duk_push_number(ctx, result->st_size);
 	duk_put_prop_string(ctx, -2, "size");
 
-	duk_push_string(ctx, ILibDuktape_fs_convertTime(result.st_ctime, ILibScratchPad, sizeof(ILibScratchPad)));
+	duk_push_string(ctx, ILibDuktape_fs_convertTime(result->st_ctime, ILibScratchPad, sizeof(ILibScratchPad)));
 	duk_put_prop_string(ctx, -2, "ctime");
 
-	duk_push_string(ctx, ILibDuktape_fs_convertTime(result.st_mtime, ILibScratchPad, sizeof(ILibScratchPad)));
+	duk_push_string(ctx, ILibDuktape_fs_convertTime(result->st_mtime, ILibScratchPad, sizeof(ILibScratchPad)));
 	duk_put_prop_string(ctx, -2, "mtime");
 
-	duk_push_string(ctx, ILibDuktape_fs_convertTime(result.st_atime, ILibScratchPad, sizeof(ILibScratchPad)));
+	duk_push_string(ctx, ILibDuktape_fs_convertTime(result->st_atime, ILibScratchPad, sizeof(ILibScratchPad)));
 	duk_put_prop_string(ctx, -2, "atime");
 
-	duk_push_int(ctx, (int)result.st_uid); duk_put_prop_string(ctx, -2, "uid");
-	duk_push_int(ctx, (int)result.st_gid); duk_put_prop_string(ctx, -2, "gid");
+	duk_push_int(ctx, (int)result->st_uid); duk_put_prop_string(ctx, -2, "uid");
+	duk_push_int(ctx, (int)result->st_gid); duk_put_prop_string(ctx, -2, "gid");
 
-	duk_push_int(ctx, result.st_mode); 
+	duk_push_int(ctx, result->st_mode); 
 	ILibDuktape_CreateReadonlyProperty(ctx, "mode");
 
-	ILibDuktape_CreateInstanceMethodWithBooleanProperty(ctx, FS_STAT_METHOD_RETVAL, S_ISDIR(result.st_mode) || S_ISBLK(result.st_mode) ? 1 : 0, "isDirectory", ILibDuktape_fs_statSyncEx, 0);
-	ILibDuktape_CreateInstanceMethodWithBooleanProperty(ctx, FS_STAT_METHOD_RETVAL, S_ISREG(result.st_mode) ? 1 : 0, "isFile", ILibDuktape_fs_statSyncEx, 0);
-
-
-	return 1;
-#endif
+	ILibDuktape_CreateInstanceMethodWithBooleanProperty(ctx, FS_STAT_METHOD_RETVAL, S_ISDIR(result->st_mode) || S_ISBLK(result->st_mode) ? 1 : 0, "isDirectory", ILibDuktape_fs_statSyncEx, 0);
+	ILibDuktape_CreateInstanceMethodWithBooleanProperty(ctx, FS_STAT_METHOD_RETVAL, S_ISREG(result->st_mode) ? 1 : 0, "isFile", ILibDuktape_fs_statSyncEx, 0);
 }
+#endif
 #ifdef WIN32
 duk_ret_t ILibDuktape_fs_readDrivesSync_result_toString(duk_context *ctx)
 {
@@ -2339,6 +3175,10 @@ void ILibDuktape_fs_PUSH(duk_context *ctx, void *chain)
 	duk_put_prop_string(ctx, -2, FS_EVENT_R_DESCRIPTORS);
 	duk_push_object(ctx);
 	duk_put_prop_string(ctx, -2, FS_EVENT_W_DESCRIPTORS);
+	duk_push_object(ctx);
+	duk_put_prop_string(ctx, -2, FS_IOPOOL_PENDING);
+	duk_push_object(ctx);
+	duk_put_prop_string(ctx, -2, FS_SEARCH_PENDING);
 
 	ILibDuktape_CreateInstanceMethod(ctx, "closeSync", ILibDuktape_fs_closeSync, 1);
 	ILibDuktape_CreateInstanceMethod(ctx, "openSync", ILibDuktape_fs_openSync, DUK_VARARGS);
@@ -2353,6 +3193,9 @@ void ILibDuktape_fs_PUSH(duk_context *ctx, void *chain)
 #else
 	ILibDuktape_CreateInstanceMethod(ctx, "readdirSync", ILibDuktape_fs_readdirSync, DUK_VARARGS);
 	ILibDuktape_CreateInstanceMethod(ctx, "statSync", ILibDuktape_fs_statSync, 1);
+	ILibDuktape_CreateInstanceMethod(ctx, "open", ILibDuktape_fs_open, DUK_VARARGS);
+	ILibDuktape_CreateInstanceMethod(ctx, "readdir", ILibDuktape_fs_readdir, DUK_VARARGS);
+	ILibDuktape_CreateInstanceMethod(ctx, "stat", ILibDuktape_fs_stat, 2);
 #endif
 	ILibDuktape_CreateInstanceMethod(ctx, "createWriteStream", ILibDuktape_fs_createWriteStream, DUK_VARARGS);
 	ILibDuktape_CreateInstanceMethod(ctx, "createReadStream", ILibDuktape_fs_createReadStream, DUK_VARARGS);
@@ -2360,6 +3203,7 @@ void ILibDuktape_fs_PUSH(duk_context *ctx, void *chain)
 	ILibDuktape_CreateInstanceMethod(ctx, "readFileSync", ILibDuktape_fs_readFileSync, DUK_VARARGS);
 	ILibDuktape_CreateInstanceMethod(ctx, "existsSync", ILibDuktape_fs_existsSync, 1);
 #ifdef _POSIX
+	ILibDuktape_CreateInstanceMethod(ctx, "search", ILibDuktape_fs_search, DUK_VARARGS);
 	ILibDuktape_CreateInstanceMethod(ctx, "chmodSync", ILibduktape_fs_chmodSync, 2);
 	ILibDuktape_CreateInstanceMethod(ctx, "chownSync", ILibDuktape_fs_chownSync, 3);
 #endif
@@ -2465,6 +3309,21 @@ void ILibDuktape_fs_PUSH(duk_context *ctx, void *chain)
 								}\
 								return(exports._readdirSync(pathstr));\
 							};\
+							exports._immediate = function _immediate(callback, args) { setImmediate(function () { callback.apply(exports, args); }); };\
+							exports.open = function open(pathstr, flags, mode, callback)\
+							{\
+								if (typeof mode === 'function') { callback = mode; }\
+								try { this._immediate(callback, [null, this.openSync(pathstr, flags)]); } catch (e) { this._immediate(callback, [e]); }\
+							};\
+							exports.stat = function stat(pathstr, callback)\
+							{\
+								try { this._immediate(callback, [null, this.statSync(pathstr)]); } catch (e) { this._immediate(callback, [e]); }\
+							};\
+							exports.readdir = function readdir(pathstr, options, callback)\
+							{\
+								if (typeof options === 'function') { callback = options; }\
+								try { this._immediate(callback, [null, this.readdirSync(pathstr)]); } catch (e) { this._immediate(callback, [e]); }\
+							};\
 						}";
 	ILibDuktape_ModSearch_AddHandler_AlsoIncludeJS(ctx, copyFile, sizeof(copyFile) - 1);
 }
@@ -2495,6 +3354,14 @@ public:
 	*/
 	Integer openSync(path, flags[, mode]);
 	/*!
+	\brief Asynchronous file open. <b>Note:</b> On POSIX, the open is run on the I/O worker pool
+	\param path \<String\>
+	\param flags \<String\|Number\>
+	\param mode <Integer> <b>Default:</b> 0o666
+	\param callback <func> function(err, fd)
+	*/
+	void open(path, flags[, mode], callback);
+	/*!
 	\brief Synchronously read data from File Descriptor
 	\param fd <Integer>
 	\param buffer \<Buffer\> 
@@ -2522,6 +3389,12 @@ public:
 	*/
 	Array<String> readdirSync(path[, options]);
 	/*!
+	\brief Asynchronously reads the contents of a directory. <b>Note:</b> On POSIX, this is run on the I/O worker pool
+	\param path \<String\> directory to read
+	\param callback <func> function(err, files), where files excludes '.' and '..'
+	*/
+	void readdir(path[, options], callback);
+	/*!
 	\brief Returns a new WritableStream
 	\param path \<String\> 
 	\param options <Object> has the following defaults:\n
@@ -2552,6 +3425,12 @@ public:
 	*/
 	Stats statSync(path);
 	/*!
+	\brief Asynchronously gets file statistics. <b>Note:</b> On POSIX, this is run on the I/O worker pool
+	\param path \<String\>
+	\param callback <func> function(err, stats)
+	*/
+	void stat(path, callback);
+	/*!
 	\brief Synchronously fetches an Array of mounted drive letters <b>Note:</b> Windows Only
 	\return Array\<String\>
 	*/
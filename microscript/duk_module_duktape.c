@@ -196,10 +196,13 @@ static void duk__resolve_module_id(duk_context *ctx, const char *req_id, const c
 #define DUK__IDX_EXPORTS        9   /* default exports table */
 #define DUK__IDX_MODULE         10  /* module object containing module.exports, etc */
 
+duk_module_duktape_loaded_function duk_module_duktape_loaded = NULL;
+
 static duk_ret_t duk__require(duk_context *ctx) {
 	const char *str_req_id;  /* requested identifier */
 	const char *str_mod_id;  /* require.id of current module */
 	duk_int_t pcall_rc;
+	duk_double_t t_start = 0, t_search = 0;
 
 	/* NOTE: we try to minimize code size by avoiding unnecessary pops,
 	 * so the stack looks a bit cluttered in this function.  DUK__ASSERT_TOP()
@@ -320,6 +323,9 @@ static duk_ret_t duk__require(duk_context *ctx) {
 	 *  (although expected to be quite rare).
 	 */
 
+	if (duk_module_duktape_loaded != NULL) {
+		t_start = duk_get_now(ctx);
+	}
 	duk_push_string(ctx, "(function(require,exports,module){");
 
 	/* Duktape.modSearch(resolved_id, fresh_require, exports, module). */
@@ -336,6 +342,14 @@ static duk_ret_t duk__require(duk_context *ctx) {
 		goto delete_rethrow;
 	}
 
+	/* If user callback returned the wrapped module function (compiled,
+	 * or loaded from cached bytecode), skip compilation and call it.
+	 */
+	if (duk_is_function(ctx, -1)) {
+		duk_remove(ctx, -2);  /* remove the wrapper prefix */
+		goto call_wrapper;
+	}
+
 	/* If user callback did not return source code, module loading
 	 * is finished (user callback initialized exports table directly).
 	 */
@@ -372,6 +386,11 @@ static duk_ret_t duk__require(duk_context *ctx) {
 		goto delete_rethrow;
 	}
 
+ call_wrapper:
+	if (duk_module_duktape_loaded != NULL) {
+		t_search = duk_get_now(ctx);
+	}
+
 	/* Module has now evaluated to a wrapped module function.  Force its
 	 * .name to match module.name (defaults to last component of resolved
 	 * ID) so that it is shown in stack traces too.  Note that we must not
@@ -425,6 +444,14 @@ static duk_ret_t duk__require(duk_context *ctx) {
 	/* fall through */
 
  return_exports:
+	if (duk_module_duktape_loaded != NULL && t_start != 0) {
+		/* Native modules are finished in modSearch(), so all of their time is search time. */
+		duk_double_t t_end = duk_get_now(ctx);
+		if (t_search == 0) {
+			t_search = t_end;
+		}
+		duk_module_duktape_loaded(ctx, duk_get_string(ctx, DUK__IDX_RESOLVED_ID), DUK__IDX_MODULE, t_start, t_search - t_start, t_end - t_search);
+	}
 	duk_get_prop_string(ctx, DUK__IDX_MODULE, "exports");
 	duk_compact(ctx, -1);  /* compact the exports table */
 	return 1;  /* return module.exports */
@@ -9,6 +9,15 @@
  */
 #define  DUK_COMMONJS_MODULE_ID_LIMIT  256
 
+/* Optional hook, called when a module finishes loading, with the module
+ * table at 'module_idx'.  'start' is the time (duk_get_now()) the require()
+ * started, 'search' is the time spent in modSearch() and compiling, and
+ * 'exec' is the time spent running the module body (including nested
+ * requires), all in milliseconds.
+ */
+typedef void (*duk_module_duktape_loaded_function)(duk_context *ctx, const char *id, duk_idx_t module_idx, duk_double_t start, duk_double_t search, duk_double_t exec);
+extern duk_module_duktape_loaded_function duk_module_duktape_loaded;
+
 extern void duk_module_duktape_init(duk_context *ctx);
 
 #endif  /* DUK_MODULE_DUKTAPE_H_INCLUDED */
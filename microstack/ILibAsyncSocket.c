@@ -116,6 +116,8 @@ typedef struct ILibAsyncSocket_SendData
 	struct sockaddr_in6 remoteAddress;
 
 	ILibAsyncSocket_MemoryOwnership UserFree;
+	ILibAsyncSocket_OnSendVFree OnFree;		// Set on the last buffer of an ILibAsyncSocket_SendV() call
+	void *OnFreeUser;
 	struct ILibAsyncSocket_SendData *Next;
 }ILibAsyncSocket_SendData;
 
@@ -205,8 +207,20 @@ typedef struct ILibAsyncSocketModule
 	long long timeout_lastActivity;
 	int timeout_milliSeconds;
 	ILibAsyncSocket_TimeoutHandler timeout_handler;
+#ifndef WIN32
+	int readinessSocket;
+	int readinessEvents;
+	int readinessInvalid;
+#endif
 }ILibAsyncSocketModule;
 
+#ifndef WIN32
+// Flags the readiness registration as stale. This is safe from any thread, the chain thread re-registers on the next PreSelect
+#define ILibAsyncSocket_Readiness_Invalidate(module) (module)->readinessInvalid = 1
+#else
+#define ILibAsyncSocket_Readiness_Invalidate(module)
+#endif
+
 void ILibAsyncSocket_PostSelect(void* object,int slct, fd_set *readset, fd_set *writeset, fd_set *errorset);
 void ILibAsyncSocket_PreSelect(void* object,fd_set *readset, fd_set *writeset, fd_set *errorset, int* blocktime);
 const int ILibMemory_ASYNCSOCKET_CONTAINERSIZE = (const int)sizeof(ILibAsyncSocketModule);
@@ -349,6 +363,16 @@ int ILibAsyncSocket_IsUsingTls(ILibAsyncSocket_SocketModule AsyncSocketToken)
 }
 #endif
 
+//
+// Frees a pending send, and its buffer if the chain owns it
+//
+void ILibAsyncSocket_FreeSendData(ILibAsyncSocketModule *module, ILibAsyncSocket_SendData *data)
+{
+	if (data->UserFree == ILibAsyncSocket_MemoryOwnership_CHAIN && data->buffer != NULL) { free(data->buffer); }
+	if (data->OnFree != NULL) { data->OnFree(module, data->OnFreeUser); }
+	free(data);
+}
+
 //
 // An internal method called by Chain as Destroy, to cleanup AsyncSocket
 //
@@ -375,6 +399,10 @@ void ILibAsyncSocket_Destroy(void *socketModule)
 	}
 	#endif
 
+#ifndef WIN32
+	if (module->readinessSocket != -1) { ILibChain_Readiness_Remove(module->Transport.ChainLink.ParentChain, module->readinessSocket, module); }
+#endif
+
 	// Close socket if necessary
 	if (module->internalSocket != ~0)
 	{
@@ -403,8 +431,7 @@ void ILibAsyncSocket_Destroy(void *socketModule)
 	while (current != NULL)
 	{
 		temp = current->Next;
-		if (current->UserFree == 0) free(current->buffer);
-		free(current);
+		ILibAsyncSocket_FreeSendData(module, current);
 		current = temp;
 	}
 
@@ -467,6 +494,9 @@ ILibAsyncSocket_SocketModule ILibCreateAsyncSocketModuleWithMemory(void *Chain,
 	RetVal->Transport.ChainLink.PostSelectHandler = &ILibAsyncSocket_PostSelect;
 	RetVal->Transport.ChainLink.DestroyHandler = &ILibAsyncSocket_Destroy;
 	RetVal->internalSocket = (SOCKET)~0;
+#ifndef WIN32
+	RetVal->readinessSocket = -1;
+#endif
 	RetVal->OnData = OnData;
 	RetVal->OnConnect = OnConnect;
 	RetVal->OnDisconnect = OnDisconnect;
@@ -499,8 +529,7 @@ void ILibAsyncSocket_ClearPendingSend(ILibAsyncSocket_SocketModule socketModule)
 	{
 		temp = data->Next;
 		// We only need to free this if we have ownership of this memory
-		if (data->UserFree == ILibAsyncSocket_MemoryOwnership_CHAIN) free(data->buffer);
-		free(data);
+		ILibAsyncSocket_FreeSendData(module, data);
 		data = temp;
 	}
 }
@@ -789,6 +818,193 @@ ILibAsyncSocket_SendStatus ILibAsyncSocket_SendTo_MultiWrite(ILibAsyncSocket_Soc
 	return (retVal);
 }
 
+//
+// Sends as much of the given buffers as the socket will take, with a single system call
+//
+int ILibAsyncSocket_SendVector(ILibAsyncSocketModule *module, ILibAsyncSocket_IOVec *vec, int vecCount)
+{
+#if defined(WIN32)
+	WSABUF bufs[ILibAsyncSocket_MAX_IOVEC];
+	DWORD bytesSent = 0;
+	int i;
+
+	if (vecCount > ILibAsyncSocket_MAX_IOVEC) { vecCount = ILibAsyncSocket_MAX_IOVEC; }
+	for (i = 0; i < vecCount; ++i)
+	{
+		bufs[i].buf = vec[i].buffer;
+		bufs[i].len = (ULONG)vec[i].length;
+	}
+	if (WSASend(module->internalSocket, bufs, (DWORD)vecCount, &bytesSent, 0, NULL, NULL) != 0) { return(-1); }
+	return((int)bytesSent);
+#else
+	struct iovec bufs[ILibAsyncSocket_MAX_IOVEC];
+	struct msghdr msg;
+	int i;
+
+	if (vecCount > ILibAsyncSocket_MAX_IOVEC) { vecCount = ILibAsyncSocket_MAX_IOVEC; }
+	for (i = 0; i < vecCount; ++i)
+	{
+		bufs[i].iov_base = vec[i].buffer;
+		bufs[i].iov_len = vec[i].length;
+	}
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = bufs;
+	msg.msg_iovlen = vecCount;
+	return((int)sendmsg(module->internalSocket, &msg, MSG_NOSIGNAL)); // Callers cap the total at INT32_MAX
+#endif
+}
+
+//
+// Gathers the pending stream sends, starting at the head of the queue, and sends them with a single system call.
+// *gathered is set to the number of bytes that were offered to the socket.
+//
+int ILibAsyncSocket_SendPendingVector(ILibAsyncSocketModule *module, int *gathered)
+{
+	ILibAsyncSocket_IOVec vec[ILibAsyncSocket_MAX_IOVEC];
+	ILibAsyncSocket_SendData *data = module->PendingSend_Head;
+	int vecCount = 0, total = 0, len;
+
+	while (data != NULL && vecCount < ILibAsyncSocket_MAX_IOVEC && (data->remoteAddress.sin6_family == 0 || data->remoteAddress.sin6_family == AF_UNIX))
+	{
+		len = data->bufferSize - data->bytesSent;
+		if (len > INT32_MAX - total) { break; }
+		if (len > 0)
+		{
+			vec[vecCount].buffer = data->buffer + data->bytesSent;
+			vec[vecCount].length = (size_t)len;
+			++vecCount;
+			total += len;
+		}
+		data = data->Next;
+	}
+
+	*gathered = total;
+	if (vecCount == 0) { return(0); }
+	return(ILibAsyncSocket_SendVector(module, vec, vecCount));
+}
+
+/*! \fn ILibAsyncSocket_SendV(ILibAsyncSocket_SocketModule socketModule, ILibAsyncSocket_IOVec *vec, int vecCount, ILibAsyncSocket_OnSendVFree OnFree, void *user)
+\brief Sends a list of buffers on the TCP stream, without copying them
+\par
+The socket takes ownership of the buffers. They are sent with a single system call if possible, and whatever can't be sent
+right away is queued by reference. \a OnFree is called exactly once, when the buffers are no longer needed, which may be before
+this method returns. The \a vec array itself is not referenced after this method returns. On a TLS socket, the buffers are
+encrypted into the write BIO, and released right away.
+\param socketModule The ILibAsyncSocket module to send data on
+\param vec The buffers to send
+\param vecCount The number of buffers in \a vec. OR with ILibAsyncSocket_LOCK_OVERRIDE if the caller already holds the send lock
+\param OnFree Handler called when the buffers are no longer needed. Can be NULL
+\param user User object passed to \a OnFree
+\returns \a ILibAsyncSocket_SendStatus indicating the send status
+*/
+ILibAsyncSocket_SendStatus ILibAsyncSocket_SendV(ILibAsyncSocket_SocketModule socketModule, ILibAsyncSocket_IOVec *vec, int vecCount, ILibAsyncSocket_OnSendVFree OnFree, void *user)
+{
+	struct ILibAsyncSocketModule *module = (struct ILibAsyncSocketModule*)socketModule;
+	ILibAsyncSocket_SendData *data, *last = NULL;
+	ILibAsyncSocket_SendStatus retVal = ILibAsyncSocket_ALL_DATA_SENT;
+	size_t total = 0, offset;
+	int i, bytesSent = 0;
+	int lockOverride = ((vecCount & ILibAsyncSocket_LOCK_OVERRIDE) == ILibAsyncSocket_LOCK_OVERRIDE) ? (vecCount ^= ILibAsyncSocket_LOCK_OVERRIDE, 1) : 0;
+
+	if (socketModule == NULL)
+	{
+		if (OnFree != NULL) { OnFree(socketModule, user); }
+		return(ILibAsyncSocket_SEND_ON_CLOSED_SOCKET_ERROR);
+	}
+	for (i = 0; i < vecCount; ++i) { total += vec[i].length; }
+	if (total > INT32_MAX)
+	{
+		if (OnFree != NULL) { OnFree(socketModule, user); }
+		if (lockOverride == 0) { ILibSpinLock_Lock(&(module->SendLock)); }
+		ILibAsyncSocket_SendError(module);
+		if (lockOverride == 0) { ILibSpinLock_UnLock(&(module->SendLock)); }
+		return(ILibAsyncSocket_BUFFER_TOO_LARGE);
+	}
+
+	if (lockOverride == 0) { ILibSpinLock_Lock(&(module->SendLock)); }
+#ifndef MICROSTACK_NOTLS
+	if (module->ssl != NULL)
+	{
+		// The data has to be copied into the write BIO anyway, so encrypt all but the last buffer, and let the last write flush the BIO
+		for (i = 0; i + 1 < vecCount; ++i) { if (vec[i].length > 0) { SSL_write(module->ssl, vec[i].buffer, (int)vec[i].length); } }
+		retVal = ILibAsyncSocket_SendTo_MultiWrite(module, NULL, 1 | ILibAsyncSocket_LOCK_OVERRIDE, vecCount > 0 ? vec[vecCount - 1].buffer : "", vecCount > 0 ? vec[vecCount - 1].length : 0, ILibAsyncSocket_MemoryOwnership_USER);
+		if (lockOverride == 0) { ILibSpinLock_UnLock(&(module->SendLock)); }
+		if (OnFree != NULL) { OnFree(socketModule, user); }
+		return(retVal);
+	}
+#endif
+
+	if (module->internalSocket == ~0)
+	{
+		// Too Bad, the socket closed
+		if (lockOverride == 0) { ILibSpinLock_UnLock(&(module->SendLock)); }
+		if (OnFree != NULL) { OnFree(socketModule, user); }
+		return(ILibAsyncSocket_SEND_ON_CLOSED_SOCKET_ERROR);
+	}
+
+	if (module->PendingSend_Tail == NULL && module->FinConnect != 0 && total > 0)
+	{
+		// No pending data, so we can try to send now
+		bytesSent = ILibAsyncSocket_SendVector(module, vec, vecCount);
+#ifdef WIN32
+		if (bytesSent < 0 && WSAGetLastError() == WSAEWOULDBLOCK) { bytesSent = 0; }
+#else
+		if (bytesSent < 0 && errno == EWOULDBLOCK) { bytesSent = 0; }
+#endif
+		if (bytesSent < 0)
+		{
+			ILibAsyncSocket_SendError(module);
+			if (lockOverride == 0) { ILibSpinLock_UnLock(&(module->SendLock)); }
+			if (OnFree != NULL) { OnFree(socketModule, user); }
+			return(ILibAsyncSocket_SEND_ON_CLOSED_SOCKET_ERROR);
+		}
+		module->TotalBytesSent += bytesSent;
+	}
+
+	if ((size_t)bytesSent < total)
+	{
+		// Queue whatever wasn't sent, by reference
+		offset = (size_t)bytesSent;
+		for (i = 0; i < vecCount; ++i)
+		{
+			if (offset >= vec[i].length) { offset -= vec[i].length; continue; }
+
+			data = (ILibAsyncSocket_SendData*)ILibMemory_Allocate(sizeof(ILibAsyncSocket_SendData), 0, NULL, NULL);
+			data->buffer = vec[i].buffer;
+			data->bufferSize = (int)vec[i].length; // No dataloss, capped to INT32_MAX
+			data->bytesSent = (int)offset;
+			data->UserFree = ILibAsyncSocket_MemoryOwnership_STATIC;
+			offset = 0;
+
+			if (module->PendingSend_Tail == NULL)
+			{
+				module->PendingSend_Head = module->PendingSend_Tail = data;
+			}
+			else
+			{
+				module->PendingSend_Tail->Next = data;
+				module->PendingSend_Tail = data;
+			}
+			last = data;
+		}
+		last->OnFree = OnFree;
+		last->OnFreeUser = user;
+		module->PendingBytesToSend += (unsigned int)(total - bytesSent);
+		retVal = ILibAsyncSocket_NOT_ALL_DATA_SENT_YET;
+	}
+	if (lockOverride == 0) { ILibSpinLock_UnLock(&(module->SendLock)); }
+
+	if (retVal == ILibAsyncSocket_ALL_DATA_SENT)
+	{
+		if (OnFree != NULL) { OnFree(socketModule, user); }
+	}
+	else if (!ILibIsRunningOnChainThread(module->Transport.ChainLink.ParentChain))
+	{
+		ILibForceUnBlockChain(module->Transport.ChainLink.ParentChain);
+	}
+	return(retVal);
+}
+
 /*! \fn ILibAsyncSocket_Disconnect(ILibAsyncSocket_SocketModule socketModule)
 \brief Disconnects an ILibAsyncSocket
 \param socketModule The ILibAsyncSocket to disconnect
@@ -833,6 +1049,7 @@ void ILibAsyncSocket_Disconnect(ILibAsyncSocket_SocketModule socketModule)
 		module->PAUSE = 1;
 		s = module->internalSocket;
 		module->internalSocket = (SOCKET)~0;
+		ILibAsyncSocket_Readiness_Invalidate(module);
 		if (s != -1)
 		{
 #if defined(_WIN32_WCE) || defined(WIN32)
@@ -960,6 +1177,8 @@ void ILibAsyncSocket_ConnectTo(void* socketModule, struct sockaddr *localInterfa
 		if ((int)(module->internalSocket = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) { ILIBCRITICALEXIT(253); return; }
 	}
 
+	ILibAsyncSocket_Readiness_Invalidate(module);
+
 	// Initialise the buffer pointers, since no data is in them yet.
 	module->FinConnect = 0;
 	#ifndef MICROSTACK_NOTLS
@@ -1377,6 +1596,7 @@ void ILibProcessAsyncSocket(struct ILibAsyncSocketModule *Reader, int pendingRea
 		close(Reader->internalSocket);
 #endif
 		Reader->internalSocket = (SOCKET)~0;
+		ILibAsyncSocket_Readiness_Invalidate(Reader);
 
 		ILibAsyncSocket_ClearPendingSend(Reader);
 
@@ -1515,6 +1735,63 @@ void ILibAsyncSocket_SetTimeoutEx(ILibAsyncSocket_SocketModule socketModule, int
 	module->timeout_handler = timeoutHandler;
 }
 
+#ifndef WIN32
+void ILibAsyncSocket_Readiness_Sink(void *chain, int fd, int events, void *user)
+{
+	UNREFERENCED_PARAMETER(chain);
+	UNREFERENCED_PARAMETER(fd);
+	((ILibAsyncSocketModule*)user)->readinessEvents |= events;
+}
+//
+// Registers the socket with the chain's readiness backend, instead of using the fd_sets. Only changes in interest
+// reach the backend, so this is cheap to call on every PreSelect.
+//
+int ILibAsyncSocket_Readiness_Update(ILibAsyncSocketModule *module)
+{
+	int interest = ILibChain_Readiness_NONE;
+
+	if (module->readinessSocket != -1 && (module->readinessInvalid != 0 || module->readinessSocket != module->internalSocket))
+	{
+		// Socket was closed or replaced since we last registered
+		ILibChain_Readiness_Remove(module->Transport.ChainLink.ParentChain, module->readinessSocket, module);
+		module->readinessSocket = -1;
+		module->readinessEvents = 0;
+	}
+	module->readinessInvalid = 0;
+	if (module->internalSocket == -1) { return(0); }
+
+	if (module->FinConnect == 0)
+	{
+		// Not Connected Yet
+		interest |= ILibChain_Readiness_WRITE;
+	}
+	else if (module->PAUSE == 0)
+	{
+		// Already Connected, just needs reading
+		interest |= ILibChain_Readiness_READ;
+	}
+	if (module->PendingSend_Head != NULL)
+	{
+		// If there is pending data to be sent, then we need to check when the socket is writable
+		interest |= ILibChain_Readiness_WRITE;
+	}
+
+	if (ILibChain_Readiness_Update(module->Transport.ChainLink.ParentChain, module->internalSocket, interest, ILibAsyncSocket_Readiness_Sink, module) != 0)
+	{
+		// Fall back to the fd_sets, which PostSelect only reads when we aren't registered
+		if (module->readinessSocket != -1)
+		{
+			ILibChain_Readiness_Remove(module->Transport.ChainLink.ParentChain, module->readinessSocket, module);
+			module->readinessSocket = -1;
+			module->readinessEvents = 0;
+		}
+		return(1);
+	}
+	module->readinessSocket = module->internalSocket;
+	return(0);
+}
+#endif
+
 //
 // Chained PreSelect handler for ILibAsyncSocket
 //
@@ -1525,6 +1802,9 @@ void ILibAsyncSocket_SetTimeoutEx(ILibAsyncSocket_SocketModule socketModule, int
 void ILibAsyncSocket_PreSelect(void* socketModule,fd_set *readset, fd_set *writeset, fd_set *errorset, int* blocktime)
 {
 	struct ILibAsyncSocketModule *module = (struct ILibAsyncSocketModule*)socketModule;
+#ifndef WIN32
+	if (module->readinessSocket != -1 && module->internalSocket == -1) { ILibAsyncSocket_Readiness_Update(module); }
+#endif
 	if (module->internalSocket == -1) return; // If there is not internal socket, just return now.
 
 	ILibRemoteLogging_printf(ILibChainGetLogger(module->Transport.ChainLink.ParentChain), ILibRemoteLogging_Modules_Microstack_AsyncSocket, ILibRemoteLogging_Flags_VerbosityLevel_5, "AsyncSocket[%p] entered PreSelect", (void*)module);
@@ -1571,44 +1851,49 @@ void ILibAsyncSocket_PreSelect(void* socketModule,fd_set *readset, fd_set *write
 		}
 
 		if (module->PAUSE < 0) *blocktime = 0;
-		if (module->FinConnect == 0)
-		{
-			// Not Connected Yet
-			#if defined(WIN32)
-			#pragma warning( push, 3 ) // warning C4127: conditional expression is constant
-			#endif
-			FD_SET(module->internalSocket, writeset);
-			FD_SET(module->internalSocket, errorset);
-			#if defined(WIN32)
-			#pragma warning( pop )
-			#endif
-		}
-		else
+#ifndef WIN32
+		if (ILibAsyncSocket_Readiness_Update(module) != 0)
+#endif
 		{
-			if (module->PAUSE == 0) // Only if this is zero. <0 is resume, so we want to process first
+			if (module->FinConnect == 0)
 			{
-				// Already Connected, just needs reading
+				// Not Connected Yet
 				#if defined(WIN32)
 				#pragma warning( push, 3 ) // warning C4127: conditional expression is constant
 				#endif
-				FD_SET(module->internalSocket, readset);
+				FD_SET(module->internalSocket, writeset);
 				FD_SET(module->internalSocket, errorset);
 				#if defined(WIN32)
 				#pragma warning( pop )
 				#endif
 			}
-		}
+			else
+			{
+				if (module->PAUSE == 0) // Only if this is zero. <0 is resume, so we want to process first
+				{
+					// Already Connected, just needs reading
+					#if defined(WIN32)
+					#pragma warning( push, 3 ) // warning C4127: conditional expression is constant
+					#endif
+					FD_SET(module->internalSocket, readset);
+					FD_SET(module->internalSocket, errorset);
+					#if defined(WIN32)
+					#pragma warning( pop )
+					#endif
+				}
+			}
 
-		if (module->PendingSend_Head != NULL)
-		{
-			// If there is pending data to be sent, then we need to check when the socket is writable
-			#if defined(WIN32)
-			#pragma warning( push, 3 ) // warning C4127: conditional expression is constant
-			#endif
-			FD_SET(module->internalSocket, writeset);
-			#if defined(WIN32)
-			#pragma warning( pop )
-			#endif
+			if (module->PendingSend_Head != NULL)
+			{
+				// If there is pending data to be sent, then we need to check when the socket is writable
+				#if defined(WIN32)
+				#pragma warning( push, 3 ) // warning C4127: conditional expression is constant
+				#endif
+				FD_SET(module->internalSocket, writeset);
+				#if defined(WIN32)
+				#pragma warning( pop )
+				#endif
+			}
 		}
 	}
 
@@ -1646,6 +1931,7 @@ void ILibAsyncSocket_PrivateShutdown(void* socketModule)
 		close(module->internalSocket);
 	#endif
 	module->internalSocket = (SOCKET)~0;
+	ILibAsyncSocket_Readiness_Invalidate(module);
 	module->timeout_handler = NULL;
 	module->timeout_milliSeconds = 0;
 
@@ -1682,6 +1968,7 @@ void ILibAsyncSocket_PostSelect(void* socketModule, int slct, fd_set *readset, f
 	int TriggerSendOK = 0;
 	struct ILibAsyncSocket_SendData *temp;
 	int bytesSent = 0;
+	int gathered, remaining, chunk, partial;
 	int flags;
 #ifdef WIN32
 	int len;
@@ -1698,9 +1985,26 @@ void ILibAsyncSocket_PostSelect(void* socketModule, int slct, fd_set *readset, f
 
 	// If there is no internal socket or no events, just return now.
 	if (module->internalSocket == -1 || module->FinConnect == -1) return;
-	fd_error = FD_ISSET(module->internalSocket, errorset);
-	fd_read = FD_ISSET(module->internalSocket, readset);
-	fd_write = FD_ISSET(module->internalSocket, writeset);
+#ifndef WIN32
+	if (module->readinessSocket == module->internalSocket && module->readinessInvalid == 0)
+	{
+		// Events were dispatched by the chain's readiness backend
+		fd_error = module->readinessEvents & ILibChain_Readiness_ERROR;
+		fd_read = module->readinessEvents & ILibChain_Readiness_READ;
+		fd_write = module->readinessEvents & ILibChain_Readiness_WRITE;
+		module->readinessEvents = 0;
+	}
+	else if (module->internalSocket >= FD_SETSIZE)
+	{
+		fd_error = fd_read = fd_write = 0;
+	}
+	else
+#endif
+	{
+		fd_error = FD_ISSET(module->internalSocket, errorset);
+		fd_read = FD_ISSET(module->internalSocket, readset);
+		fd_write = FD_ISSET(module->internalSocket, writeset);
+	}
 
 	ILibRemoteLogging_printf(ILibChainGetLogger(module->Transport.ChainLink.ParentChain), ILibRemoteLogging_Modules_Microstack_AsyncSocket, ILibRemoteLogging_Flags_VerbosityLevel_5, "AsyncSocket[%p] entered PostSelect", (void*)module);
 	
@@ -2005,9 +2309,11 @@ void ILibAsyncSocket_PostSelect(void* socketModule, int slct, fd_set *readset, f
 			else
 #endif
 			{
+				gathered = -1;
 				if (module->PendingSend_Head->remoteAddress.sin6_family == 0 || module->PendingSend_Head->remoteAddress.sin6_family == AF_UNIX)
 				{
-					bytesSent = (int)send(module->internalSocket, module->PendingSend_Head->buffer + module->PendingSend_Head->bytesSent, module->PendingSend_Head->bufferSize - module->PendingSend_Head->bytesSent, MSG_NOSIGNAL); // Klocwork reports that this could block while holding a lock... This socket has been set to O_NONBLOCK, so that will never happen
+					// Send as many of the pending buffers as we can, with a single call
+					bytesSent = ILibAsyncSocket_SendPendingVector(module, &gathered);
 				}
 				else
 				{
@@ -2021,28 +2327,31 @@ void ILibAsyncSocket_PostSelect(void* socketModule, int slct, fd_set *readset, f
 					module->PendingBytesToSend -= bytesSent;
 					if ((int)module->PendingBytesToSend < 0) { module->PendingBytesToSend = 0; }
 					module->TotalBytesSent += bytesSent;
-					module->PendingSend_Head->bytesSent += bytesSent;
-					if (module->PendingSend_Head->bytesSent == module->PendingSend_Head->bufferSize)
+
+					// Retire the blocks that were completely sent
+					remaining = bytesSent;
+					partial = 0;
+					while (module->PendingSend_Head != NULL)
 					{
+						chunk = module->PendingSend_Head->bufferSize - module->PendingSend_Head->bytesSent;
+						if (chunk > remaining) { chunk = remaining; }
+						module->PendingSend_Head->bytesSent += chunk;
+						remaining -= chunk;
+						if (module->PendingSend_Head->bytesSent != module->PendingSend_Head->bufferSize) { partial = 1; break; }
+
 						// Finished Sending this block
 						if (module->PendingSend_Head == module->PendingSend_Tail)
 						{
 							module->PendingSend_Tail = NULL;
 						}
-						if (module->PendingSend_Head->UserFree == 0)
-						{
-							free(module->PendingSend_Head->buffer);
-						}
 						temp = module->PendingSend_Head->Next;
-						free(module->PendingSend_Head);
+						ILibAsyncSocket_FreeSendData(module, module->PendingSend_Head);
 						module->PendingSend_Head = temp;
-						if (module->PendingSend_Head == NULL) { TRY_TO_SEND = 0; }
-					}
-					else
-					{
-						// We sent data, but not everything that needs to get sent was sent, try again
-						TRY_TO_SEND = 0;
+						if (gathered < 0) { break; }	// Datagrams are sent one at a time
 					}
+
+					// Stop if everything was sent, or if we sent data, but not everything that needs to get sent was sent
+					if (module->PendingSend_Head == NULL || partial != 0) { TRY_TO_SEND = 0; }
 				}
 			}
 
@@ -2307,6 +2616,7 @@ void ILibAsyncSocket_UseThisSocket(ILibAsyncSocket_SocketModule socketModule, in
 	module->PendingBytesToSend = 0;
 	module->TotalBytesSent = 0;
 	module->internalSocket = UseThisSocket;
+	ILibAsyncSocket_Readiness_Invalidate(module);
 	module->OnInterrupt = InterruptPtr;
 	module->user = user;
 	module->FinConnect = 1;
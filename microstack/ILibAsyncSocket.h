@@ -181,6 +181,25 @@ void ILibAsyncSocket_ConnectToProxy(void* socketModule, struct sockaddr *localIn
 
 enum ILibAsyncSocket_SendStatus ILibAsyncSocket_SendTo_MultiWrite(ILibAsyncSocket_SocketModule socketModule, struct sockaddr *remoteAddress, unsigned int count, ...);
 
+/*! \struct ILibAsyncSocket_IOVec
+\brief A buffer passed to \a ILibAsyncSocket_SendV
+*/
+typedef struct ILibAsyncSocket_IOVec
+{
+	char *buffer;
+	size_t length;
+}ILibAsyncSocket_IOVec;
+/*! \typedef ILibAsyncSocket_OnSendVFree
+\brief Handler for when the buffers passed to \a ILibAsyncSocket_SendV are no longer needed
+\par
+This may be called with the socket's send lock held, so it must only release the memory, and not call back into the socket.
+\param socketModule The \a ILibAsyncSocket_SocketModule the buffers were sent on
+\param user The user object that was passed to \a ILibAsyncSocket_SendV
+*/
+typedef void(*ILibAsyncSocket_OnSendVFree)(ILibAsyncSocket_SocketModule socketModule, void *user);
+#define ILibAsyncSocket_MAX_IOVEC 64
+ILibAsyncSocket_SendStatus ILibAsyncSocket_SendV(ILibAsyncSocket_SocketModule socketModule, ILibAsyncSocket_IOVec *vec, int vecCount, ILibAsyncSocket_OnSendVFree OnFree, void *user);
+
 /*! \def ILibAsyncSocket_Send
 \brief Sends data onto the TCP stream
 \param socketModule The \a ILibAsyncSocket_SocketModule to send data on
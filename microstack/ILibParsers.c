@@ -51,6 +51,11 @@ limitations under the License.
 #include <sys/resource.h>
 #endif
 
+#if defined(__linux__) && !defined(ILIBCHAIN_NO_EPOLL)
+#define ILibChain_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifdef _MINCORE
 #define strncmp(a,b,c) strcmp(a,b)
 #endif
@@ -905,19 +910,52 @@ typedef struct LifeTimeMonitorData
 	char *file;
 	uint32_t line;
 	char *metadata;
+
+	struct LifeTimeMonitorData *Next, *Prev;				// Wheel slot (or firing queue)
+	struct LifeTimeMonitorData *IndexNext, *IndexPrev;		// Index, keyed by data
+	struct ILibLifeTime_Slot *Slot;
+	int Firing;
+	int Removed;
 }LifeTimeMonitorData;
+
+//
+// Timers are kept in a hierarchical timing wheel with millisecond resolution. Each level has 256 slots,
+// so level 0 covers the next 256ms, and level 3 covers ~49 days. Timers further out than that are kept
+// in an overflow slot. Add and Remove are O(1), and slots from the higher levels are cascaded down as
+// the wheel turns.
+//
+#define ILibLifeTime_WHEEL_BITS 8
+#define ILibLifeTime_WHEEL_SIZE (1 << ILibLifeTime_WHEEL_BITS)
+#define ILibLifeTime_WHEEL_MASK (ILibLifeTime_WHEEL_SIZE - 1)
+#define ILibLifeTime_WHEEL_LEVELS 4
+#define ILibLifeTime_INDEX_INITIAL_SIZE 64
+
+typedef struct ILibLifeTime_Slot
+{
+	struct LifeTimeMonitorData *Head;
+	struct LifeTimeMonitorData *Tail;
+}ILibLifeTime_Slot;
+
 struct ILibLifeTime
 {
 	ILibChain_Link ChainLink;
-	struct LifeTimeMonitorData *LM;
 	long long NextTriggerTick;
-
-	void *Reserved;
 	char *CurrentTriggeredMetaData;
-
-	void *ObjectList;
 	int ObjectCount;
+
+	ILibSpinLock Lock;
+	long long WheelTick;		// All slots before this tick have been processed
+	int LevelCount[ILibLifeTime_WHEEL_LEVELS];
+	ILibLifeTime_Slot Immediate;
+	ILibLifeTime_Slot Overflow;
+	ILibLifeTime_Slot Wheel[ILibLifeTime_WHEEL_LEVELS][ILibLifeTime_WHEEL_SIZE];
+
+	struct LifeTimeMonitorData **Index;
+	unsigned int IndexSize;
+	unsigned int IndexCount;
 };
+struct LifeTimeMonitorData** ILibLifeTime_Snapshot(struct ILibLifeTime *LifeTimeMonitor, int *count);
+long long ILibLifeTime_Wheel_NextTick(struct ILibLifeTime *LifeTimeMonitor);
 
 typedef struct ILibChain_Link_Hook
 {
@@ -930,6 +968,39 @@ struct ILibBaseChain_SafeData
 	void *Object;
 };
 
+//
+// Work items dispatched with ILibChain_RunOnMicrostackThread. The first four fields must stay in this order,
+// because the token returned by ILibChain_RunOnMicrostackThreadEx3 is also accessed as a void*[4] (see ILibDuktape_Helpers.c)
+//
+typedef struct ILibChain_WorkItem
+{
+	void *chain;
+	ILibChain_StartEvent handler;
+	void *user;
+	ILibChain_StartEvent abortHandler;
+	struct ILibChain_WorkItem *volatile next;
+}ILibChain_WorkItem;
+
+#if defined(WIN32)
+	#define ILibChain_Atomic_ExchangePtr(ptr, val) InterlockedExchangePointer((PVOID volatile*)(ptr), (PVOID)(val))
+	#define ILibChain_Atomic_ExchangeInt(ptr, val) InterlockedExchange((LONG volatile*)(ptr), (LONG)(val))
+	#define ILibChain_Atomic_AddInt(ptr, val) (InterlockedExchangeAdd((LONG volatile*)(ptr), (LONG)(val)) + (LONG)(val))
+	#define ILibChain_Atomic_StorePtr(ptr, val) (*(ptr) = (val))
+	#define ILibChain_Atomic_LoadPtr(ptr) (*(ptr))
+#elif defined(__ATOMIC_SEQ_CST)
+	#define ILibChain_Atomic_ExchangePtr(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+	#define ILibChain_Atomic_ExchangeInt(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+	#define ILibChain_Atomic_AddInt(ptr, val) __atomic_add_fetch((ptr), (val), __ATOMIC_SEQ_CST)
+	#define ILibChain_Atomic_StorePtr(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+	#define ILibChain_Atomic_LoadPtr(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#else
+	#define ILibChain_Atomic_ExchangePtr(ptr, val) (__sync_synchronize(), __sync_lock_test_and_set((ptr), (val)))
+	#define ILibChain_Atomic_ExchangeInt(ptr, val) (__sync_synchronize(), __sync_lock_test_and_set((ptr), (val)))
+	#define ILibChain_Atomic_AddInt(ptr, val) __sync_add_and_fetch((ptr), (val))
+	#define ILibChain_Atomic_StorePtr(ptr, val) do { __sync_synchronize(); *(ptr) = (val); } while (0)
+	#define ILibChain_Atomic_LoadPtr(ptr) (*(ptr))
+#endif
+
 #ifdef WIN32
 typedef struct ILibChain_WaitHandleInfo
 {
@@ -973,10 +1044,25 @@ typedef struct ILibBaseChain
 #else
 	pthread_t ChainThreadID;
 	int TerminatePipe[2];
+	void *Readiness;
 #endif
 
 	void *Timer;
 	void *Reserved;
+
+	//
+	// Lock-free multi-producer/single-consumer queue for ILibChain_RunOnMicrostackThread. Producers on any thread
+	// push onto WorkQueueHead, and the BaseTimer drains from WorkQueueTail on the microstack thread. Only the
+	// producer that sets WorkQueueSignaled unblocks the chain, so a burst of posts costs a single wakeup.
+	// WorkQueuePosting counts the producers in the middle of a post, so the queue can be closed without losing any.
+	//
+	ILibChain_WorkItem *volatile WorkQueueHead;
+	ILibChain_WorkItem *WorkQueueTail;
+	ILibChain_WorkItem WorkQueueStub;
+	volatile long WorkQueueSignaled;
+	volatile long WorkQueuePosting;
+	volatile long WorkQueueClosed;
+
 	ILibLinkedList OnDestroyEventSinks;
 	ILibLinkedList Links;
 	ILibLinkedList LinksPendingDelete;
@@ -1676,9 +1762,9 @@ void ILibChain_RunOnMicrostackThreadSink_Abort(void *obj)
 {
 	if (!ILibMemory_CanaryOK(obj)) { return; }
 
-	void* chain = ((void**)obj)[0];
-	ILibChain_StartEvent abortHandler = (ILibChain_StartEvent)((void**)obj)[3];
-	void* user = ((void**)obj)[2];
+	void* chain = ((ILibChain_WorkItem*)obj)->chain;
+	ILibChain_StartEvent abortHandler = ((ILibChain_WorkItem*)obj)->abortHandler;
+	void* user = ((ILibChain_WorkItem*)obj)->user;
 
 	if (abortHandler == (ILibChain_StartEvent)0x01)
 	{
@@ -1697,13 +1783,125 @@ void ILibChain_RunOnMicrostackThreadSink(void *obj)
 {
 	if (!ILibMemory_CanaryOK(obj)) { return; }
 
-	void* chain = ((void**)obj)[0];
-	ILibChain_StartEvent handler = (ILibChain_StartEvent)((void**)obj)[1];
-	void* user = ((void**)obj)[2];
+	void* chain = ((ILibChain_WorkItem*)obj)->chain;
+	ILibChain_StartEvent handler = ((ILibChain_WorkItem*)obj)->handler;
+	void* user = ((ILibChain_WorkItem*)obj)->user;
 
 	if (handler != NULL) { handler(chain, user); }
 	ILibMemory_Free(obj);
 }
+
+//
+// Intrusive MPSC queue (Dmitry Vyukov). Push is wait-free, and can be called from any thread.
+//
+void ILibChain_WorkQueue_Push(ILibBaseChain *chain, ILibChain_WorkItem *item)
+{
+	ILibChain_WorkItem *prev;
+
+	item->next = NULL;
+	prev = (ILibChain_WorkItem*)ILibChain_Atomic_ExchangePtr(&(chain->WorkQueueHead), item);
+	ILibChain_Atomic_StorePtr(&(prev->next), item);
+}
+//
+// Must only be called from the microstack thread. Returns NULL if the queue is empty, or if a producer is
+// in the middle of a push, in which case *retry is set.
+//
+ILibChain_WorkItem* ILibChain_WorkQueue_Pop(ILibBaseChain *chain, int *retry)
+{
+	ILibChain_WorkItem *tail = chain->WorkQueueTail;
+	ILibChain_WorkItem *next = (ILibChain_WorkItem*)ILibChain_Atomic_LoadPtr(&(tail->next));
+
+	if (tail == &(chain->WorkQueueStub))
+	{
+		if (next == NULL) 
+		{
+			if ((ILibChain_WorkItem*)ILibChain_Atomic_LoadPtr(&(chain->WorkQueueHead)) != tail) { *retry = 1; }
+			return(NULL); 
+		}
+		chain->WorkQueueTail = tail = next;
+		next = (ILibChain_WorkItem*)ILibChain_Atomic_LoadPtr(&(next->next));
+	}
+	if (next != NULL)
+	{
+		chain->WorkQueueTail = next;
+		return(tail);
+	}
+	if ((ILibChain_WorkItem*)ILibChain_Atomic_LoadPtr(&(chain->WorkQueueHead)) != tail)
+	{
+		*retry = 1;
+		return(NULL);
+	}
+
+	// This is the last item, so put the stub back, to keep the queue from becoming empty
+	ILibChain_WorkQueue_Push(chain, &(chain->WorkQueueStub));
+	next = (ILibChain_WorkItem*)ILibChain_Atomic_LoadPtr(&(tail->next));
+	if (next != NULL)
+	{
+		chain->WorkQueueTail = next;
+		return(tail);
+	}
+	*retry = 1;
+	return(NULL);
+}
+void ILibChain_WorkQueue_Init(ILibBaseChain *chain)
+{
+	chain->WorkQueueStub.next = NULL;
+	chain->WorkQueueHead = chain->WorkQueueTail = &(chain->WorkQueueStub);
+	chain->WorkQueueSignaled = 0;
+	chain->WorkQueuePosting = 0;
+	chain->WorkQueueClosed = 0;
+}
+//
+// Called by the BaseTimer on the microstack thread. Everything that is in the queue is detached first, and then
+// dispatched in order, so work that is posted by the handlers themselves will run on the next iteration of the chain.
+// Returns non-zero if the chain should not block, because there is more work that could not be drained.
+//
+int ILibChain_WorkQueue_Drain(ILibBaseChain *chain)
+{
+	ILibChain_WorkItem *item, *first = NULL, *last = NULL;
+	int retry = 0;
+
+	if (chain->WorkQueueTail == NULL) { return(0); }
+	ILibChain_Atomic_ExchangeInt(&(chain->WorkQueueSignaled), 0);
+
+	while ((item = ILibChain_WorkQueue_Pop(chain, &retry)) != NULL)
+	{
+		item->next = NULL;
+		if (last == NULL) { first = item; } else { last->next = item; }
+		last = item;
+	}
+	while ((item = first) != NULL)
+	{
+		first = item->next;
+		ILibChain_RunOnMicrostackThreadSink(item);
+	}
+	return(retry);
+}
+//
+// Called when the BaseTimer is destroyed. The queue is closed first, so posts made from then on are aborted right away,
+// and once the posts that were already under way are in the queue, everything in it is aborted, so the abort handlers can clean up.
+//
+void ILibChain_WorkQueue_Abort(ILibBaseChain *chain)
+{
+	ILibChain_WorkItem *item;
+	int retry = 0;
+
+	if (chain->WorkQueueTail == NULL) { return; }
+	ILibChain_Atomic_AddInt(&(chain->WorkQueueClosed), 1);
+	while (ILibChain_Atomic_AddInt(&(chain->WorkQueuePosting), 0) != 0)
+	{
+#ifdef WIN32
+		YieldProcessor();
+#else
+		sched_yield();
+#endif
+	}
+	while ((item = ILibChain_WorkQueue_Pop(chain, &retry)) != NULL)
+	{
+		ILibChain_RunOnMicrostackThreadSink_Abort(item);
+	}
+}
+
 //! Dispatch an operation to the Microstack Chain thread
 /*!
 	\param chain Microstack Chain to dispatch to
@@ -1712,17 +1910,40 @@ void ILibChain_RunOnMicrostackThreadSink(void *obj)
 */
 void* ILibChain_RunOnMicrostackThreadEx3(void *chain, ILibChain_StartEvent handler, ILibChain_StartEvent abortHandler, void *user)
 {
-	void** value = NULL;
-	
-	value = (void**)ILibMemory_SmartAllocate(4 * sizeof(void*));
+	ILibBaseChain *bchain = (ILibBaseChain*)chain;
+	ILibChain_WorkItem *value = (ILibChain_WorkItem*)ILibMemory_SmartAllocate(sizeof(ILibChain_WorkItem));
+
+	value->chain = chain;
+	value->handler = handler;
+	value->user = user;
+	value->abortHandler = abortHandler;
 
-	value[0] = chain;
-	value[1] = handler;
-	value[2] = user;
-	value[3] = abortHandler;
-	ILibLifeTime_AddEx(ILibGetBaseTimer(chain), value, 0, &ILibChain_RunOnMicrostackThreadSink, &ILibChain_RunOnMicrostackThreadSink_Abort);
+	ILibChain_Atomic_AddInt(&(bchain->WorkQueuePosting), 1);
+	if (bchain->Timer == NULL || ILibChain_Atomic_AddInt(&(bchain->WorkQueueClosed), 0) != 0)
+	{
+		// The chain is being destroyed, so this can never be dispatched
+		ILibChain_Atomic_AddInt(&(bchain->WorkQueuePosting), -1);
+		ILibChain_RunOnMicrostackThreadSink_Abort(value);
+		return(NULL);
+	}
+
+	ILibChain_WorkQueue_Push(bchain, value);
+	if (ILibChain_Atomic_ExchangeInt(&(bchain->WorkQueueSignaled), 1) == 0)
+	{
+		// Only the first post since the last drain needs to unblock the chain
+		ILibForceUnBlockChain(chain);
+	}
+	ILibChain_Atomic_AddInt(&(bchain->WorkQueuePosting), -1);
 	return(value);
 }
+//
+// Returns non-zero once the chain has started tearing down its work queue. Work posted from then on is aborted instead of queued,
+// and work that was already queued is aborted by the chain, so a token returned earlier must not be touched anymore.
+//
+int ILibChain_WorkQueue_IsClosed(void *chain)
+{
+	return(ILibChain_Atomic_AddInt(&(((ILibBaseChain*)chain)->WorkQueueClosed), 0) != 0);
+}
 #ifdef WIN32
 HANDLE ILibChain_GetMicrostackThreadHandle(void *chain)
 {
@@ -1998,6 +2219,7 @@ void *ILibCreateChainEx(int extraMemorySize)
 #endif
 
 	RetVal->TerminateFlag = 0;
+	ILibChain_WorkQueue_Init(RetVal);
 	RetVal->Timer = ILibCreateLifeTime(RetVal);
 
 #if defined(WIN32)
@@ -2090,6 +2312,319 @@ void ILibForceUnBlockChain(void* Chain)
 #endif
 }
 
+#ifndef WIN32
+typedef struct ILibChain_Readiness_Entry
+{
+	ILibChain_Readiness_Handler handler;
+	void *user;
+	int interest;
+	int armed;
+	int registered;
+}ILibChain_Readiness_Entry;
+
+struct ILibChain_Readiness;
+typedef struct ILibChain_Readiness_Backend
+{
+	char *name;
+	int(*Arm)(struct ILibChain_Readiness *r, int fd, ILibChain_Readiness_Entry *entry);
+	void(*Remove)(struct ILibChain_Readiness *r, int fd, ILibChain_Readiness_Entry *entry);
+	void(*PreSelect)(struct ILibChain_Readiness *r, fd_set *readset, fd_set *writeset, fd_set *errorset);
+	void(*PostSelect)(struct ILibChain_Readiness *r, int slct, fd_set *readset, fd_set *writeset, fd_set *errorset);
+}ILibChain_Readiness_Backend;
+
+typedef struct ILibChain_Readiness
+{
+	ILibChain_Readiness_Backend *backend;
+	void *chain;
+	int pollfd;
+	int count;
+	int maxfd;
+	int entriesLength;
+	int suspended;									// Set while ILibChain_Continue() runs a subset of the modules
+	ILibChain_Readiness_Entry *entries;
+}ILibChain_Readiness;
+
+#define ILibChain_Readiness_EPOLL_BATCH 256
+
+void ILibChain_Readiness_Dispatch(ILibChain_Readiness *r, int fd, int events)
+{
+	ILibChain_Readiness_Entry *entry;
+	if (fd < 0 || fd >= r->entriesLength) { return; }
+	entry = &(r->entries[fd]);
+	if (entry->handler == NULL || entry->armed == 0) { return; }
+
+	//
+	// Events are one-shot. The link must re-arm the descriptor (typically from its PreSelect) to get notified again
+	//
+	entry->armed = 0;
+	entry->handler(r->chain, fd, events & (entry->interest | ILibChain_Readiness_ERROR), entry->user);
+}
+
+//
+// select() Backend
+//
+int ILibChain_Readiness_Select_Arm(ILibChain_Readiness *r, int fd, ILibChain_Readiness_Entry *entry)
+{
+	if (fd >= FD_SETSIZE) { return(1); }
+	entry->registered = 1;
+	entry->armed = entry->interest != ILibChain_Readiness_NONE ? 1 : 0;
+	return(0);
+}
+void ILibChain_Readiness_Select_Remove(ILibChain_Readiness *r, int fd, ILibChain_Readiness_Entry *entry)
+{
+	UNREFERENCED_PARAMETER(r);
+	UNREFERENCED_PARAMETER(fd);
+	UNREFERENCED_PARAMETER(entry);
+}
+void ILibChain_Readiness_Select_PreSelect(ILibChain_Readiness *r, fd_set *readset, fd_set *writeset, fd_set *errorset)
+{
+	int fd;
+	for (fd = 0; fd <= r->maxfd && fd < r->entriesLength; ++fd)
+	{
+		if (r->entries[fd].armed == 0) { continue; }
+		if ((r->entries[fd].interest & ILibChain_Readiness_READ) == ILibChain_Readiness_READ) { FD_SET(fd, readset); }
+		if ((r->entries[fd].interest & ILibChain_Readiness_WRITE) == ILibChain_Readiness_WRITE) { FD_SET(fd, writeset); }
+		FD_SET(fd, errorset);
+	}
+}
+void ILibChain_Readiness_Select_PostSelect(ILibChain_Readiness *r, int slct, fd_set *readset, fd_set *writeset, fd_set *errorset)
+{
+	int fd, events;
+	if (slct <= 0) { return; }
+	for (fd = 0; fd <= r->maxfd && fd < r->entriesLength; ++fd)
+	{
+		if (r->entries[fd].armed == 0) { continue; }
+		events = 0;
+		if (FD_ISSET(fd, readset)) { events |= ILibChain_Readiness_READ; }
+		if (FD_ISSET(fd, writeset)) { events |= ILibChain_Readiness_WRITE; }
+		if (FD_ISSET(fd, errorset)) { events |= ILibChain_Readiness_ERROR; }
+		if (events != 0) { ILibChain_Readiness_Dispatch(r, fd, events); }
+	}
+}
+ILibChain_Readiness_Backend ILibChain_Readiness_SelectBackend = 
+{
+	"select",
+	ILibChain_Readiness_Select_Arm,
+	ILibChain_Readiness_Select_Remove,
+	ILibChain_Readiness_Select_PreSelect,
+	ILibChain_Readiness_Select_PostSelect
+};
+
+#ifdef ILibChain_EPOLL
+//
+// epoll Backend. The epoll descriptor itself is placed in the select() readset, so links that still use
+// fd_sets continue to work, while registered descriptors are not bound by FD_SETSIZE.
+//
+int ILibChain_Readiness_Epoll_Arm(ILibChain_Readiness *r, int fd, ILibChain_Readiness_Entry *entry)
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.data.fd = fd;
+	ev.events = EPOLLONESHOT;
+	if ((entry->interest & ILibChain_Readiness_READ) == ILibChain_Readiness_READ) { ev.events |= (EPOLLIN | EPOLLPRI); }
+	if ((entry->interest & ILibChain_Readiness_WRITE) == ILibChain_Readiness_WRITE) { ev.events |= EPOLLOUT; }
+
+	if (entry->interest == ILibChain_Readiness_NONE)
+	{
+		// epoll reports EPOLLERR/EPOLLHUP even with an empty mask, which would leave the epoll descriptor readable
+		// until the link re-arms. So the descriptor is taken out, and added back when there is interest again.
+		if (entry->registered != 0 && epoll_ctl(r->pollfd, EPOLL_CTL_DEL, fd, &ev) != 0 && errno != ENOENT) { return(1); }
+		entry->registered = 0;
+		entry->armed = 0;
+		return(0);
+	}
+
+	if (entry->registered != 0)
+	{
+		if (epoll_ctl(r->pollfd, EPOLL_CTL_MOD, fd, &ev) != 0)
+		{
+			// The descriptor was closed and re-created underneath us, so the kernel forgot about it
+			if (errno != ENOENT || epoll_ctl(r->pollfd, EPOLL_CTL_ADD, fd, &ev) != 0) { return(1); }
+		}
+	}
+	else
+	{
+		if (epoll_ctl(r->pollfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+		{
+			if (errno != EEXIST || epoll_ctl(r->pollfd, EPOLL_CTL_MOD, fd, &ev) != 0) { return(1); }
+		}
+		entry->registered = 1;
+	}
+	entry->armed = 1;
+	return(0);
+}
+void ILibChain_Readiness_Epoll_Remove(ILibChain_Readiness *r, int fd, ILibChain_Readiness_Entry *entry)
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	if (entry->registered != 0) { ignore_result(epoll_ctl(r->pollfd, EPOLL_CTL_DEL, fd, &ev)); }
+}
+void ILibChain_Readiness_Epoll_PreSelect(ILibChain_Readiness *r, fd_set *readset, fd_set *writeset, fd_set *errorset)
+{
+	UNREFERENCED_PARAMETER(writeset);
+	UNREFERENCED_PARAMETER(errorset);
+	if (r->count > 0) { FD_SET(r->pollfd, readset); }
+}
+void ILibChain_Readiness_Epoll_PostSelect(ILibChain_Readiness *r, int slct, fd_set *readset, fd_set *writeset, fd_set *errorset)
+{
+	struct epoll_event events[ILibChain_Readiness_EPOLL_BATCH];
+	int i, n, flags;
+
+	UNREFERENCED_PARAMETER(writeset);
+	UNREFERENCED_PARAMETER(errorset);
+	if (slct <= 0 || !FD_ISSET(r->pollfd, readset)) { return; }
+
+	do
+	{
+		n = epoll_wait(r->pollfd, events, ILibChain_Readiness_EPOLL_BATCH, 0);
+		for (i = 0; i < n; ++i)
+		{
+			flags = 0;
+			if ((events[i].events & (EPOLLIN | EPOLLPRI | EPOLLHUP)) != 0) { flags |= ILibChain_Readiness_READ; }
+			if ((events[i].events & EPOLLOUT) != 0) { flags |= ILibChain_Readiness_WRITE; }
+			if ((events[i].events & EPOLLERR) != 0) { flags |= (ILibChain_Readiness_ERROR | ILibChain_Readiness_READ | ILibChain_Readiness_WRITE); }
+			ILibChain_Readiness_Dispatch(r, events[i].data.fd, flags);
+		}
+	} while (n == ILibChain_Readiness_EPOLL_BATCH);
+}
+ILibChain_Readiness_Backend ILibChain_Readiness_EpollBackend =
+{
+	"epoll",
+	ILibChain_Readiness_Epoll_Arm,
+	ILibChain_Readiness_Epoll_Remove,
+	ILibChain_Readiness_Epoll_PreSelect,
+	ILibChain_Readiness_Epoll_PostSelect
+};
+#endif
+
+ILibChain_Readiness* ILibChain_Readiness_Get(void *chain)
+{
+	ILibBaseChain *bchain = (ILibBaseChain*)chain;
+	ILibChain_Readiness *r = (ILibChain_Readiness*)bchain->Readiness;
+	if (r == NULL)
+	{
+		r = (ILibChain_Readiness*)ILibMemory_SmartAllocate(sizeof(ILibChain_Readiness));
+		r->chain = chain;
+		r->pollfd = -1;
+		r->maxfd = -1;
+		r->backend = &ILibChain_Readiness_SelectBackend;
+#ifdef ILibChain_EPOLL
+		if ((r->pollfd = epoll_create1(EPOLL_CLOEXEC)) >= 0 && r->pollfd < FD_SETSIZE)
+		{
+			r->backend = &ILibChain_Readiness_EpollBackend;
+		}
+		else if (r->pollfd >= 0)
+		{
+			close(r->pollfd);
+			r->pollfd = -1;
+		}
+#endif
+		bchain->Readiness = r;
+	}
+	return(r);
+}
+void ILibChain_Readiness_Destroy(void *chain)
+{
+	ILibChain_Readiness *r = (ILibChain_Readiness*)((ILibBaseChain*)chain)->Readiness;
+	if (r != NULL)
+	{
+		if (r->pollfd >= 0) { close(r->pollfd); }
+		if (r->entries != NULL) { free(r->entries); }
+		ILibMemory_Free(r);
+		((ILibBaseChain*)chain)->Readiness = NULL;
+	}
+}
+
+/*! \fn int ILibChain_Readiness_Update(void *chain, int fd, int interest, ILibChain_Readiness_Handler handler, void *user)
+\brief Registers a descriptor with the chain's readiness backend, or updates the interest of a registered descriptor
+\par
+Notifications are one-shot. After \a handler is dispatched, the descriptor must be re-armed by calling this method
+again, which is cheap (no system call) when the descriptor is already armed for the same \a interest.
+<br>Must be called on the microstack thread.
+\param chain Microstack Chain
+\param fd The descriptor to monitor
+\param interest ILibChain_Readiness_Flags to monitor for
+\param handler Dispatched on the microstack thread, after select() returns, but before PostSelect handlers
+\param user Custom user state object
+\return 0 on success, non-zero if the descriptor cannot be monitored by the backend, or ILibChain_Continue() is running
+a subset of the chain's modules. The caller must then use the fd_sets, and drop any registration it already has.
+*/
+int ILibChain_Readiness_Update(void *chain, int fd, int interest, ILibChain_Readiness_Handler handler, void *user)
+{
+	ILibChain_Readiness *r = ILibChain_Readiness_Get(chain);
+	ILibChain_Readiness_Entry *entry;
+
+	if (fd < 0 || r->suspended != 0) { return(1); }
+	if (fd >= r->entriesLength)
+	{
+		int newLength = r->entriesLength == 0 ? 64 : r->entriesLength;
+		while (newLength <= fd) { newLength *= 2; }
+		if ((r->entries = (ILibChain_Readiness_Entry*)realloc(r->entries, newLength * sizeof(ILibChain_Readiness_Entry))) == NULL) { ILIBCRITICALEXIT(254); }
+		memset(r->entries + r->entriesLength, 0, (newLength - r->entriesLength) * sizeof(ILibChain_Readiness_Entry));
+		r->entriesLength = newLength;
+	}
+
+	entry = &(r->entries[fd]);
+	if (entry->handler != NULL && entry->user == user && entry->handler == handler && entry->interest == interest && (entry->armed != 0 || interest == ILibChain_Readiness_NONE))
+	{
+		// Nothing changed
+		return(0);
+	}
+	if (entry->handler == NULL) 
+	{ 
+		++r->count; 
+		if (fd > r->maxfd) { r->maxfd = fd; }
+	}
+
+	entry->handler = handler;
+	entry->user = user;
+	entry->interest = interest;
+	if (r->backend->Arm(r, fd, entry) != 0)
+	{
+		r->backend->Remove(r, fd, entry);
+		memset(entry, 0, sizeof(ILibChain_Readiness_Entry));
+		--r->count;
+		while (r->maxfd >= 0 && r->entries[r->maxfd].handler == NULL) { --r->maxfd; }
+		return(1);
+	}
+	return(0);
+}
+
+/*! \fn void ILibChain_Readiness_Remove(void *chain, int fd, void *user)
+\brief Unregisters a descriptor from the chain's readiness backend. This must be called before the descriptor is closed.
+\param chain Microstack Chain
+\param fd The descriptor to unregister
+\param user The user state object that was registered. If the descriptor is currently registered by a different owner, this is a no-op.
+*/
+void ILibChain_Readiness_Remove(void *chain, int fd, void *user)
+{
+	ILibChain_Readiness *r = (ILibChain_Readiness*)((ILibBaseChain*)chain)->Readiness;
+	if (r == NULL || fd < 0 || fd >= r->entriesLength || r->entries[fd].handler == NULL || r->entries[fd].user != user) { return; }
+
+	r->backend->Remove(r, fd, &(r->entries[fd]));
+	memset(&(r->entries[fd]), 0, sizeof(ILibChain_Readiness_Entry));
+	--r->count;
+	while (r->maxfd >= 0 && r->entries[r->maxfd].handler == NULL) { --r->maxfd; }
+}
+
+//! Fetch the name of the readiness backend used by the chain
+/*!
+	\param chain Microstack Chain
+	\return "epoll" or "select"
+*/
+char* ILibChain_Readiness_GetBackendName(void *chain)
+{
+	return(ILibChain_Readiness_Get(chain)->backend->name);
+}
+void* ILibChain_Readiness_GetUser(void *chain, int fd)
+{
+	ILibChain_Readiness *r = (ILibChain_Readiness*)((ILibBaseChain*)chain)->Readiness;
+	return((r == NULL || fd < 0 || fd >= r->entriesLength) ? NULL : r->entries[fd].user);
+}
+#define ILibChain_Readiness_PreSelect(chain, readset, writeset, errorset) if(((ILibBaseChain*)(chain))->Readiness != NULL) { ((ILibChain_Readiness*)((ILibBaseChain*)(chain))->Readiness)->backend->PreSelect((ILibChain_Readiness*)((ILibBaseChain*)(chain))->Readiness, readset, writeset, errorset); }
+#define ILibChain_Readiness_PostSelect(chain, slct, readset, writeset, errorset) if(((ILibBaseChain*)(chain))->Readiness != NULL) { ((ILibChain_Readiness*)((ILibBaseChain*)(chain))->Readiness)->backend->PostSelect((ILibChain_Readiness*)((ILibBaseChain*)(chain))->Readiness, slct, readset, writeset, errorset); }
+#endif
+
 /*! \fn void ILibChain_DestroyEx(void *subChain)
 \brief Destroys a chain or subchain that was never started.
 \par
@@ -2120,6 +2655,9 @@ void ILibChain_DestroyEx(void *subChain)
 	ILibRemoteLogging_Destroy(((ILibBaseChain*)subChain)->ChainLogger);
 	if(((ILibBaseChain*)subChain)->LoggingWebServerFileTransport != NULL) { ILibTransport_Close(((ILibBaseChain*)subChain)->LoggingWebServerFileTransport); }
 #endif
+#ifndef WIN32
+	ILibChain_Readiness_Destroy(subChain);
+#endif
 
 	free(subChain);
 }
@@ -2390,6 +2928,12 @@ ILibExportMethod ILibChain_Continue_Result ILibChain_Continue(void *Chain, ILibC
 	if (root->continuationState != ILibChain_ContinuationState_INACTIVE && root->continuationState != ILibChain_ContinuationState_END_CONTINUE) { return(ILibChain_Continue_Result_ERROR_INVALID_STATE); }
 	root->continuationState = ILibChain_ContinuationState_CONTINUE;
 	currentNode = root->node;
+#ifndef WIN32
+	//
+	// The readiness backend dispatches for the whole chain, so while only some of the modules run, they use the fd_sets
+	//
+	if (useAllModules == 0) { ILibChain_Readiness_Get(root)->suspended = 1; }
+#endif
 
 	gettimeofday(&startTime, NULL);
 	ILibRemoteLogging_printf(ILibChainGetLogger(chain), ILibRemoteLogging_Modules_Microstack_Generic, ILibRemoteLogging_Flags_VerbosityLevel_1, "ContinueChain...");
@@ -2472,6 +3016,7 @@ ILibExportMethod ILibChain_Continue_Result ILibChain_Continue(void *Chain, ILibC
 		// Put the Read end of the Pipe in the FDSET, for ILibForceUnBlockChain
 		//
 		FD_SET(root->TerminatePipe[0], &readset);
+		if (useAllModules) { ILibChain_Readiness_PreSelect(root, &readset, &writeset, &errorset); }
 #endif
 
 		while (ILibLinkedList_GetCount(((ILibBaseChain*)Chain)->LinksPendingDelete) > 0)
@@ -2542,6 +3087,11 @@ ILibExportMethod ILibChain_Continue_Result ILibChain_Continue(void *Chain, ILibC
 				}
 			}
 		}
+
+		//
+		// Dispatch descriptors registered with the readiness backend, before the PostSelect handlers run
+		//
+		if (useAllModules) { ILibChain_Readiness_PostSelect(root, slct, &readset, &writeset, &errorset); }
 #endif
 		//
 		// Iterate through all of the PostSelect in the chain
@@ -2576,6 +3126,9 @@ ILibExportMethod ILibChain_Continue_Result ILibChain_Continue(void *Chain, ILibC
 
 	ILibRemoteLogging_printf(ILibChainGetLogger(chain), ILibRemoteLogging_Modules_Microstack_Generic, ILibRemoteLogging_Flags_VerbosityLevel_1, "ContinueChain...Ending...");
 	root->node = currentNode;
+#ifndef WIN32
+	if (useAllModules == 0) { ILibChain_Readiness_Get(root)->suspended = 0; }
+#endif
 #ifdef WIN32
 	root->currentHandle = currentHandle;
 	root->currentInfo = currentInfo;
@@ -3343,50 +3896,38 @@ char *ILibChain_GetMetaDataFromDescriptorSetEx(void *chain, fd_set *inr, fd_set
 	return(retStr);
 }
 
+//
+// Returns the milliseconds until the next timer is due (0 if one is already due), or -1 if there are no timers. This is read off the wheel, so
+// a timer in an upper level reports the tick it will be cascaded on, which is never later than its expiration.
+//
 int ILibChain_GetMinimumTimer(void *chain)
 {
-	int minimum = -1;
-	void *node;
-	struct LifeTimeMonitorData *Temp = NULL;
 	struct ILibLifeTime *LifeTimeMonitor = (struct ILibLifeTime*)ILibGetBaseTimer(chain);
-	int64_t current = ILibGetUptime();
+	long long next, current = ILibGetUptime();
 
-	ILibLinkedList_Lock(LifeTimeMonitor->ObjectList);
-	node = ILibLinkedList_GetNode_Head(LifeTimeMonitor->ObjectList);
-	while (node != NULL)
-	{
-		if ((Temp = (struct LifeTimeMonitorData*)ILibLinkedList_GetDataFromNode(node)) == NULL)
-		{
-			node = ILibLinkedList_GetNextNode(node);
-			continue;
-		}
-		minimum = (int)(Temp->ExpirationTick - current);
-		node = NULL;
-	}
-	ILibLinkedList_UnLock(LifeTimeMonitor->ObjectList);
-	return(minimum);
+	ILibSpinLock_Lock(&(LifeTimeMonitor->Lock));
+	next = ILibLifeTime_Wheel_NextTick(LifeTimeMonitor);
+	ILibSpinLock_UnLock(&(LifeTimeMonitor->Lock));
+
+	if (next == -1) { return(-1); }
+	return(next > current ? (int)(next - current) : 0);
 }
 char *ILibChain_GetMetadataForTimers(void *chain)
 {
-	void *node;
-	struct LifeTimeMonitorData *Temp = NULL;
+	struct LifeTimeMonitorData **pending, *Temp = NULL;
 	struct ILibLifeTime *LifeTimeMonitor = (struct ILibLifeTime*)ILibGetBaseTimer(chain);
 	size_t retlen = 0;
 	char *ret = NULL;
-	int i;
+	int i, x, count;
 	int64_t current = ILibGetUptime();
 
-	ILibLinkedList_Lock(LifeTimeMonitor->ObjectList);
+	ILibSpinLock_Lock(&(LifeTimeMonitor->Lock));
+	pending = ILibLifeTime_Snapshot(LifeTimeMonitor, &count);
 	while (1)
 	{
-		node = ILibLinkedList_GetNode_Head(LifeTimeMonitor->ObjectList);
-		while (node != NULL)
+		for (x = 0; x < count; ++x)
 		{
-			if ((Temp = (struct LifeTimeMonitorData*)ILibLinkedList_GetDataFromNode(node)) == NULL)
-			{
-				node = ILibLinkedList_GetNextNode(node);
-				continue;
-			}
+			Temp = pending[x];
 			double ex = (double)(Temp->ExpirationTick - current);
 			char *units = "milliseconds";
 
@@ -3428,7 +3969,6 @@ char *ILibChain_GetMetadataForTimers(void *chain)
 				}
 				if (i > 0) { retlen += i; }
 			}
-			node = ILibLinkedList_GetNextNode(node);
 		}
 
 		if (ret == NULL)
@@ -3441,7 +3981,8 @@ char *ILibChain_GetMetadataForTimers(void *chain)
 			break;
 		}
 	}
-	ILibLinkedList_UnLock(LifeTimeMonitor->ObjectList);
+	ILibSpinLock_UnLock(&(LifeTimeMonitor->Lock));
+	ILibMemory_Free(pending);
 
 	return(ret);
 }
@@ -3457,6 +3998,10 @@ void *ILibChain_GetObjectForDescriptor(void *chain, int fd)
 	fd_set errorset;
 	fd_set writeset;
 
+#ifndef WIN32
+	if ((ret = ILibChain_Readiness_GetUser(chain, fd)) != NULL) { return(ret); }
+#endif
+
 	while (node != NULL && (module = (ILibChain_Link*)ILibLinkedList_GetDataFromNode(node)) != NULL)
 	{
 		if (module->PreSelectHandler != NULL)
@@ -4008,6 +4553,7 @@ ILibExportMethod void ILibStartChain(void *Chain)
 		// Put the Read end of the Pipe in the FDSET, for ILibForceUnBlockChain
 		//
 		FD_SET(chain->TerminatePipe[0], &readset);
+		ILibChain_Readiness_PreSelect(chain, &readset, &writeset, &errorset);
 #endif
 
 		while (ILibLinkedList_GetCount(((ILibBaseChain*)Chain)->LinksPendingDelete) > 0)
@@ -4044,6 +4590,7 @@ ILibExportMethod void ILibStartChain(void *Chain)
 			{
 				if (FD_ISSET(z, &readset) || FD_ISSET(z, &writeset) || FD_ISSET(z, &errorset)) { chain->lastDescriptorCount += 1; }
 			}
+			if (chain->Readiness != NULL) { chain->lastDescriptorCount += ((ILibChain_Readiness*)chain->Readiness)->count; }
 		}
 		slct = select(FD_SETSIZE, &readset, &writeset, &errorset, &tv);
 #endif
@@ -4079,6 +4626,11 @@ ILibExportMethod void ILibStartChain(void *Chain)
 				}
 			}
 		}
+
+		//
+		// Dispatch descriptors registered with the readiness backend, before the PostSelect handlers run
+		//
+		ILibChain_Readiness_PostSelect(chain, slct, &readset, &writeset, &errorset);
 #endif
 		//
 		// Iterate through all of the PostSelect in the chain
@@ -4222,6 +4774,7 @@ ILibExportMethod void ILibStartChain(void *Chain)
 	//
 	close(((ILibBaseChain*)Chain)->TerminatePipe[0]); 
 	close(((ILibBaseChain*)Chain)->TerminatePipe[1]);
+	ILibChain_Readiness_Destroy(Chain);
 
 	((ILibBaseChain*)Chain)->TerminatePipe[0] = 0;
 	((ILibBaseChain*)Chain)->TerminatePipe[1] = 0;
@@ -7491,23 +8044,260 @@ int ILibXmlEscapeEx(char* outdata, const char* indata, size_t indataLen)
 	return (int)(out - outdata);
 }
 
+//
+// Internal helpers used by the ILibLifeTime methods. The caller must be holding the lock.
+//
+#define ILibLifeTime_IndexHash(LifeTimeMonitor, data) ((unsigned int)((((uintptr_t)(data)) >> 3) * 2654435761u) & ((LifeTimeMonitor)->IndexSize - 1))
+void ILibLifeTime_Slot_Append(ILibLifeTime_Slot *slot, struct LifeTimeMonitorData *ltms)
+{
+	ltms->Slot = slot;
+	ltms->Next = NULL;
+	ltms->Prev = slot->Tail;
+	if (slot->Tail != NULL) { slot->Tail->Next = ltms; } else { slot->Head = ltms; }
+	slot->Tail = ltms;
+}
+void ILibLifeTime_Slot_Unlink(struct LifeTimeMonitorData *ltms)
+{
+	ILibLifeTime_Slot *slot = ltms->Slot;
+	if (ltms->Prev != NULL) { ltms->Prev->Next = ltms->Next; } else { slot->Head = ltms->Next; }
+	if (ltms->Next != NULL) { ltms->Next->Prev = ltms->Prev; } else { slot->Tail = ltms->Prev; }
+	ltms->Next = ltms->Prev = NULL;
+	ltms->Slot = NULL;
+}
+void ILibLifeTime_Index_Add(struct ILibLifeTime *LifeTimeMonitor, struct LifeTimeMonitorData *ltms)
+{
+	unsigned int i;
+	if (LifeTimeMonitor->IndexCount >= LifeTimeMonitor->IndexSize)
+	{
+		// Grow the index
+		struct LifeTimeMonitorData **old = LifeTimeMonitor->Index, *e, *n;
+		unsigned int oldSize = LifeTimeMonitor->IndexSize;
+
+		LifeTimeMonitor->IndexSize = oldSize == 0 ? ILibLifeTime_INDEX_INITIAL_SIZE : (oldSize * 2);
+		if ((LifeTimeMonitor->Index = (struct LifeTimeMonitorData**)calloc(LifeTimeMonitor->IndexSize, sizeof(struct LifeTimeMonitorData*))) == NULL) { ILIBCRITICALEXIT(254); }
+		for (i = 0; i < oldSize; ++i)
+		{
+			for (e = old[i]; e != NULL; e = n)
+			{
+				unsigned int h = ILibLifeTime_IndexHash(LifeTimeMonitor, e->data);
+				n = e->IndexNext;
+				e->IndexPrev = NULL;
+				e->IndexNext = LifeTimeMonitor->Index[h];
+				if (e->IndexNext != NULL) { e->IndexNext->IndexPrev = e; }
+				LifeTimeMonitor->Index[h] = e;
+			}
+		}
+		if (old != NULL) { free(old); }
+	}
+	i = ILibLifeTime_IndexHash(LifeTimeMonitor, ltms->data);
+	ltms->IndexPrev = NULL;
+	ltms->IndexNext = LifeTimeMonitor->Index[i];
+	if (ltms->IndexNext != NULL) { ltms->IndexNext->IndexPrev = ltms; }
+	LifeTimeMonitor->Index[i] = ltms;
+	++LifeTimeMonitor->IndexCount;
+}
+void ILibLifeTime_Index_Remove(struct ILibLifeTime *LifeTimeMonitor, struct LifeTimeMonitorData *ltms)
+{
+	if (ltms->IndexPrev != NULL) { ltms->IndexPrev->IndexNext = ltms->IndexNext; }
+	else { LifeTimeMonitor->Index[ILibLifeTime_IndexHash(LifeTimeMonitor, ltms->data)] = ltms->IndexNext; }
+	if (ltms->IndexNext != NULL) { ltms->IndexNext->IndexPrev = ltms->IndexPrev; }
+	ltms->IndexNext = ltms->IndexPrev = NULL;
+	--LifeTimeMonitor->IndexCount;
+}
+int ILibLifeTime_Wheel_Level(struct ILibLifeTime *LifeTimeMonitor, ILibLifeTime_Slot *slot)
+{
+	if (slot >= &(LifeTimeMonitor->Wheel[0][0]) && slot <= &(LifeTimeMonitor->Wheel[ILibLifeTime_WHEEL_LEVELS - 1][ILibLifeTime_WHEEL_MASK]))
+	{
+		return((int)((slot - &(LifeTimeMonitor->Wheel[0][0])) / ILibLifeTime_WHEEL_SIZE));
+	}
+	return(-1);
+}
+void ILibLifeTime_Wheel_Insert(struct ILibLifeTime *LifeTimeMonitor, struct LifeTimeMonitorData *ltms)
+{
+	long long delta;
+	int level;
+
+	if (ltms->ExpirationTick == 0)
+	{
+		// Zero timeouts are dispatched in FIFO order, on the next pass of the chain
+		ILibLifeTime_Slot_Append(&(LifeTimeMonitor->Immediate), ltms);
+		return;
+	}
+
+	delta = ltms->ExpirationTick - LifeTimeMonitor->WheelTick;
+	if (delta < 0)
+	{
+		// Already expired, so put it in the very next slot to be processed
+		ILibLifeTime_Slot_Append(&(LifeTimeMonitor->Wheel[0][LifeTimeMonitor->WheelTick & ILibLifeTime_WHEEL_MASK]), ltms);
+		++LifeTimeMonitor->LevelCount[0];
+		return;
+	}
+	for (level = 0; level < ILibLifeTime_WHEEL_LEVELS; ++level)
+	{
+		if (delta < (1LL << (ILibLifeTime_WHEEL_BITS * (level + 1))))
+		{
+			ILibLifeTime_Slot_Append(&(LifeTimeMonitor->Wheel[level][(ltms->ExpirationTick >> (ILibLifeTime_WHEEL_BITS * level)) & ILibLifeTime_WHEEL_MASK]), ltms);
+			++LifeTimeMonitor->LevelCount[level];
+			return;
+		}
+	}
+	ILibLifeTime_Slot_Append(&(LifeTimeMonitor->Overflow), ltms);
+}
+void ILibLifeTime_Wheel_Unlink(struct ILibLifeTime *LifeTimeMonitor, struct LifeTimeMonitorData *ltms)
+{
+	int level = ILibLifeTime_Wheel_Level(LifeTimeMonitor, ltms->Slot);
+	if (level >= 0) { --LifeTimeMonitor->LevelCount[level]; }
+	ILibLifeTime_Slot_Unlink(ltms);
+}
+void ILibLifeTime_Wheel_Cascade(struct ILibLifeTime *LifeTimeMonitor, ILibLifeTime_Slot *slot)
+{
+	struct LifeTimeMonitorData *ltms;
+	while ((ltms = slot->Head) != NULL)
+	{
+		ILibLifeTime_Wheel_Unlink(LifeTimeMonitor, ltms);
+		ILibLifeTime_Wheel_Insert(LifeTimeMonitor, ltms);
+	}
+}
+//
+// Turns the wheel up to (but not including) CurrentTick, and moves everything that expired into the firing queue
+//
+void ILibLifeTime_Wheel_Advance(struct ILibLifeTime *LifeTimeMonitor, long long CurrentTick, ILibLifeTime_Slot *firing)
+{
+	struct LifeTimeMonitorData *ltms;
+	int level, top, index;
+
+	while (LifeTimeMonitor->WheelTick < CurrentTick)
+	{
+		if ((LifeTimeMonitor->WheelTick & ILibLifeTime_WHEEL_MASK) == 0)
+		{
+			//
+			// Level 0 wrapped, so cascade the current slot of each upper level that also wrapped. This is
+			// done from the top down, so that cascaded timers are not dropped into a slot that was already processed.
+			//
+			for (top = 1; top < ILibLifeTime_WHEEL_LEVELS && ((LifeTimeMonitor->WheelTick >> (ILibLifeTime_WHEEL_BITS * top)) & ILibLifeTime_WHEEL_MASK) == 0; ++top);
+			if (top == ILibLifeTime_WHEEL_LEVELS) { ILibLifeTime_Wheel_Cascade(LifeTimeMonitor, &(LifeTimeMonitor->Overflow)); --top; }
+			for (level = top; level > 0; --level)
+			{
+				index = (int)((LifeTimeMonitor->WheelTick >> (ILibLifeTime_WHEEL_BITS * level)) & ILibLifeTime_WHEEL_MASK);
+				ILibLifeTime_Wheel_Cascade(LifeTimeMonitor, &(LifeTimeMonitor->Wheel[level][index]));
+			}
+		}
+
+		index = (int)(LifeTimeMonitor->WheelTick & ILibLifeTime_WHEEL_MASK);
+		while ((ltms = LifeTimeMonitor->Wheel[0][index].Head) != NULL)
+		{
+			ILibLifeTime_Wheel_Unlink(LifeTimeMonitor, ltms);
+			ILibLifeTime_Slot_Append(firing, ltms);
+			ltms->Firing = 1;
+			--LifeTimeMonitor->ObjectCount;
+		}
+
+		if (LifeTimeMonitor->LevelCount[0] != 0)
+		{
+			++LifeTimeMonitor->WheelTick;
+		}
+		else
+		{
+			// Nothing left in level 0, so skip ahead to the next cascade of the lowest level that has something in it
+			for (level = 1; level < ILibLifeTime_WHEEL_LEVELS && LifeTimeMonitor->LevelCount[level] == 0; ++level);
+			if (level == ILibLifeTime_WHEEL_LEVELS && LifeTimeMonitor->Overflow.Head == NULL)
+			{
+				LifeTimeMonitor->WheelTick = CurrentTick;
+			}
+			else
+			{
+				LifeTimeMonitor->WheelTick = (LifeTimeMonitor->WheelTick | ((1LL << (ILibLifeTime_WHEEL_BITS * level)) - 1)) + 1;
+				if (LifeTimeMonitor->WheelTick > CurrentTick) { LifeTimeMonitor->WheelTick = CurrentTick; }
+			}
+		}
+	}
+}
+//
+// Returns the tick of the next timer, or -1 if there are no timers. For timers in the upper levels this is
+// the tick at which the timer will be cascaded, which is never later than the actual expiration.
+//
+long long ILibLifeTime_Wheel_NextTick(struct ILibLifeTime *LifeTimeMonitor)
+{
+	long long ret = -1, t;
+	int level, i;
+
+	if (LifeTimeMonitor->Immediate.Head != NULL) { return(0); }
+	if (LifeTimeMonitor->LevelCount[0] > 0)
+	{
+		for (i = 0; i < ILibLifeTime_WHEEL_SIZE; ++i)
+		{
+			t = LifeTimeMonitor->WheelTick + i;
+			if (LifeTimeMonitor->Wheel[0][t & ILibLifeTime_WHEEL_MASK].Head != NULL)
+			{
+				ret = LifeTimeMonitor->Wheel[0][t & ILibLifeTime_WHEEL_MASK].Head->ExpirationTick;
+				break;
+			}
+		}
+	}
+	for (level = 1; level < ILibLifeTime_WHEEL_LEVELS; ++level)
+	{
+		if (LifeTimeMonitor->LevelCount[level] == 0) { continue; }
+
+		// The current slot of this level has already been cascaded, unless the wheel is sitting right on the boundary
+		for (i = (LifeTimeMonitor->WheelTick & ((1LL << (ILibLifeTime_WHEEL_BITS * level)) - 1)) == 0 ? 0 : 1; i <= ILibLifeTime_WHEEL_SIZE; ++i)
+		{
+			t = (LifeTimeMonitor->WheelTick >> (ILibLifeTime_WHEEL_BITS * level)) + i;
+			if (LifeTimeMonitor->Wheel[level][t & ILibLifeTime_WHEEL_MASK].Head != NULL)
+			{
+				t = t << (ILibLifeTime_WHEEL_BITS * level);
+				if (ret == -1 || t < ret) { ret = t; }
+				break;
+			}
+		}
+	}
+	if (LifeTimeMonitor->Overflow.Head != NULL)
+	{
+		t = ((LifeTimeMonitor->WheelTick + ((1LL << (ILibLifeTime_WHEEL_BITS * ILibLifeTime_WHEEL_LEVELS)) - 1)) >> (ILibLifeTime_WHEEL_BITS * ILibLifeTime_WHEEL_LEVELS)) << (ILibLifeTime_WHEEL_BITS * ILibLifeTime_WHEEL_LEVELS);
+		if (ret == -1 || t < ret) { ret = t; }
+	}
+	return(ret);
+}
+//
+// Returns a snapshot of all the pending timers, roughly in the order they will be triggered. The caller must be holding the lock.
+//
+struct LifeTimeMonitorData** ILibLifeTime_Snapshot(struct ILibLifeTime *LifeTimeMonitor, int *count)
+{
+	struct LifeTimeMonitorData **ret, *ltms;
+	int level, i, x = 0;
+
+	ret = (struct LifeTimeMonitorData**)ILibMemory_SmartAllocate((LifeTimeMonitor->ObjectCount + 1) * sizeof(struct LifeTimeMonitorData*));
+	for (ltms = LifeTimeMonitor->Immediate.Head; ltms != NULL && x < LifeTimeMonitor->ObjectCount; ltms = ltms->Next) { ret[x++] = ltms; }
+	for (level = 0; level < ILibLifeTime_WHEEL_LEVELS; ++level)
+	{
+		if (LifeTimeMonitor->LevelCount[level] == 0) { continue; }
+		for (i = 0; i < ILibLifeTime_WHEEL_SIZE; ++i)
+		{
+			long long t = (LifeTimeMonitor->WheelTick >> (ILibLifeTime_WHEEL_BITS * level)) + i;
+			for (ltms = LifeTimeMonitor->Wheel[level][t & ILibLifeTime_WHEEL_MASK].Head; ltms != NULL && x < LifeTimeMonitor->ObjectCount; ltms = ltms->Next) { ret[x++] = ltms; }
+		}
+	}
+	for (ltms = LifeTimeMonitor->Overflow.Head; ltms != NULL && x < LifeTimeMonitor->ObjectCount; ltms = ltms->Next) { ret[x++] = ltms; }
+	*count = x;
+	return(ret);
+}
+
 // Return the number of milliseconds until trigger, -1 if not found.
 long long ILibLifeTime_GetExpiration(void *LifetimeMonitorObject, void *data)
 {
-	void *node;
+	long long ret = -1;
 	struct LifeTimeMonitorData *temp;
 	struct ILibLifeTime *LifeTimeMonitor = (struct ILibLifeTime*)LifetimeMonitorObject;
 
-	node = ILibLinkedList_GetNode_Head(LifeTimeMonitor->ObjectList);
-	while (node != NULL)
+	ILibSpinLock_Lock(&(LifeTimeMonitor->Lock));
+	if (LifeTimeMonitor->IndexSize > 0)
 	{
-		if ((temp = (struct LifeTimeMonitorData*)ILibLinkedList_GetDataFromNode(node)) != NULL)
+		for (temp = LifeTimeMonitor->Index[ILibLifeTime_IndexHash(LifeTimeMonitor, data)]; temp != NULL; temp = temp->IndexNext)
 		{
-			if (temp->data == data) return temp->ExpirationTick;
+			if (temp->data == data && temp->Firing == 0 && (ret == -1 || temp->ExpirationTick < ret)) { ret = temp->ExpirationTick; }
 		}
-		node = ILibLinkedList_GetNextNode(node);
 	}
-	return -1;
+	ILibSpinLock_UnLock(&(LifeTimeMonitor->Lock));
+	return(ret);
 }
 
 /*! \fn ILibLifeTime_AddEx4(void *LifetimeMonitorObject,void *data, int ms, void* Callback, void* Destroy)
@@ -7523,10 +8313,9 @@ long long ILibLifeTime_GetExpiration(void *LifetimeMonitorObject, void *data)
 */
 ILibLifeTime_Token ILibLifeTime_AddEx4(void *LifetimeMonitorObject, void *data, int ms, ILibLifeTime_OnCallback Callback, ILibLifeTime_OnCallback Destroy, char *file, uint32_t line, char *metadata)
 {
-	struct LifeTimeMonitorData *temp;
 	struct LifeTimeMonitorData *ltms;
 	struct ILibLifeTime *LifeTimeMonitor = (struct ILibLifeTime*)LifetimeMonitorObject;
-	void *node;
+	int unblock = 0;
 
 	if (LifetimeMonitorObject == NULL)
 	{
@@ -7556,43 +8345,21 @@ ILibLifeTime_Token ILibLifeTime_AddEx4(void *LifetimeMonitorObject, void *data,
 		strcpy_s(ltms->metadata, ILibMemory_Size(ltms->metadata), metadata);
 	}
 
-	ILibLinkedList_Lock(LifeTimeMonitor->ObjectList);
+	ILibSpinLock_Lock(&(LifeTimeMonitor->Lock));
 
-	// Add the node to the list
-	node = ILibLinkedList_GetNode_Head(LifeTimeMonitor->ObjectList);
-	if (node == NULL)
-	{
-		ILibLinkedList_AddTail(LifeTimeMonitor->ObjectList, ltms);
-		ILibForceUnBlockChain(LifeTimeMonitor->ChainLink.ParentChain);
-	}
-	else
-	{
-		while (node != NULL)
-		{
-			if ((temp = (struct LifeTimeMonitorData*)ILibLinkedList_GetDataFromNode(node)) != NULL)
-			{
-				if (ltms->ExpirationTick < temp->ExpirationTick)
-				{
-					ILibLinkedList_InsertBefore(node, ltms);
-					break;
-				}
-			}
-			node = ILibLinkedList_GetNextNode(node);
-		}
-		if (node == NULL)
-		{
-			ILibLinkedList_AddTail(LifeTimeMonitor->ObjectList,ltms);
-		}
-		else if (ILibLinkedList_GetDataFromNode(ILibLinkedList_GetNode_Head(LifeTimeMonitor->ObjectList)) == ltms)
-		{
-			ILibForceUnBlockChain(LifeTimeMonitor->ChainLink.ParentChain);
-		}
-	}
+	ILibLifeTime_Wheel_Insert(LifeTimeMonitor, ltms);
+	ILibLifeTime_Index_Add(LifeTimeMonitor, ltms);
+	++LifeTimeMonitor->ObjectCount;
 
-	// If this notification is sooner than the existing one, replace it.
-	if (LifeTimeMonitor->NextTriggerTick > ltms->ExpirationTick || LifeTimeMonitor->NextTriggerTick == -1) LifeTimeMonitor->NextTriggerTick = ltms->ExpirationTick;
+	// If this notification is sooner than the existing one, replace it, and unblock the chain so it can recalculate the timeout
+	if (LifeTimeMonitor->NextTriggerTick > ltms->ExpirationTick || LifeTimeMonitor->NextTriggerTick == -1) 
+	{ 
+		LifeTimeMonitor->NextTriggerTick = ltms->ExpirationTick;
+		unblock = 1;
+	}
 
-	ILibLinkedList_UnLock(LifeTimeMonitor->ObjectList);
+	ILibSpinLock_UnLock(&(LifeTimeMonitor->Lock));
+	if (unblock != 0) { ILibForceUnBlockChain(LifeTimeMonitor->ChainLink.ParentChain); }
 	return((void*)ltms);
 }
 
@@ -7615,11 +8382,10 @@ char *ILibLifeTime_GetCurrentTriggeredMetadata(void* LifeTimeMonitorObject)
 // 
 void ILibLifeTime_Check(void *LifeTimeMonitorObject, fd_set *readset, fd_set *writeset, fd_set *errorset, int* blocktime)
 {
-	void *node;
 	int removed;
-	void *EventQueue;
+	ILibLifeTime_Slot EventQueue;
 	long long CurrentTick;
-	struct LifeTimeMonitorData *EVT, *Temp = NULL;
+	struct LifeTimeMonitorData *EVT;
 	struct ILibLifeTime *LifeTimeMonitor = (struct ILibLifeTime*)LifeTimeMonitorObject;
 
 	UNREFERENCED_PARAMETER( readset );
@@ -7627,6 +8393,14 @@ void ILibLifeTime_Check(void *LifeTimeMonitorObject, fd_set *readset, fd_set *wr
 	UNREFERENCED_PARAMETER( errorset );
 
 
+	//
+	// The BaseTimer is responsible for dispatching work posted with ILibChain_RunOnMicrostackThread
+	//
+	if (((ILibBaseChain*)LifeTimeMonitor->ChainLink.ParentChain)->Timer == LifeTimeMonitor && ILibChain_WorkQueue_Drain((ILibBaseChain*)LifeTimeMonitor->ChainLink.ParentChain) != 0)
+	{
+		*blocktime = 0;
+	}
+
 	//
 	// Get the current tick count for reference
 	//
@@ -7640,54 +8414,40 @@ void ILibLifeTime_Check(void *LifeTimeMonitorObject, fd_set *readset, fd_set *wr
 		*blocktime = (int)(LifeTimeMonitor->NextTriggerTick - CurrentTick);
 		return;
 	}
-	LifeTimeMonitor->NextTriggerTick = -1;
 
-	// This is an optimization. We are going to create the root of this linked list on the stack instead of the heap.
-	EventQueue = ILibMemory_AllocateA(sizeof(ILibLinkedListNode_Root));
+	memset(&EventQueue, 0, sizeof(EventQueue));
+	ILibSpinLock_Lock(&(LifeTimeMonitor->Lock));
 
-	ILibLinkedList_Lock(LifeTimeMonitor->Reserved);
-	ILibLinkedList_Lock(LifeTimeMonitor->ObjectList);
-
-	while (ILibQueue_DeQueue(LifeTimeMonitor->Reserved) != NULL);
-
-	node = ILibLinkedList_GetNode_Head(LifeTimeMonitor->ObjectList);
-	while (node != NULL)
+	// Zero timeouts go first, followed by everything that expired, in order
+	while ((EVT = LifeTimeMonitor->Immediate.Head) != NULL)
 	{
-		if ((Temp = (struct LifeTimeMonitorData*)ILibLinkedList_GetDataFromNode(node)) == NULL)
-		{
-			node = ILibLinkedList_GetNextNode(node);
-			continue;
-		}
-		if (Temp->ExpirationTick == 0 || Temp->ExpirationTick < CurrentTick)
-		{
-			ILibQueue_EnQueue(EventQueue, Temp);
-			node = ILibLinkedList_Remove(node);
-		}
-		else
-		{
-			if (LifeTimeMonitor->NextTriggerTick == -1 || Temp->ExpirationTick < LifeTimeMonitor->NextTriggerTick) LifeTimeMonitor->NextTriggerTick = Temp->ExpirationTick; // Save the next smallest value
-			node = ILibLinkedList_GetNextNode(node);
-		}
+		ILibLifeTime_Slot_Unlink(EVT);
+		ILibLifeTime_Slot_Append(&EventQueue, EVT);
+		EVT->Firing = 1;
+		--LifeTimeMonitor->ObjectCount;
 	}
+	// Timers that expire on this tick fire now. The sorted list waited for the next tick (ExpirationTick < CurrentTick), so
+	// timers fire up to a tick sooner than they used to, instead of a whole block time later.
+	ILibLifeTime_Wheel_Advance(LifeTimeMonitor, CurrentTick + 1, &EventQueue);
+	LifeTimeMonitor->NextTriggerTick = ILibLifeTime_Wheel_NextTick(LifeTimeMonitor);
 
-	ILibLinkedList_UnLock(LifeTimeMonitor->ObjectList);
-	ILibLinkedList_UnLock(LifeTimeMonitor->Reserved);
+	ILibSpinLock_UnLock(&(LifeTimeMonitor->Lock));
 
 	//
 	// Iterate through all the triggers that we need to fire
 	//
-	node = ILibQueue_DeQueue(EventQueue);
-	while (node != NULL)
+	while ((EVT = EventQueue.Head) != NULL)
 	{
 		//
-		// Check to see if the item to be fired, is in the remove list.
-		// If it is, that means we shouldn't fire this item anymore.
+		// Check to see if the item to be fired was removed while it was queued.
+		// If it was, that means we shouldn't fire this item anymore.
 		//
-		ILibLinkedList_Lock(LifeTimeMonitor->Reserved);
-		removed = ILibLinkedList_Remove_ByData(LifeTimeMonitor->Reserved,((struct LifeTimeMonitorData*)node)->data);
-		ILibLinkedList_UnLock(LifeTimeMonitor->Reserved);
+		ILibSpinLock_Lock(&(LifeTimeMonitor->Lock));
+		ILibLifeTime_Slot_Unlink(EVT);
+		ILibLifeTime_Index_Remove(LifeTimeMonitor, EVT);
+		removed = EVT->Removed;
+		ILibSpinLock_UnLock(&(LifeTimeMonitor->Lock));
 
-		EVT = (struct LifeTimeMonitorData*)node;
 		if (removed == 0)
 		{
 			// Trigger the callback
@@ -7705,7 +8465,6 @@ void ILibLifeTime_Check(void *LifeTimeMonitorObject, fd_set *readset, fd_set *wr
 		}
 		ILibMemory_Free(EVT->metadata);
 		free(EVT);
-		node = ILibQueue_DeQueue(EventQueue);
 	}
 
 	// Compute how much time until next trigger
@@ -7723,57 +8482,52 @@ void ILibLifeTime_Check(void *LifeTimeMonitorObject, fd_set *readset, fd_set *wr
 */
 void ILibLifeTime_Remove(void *LifeTimeToken, void *data)
 {
-	void *node;
 	int removed = 0;
-	struct LifeTimeMonitorData *evt;
+	struct LifeTimeMonitorData *evt, *next;
 	struct ILibLifeTime *UPnPLifeTime = (struct ILibLifeTime*)LifeTimeToken;
-	void *EventQueue;
+	ILibLifeTime_Slot EventQueue;
 
-	if (UPnPLifeTime == NULL || UPnPLifeTime->ObjectList == NULL) return;
-	EventQueue = ILibQueue_Create();
-	ILibLinkedList_Lock(UPnPLifeTime->ObjectList);
+	if (UPnPLifeTime == NULL || UPnPLifeTime->ChainLink.ParentChain == NULL) return;
+	memset(&EventQueue, 0, sizeof(EventQueue));
+	ILibSpinLock_Lock(&(UPnPLifeTime->Lock));
 
-	node = ILibLinkedList_GetNode_Head(UPnPLifeTime->ObjectList);
-	if (node != NULL)
+	if (UPnPLifeTime->IndexSize > 0)
 	{
-		while (node != NULL)
+		for (evt = UPnPLifeTime->Index[ILibLifeTime_IndexHash(UPnPLifeTime, data)]; evt != NULL; evt = next)
 		{
-			evt = (struct LifeTimeMonitorData*)ILibLinkedList_GetDataFromNode(node);
-			if (evt!=NULL && evt->data == data)
+			next = evt->IndexNext;
+			if (evt->data == data && evt->Firing == 0)
 			{
-				ILibQueue_EnQueue(EventQueue, evt);
-				node = ILibLinkedList_Remove(node);
+				ILibLifeTime_Wheel_Unlink(UPnPLifeTime, evt);
+				ILibLifeTime_Index_Remove(UPnPLifeTime, evt);
+				ILibLifeTime_Slot_Append(&EventQueue, evt);
+				--UPnPLifeTime->ObjectCount;
 				removed = 1;
 			}
-			else
+		}
+		if (removed == 0)
+		{
+			//
+			// The item wasn't pending, so maybe it is queued to be triggered
+			//
+			for (evt = UPnPLifeTime->Index[ILibLifeTime_IndexHash(UPnPLifeTime, data)]; evt != NULL; evt = evt->IndexNext)
 			{
-				node = ILibLinkedList_GetNextNode(node);
+				if (evt->data == data && evt->Firing != 0 && evt->Removed == 0) { evt->Removed = 1; break; }
 			}
 		}
 	}
-	if (removed == 0)
-	{
-		//
-		// The item wasn't in the list, so maybe it is pending to be triggered
-		//
-		ILibLinkedList_Lock(UPnPLifeTime->Reserved);
-		ILibLinkedList_AddTail(UPnPLifeTime->Reserved, data);
-		ILibLinkedList_UnLock(UPnPLifeTime->Reserved);
-	}
-	ILibLinkedList_UnLock(UPnPLifeTime->ObjectList);
+	ILibSpinLock_UnLock(&(UPnPLifeTime->Lock));
 
 	//
 	// Iterate through each node that is to be removed
 	//
-	evt = (struct LifeTimeMonitorData*)ILibQueue_DeQueue(EventQueue);
-	while (evt != NULL)
+	while ((evt = EventQueue.Head) != NULL)
 	{
+		ILibLifeTime_Slot_Unlink(evt);
 		if (evt->DestroyPtr != NULL) {evt->DestroyPtr(evt->data);}
 		ILibMemory_Free(evt->metadata);
 		free(evt);
-		evt = (struct LifeTimeMonitorData*)ILibQueue_DeQueue(EventQueue);
 	}
-	ILibQueue_Destroy(EventQueue);
 }
 
 /*! \fn ILibLifeTime_Flush(void *LifeTimeToken)
@@ -7783,18 +8537,34 @@ void ILibLifeTime_Remove(void *LifeTimeToken, void *data)
 void ILibLifeTime_Flush(void *LifeTimeToken)
 {
 	struct ILibLifeTime *UPnPLifeTime = (struct ILibLifeTime*)LifeTimeToken;
-	struct LifeTimeMonitorData *temp;
+	struct LifeTimeMonitorData **pending;
+	int count, i;
 
-	ILibLinkedList_Lock(UPnPLifeTime->ObjectList);
+	ILibSpinLock_Lock(&(UPnPLifeTime->Lock));
+	pending = ILibLifeTime_Snapshot(UPnPLifeTime, &count);
+	for (i = 0; i < count; ++i)
+	{
+		if (pending[i]->Slot != &(UPnPLifeTime->Immediate))
+		{
+			ILibLifeTime_Wheel_Unlink(UPnPLifeTime, pending[i]);
+		}
+		else
+		{
+			ILibLifeTime_Slot_Unlink(pending[i]);
+		}
+		ILibLifeTime_Index_Remove(UPnPLifeTime, pending[i]);
+		--UPnPLifeTime->ObjectCount;
+	}
+	UPnPLifeTime->NextTriggerTick = -1;
+	ILibSpinLock_UnLock(&(UPnPLifeTime->Lock));
 
-	temp = (struct LifeTimeMonitorData*)ILibQueue_DeQueue(UPnPLifeTime->ObjectList);
-	while (temp != NULL)
+	for (i = 0; i < count; ++i)
 	{
-		if (temp->DestroyPtr != NULL) temp->DestroyPtr(temp->data);
-		free(temp);
-		temp = (struct LifeTimeMonitorData*)ILibQueue_DeQueue(UPnPLifeTime->ObjectList);
+		if (pending[i]->DestroyPtr != NULL) { pending[i]->DestroyPtr(pending[i]->data); }
+		ILibMemory_Free(pending[i]->metadata);
+		free(pending[i]);
 	}
-	ILibLinkedList_UnLock(UPnPLifeTime->ObjectList);
+	ILibMemory_Free(pending);
 }
 
 //
@@ -7803,11 +8573,15 @@ void ILibLifeTime_Flush(void *LifeTimeToken)
 void ILibLifeTime_Destroy(void *LifeTimeToken)
 {
 	struct ILibLifeTime *UPnPLifeTime = (struct ILibLifeTime*)LifeTimeToken;
+	if (((ILibBaseChain*)UPnPLifeTime->ChainLink.ParentChain)->Timer == UPnPLifeTime)
+	{
+		ILibChain_WorkQueue_Abort((ILibBaseChain*)UPnPLifeTime->ChainLink.ParentChain);
+	}
 	ILibLifeTime_Flush(LifeTimeToken);
-	ILibLinkedList_Destroy(UPnPLifeTime->ObjectList);
-	ILibQueue_Destroy(UPnPLifeTime->Reserved);
+	if (UPnPLifeTime->Index != NULL) { free(UPnPLifeTime->Index); }
+	UPnPLifeTime->Index = NULL;
+	UPnPLifeTime->IndexSize = UPnPLifeTime->IndexCount = 0;
 	UPnPLifeTime->ObjectCount = 0;
-	UPnPLifeTime->ObjectList = NULL;
 }
 
 /*! \fn ILibCreateLifeTime(void *Chain)
@@ -7824,11 +8598,12 @@ void *ILibCreateLifeTime(void *Chain)
 	memset(RetVal,0,sizeof(struct ILibLifeTime));
 
 	RetVal->ChainLink.MetaData = ILibMemory_SmartAllocate_FromString("ILibLifeTime");
-	RetVal->ObjectList = ILibLinkedList_Create();
 	RetVal->ChainLink.PreSelectHandler = &ILibLifeTime_Check;
 	RetVal->ChainLink.DestroyHandler = &ILibLifeTime_Destroy;
 	RetVal->ChainLink.ParentChain = Chain;
-	RetVal->Reserved = ILibQueue_Create();
+	RetVal->NextTriggerTick = -1;
+	RetVal->WheelTick = ILibGetUptime();
+	ILibSpinLock_Init(&(RetVal->Lock));
 
 	ILibAddToChain(Chain, RetVal);
 	return((void*)RetVal);
@@ -7838,7 +8613,7 @@ void *ILibCreateLifeTime(void *Chain)
 long ILibLifeTime_Count(void* LifeTimeToken)
 {
 	struct ILibLifeTime *UPnPLifeTime = (struct ILibLifeTime*)LifeTimeToken;
-	return ILibQueue_GetCount(UPnPLifeTime->ObjectList);
+	return(UPnPLifeTime->ObjectCount);
 }
 
 /*! \fn ILibFindEntryInTable(char *Entry, char **Table)
@@ -9672,7 +10447,7 @@ long long ILibGetUptime()
 	struct timespec ts; 
 	memset(&ts, 0, sizeof ts);
 	clock_gettime(CLOCK_MONOTONIC, &ts);
-	return (((long long)ts.tv_sec) * 1000) + ((((long long)ts.tv_nsec) / 1000) % 1000);
+	return (((long long)ts.tv_sec) * 1000) + (((long long)ts.tv_nsec) / 1000000);
 }
 #endif
 
@@ -1070,6 +1070,27 @@ int ILibIsRunningOnChainThread(void* chain);
 	char *ILibChain_GetMetadataForTimers(void *chain);
 	int ILibChain_GetMinimumTimer(void *chain);
 	ILibChain_Link **ILibChain_GetModules(void *chain);
+#ifndef WIN32
+	//
+	// Readiness Backend
+	//
+	// Links can register a descriptor once, and only report changes in interest, instead of
+	// re-filling fd_sets on every pass of the chain. On Linux the descriptors are tracked with
+	// epoll, otherwise they are merged into the select() sets by the chain.
+	//
+	typedef enum ILibChain_Readiness_Flags
+	{
+		ILibChain_Readiness_NONE = 0x00,
+		ILibChain_Readiness_READ = 0x01,
+		ILibChain_Readiness_WRITE = 0x02,
+		ILibChain_Readiness_ERROR = 0x04
+	}ILibChain_Readiness_Flags;
+	typedef void(*ILibChain_Readiness_Handler)(void *chain, int fd, int events, void *user);
+
+	int ILibChain_Readiness_Update(void *chain, int fd, int interest, ILibChain_Readiness_Handler handler, void *user);
+	void ILibChain_Readiness_Remove(void *chain, int fd, void *user);
+	char* ILibChain_Readiness_GetBackendName(void *chain);
+#endif
 #ifdef WIN32
 	typedef void(*ILib_GenericReadHandler)(char *buffer, int bufferLen, DWORD* bytesConsumed, void* user1, void *user2);
 	typedef BOOL(*ILibChain_ReadEx_Handler)(void *chain, HANDLE h, ILibWaitHandle_ErrorStatus status, char *buffer, DWORD bytesRead, void* user);
@@ -1134,6 +1155,7 @@ int ILibIsRunningOnChainThread(void* chain);
 
 	void ILibForceUnBlockChain(void *Chain);
 	void* ILibChain_RunOnMicrostackThreadEx3(void *chain, ILibChain_StartEvent handler, ILibChain_StartEvent abortHandler, void *user);
+	int ILibChain_WorkQueue_IsClosed(void *chain);
 	#define ILibChain_RunOnMicrostackThreadEx2(chain, handler, user, freeOnShutdown) ILibChain_RunOnMicrostackThreadEx3(chain, handler, ((freeOnShutdown) == 0 ? (void*)0x00 : (void*)0x01), user)
 	#define ILibChain_RunOnMicrostackThreadEx(chain, handler, user) ILibChain_RunOnMicrostackThreadEx2(chain, handler, user, 0)
 	#define ILibChain_RunOnMicrostackThread(chain, handler, user) if(ILibIsRunningOnChainThread(chain)==0){ILibChain_RunOnMicrostackThreadEx(chain, handler, user);}else{handler(chain,user);}
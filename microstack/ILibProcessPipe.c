@@ -45,6 +45,11 @@ limitations under the License.
 		#include <libutil.h>
 	#endif
 #endif
+#ifndef ILibProcessPipe_NO_POSIX_SPAWN
+	#include <spawn.h>
+	#define ILibProcessPipe_POSIX_SPAWN
+	extern char **environ;
+#endif
 #endif
 
 
@@ -504,6 +509,112 @@ void ILibProcessPipe_Process_HardKill(ILibProcessPipe_Process p)
 
 
 
+#ifdef ILibProcessPipe_POSIX_SPAWN
+//
+// Builds the environment for posix_spawn(): the current environment, with the name/value pairs in envvars added or replaced.
+// The strings from ret[*allocated] on were allocated here.
+//
+char** ILibProcessPipe_PosixSpawn_Environment(void *envvars, size_t *allocated)
+{
+	char **ret, **e, **v;
+	size_t count = 0, len, i;
+
+	for (e = environ; e != NULL && *e != NULL; ++e) { ++count; }
+	for (v = (char**)envvars; v[0] != NULL; v += 2) { ++count; }
+	if ((ret = (char**)malloc((count + 1) * sizeof(char*))) == NULL) { ILIBCRITICALEXIT(254); }
+
+	i = 0;
+	for (e = environ; e != NULL && *e != NULL; ++e)
+	{
+		for (v = (char**)envvars; v[0] != NULL; v += 2)
+		{
+			len = strlen(v[0]);
+			if (strncmp(*e, v[0], len) == 0 && (*e)[len] == '=') { break; }
+		}
+		if (v[0] == NULL) { ret[i++] = *e; }	// Not overridden
+	}
+	*allocated = i;
+	for (v = (char**)envvars; v[0] != NULL; v += 2)
+	{
+		len = strlen(v[0]) + strlen(v[1]) + 2;
+		if ((ret[i] = (char*)malloc(len)) == NULL) { ILIBCRITICALEXIT(254); }
+		sprintf_s(ret[i++], len, "%s=%s", v[0], v[1]);
+	}
+	ret[i] = NULL;
+	return(ret);
+}
+
+//
+// Spawns the child with posix_spawn(). glibc implements it with clone(CLONE_VM|CLONE_VFORK) on a separate stack, so like vfork()
+// it doesn't copy page tables, but the pipes, signals, session and environment are set up without running any of our code
+// in the child. Returns the PID, or -1 if this spawn needs something posix_spawn() can't do, or it failed, in which case
+// the caller falls back to vfork()/fork().
+//
+pid_t ILibProcessPipe_PosixSpawn(ILibProcessPipe_Process_Object *p, char *target, char* const* parameters, ILibProcessPipe_SpawnTypes spawnType, int needSetSid, int UID, void *envvars)
+{
+	posix_spawn_file_actions_t actions;
+	posix_spawnattr_t attr;
+	sigset_t sset;
+	short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+	char *defaultArgs[] = { target, NULL };
+	char **env = environ;
+	size_t allocated = 0;
+	pid_t pid;
+	int f, r;
+
+	if (UID != -1 && UID != 0) { return(-1); }		// setuid() has to run in the child
+#ifdef POSIX_SPAWN_SETSID
+	if (needSetSid != 0) { flags |= POSIX_SPAWN_SETSID; }
+#else
+	if (needSetSid != 0) { return(-1); }
+#endif
+#ifdef POSIX_SPAWN_USEVFORK
+	flags |= POSIX_SPAWN_USEVFORK;					// Older glibc uses fork() otherwise
+#endif
+
+	if (posix_spawn_file_actions_init(&actions) != 0) { return(-1); }
+	if (posix_spawnattr_init(&attr) != 0) { posix_spawn_file_actions_destroy(&actions); return(-1); }
+
+	// The child starts with nothing blocked, and every signal at its default disposition
+	sigemptyset(&sset);
+	posix_spawnattr_setsigmask(&attr, &sset);
+	sigfillset(&sset);
+	posix_spawnattr_setsigdefault(&attr, &sset);
+	posix_spawnattr_setflags(&attr, flags);
+
+	if (spawnType != ILibProcessPipe_SpawnTypes_DETACHED)
+	{
+		posix_spawn_file_actions_addclose(&actions, p->stdErr->mPipe_ReadEnd);
+		posix_spawn_file_actions_addclose(&actions, p->stdIn->mPipe_WriteEnd);
+		posix_spawn_file_actions_addclose(&actions, p->stdOut->mPipe_ReadEnd);
+		posix_spawn_file_actions_adddup2(&actions, p->stdIn->mPipe_ReadEnd, STDIN_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, p->stdOut->mPipe_WriteEnd, STDOUT_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, p->stdErr->mPipe_WriteEnd, STDERR_FILENO);
+		posix_spawn_file_actions_addclose(&actions, p->stdIn->mPipe_ReadEnd);
+		posix_spawn_file_actions_addclose(&actions, p->stdOut->mPipe_WriteEnd);
+		posix_spawn_file_actions_addclose(&actions, p->stdErr->mPipe_WriteEnd);
+
+		// The child's stdin/stdout must block. These are the child's ends, which we close after spawning, so we can change them here
+		f = fcntl(p->stdIn->mPipe_ReadEnd, F_GETFL);
+		fcntl(p->stdIn->mPipe_ReadEnd, F_SETFL, f & ~O_NONBLOCK);
+		f = fcntl(p->stdOut->mPipe_WriteEnd, F_GETFL);
+		fcntl(p->stdOut->mPipe_WriteEnd, F_SETFL, f & ~O_NONBLOCK);
+	}
+	if (envvars != NULL && ((char**)envvars)[0] != NULL) { env = ILibProcessPipe_PosixSpawn_Environment(envvars, &allocated); }
+
+	r = posix_spawn(&pid, target, &actions, &attr, parameters != NULL ? parameters : defaultArgs, env);
+
+	if (env != environ)
+	{
+		for (; env[allocated] != NULL; ++allocated) { free(env[allocated]); }
+		free(env);
+	}
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
+	return(r == 0 ? pid : -1);
+}
+#endif
+
 ILibProcessPipe_Process ILibProcessPipe_Manager_SpawnProcessEx4(ILibProcessPipe_Manager pipeManager, char* target, char* const* parameters, ILibProcessPipe_SpawnTypes spawnType, void *sid, void *envvars, int extraMemorySize)
 {
 	ILibProcessPipe_Process_Object* retVal = NULL;
@@ -731,22 +842,29 @@ ILibProcessPipe_Process ILibProcessPipe_Manager_SpawnProcessEx4(ILibProcessPipe_
 			retVal->stdOut = ILibProcessPipe_CreatePipe(pipeManager, 4096, (ILibProcessPipe_GenericBrokenPipeHandler)ILibProcessPipe_Process_BrokenPipeSink, extraMemorySize);
 			retVal->stdOut->mProcess = retVal;
 		}
-#ifdef __APPLE__
-		if (needSetSid == 0)
+		pid = -1;
+#ifdef ILibProcessPipe_POSIX_SPAWN
+		pid = ILibProcessPipe_PosixSpawn(retVal, target, parameters, spawnType, needSetSid, UID, envvars);
+#endif
+		if (pid < 0)
 		{
+#ifdef __APPLE__
+			if (needSetSid == 0)
+			{
+				set = &sset;
+				ILibVForkPrepareSignals_Parent_Init(set);
+				pid = vfork();
+			}
+			else
+			{
+				pid = fork();
+			}
+#else
 			set = &sset;
 			ILibVForkPrepareSignals_Parent_Init(set);
 			pid = vfork();
-		}
-		else
-		{
-			pid = fork();
-		}
-#else
-		set = &sset;
-		ILibVForkPrepareSignals_Parent_Init(set);
-		pid = vfork();
 #endif
+		}
 	}
 	if (pid < 0)
 	{
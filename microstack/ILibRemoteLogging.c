@@ -39,18 +39,209 @@ char* ILibRemoteLogging_ConvertAddress(struct sockaddr* addr)
 	return(ILibScratchPad_RemoteLogging);
 }
 
+//
+// Reads the next argument from a binary log record. Returns 0 on success, or non-zero if the record doesn't hold an argument of that type
+//
+int ILibRemoteLogging_BinaryLog_ReadArg(char *args, int argsLen, int *pos, char type, unsigned long long *value, double *dvalue, char **str, int *strLen)
+{
+	unsigned short len;
+
+	if (*pos >= argsLen || args[*pos] != type) { return(1); }
+	++(*pos);
+	switch (type)
+	{
+		case 's':
+			if (*pos + (int)sizeof(unsigned short) > argsLen) { return(1); }
+			memcpy_s(&len, sizeof(len), args + *pos, sizeof(len));
+			*pos += (int)sizeof(len);
+			if (*pos + (int)len > argsLen) { return(1); }
+			*str = args + *pos;
+			*strLen = (int)len;
+			*pos += (int)len;
+			break;
+		case 'f':
+			if (*pos + (int)sizeof(double) > argsLen) { return(1); }
+			memcpy_s(dvalue, sizeof(double), args + *pos, sizeof(double));
+			*pos += (int)sizeof(double);
+			break;
+		default:
+			if (*pos + (int)sizeof(unsigned long long) > argsLen) { return(1); }
+			memcpy_s(value, sizeof(unsigned long long), args + *pos, sizeof(unsigned long long));
+			*pos += (int)sizeof(unsigned long long);
+			break;
+	}
+	return(0);
+}
+int ILibRemoteLogging_BinaryLog_Append(char *dest, int destLen, int len, char *spec, ...)
+{
+	int ret;
+	va_list argptr;
+
+	va_start(argptr, spec);
+	ret = vsnprintf(dest + len, destLen - len, spec, argptr);
+	va_end(argptr);
+
+	if (ret < 0) { ret = 0; }
+	return(len + ret < destLen ? len + ret : destLen - 1);
+}
+//! Formats the arguments of a binary log record, using the printf format string that the record references
+/*!
+	\param format printf format string, from the format table
+	\param args Arguments of the record (Data following ILibRemoteLogging_BinaryLog_Record)
+	\param argsLen Length of the arguments
+	\param dest Buffer to format into (NULL Terminated)
+	\param destLen Size of the buffer
+	\return Number of characters written, not including the NULL terminator
+*/
+int ILibRemoteLogging_BinaryLog_Format(char *format, char *args, int argsLen, char *dest, int destLen)
+{
+	char spec[64];
+	int len = 0, pos = 0, specLen, strLen = 0;
+	unsigned long long v = 0;
+	double d = 0;
+	char *str = NULL;
+	char conv;
+
+	if (destLen <= 0) { return(0); }
+	while (format != NULL && *format != 0 && len < destLen - 1)
+	{
+		if (*format != '%') { dest[len++] = *format++; continue; }
+		if (*(++format) == '%') { dest[len++] = *format++; continue; }
+
+		// Flags and Width are copied, '*' is replaced by the recorded value
+		spec[0] = '%'; specLen = 1;
+		while (*format != 0 && strchr("-+ #0", *format) != NULL && specLen < 8) { spec[specLen++] = *format++; }
+		if (*format == '*')
+		{
+			++format;
+			if (ILibRemoteLogging_BinaryLog_ReadArg(args, argsLen, &pos, 'i', &v, &d, &str, &strLen) != 0) { break; }
+			specLen += sprintf_s(spec + specLen, sizeof(spec) - specLen, "%d", (int)v);
+		}
+		while (*format >= '0' && *format <= '9') { if (specLen < 16) { spec[specLen++] = *format; } ++format; }
+		if (*format == '.')
+		{
+			spec[specLen++] = *format++;
+			if (*format == '*')
+			{
+				++format;
+				if (ILibRemoteLogging_BinaryLog_ReadArg(args, argsLen, &pos, 'i', &v, &d, &str, &strLen) != 0) { break; }
+				specLen += sprintf_s(spec + specLen, sizeof(spec) - specLen, "%d", (int)v);
+			}
+			while (*format >= '0' && *format <= '9') { if (specLen < 24) { spec[specLen++] = *format; } ++format; }
+		}
+
+		// Length modifiers are dropped, because integers are always recorded as 64 bits
+		while (*format != 0 && strchr("hlLqjzt", *format) != NULL) { ++format; }
+		if (format[0] == 'I' && ((format[1] == '6' && format[2] == '4') || (format[1] == '3' && format[2] == '2'))) { format += 3; }
+		if ((conv = *format) == 0) { break; }
+		++format;
+
+		switch (conv)
+		{
+			case 'd': case 'i':
+				if (ILibRemoteLogging_BinaryLog_ReadArg(args, argsLen, &pos, 'i', &v, &d, &str, &strLen) != 0) { len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, "<?>"); break; }
+				spec[specLen++] = 'l'; spec[specLen++] = 'l'; spec[specLen++] = conv; spec[specLen] = 0;
+				len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, spec, (long long)v);
+				break;
+			case 'o': case 'u': case 'x': case 'X':
+				if (ILibRemoteLogging_BinaryLog_ReadArg(args, argsLen, &pos, 'i', &v, &d, &str, &strLen) != 0) { len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, "<?>"); break; }
+				spec[specLen++] = 'l'; spec[specLen++] = 'l'; spec[specLen++] = conv; spec[specLen] = 0;
+				len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, spec, v);
+				break;
+			case 'c':
+				if (ILibRemoteLogging_BinaryLog_ReadArg(args, argsLen, &pos, 'i', &v, &d, &str, &strLen) != 0) { len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, "<?>"); break; }
+				spec[specLen++] = conv; spec[specLen] = 0;
+				len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, spec, (int)v);
+				break;
+			case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+				if (ILibRemoteLogging_BinaryLog_ReadArg(args, argsLen, &pos, 'f', &v, &d, &str, &strLen) != 0) { len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, "<?>"); break; }
+				spec[specLen++] = conv; spec[specLen] = 0;
+				len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, spec, d);
+				break;
+			case 'p':
+				if (ILibRemoteLogging_BinaryLog_ReadArg(args, argsLen, &pos, 'p', &v, &d, &str, &strLen) != 0) { len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, "<?>"); break; }
+				spec[specLen++] = conv; spec[specLen] = 0;
+				len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, spec, (void*)(uintptr_t)v);
+				break;
+			case 's':
+				if (ILibRemoteLogging_BinaryLog_ReadArg(args, argsLen, &pos, 's', &v, &d, &str, &strLen) != 0) { len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, "<?>"); break; }
+				// The recorded string was already limited to the precision, and isn't NULL terminated
+				if (strchr(spec, '.') != NULL) { *strchr(spec, '.') = 0; specLen = (int)strnlen_s(spec, sizeof(spec)); }
+				spec[specLen++] = '.'; spec[specLen++] = '*'; spec[specLen++] = 's'; spec[specLen] = 0;
+				len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, spec, strLen, str);
+				break;
+			case 'n':
+				break;
+			default:
+				len = ILibRemoteLogging_BinaryLog_Append(dest, destLen, len, "%s", format - 1);
+				format += strnlen_s(format, (size_t)destLen);
+				break;
+		}
+	}
+	dest[len] = 0;
+	return(len);
+}
+
 #ifdef _REMOTELOGGING
 
+#if defined(WIN32)
+	#define ILibRemoteLogging_ThreadLocal __declspec(thread)
+	#define ILibRemoteLogging_ThreadID() ((unsigned long long)GetCurrentThreadId())
+	#define ILibRemoteLogging_Atomic_Increment(ptr) InterlockedIncrement((LONG volatile*)(ptr))
+	#define ILibRemoteLogging_Atomic_CompareExchangePtr(ptr, oldVal, newVal) (InterlockedCompareExchangePointer((PVOID volatile*)(ptr), (PVOID)(newVal), (PVOID)(oldVal)) == (PVOID)(oldVal))
+	#define ILibRemoteLogging_Atomic_Load(ptr) (MemoryBarrier(), *(ptr))
+	#define ILibRemoteLogging_Atomic_Store(ptr, val) do { MemoryBarrier(); *(ptr) = (val); } while (0)
+#else
+	#define ILibRemoteLogging_ThreadLocal __thread
+	#define ILibRemoteLogging_ThreadID() ((unsigned long long)(uintptr_t)pthread_self())
+	#define ILibRemoteLogging_Atomic_Increment(ptr) __sync_add_and_fetch((ptr), 1)
+	#define ILibRemoteLogging_Atomic_CompareExchangePtr(ptr, oldVal, newVal) __sync_bool_compare_and_swap((ptr), (oldVal), (newVal))
+	#if defined(__ATOMIC_SEQ_CST)
+		#define ILibRemoteLogging_Atomic_Load(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+		#define ILibRemoteLogging_Atomic_Store(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+	#else
+		#define ILibRemoteLogging_Atomic_Load(ptr) (__sync_synchronize(), *(ptr))
+		#define ILibRemoteLogging_Atomic_Store(ptr, val) do { __sync_synchronize(); *(ptr) = (val); } while (0)
+	#endif
+#endif
+
+//
+// Filters are stored like the session flags: Modules in the low 16 bits, Verbosity in the high 16 bits
+//
+#define ILibRemoteLogging_FilterMatch(filter, module, flags) ((((filter) & (unsigned int)(module) & 0xFFFF) != 0) && ((((filter) >> 16) & 0x3E) >= (unsigned int)(flags)))
+
 typedef struct ILibRemoteLogging_Session
 {
 	unsigned int Flags;
 	void* UserContext;
 }ILibRemoteLogging_Session;
 
+//
+// Single producer (the owning thread), single consumer ring buffer of binary log records
+//
+typedef struct ILibRemoteLogging_Ring
+{
+	struct ILibRemoteLogging_Ring *next;
+	unsigned long long threadID;
+	volatile unsigned int head;					// Only written by the owning thread
+	volatile unsigned int tail;					// Only written by ILibRemoteLogging_BinaryLog_Drain()
+	volatile unsigned int dropped;
+	unsigned int mask;
+	char *buffer;
+}ILibRemoteLogging_Ring;
+
 typedef struct ILibRemoteLogging_Module
 {
 	sem_t LogSyncLock;
 	unsigned int LogFlags;
+	volatile unsigned int SessionFilter;		// Union of the session flags, so ILibRemoteLogging_printf() can bail before formatting
+
+	volatile unsigned int BinaryLogFilter;
+	unsigned int BinaryLogID;
+	int BinaryLogSize;
+	ILibSpinLock BinaryLogLock;
+	ILibRemoteLogging_Ring *volatile BinaryLogRings;
+	char *volatile BinaryLogFormats[ILibRemoteLogging_BinaryLog_MaxFormats];
 
 	ILibRemoteLogging_OnWrite OutputSink;
 	ILibRemoteLogging_OnRawForward RawForwardSink;
@@ -59,16 +250,43 @@ typedef struct ILibRemoteLogging_Module
 	ILibRemoteLogging_Session Sessions[5];
 }ILibRemoteLogging_Module;
 
+unsigned int ILibRemoteLogging_BinaryLog_NextID = 0;
+ILibRemoteLogging_ThreadLocal ILibRemoteLogging_Ring *ILibRemoteLogging_BinaryLog_CurrentRing = NULL;
+ILibRemoteLogging_ThreadLocal unsigned int ILibRemoteLogging_BinaryLog_CurrentID = 0;
+
 void ILibRemoteLogging_Destroy(ILibRemoteLogging module)
 {
 	ILibRemoteLogging_Module *obj = (ILibRemoteLogging_Module*)module;
+	ILibRemoteLogging_Ring *ring;
 	if (obj != NULL)
 	{
+		while ((ring = obj->BinaryLogRings) != NULL)
+		{
+			obj->BinaryLogRings = ring->next;
+			free(ring);
+		}
 		sem_destroy(&(obj->LogSyncLock));
 		free(module);
 	}
 }
 
+//
+// Recomputes SessionFilter. Must be called while holding LogSyncLock
+//
+void ILibRemoteLogging_UpdateSessionFilter(ILibRemoteLogging_Module *obj)
+{
+	unsigned int modules = 0, verbosity = 0;
+	int i;
+
+	for (i = 0; i < (int)(sizeof(obj->Sessions) / sizeof(ILibRemoteLogging_Session)); ++i)
+	{
+		if (obj->Sessions[i].UserContext == NULL) { break; }
+		modules |= (obj->Sessions[i].Flags & 0xFFFF);
+		if (((obj->Sessions[i].Flags >> 16) & 0x3E) > verbosity) { verbosity = (obj->Sessions[i].Flags >> 16) & 0x3E; }
+	}
+	obj->SessionFilter = modules | (verbosity << 16);
+}
+
 void ILibRemoteLogging_CompactSessions(ILibRemoteLogging_Session sessions[], int sessionsLength)
 {
 	int x=0,y=0;
@@ -147,7 +365,9 @@ ILibRemoteLogging ILibRemoteLogging_Create(ILibRemoteLogging_OnWrite onOutput)
 	memset(retVal, 0, sizeof(ILibRemoteLogging_Module));
 
 	sem_init(&(retVal->LogSyncLock), 0, 1);
+	ILibSpinLock_Init(&(retVal->BinaryLogLock));
 	retVal->OutputSink = onOutput;
+	retVal->BinaryLogID = (unsigned int)ILibRemoteLogging_Atomic_Increment(&ILibRemoteLogging_BinaryLog_NextID);
 
 	ILibRemoteLogging_RegisterCommandSink(retVal, ILibRemoteLogging_Modules_Logger, ILibRemoteLogging_LoggerCommand_Default);
 
@@ -172,6 +392,7 @@ void ILibRemoteLogging_DeleteUserContext(ILibRemoteLogging logger, void *userCon
 
 	sem_wait(&(obj->LogSyncLock));
 	ILibRemoteLogging_RemoveUserContext(obj->Sessions, sizeof(obj->Sessions) / sizeof(ILibRemoteLogging_Session), userContext);
+	ILibRemoteLogging_UpdateSessionFilter(obj);
 	sem_post(&(obj->LogSyncLock));
 }
 
@@ -200,6 +421,309 @@ void ILibRemoteLogging_SendCommand(ILibRemoteLogging loggingModule, ILibRemoteLo
 		obj->OutputSink(loggingModule, dest, 4+dataLen, userContext);
 	}
 }
+//
+// Returns the index of the format string in the format table, adding it if necessary. Formats are keyed by address, so they must be string literals.
+//
+int ILibRemoteLogging_BinaryLog_FormatID(ILibRemoteLogging_Module *obj, char *format)
+{
+	unsigned int i, h = (unsigned int)((((uintptr_t)format) >> 2) * 2654435761u) % ILibRemoteLogging_BinaryLog_MaxFormats;
+
+	for (i = 0; i < ILibRemoteLogging_BinaryLog_MaxFormats; ++i, h = (h + 1) % ILibRemoteLogging_BinaryLog_MaxFormats)
+	{
+		if (obj->BinaryLogFormats[h] == format) { return((int)h); }
+		if (obj->BinaryLogFormats[h] == NULL)
+		{
+			if (ILibRemoteLogging_Atomic_CompareExchangePtr(&(obj->BinaryLogFormats[h]), NULL, format) || obj->BinaryLogFormats[h] == format) { return((int)h); }
+		}
+	}
+	return(-1);
+}
+//
+// Returns the ring for the calling thread, creating it if necessary
+//
+ILibRemoteLogging_Ring* ILibRemoteLogging_BinaryLog_GetRing(ILibRemoteLogging_Module *obj)
+{
+	ILibRemoteLogging_Ring *ring;
+	unsigned long long tid;
+
+	if (ILibRemoteLogging_BinaryLog_CurrentID == obj->BinaryLogID) { return(ILibRemoteLogging_BinaryLog_CurrentRing); }
+
+	tid = ILibRemoteLogging_ThreadID();
+	for (ring = ILibRemoteLogging_Atomic_Load(&(obj->BinaryLogRings)); ring != NULL && ring->threadID != tid; ring = ring->next);
+	if (ring == NULL)
+	{
+		if ((ring = (ILibRemoteLogging_Ring*)malloc(sizeof(ILibRemoteLogging_Ring) + obj->BinaryLogSize)) == NULL) { ILIBCRITICALEXIT(254); }
+		memset(ring, 0, sizeof(ILibRemoteLogging_Ring));
+		ring->threadID = tid;
+		ring->mask = (unsigned int)obj->BinaryLogSize - 1;
+		ring->buffer = (char*)(ring + 1);
+		do
+		{
+			ring->next = obj->BinaryLogRings;
+		} while (!ILibRemoteLogging_Atomic_CompareExchangePtr(&(obj->BinaryLogRings), ring->next, ring));
+	}
+
+	ILibRemoteLogging_BinaryLog_CurrentRing = ring;
+	ILibRemoteLogging_BinaryLog_CurrentID = obj->BinaryLogID;
+	return(ring);
+}
+int ILibRemoteLogging_BinaryLog_PutArg(char *dest, int destLen, int len, char type, void *value, int valueLen)
+{
+	unsigned short sLen = (unsigned short)valueLen;
+	int hdrLen = type == 's' ? (int)(1 + sizeof(unsigned short)) : 1;
+
+	if (len + hdrLen > destLen) { return(-1); }
+	if (type == 's' && len + hdrLen + valueLen > destLen) { sLen = (unsigned short)(destLen - len - hdrLen); }
+
+	dest[len++] = type;
+	if (type == 's') 
+	{ 
+		memcpy_s(dest + len, destLen - len, &sLen, sizeof(sLen)); len += (int)sizeof(sLen);
+		valueLen = (int)sLen;
+	}
+	if (len + valueLen > destLen) { return(-1); }
+	memcpy_s(dest + len, destLen - len, value, valueLen);
+	return(len + valueLen);
+}
+//
+// Copies the arguments described by the format string into dest, without formatting them. Returns the number of bytes written.
+//
+int ILibRemoteLogging_BinaryLog_PackArgs(char *format, va_list args, char *dest, int destLen)
+{
+	int len = 0, lmod, precision, sLen;
+	unsigned long long v;
+	double d;
+	char *str;
+	char conv;
+
+	while (*format != 0 && len >= 0)
+	{
+		if (*format++ != '%') { continue; }
+		if (*format == '%') { ++format; continue; }
+
+		while (*format != 0 && strchr("-+ #0", *format) != NULL) { ++format; }
+		if (*format == '*') { ++format; v = (unsigned long long)(long long)va_arg(args, int); len = ILibRemoteLogging_BinaryLog_PutArg(dest, destLen, len, 'i', &v, sizeof(v)); }
+		while (*format >= '0' && *format <= '9') { ++format; }
+		precision = -1;
+		if (*format == '.')
+		{
+			++format;
+			if (*format == '*') { ++format; precision = va_arg(args, int); v = (unsigned long long)(long long)precision; len = ILibRemoteLogging_BinaryLog_PutArg(dest, destLen, len, 'i', &v, sizeof(v)); }
+			else { precision = 0; while (*format >= '0' && *format <= '9') { precision = (precision * 10) + (*format++ - '0'); } }
+		}
+		if (len < 0) { break; }
+
+		// 1 = h/hh, 2 = l, 3 = ll, 4 = z/t, 5 = j, 6 = L
+		lmod = 0;
+		while (*format != 0 && strchr("hlLqjzt", *format) != NULL)
+		{
+			switch (*format++)
+			{
+				case 'h': lmod = 1; break;
+				case 'l': lmod = lmod == 2 ? 3 : 2; break;
+				case 'q': lmod = 3; break;
+				case 'z': case 't': lmod = 4; break;
+				case 'j': lmod = 5; break;
+				case 'L': lmod = 6; break;
+			}
+		}
+		if (format[0] == 'I' && format[1] == '6' && format[2] == '4') { lmod = 3; format += 3; }
+		else if (format[0] == 'I' && format[1] == '3' && format[2] == '2') { lmod = 0; format += 3; }
+		if ((conv = *format) == 0) { break; }
+		++format;
+
+		switch (conv)
+		{
+			case 'd': case 'i':
+				switch (lmod)
+				{
+					case 2: v = (unsigned long long)(long long)va_arg(args, long); break;
+					case 3: case 6: v = (unsigned long long)va_arg(args, long long); break;
+					case 4: v = (unsigned long long)(long long)va_arg(args, ptrdiff_t); break;
+					case 5: v = (unsigned long long)(long long)va_arg(args, intmax_t); break;
+					default: v = (unsigned long long)(long long)va_arg(args, int); break;
+				}
+				len = ILibRemoteLogging_BinaryLog_PutArg(dest, destLen, len, 'i', &v, sizeof(v));
+				break;
+			case 'o': case 'u': case 'x': case 'X':
+				switch (lmod)
+				{
+					case 2: v = (unsigned long long)va_arg(args, unsigned long); break;
+					case 3: case 6: v = va_arg(args, unsigned long long); break;
+					case 4: v = (unsigned long long)va_arg(args, size_t); break;
+					case 5: v = (unsigned long long)va_arg(args, uintmax_t); break;
+					default: v = (unsigned long long)va_arg(args, unsigned int); break;
+				}
+				len = ILibRemoteLogging_BinaryLog_PutArg(dest, destLen, len, 'i', &v, sizeof(v));
+				break;
+			case 'c':
+				v = (unsigned long long)(long long)va_arg(args, int);
+				len = ILibRemoteLogging_BinaryLog_PutArg(dest, destLen, len, 'i', &v, sizeof(v));
+				break;
+			case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+				d = lmod == 6 ? (double)va_arg(args, long double) : va_arg(args, double);
+				len = ILibRemoteLogging_BinaryLog_PutArg(dest, destLen, len, 'f', &d, sizeof(d));
+				break;
+			case 'p':
+				v = (unsigned long long)(uintptr_t)va_arg(args, void*);
+				len = ILibRemoteLogging_BinaryLog_PutArg(dest, destLen, len, 'p', &v, sizeof(v));
+				break;
+			case 's':
+				str = va_arg(args, char*);
+				if (str == NULL || lmod != 0) { str = lmod != 0 ? "" : "(null)"; }
+				for (sLen = 0; str[sLen] != 0 && (precision < 0 || sLen < precision) && sLen < destLen; ++sLen);
+				len = ILibRemoteLogging_BinaryLog_PutArg(dest, destLen, len, 's', str, sLen);
+				break;
+			case 'n':
+				(void)va_arg(args, void*);
+				break;
+			default:
+				// Unknown conversion, so we can't know what the rest of the arguments are
+				return(len);
+		}
+	}
+	return(len < 0 ? 0 : len);
+}
+void ILibRemoteLogging_BinaryLog_Write(ILibRemoteLogging_Module *obj, ILibRemoteLogging_Modules module, ILibRemoteLogging_Flags flags, char *format, va_list args)
+{
+	char record[ILibRemoteLogging_BinaryLog_MaxRecordSize];
+	ILibRemoteLogging_BinaryLog_Record *hdr = (ILibRemoteLogging_BinaryLog_Record*)record;
+	ILibRemoteLogging_Ring *ring = ILibRemoteLogging_BinaryLog_GetRing(obj);
+	unsigned int head, offset;
+	struct timeval tv;
+	int id;
+
+	if ((id = ILibRemoteLogging_BinaryLog_FormatID(obj, format)) < 0) { ++ring->dropped; return; }
+
+	gettimeofday(&tv, NULL);
+	hdr->length = (unsigned short)(sizeof(ILibRemoteLogging_BinaryLog_Record) + ILibRemoteLogging_BinaryLog_PackArgs(format, args, record + sizeof(ILibRemoteLogging_BinaryLog_Record), (int)(sizeof(record) - sizeof(ILibRemoteLogging_BinaryLog_Record))));
+	hdr->module = (unsigned short)module;
+	hdr->flags = (unsigned short)flags;
+	hdr->formatId = (unsigned short)id;
+	hdr->timestamp = ((unsigned long long)tv.tv_sec * 1000) + (unsigned long long)(tv.tv_usec / 1000);
+
+	head = ring->head;
+	if ((ring->mask + 1) - (head - ILibRemoteLogging_Atomic_Load(&(ring->tail))) < hdr->length) { ++ring->dropped; return; }
+
+	offset = head & ring->mask;
+	if (offset + hdr->length <= ring->mask + 1)
+	{
+		memcpy_s(ring->buffer + offset, ring->mask + 1 - offset, record, hdr->length);
+	}
+	else
+	{
+		memcpy_s(ring->buffer + offset, ring->mask + 1 - offset, record, ring->mask + 1 - offset);
+		memcpy_s(ring->buffer, ring->mask + 1, record + (ring->mask + 1 - offset), hdr->length - (ring->mask + 1 - offset));
+	}
+	ILibRemoteLogging_Atomic_Store(&(ring->head), head + hdr->length);
+}
+//! Enables the binary log. Matching ILibRemoteLogging_printf() calls are recorded unformatted, to a ring buffer per calling thread.
+/*!
+	\param loggingModule ILibRemoteLogging Logging Module
+	\param modules ILibRemoteLogging_Modules to record (0 = Disable)
+	\param flags Maximum ILibRemoteLogging_Flags verbosity to record
+	\param ringSize Size of the ring buffer for each thread, rounded up to a power of two (0 = 64KB). Only applies to threads that haven't logged yet.
+*/
+void ILibRemoteLogging_BinaryLog_Enable(ILibRemoteLogging loggingModule, ILibRemoteLogging_Modules modules, ILibRemoteLogging_Flags flags, int ringSize)
+{
+	ILibRemoteLogging_Module *obj = (ILibRemoteLogging_Module*)loggingModule;
+	int size = 4096;
+
+	if (obj == NULL) { return; }
+	if (ringSize <= 0) { ringSize = 65536; }
+	while (size < ringSize && size < 0x4000000) { size <<= 1; }
+
+	if (obj->BinaryLogRings == NULL) { obj->BinaryLogSize = size; }
+	ILibRemoteLogging_Atomic_Store(&(obj->BinaryLogFilter), ((unsigned int)modules & 0xFFFF) | (((unsigned int)flags & 0x3E) << 16));
+}
+//! Removes all the pending binary log records from the ring buffers, and passes them to a callback
+/*!
+	\b NOTE: Records are in order for each thread, but are not sorted across threads
+	\param loggingModule ILibRemoteLogging Logging Module
+	\param sink Callback to pass each record to (NULL = Discard)
+	\param user Custom user state
+	\return Number of records drained
+*/
+int ILibRemoteLogging_BinaryLog_Drain(ILibRemoteLogging loggingModule, ILibRemoteLogging_BinaryLog_OnRecord sink, void *user)
+{
+	ILibRemoteLogging_Module *obj = (ILibRemoteLogging_Module*)loggingModule;
+	char record[ILibRemoteLogging_BinaryLog_MaxRecordSize];
+	ILibRemoteLogging_BinaryLog_Record *hdr = (ILibRemoteLogging_BinaryLog_Record*)record;
+	ILibRemoteLogging_Ring *ring;
+	unsigned int head, tail, offset, i;
+	int count = 0;
+
+	if (obj == NULL) { return(0); }
+
+	ILibSpinLock_Lock(&(obj->BinaryLogLock));
+	for (ring = ILibRemoteLogging_Atomic_Load(&(obj->BinaryLogRings)); ring != NULL; ring = ring->next)
+	{
+		tail = ring->tail;
+		head = ILibRemoteLogging_Atomic_Load(&(ring->head));
+		while (head - tail >= sizeof(ILibRemoteLogging_BinaryLog_Record))
+		{
+			offset = tail & ring->mask;
+			for (i = 0; i < sizeof(ILibRemoteLogging_BinaryLog_Record); ++i) { record[i] = ring->buffer[(offset + i) & ring->mask]; }
+			if (hdr->length < sizeof(ILibRemoteLogging_BinaryLog_Record) || hdr->length > head - tail) { tail = head; break; }
+			for (; i < hdr->length && i < sizeof(record); ++i) { record[i] = ring->buffer[(offset + i) & ring->mask]; }
+			tail += hdr->length;
+			if (sink != NULL) { sink(obj, hdr, obj->BinaryLogFormats[hdr->formatId], user); }
+			++count;
+		}
+		ILibRemoteLogging_Atomic_Store(&(ring->tail), tail);
+	}
+	ILibSpinLock_UnLock(&(obj->BinaryLogLock));
+	return(count);
+}
+void ILibRemoteLogging_BinaryLog_Dump_Sink(ILibRemoteLogging sender, ILibRemoteLogging_BinaryLog_Record *record, char *format, void *user)
+{
+	UNREFERENCED_PARAMETER(sender);
+	UNREFERENCED_PARAMETER(format);
+	ignore_result(fwrite(record, 1, record->length, (FILE*)user));
+}
+//! Drains the binary log to a dump file, along with the format table. Use test/ILibRemoteLogging_decode.c to read it.
+/*!
+	\param loggingModule ILibRemoteLogging Logging Module
+	\param path Path of the dump file to write
+	\return Number of records written (-1 = Could not open the file)
+*/
+int ILibRemoteLogging_BinaryLog_Dump(ILibRemoteLogging loggingModule, char *path)
+{
+	ILibRemoteLogging_Module *obj = (ILibRemoteLogging_Module*)loggingModule;
+	ILibRemoteLogging_BinaryLog_FileHeader header;
+	ILibRemoteLogging_Ring *ring;
+	unsigned short id, len;
+	FILE *f = NULL;
+	int count;
+
+	if (obj == NULL) { return(-1); }
+#ifdef WIN32
+	_wfopen_s(&f, ILibUTF8ToWide(path, -1), L"wb");
+#else
+	f = fopen(path, "wb");
+#endif
+	if (f == NULL) { return(-1); }
+
+	memset(&header, 0, sizeof(header));
+	header.magic = ILibRemoteLogging_BinaryLog_MAGIC;
+	header.version = ILibRemoteLogging_BinaryLog_VERSION;
+	for (id = 0; id < ILibRemoteLogging_BinaryLog_MaxFormats; ++id) { if (obj->BinaryLogFormats[id] != NULL) { ++header.formatCount; } }
+	for (ring = ILibRemoteLogging_Atomic_Load(&(obj->BinaryLogRings)); ring != NULL; ring = ring->next) { header.dropped += ring->dropped; }
+	ignore_result(fwrite(&header, 1, sizeof(header), f));
+
+	for (id = 0; id < ILibRemoteLogging_BinaryLog_MaxFormats; ++id)
+	{
+		if (obj->BinaryLogFormats[id] == NULL) { continue; }
+		len = (unsigned short)strnlen_s(obj->BinaryLogFormats[id], 0xFFFF);
+		ignore_result(fwrite(&id, 1, sizeof(id), f));
+		ignore_result(fwrite(&len, 1, sizeof(len), f));
+		ignore_result(fwrite(obj->BinaryLogFormats[id], 1, len, f));
+	}
+
+	count = ILibRemoteLogging_BinaryLog_Drain(obj, ILibRemoteLogging_BinaryLog_Dump_Sink, f);
+	fclose(f);
+	return(count);
+}
 //! Logging method using printf notation
 /*!
 	\b NOTE: NO-OP if there is no connected viewers
@@ -217,7 +741,25 @@ void ILibRemoteLogging_printf(ILibRemoteLogging loggingModule, ILibRemoteLogging
 	ILibRemoteLogging_Module *obj = (ILibRemoteLogging_Module*)loggingModule;
 
 	va_list argptr;
-	
+
+	if (obj != NULL && obj->RawForwardSink == NULL)
+	{
+		if (ILibRemoteLogging_FilterMatch(obj->BinaryLogFilter, module, flags))
+		{
+			va_start(argptr, format);
+			ILibRemoteLogging_BinaryLog_Write(obj, module, flags, format, argptr);
+			va_end(argptr);
+		}
+
+		// Don't bother formatting, if nobody is going to see it
+		if ((module & ILibRemoteLogging_Modules_ConsolePrint) != ILibRemoteLogging_Modules_ConsolePrint &&
+			(obj->OutputSink == NULL || !ILibRemoteLogging_FilterMatch(obj->SessionFilter, module, flags))) { return; }
+	}
+	else if (obj == NULL && (module & ILibRemoteLogging_Modules_ConsolePrint) != ILibRemoteLogging_Modules_ConsolePrint)
+	{
+		return;
+	}
+
 	if (obj != NULL && obj->RawForwardSink != NULL)
 	{
 		// When Forwarding, TimeStamp will be added later
@@ -384,6 +926,7 @@ int ILibRemoteLogging_Dispatch(ILibRemoteLogging loggingModule, char* data, int
 		{
 			// Disable Modules
 			session->Flags &= (0xFFFFFFFF ^ module);
+			ILibRemoteLogging_UpdateSessionFilter(obj);
 			sem_post(&(obj->LogSyncLock));
 			ILibRemoteLogging_Dispatch_Update(obj, module, "DISABLED", userContext);
 			
@@ -394,6 +937,7 @@ int ILibRemoteLogging_Dispatch(ILibRemoteLogging loggingModule, char* data, int
 			session->Flags &= 0xFFC0FFFF;							// Reset Verbosity Flags
 			session->Flags |= (flags << 16);						// Set Verbosity Flags
 			session->Flags |= (unsigned int)module;					// Enable Modules
+			ILibRemoteLogging_UpdateSessionFilter(obj);
 			sem_post(&(obj->LogSyncLock));
 			ILibRemoteLogging_Dispatch_Update(obj, module, "ENABLED", userContext);
 		}
@@ -639,6 +1183,7 @@ void ILibRemoteLogging_FileTransport_CommandSink(ILibRemoteLogging sender, ILibR
 					unsigned short newFlags = ntohs(((unsigned short*)data)[1]);
 					obj->Sessions[i].Flags = (newFlags & 0x3F) << 16;
 					obj->Sessions[i].Flags |= (unsigned int)newModules;
+					ILibRemoteLogging_UpdateSessionFilter(obj);
 
 					ILibLinkedList_FileBacked_ReloadRoot(ft->logFile);
 					ft->logFile->flags = (unsigned int)ft->enabled << 31;
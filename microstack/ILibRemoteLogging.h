@@ -60,11 +60,44 @@ typedef enum ILibRemoteLogging_Command_Logger_Flags
 }ILibRemoteLogging_Command_Logger_Flags;
 
 #define ILibTransports_RemoteLogging_FileTransport 0x70
+
+//
+// Binary Log: ILibRemoteLogging_printf() calls that match the binary log filter are written to a per-thread ring buffer,
+// as a record header followed by the unformatted arguments. The format string is referenced by id, so it must be a string literal.
+// Records are only formatted when they are read back, with ILibRemoteLogging_BinaryLog_Format().
+//
+// Dump File (host byte order): ILibRemoteLogging_BinaryLog_FileHeader, then formatCount x [unsigned short id][unsigned short len][format],
+// then the records until the end of the file. Each argument is a one byte type, followed by its value:
+//     'i' 8 byte integer, 'f' 8 byte double, 'p' 8 byte pointer, 's' unsigned short length followed by the string (not NULL terminated)
+//
+#define ILibRemoteLogging_BinaryLog_MAGIC			0x4C52494C
+#define ILibRemoteLogging_BinaryLog_VERSION			1
+#define ILibRemoteLogging_BinaryLog_MaxFormats		1024
+#define ILibRemoteLogging_BinaryLog_MaxRecordSize	1024
+typedef struct ILibRemoteLogging_BinaryLog_FileHeader
+{
+	unsigned int magic;
+	unsigned short version;
+	unsigned short formatCount;
+	unsigned int dropped;
+	unsigned int reserved;
+}ILibRemoteLogging_BinaryLog_FileHeader;
+typedef struct ILibRemoteLogging_BinaryLog_Record
+{
+	unsigned short length;					//!< Length of the record, including this header
+	unsigned short module;					//!< ILibRemoteLogging_Modules
+	unsigned short flags;					//!< ILibRemoteLogging_Flags
+	unsigned short formatId;				//!< Index into the format table
+	unsigned long long timestamp;			//!< Milliseconds since the epoch
+}ILibRemoteLogging_BinaryLog_Record;
+
 typedef void* ILibRemoteLogging;
 typedef void (*ILibRemoteLogging_OnWrite)(ILibRemoteLogging module, char* data, int dataLen, void *userContext);
 typedef void (*ILibRemoteLogging_OnCommand)(ILibRemoteLogging sender, ILibRemoteLogging_Modules module, unsigned short flags, char* data, int dataLen, void *userContext);
 typedef void(*ILibRemoteLogging_OnRawForward)(ILibRemoteLogging sender, ILibRemoteLogging_Modules module, ILibRemoteLogging_Flags flags, char *buffer, int bufferLen);
+typedef void(*ILibRemoteLogging_BinaryLog_OnRecord)(ILibRemoteLogging sender, ILibRemoteLogging_BinaryLog_Record *record, char *format, void *user);
 char* ILibRemoteLogging_ConvertAddress(struct sockaddr* addr);
+int ILibRemoteLogging_BinaryLog_Format(char *format, char *args, int argsLen, char *dest, int destLen);
 
 #ifdef _REMOTELOGGING
 	char* ILibRemoteLogging_ConvertToHex(char* inVal, int inValLength);
@@ -82,6 +115,10 @@ char* ILibRemoteLogging_ConvertAddress(struct sockaddr* addr);
 	#define ILibRemoteLogging_ReadFlags(data) ((ILibRemoteLogging_Flags)ntohs(((unsigned short*)data)[1]))
 	int ILibRemoteLogging_IsModuleSet(ILibRemoteLogging loggingModule, ILibRemoteLogging_Modules module);
 	void ILibRemoteLogging_Forward(ILibRemoteLogging loggingModule, char* data, int dataLen);
+
+	void ILibRemoteLogging_BinaryLog_Enable(ILibRemoteLogging loggingModule, ILibRemoteLogging_Modules modules, ILibRemoteLogging_Flags flags, int ringSize);
+	int ILibRemoteLogging_BinaryLog_Drain(ILibRemoteLogging loggingModule, ILibRemoteLogging_BinaryLog_OnRecord sink, void *user);
+	int ILibRemoteLogging_BinaryLog_Dump(ILibRemoteLogging loggingModule, char *path);
 #else
 	#define ILibRemoteLogging_ConvertToHex(...) ;
 	#define ILibRemoteLogging_printf(...) ;
@@ -96,6 +133,9 @@ char* ILibRemoteLogging_ConvertAddress(struct sockaddr* addr);
 	#define ILibRemoteLogging_ReadFlags(data) ILibRemoteLogging_Flags_NONE
 	#define ILibRemoteLogging_IsModuleSet(...) 0
 	#define ILibRemoteLogging_Forward(...) ;
+	#define ILibRemoteLogging_BinaryLog_Enable(...) ;
+	#define ILibRemoteLogging_BinaryLog_Drain(...) 0
+	#define ILibRemoteLogging_BinaryLog_Dump(...) -1
 #endif
 
 /*! @} */
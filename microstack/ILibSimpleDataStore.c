@@ -18,6 +18,7 @@ limitations under the License.
 #include "ILibCrypto.h"
 #ifndef WIN32
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #else
 #include <io.h>
@@ -56,6 +57,24 @@ typedef struct ILibSimpleDataStore_Root
 	int error;
 	ILibSimpleDataStore_WriteErrorHandler ErrorHandler;
 	void *ErrorHandlerUser;
+
+	int readonly;
+	uint64_t scanSize;			// Size of the file, while the key table is being rebuilt
+	uint64_t indexedSize;		// Size of the file covered by the index file on disk
+	char *mappedView;
+	uint64_t mappedSize;
+#ifdef WIN32
+	HANDLE mappedHandle;
+#endif
+
+	struct ILibSimpleDataStore_Compaction *compaction;	// Background compaction in progress, if any
+	ILibSimpleDataStore_CompactionStats compactionStats;
+
+	int batchDepth;
+	uint64_t batchOffset;	// Offset in the data store, where the batch will be written
+	char *batchBuffer;		// Records written while a batch is open
+	size_t batchLen;
+	size_t batchSize;
 } ILibSimpleDataStore_Root;
 
 /* File Format                 
@@ -68,6 +87,26 @@ Variable	- Key
 Variable	- Value
 ------------------------------------------ */
 
+/* Index File Format (<filePath>.idx)
+------------------------------------------
+ 8 Bytes	- Magic
+ 4 Bytes	- Version
+ 8 Bytes	- Size of the data store covered by this index
+ 4 Bytes	- CRC32C of the last 4K of the covered data store
+ 4 Bytes	- Entry count
+ 8 Bytes	- Dirty size
+ [Entry count]
+	 4 Bytes	- Key length
+	 4 Bytes	- Value length
+	 8 Bytes	- Value offset
+	48 Bytes	- SHA384 hash check value
+	Variable	- Key
+ 4 Bytes	- CRC32C of everything above
+------------------------------------------
+The index is a snapshot of the key table. If it matches the data store, only the records appended
+after it was written need to be read at startup. Otherwise the key table is rebuilt from the records.
+*/
+
 #define ILibSimpleDataStore_RecordHeader_ValueOffset(h) (((uint64_t*)(((char*)h) - sizeof(uint64_t)))[0])
 
 #pragma pack(push, 1)
@@ -97,15 +136,63 @@ typedef struct ILibSimpleDataStore_RecordHeader_64
 	char reserved[12];
 	char key[];
 } ILibSimpleDataStore_RecordHeader_64;
+typedef struct ILibSimpleDataStore_IndexHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t coveredSize[2];
+	uint32_t tailCRC;
+	uint32_t entryCount;
+	uint32_t dirtySize[2];
+} ILibSimpleDataStore_IndexHeader;
+typedef struct ILibSimpleDataStore_IndexRecord
+{
+	uint32_t keyLen;
+	uint32_t valueLength;
+	uint32_t valueOffset[2];
+	char hash[SHA384HASHSIZE];
+	char key[];
+} ILibSimpleDataStore_IndexRecord;
 #pragma pack(pop)
 
+#define ILibSimpleDataStore_INDEX_MAGIC "SDSINDEX"
+#define ILibSimpleDataStore_INDEX_VERSION 1
+#define ILibSimpleDataStore_INDEX_TAILSIZE 4096
+#define ILibSimpleDataStore_Put64(dest, val) (dest)[0] = htonl((uint32_t)((uint64_t)(val) >> 32)); (dest)[1] = htonl((uint32_t)((uint64_t)(val) & 0xFFFFFFFF))
+#define ILibSimpleDataStore_Get64(src) ((((uint64_t)ntohl((src)[0])) << 32) | (uint64_t)ntohl((src)[1]))
+#define ILibSimpleDataStore_CompactionBatchWait 50	// Milliseconds a background compaction waits, before checking again if the open batch was committed
+
 
 typedef struct ILibSimpleDataStore_TableEntry
 {
 	int valueLength;
 	char valueHash[SHA384HASHSIZE];
 	uint64_t valueOffset;
+	int verified;			// Set once the hash has been checked, on the first read
+	uint64_t compactOffset;	// Offset of the value in the data store being compacted in the background
 } ILibSimpleDataStore_TableEntry;
+typedef struct ILibSimpleDataStore_CompactionKey
+{
+	char *key;
+	int keyLen;
+} ILibSimpleDataStore_CompactionKey;
+typedef struct ILibSimpleDataStore_Compaction
+{
+	ILibSimpleDataStore_Root *root;		// Set to NULL when the compaction is cancelled
+	void *chain;
+	FILE *compacted;
+	char *tmpPath;
+	ILibSimpleDataStore_CompactionKey *keys;	// Snapshot of the keys, when the compaction started
+	int keyCount;
+	int keyIndex;
+	uint64_t endOffset;					// Records at or after this offset were written after the compaction started
+	uint64_t startSize;
+	uint64_t startDirtySize;
+	size_t sliceSize;
+	char *value;
+	ILibSimpleDataStore_CompactionHandler handler;
+	void *user;
+} ILibSimpleDataStore_Compaction;
 typedef struct ILibSimpleDataStore_CacheEntry
 {
 	char valueHash[SHA384HASHSIZE];
@@ -115,6 +202,8 @@ typedef struct ILibSimpleDataStore_CacheEntry
 
 const int ILibMemory_SimpleDataStore_CONTAINERSIZE = sizeof(ILibSimpleDataStore_Root);
 void ILibSimpleDataStore_RebuildKeyTable(ILibSimpleDataStore_Root *root);
+FILE* ILibSimpleDataStore_OpenFileEx2(char* filePath, int forceTruncateIfNonZero, int readonly);
+void ILibSimpleDataStore_Compaction_Cancel(ILibSimpleDataStore_Root *root);
 extern int ILibInflate(char *buffer, size_t bufferLen, char *decompressed, size_t *decompressedLen, uint32_t crc);
 extern int ILibDeflate(char *buffer, size_t bufferLen, char *compressed, size_t *compressedLen, uint32_t *crc);
 extern uint32_t crc32c(uint32_t crci, const unsigned char *buf, uint32_t len);
@@ -264,6 +353,34 @@ uint64_t ILibSimpleDataStore_WriteRecord(FILE *f, char* key, int keyLen, char* v
 	return offset;
 }
 
+// Write a record to the data store, or to the open batch
+uint64_t ILibSimpleDataStore_AppendRecord(ILibSimpleDataStore_Root *root, char* key, int keyLen, char* value, int valueLen, char* hash)
+{
+	ILibSimpleDataStore_RecordHeader_NG *header;
+	size_t len = sizeof(ILibSimpleDataStore_RecordHeader_NG) + keyLen + (value != NULL ? valueLen : 0);
+	uint64_t offset;
+
+	if (root->batchDepth == 0) { return(ILibSimpleDataStore_WriteRecord(root->dataFile, key, keyLen, value, valueLen, hash)); }
+
+	if (root->batchLen + len > root->batchSize)
+	{
+		root->batchSize = (root->batchLen + len) * 2;
+		if ((root->batchBuffer = (char*)realloc(root->batchBuffer, root->batchSize)) == NULL) { ILIBCRITICALEXIT(254); }
+	}
+
+	header = (ILibSimpleDataStore_RecordHeader_NG*)(root->batchBuffer + root->batchLen);
+	header->nodeSize = htonl((int)sizeof(ILibSimpleDataStore_RecordHeader_NG) + keyLen + valueLen);
+	header->keyLen = htonl(keyLen);
+	header->valueLength = htonl(valueLen);
+	if (hash != NULL) { memcpy_s(header->hash, sizeof(header->hash), hash, SHA384HASHSIZE); } else { memset(header->hash, 0, SHA384HASHSIZE); }
+	memcpy_s(header->key, keyLen, key, keyLen);
+	if (value != NULL) { memcpy_s(header->key + keyLen, valueLen, value, valueLen); }
+
+	offset = root->batchOffset + root->batchLen + sizeof(ILibSimpleDataStore_RecordHeader_NG) + keyLen;
+	root->batchLen += len;
+	return(offset);
+}
+
 // Read the next record in the file
 ILibSimpleDataStore_RecordHeader_NG* ILibSimpleDataStore_ReadNextRecord(ILibSimpleDataStore_Root *root, int legacySize)
 {
@@ -305,7 +422,7 @@ ILibSimpleDataStore_RecordHeader_NG* ILibSimpleDataStore_ReadNextRecord(ILibSimp
 	node->valueLength = (int)ntohl(node->valueLength);
 	ILibSimpleDataStore_RecordHeader_ValueOffset(node) = (uint64_t)((uint64_t)ILibSimpleDataStore_GetPosition(root->dataFile) + (uint64_t)node->keyLen);
 
-	if (node->keyLen > (int)((sizeof(ILibScratchPad) - nodeSize - sizeof(uint64_t))))
+	if (node->keyLen < 0 || node->keyLen > (int)((sizeof(ILibScratchPad) - nodeSize - sizeof(uint64_t))))
 	{
 		// Invalid record
 		return(NULL);
@@ -315,6 +432,19 @@ ILibSimpleDataStore_RecordHeader_NG* ILibSimpleDataStore_ReadNextRecord(ILibSimp
 	i = (int)fread((char*)node + nodeSize, 1, node->keyLen, root->dataFile);
 	if (i != node->keyLen) return NULL; // Reading Key Failed
 
+	if (legacySize == 0)
+	{
+		//
+		// NG records are not hashed here, so that we don't have to read every value at startup. The hash is
+		// checked the first time the value is read instead. The header must still be consistent, which is also
+		// how the legacy formats are detected.
+		//
+		if (node->valueLength < 0 || node->nodeSize != (int)(nodeSize + node->keyLen + node->valueLength)) { return(NULL); }
+		if (ILibSimpleDataStore_RecordHeader_ValueOffset(node) + (uint64_t)node->valueLength > root->scanSize) { return(NULL); } // Truncated record
+		if (ILibSimpleDataStore_SeekPosition(root->dataFile, ILibSimpleDataStore_RecordHeader_ValueOffset(node) + node->valueLength, SEEK_SET) != 0) { return(NULL); }
+		return(node);
+	}
+
 	// Validate Data, in 4k chunks at a time
 	bytesLeft = node->valueLength;
 
@@ -359,6 +489,277 @@ void ILibSimpleDataStore_TableClear_Sink(ILibHashtable sender, void *Key1, char*
 	free(Data);
 }
 
+// Map the data store file into memory, so values can be read without seeking the FILE*
+void ILibSimpleDataStore_Unmap(ILibSimpleDataStore_Root *root)
+{
+	if (root->mappedView != NULL)
+	{
+#ifdef WIN32
+		UnmapViewOfFile(root->mappedView);
+		CloseHandle(root->mappedHandle);
+		root->mappedHandle = NULL;
+#else
+		munmap(root->mappedView, (size_t)root->mappedSize);
+#endif
+	}
+	root->mappedView = NULL;
+	root->mappedSize = 0;
+}
+void ILibSimpleDataStore_Map(ILibSimpleDataStore_Root *root)
+{
+	ILibSimpleDataStore_Unmap(root);
+	if (root->dataFile == NULL || root->fileSize == 0 || root->fileSize == (uint64_t)-1 || root->fileSize > (uint64_t)SIZE_MAX) { return; }
+
+	fflush(root->dataFile);
+#ifdef WIN32
+	if ((root->mappedHandle = CreateFileMappingW((HANDLE)_get_osfhandle(_fileno(root->dataFile)), NULL, PAGE_READONLY, 0, 0, NULL)) == NULL) { return; }
+	if ((root->mappedView = (char*)MapViewOfFile(root->mappedHandle, FILE_MAP_READ, 0, 0, 0)) == NULL)
+	{
+		CloseHandle(root->mappedHandle);
+		root->mappedHandle = NULL;
+		return;
+	}
+#else
+	root->mappedView = (char*)mmap(NULL, (size_t)root->fileSize, PROT_READ, MAP_SHARED, fileno(root->dataFile), 0);
+	if (root->mappedView == (char*)MAP_FAILED) { root->mappedView = NULL; return; }
+#endif
+	root->mappedSize = root->fileSize;
+}
+// Read a value from the data store into buffer, which must be at least entry->valueLength in size
+int ILibSimpleDataStore_ReadValue(ILibSimpleDataStore_Root *root, ILibSimpleDataStore_TableEntry *entry, char *buffer)
+{
+	if (root->batchDepth > 0 && entry->valueOffset >= root->batchOffset)
+	{
+		// The value hasn't been committed yet
+		memcpy_s(buffer, entry->valueLength, root->batchBuffer + (entry->valueOffset - root->batchOffset), entry->valueLength);
+		return(entry->valueLength);
+	}
+
+	// If the file grew since it was mapped, map it again
+	if (entry->valueOffset + (uint64_t)entry->valueLength > root->mappedSize) { ILibSimpleDataStore_Map(root); }
+
+	if (root->mappedView != NULL && entry->valueOffset + (uint64_t)entry->valueLength <= root->mappedSize)
+	{
+		memcpy_s(buffer, entry->valueLength, root->mappedView + entry->valueOffset, entry->valueLength);
+		return(entry->valueLength);
+	}
+	if (ILibSimpleDataStore_SeekPosition(root->dataFile, entry->valueOffset, SEEK_SET) != 0) return 0; // Seek to the position of the value in the data store
+	if (fread(buffer, 1, entry->valueLength, root->dataFile) != (size_t)entry->valueLength) return 0; // Read the value into the buffer
+	return(entry->valueLength);
+}
+
+// CRC32C of the last 4K of the data store, up to the specified size. Used to check that an index belongs to the data store.
+uint32_t ILibSimpleDataStore_TailCRC(ILibSimpleDataStore_Root *root, uint64_t size)
+{
+	char tail[ILibSimpleDataStore_INDEX_TAILSIZE];
+	uint64_t start = size > ILibSimpleDataStore_INDEX_TAILSIZE ? (size - ILibSimpleDataStore_INDEX_TAILSIZE) : 0;
+	size_t len = (size_t)(size - start);
+
+	if (len == 0) { return(0); }
+	if (ILibSimpleDataStore_SeekPosition(root->dataFile, start, SEEK_SET) != 0) { return(0); }
+	if (fread(tail, 1, len, root->dataFile) != len) { return(0); }
+	return(crc32c(0, (unsigned char*)tail, (uint32_t)len));
+}
+
+// Used by WriteIndex, to size and then fill the index
+void ILibSimpleDataStore_WriteIndex_Sink(ILibHashtable sender, void *Key1, char* Key2, int Key2Len, void *Data, void *user)
+{
+	ILibSimpleDataStore_TableEntry *entry = (ILibSimpleDataStore_TableEntry*)Data;
+	char *buffer = (char*)((void**)user)[0];
+	size_t *offset = (size_t*)((void**)user)[1];
+	uint32_t *count = (uint32_t*)((void**)user)[2];
+	ILibSimpleDataStore_IndexRecord *record;
+
+	UNREFERENCED_PARAMETER(sender);
+	UNREFERENCED_PARAMETER(Key1);
+
+	if (buffer != NULL)
+	{
+		record = (ILibSimpleDataStore_IndexRecord*)(buffer + *offset);
+		record->keyLen = htonl((uint32_t)Key2Len);
+		record->valueLength = htonl((uint32_t)entry->valueLength);
+		ILibSimpleDataStore_Put64(record->valueOffset, entry->valueOffset);
+		memcpy_s(record->hash, sizeof(record->hash), entry->valueHash, SHA384HASHSIZE);
+		memcpy_s(record->key, Key2Len, Key2, Key2Len);
+	}
+	*offset += sizeof(ILibSimpleDataStore_IndexRecord) + Key2Len;
+	*count += 1;
+}
+
+// Save a snapshot of the key table next to the data store, so it does not have to be rebuilt at startup
+int ILibSimpleDataStore_WriteIndex(ILibSimpleDataStore_Root *root)
+{
+	ILibSimpleDataStore_IndexHeader *header;
+	char *buffer = NULL, *idx, *tmp;
+	size_t offset = sizeof(ILibSimpleDataStore_IndexHeader);
+	uint32_t count = 0, crc;
+	void *state[] = { NULL, &offset, &count };
+	FILE *f;
+	int retVal = 1;
+
+	if (root == NULL || root->filePath == NULL || root->dataFile == NULL || root->readonly != 0 || root->fileSize == (uint64_t)-1) { return(1); }
+
+	// Size the index, then fill it
+	ILibHashtable_Enumerate(root->keyTable, ILibSimpleDataStore_WriteIndex_Sink, state);
+	buffer = (char*)ILibMemory_SmartAllocate(offset + sizeof(uint32_t));
+	offset = sizeof(ILibSimpleDataStore_IndexHeader);
+	count = 0;
+	state[0] = buffer;
+	ILibHashtable_Enumerate(root->keyTable, ILibSimpleDataStore_WriteIndex_Sink, state);
+
+	header = (ILibSimpleDataStore_IndexHeader*)buffer;
+	memcpy_s(header->magic, sizeof(header->magic), ILibSimpleDataStore_INDEX_MAGIC, sizeof(header->magic));
+	header->version = htonl(ILibSimpleDataStore_INDEX_VERSION);
+	ILibSimpleDataStore_Put64(header->coveredSize, root->fileSize);
+	header->tailCRC = htonl(ILibSimpleDataStore_TailCRC(root, root->fileSize));
+	header->entryCount = htonl(count);
+	ILibSimpleDataStore_Put64(header->dirtySize, root->dirtySize);
+	crc = htonl(crc32c(0, (unsigned char*)buffer, (uint32_t)offset));
+	memcpy_s(buffer + offset, sizeof(uint32_t), &crc, sizeof(uint32_t));
+
+	// Write to a temporary file first, and then move it over the index, so that the index is never partially written
+	idx = ILibString_Cat(root->filePath, -1, ".idx", -1);
+	tmp = ILibString_Cat(idx, -1, ".tmp", -1);
+	if ((f = ILibSimpleDataStore_OpenFileEx2(tmp, 1, 0)) != NULL)
+	{
+		size_t written = fwrite(buffer, 1, offset + sizeof(uint32_t), f);
+#ifdef _POSIX
+		flock(fileno(f), LOCK_UN);
+#endif
+		fclose(f);
+		if (written == offset + sizeof(uint32_t))
+		{
+#ifdef WIN32
+			WCHAR tmptmp[4096];
+			MultiByteToWideChar(CP_UTF8, 0, (LPCCH)tmp, -1, (LPWSTR)tmptmp, (int)sizeof(tmptmp) / 2);
+			if (MoveFileExW(tmptmp, ILibUTF8ToWide(idx, -1), MOVEFILE_REPLACE_EXISTING) != FALSE) { retVal = 0; } else { DeleteFileW(tmptmp); }
+#else
+			if (rename(tmp, idx) == 0) { retVal = 0; } else { remove(tmp); }
+#endif
+		}
+	}
+	if (retVal == 0) { root->indexedSize = root->fileSize; }
+
+	free(tmp);
+	free(idx);
+	ILibMemory_Free(buffer);
+	return(retVal);
+}
+
+// Load the key table from the index file. On success, the data store is positioned at the first record not covered by the index.
+int ILibSimpleDataStore_LoadIndex(ILibSimpleDataStore_Root *root)
+{
+	ILibSimpleDataStore_IndexHeader *header;
+	ILibSimpleDataStore_IndexRecord *record;
+	ILibSimpleDataStore_TableEntry *entry;
+	char *buffer = NULL, *idx;
+	uint64_t coveredSize, idxSize;
+	size_t offset;
+	uint32_t i, count, crc;
+	FILE *f;
+	int retVal = 1;
+
+	if (root->filePath == NULL) { return(1); }
+	idx = ILibString_Cat(root->filePath, -1, ".idx", -1);
+#ifdef WIN32
+	f = _wfopen(ILibUTF8ToWide(idx, -1), L"rb");
+#else
+	f = fopen(idx, "rb");
+#endif
+	free(idx);
+	if (f == NULL) { return(1); }
+
+	fseek(f, 0, SEEK_END);
+	idxSize = (uint64_t)ILibSimpleDataStore_GetPosition(f);
+	fseek(f, 0, SEEK_SET);
+	if (idxSize >= sizeof(ILibSimpleDataStore_IndexHeader) + sizeof(uint32_t) && idxSize < INT32_MAX)
+	{
+		buffer = (char*)ILibMemory_SmartAllocate((size_t)idxSize);
+		if (fread(buffer, 1, (size_t)idxSize, f) != (size_t)idxSize) { ILibMemory_Free(buffer); buffer = NULL; }
+	}
+	fclose(f);
+	if (buffer == NULL) { return(1); }
+
+	header = (ILibSimpleDataStore_IndexHeader*)buffer;
+	memcpy_s(&crc, sizeof(crc), buffer + idxSize - sizeof(uint32_t), sizeof(uint32_t));
+	coveredSize = ILibSimpleDataStore_Get64(header->coveredSize);
+
+	if (memcmp(header->magic, ILibSimpleDataStore_INDEX_MAGIC, sizeof(header->magic)) == 0 && ntohl(header->version) == ILibSimpleDataStore_INDEX_VERSION &&
+		ntohl(crc) == crc32c(0, (unsigned char*)buffer, (uint32_t)(idxSize - sizeof(uint32_t))) &&
+		coveredSize <= root->scanSize && ntohl(header->tailCRC) == ILibSimpleDataStore_TailCRC(root, coveredSize))
+	{
+		retVal = 0;
+		count = ntohl(header->entryCount);
+		offset = sizeof(ILibSimpleDataStore_IndexHeader);
+		for (i = 0; i < count; ++i)
+		{
+			record = (ILibSimpleDataStore_IndexRecord*)(buffer + offset);
+			if (offset + sizeof(ILibSimpleDataStore_IndexRecord) > idxSize - sizeof(uint32_t) ||
+				ntohl(record->keyLen) > ILibSimpleDataStore_MaxKeyLength + sizeof(uint32_t) ||
+				offset + sizeof(ILibSimpleDataStore_IndexRecord) + ntohl(record->keyLen) > idxSize - sizeof(uint32_t) ||
+				ntohl(record->valueLength) > INT32_MAX ||
+				ILibSimpleDataStore_Get64(record->valueOffset) + ntohl(record->valueLength) > coveredSize)
+			{
+				retVal = 1;
+				break;
+			}
+			entry = (ILibSimpleDataStore_TableEntry*)ILibMemory_Allocate(sizeof(ILibSimpleDataStore_TableEntry), 0, NULL, NULL);
+			entry->valueLength = (int)ntohl(record->valueLength);
+			entry->valueOffset = ILibSimpleDataStore_Get64(record->valueOffset);
+			memcpy_s(entry->valueHash, sizeof(entry->valueHash), record->hash, SHA384HASHSIZE);
+			free(ILibHashtable_Put(root->keyTable, NULL, record->key, (int)ntohl(record->keyLen), entry));
+			offset += sizeof(ILibSimpleDataStore_IndexRecord) + ntohl(record->keyLen);
+		}
+	}
+
+	if (retVal == 0)
+	{
+		root->dirtySize = ILibSimpleDataStore_Get64(header->dirtySize);
+		root->indexedSize = coveredSize;
+		ILibSimpleDataStore_SeekPosition(root->dataFile, coveredSize, SEEK_SET);
+	}
+	ILibMemory_Free(buffer);
+	return(retVal);
+}
+
+// Apply an NG record to the in-memory key table. Returns the change in the number of keys.
+int ILibSimpleDataStore_ApplyRecord(ILibSimpleDataStore_Root *root, ILibSimpleDataStore_RecordHeader_NG *node)
+{
+	int count = 0;
+
+	// Get the entry from the memory table
+	ILibSimpleDataStore_TableEntry *entry = (ILibSimpleDataStore_TableEntry*)ILibHashtable_Get(root->keyTable, NULL, node->key, node->keyLen);
+	if (node->valueLength > 0)
+	{
+		// If the value is not empty, we need to create/overwrite this value in memory
+		if (entry == NULL) 
+		{
+			// Create new entry in table
+			++count;  
+			entry = (ILibSimpleDataStore_TableEntry*)ILibMemory_Allocate(sizeof(ILibSimpleDataStore_TableEntry), 0, NULL, NULL);
+		}
+		else
+		{
+			// Entry already exists in table
+			root->dirtySize += entry->valueLength;
+		}
+		memcpy_s(entry->valueHash, sizeof(entry->valueHash), node->hash, SHA384HASHSIZE);
+		entry->valueLength = node->valueLength;
+		entry->valueOffset = ILibSimpleDataStore_RecordHeader_ValueOffset(node);
+		entry->verified = 0;
+		ILibHashtable_Put(root->keyTable, NULL, node->key, node->keyLen, entry);
+	}
+	else if (entry != NULL)
+	{
+		// If value is empty, remove the in-memory entry.
+		root->dirtySize += entry->valueLength;
+		--count;
+		ILibHashtable_Remove(root->keyTable, NULL, node->key, node->keyLen);
+		free(entry);
+	}
+	return(count);
+}
+
 // Rebuild the in-memory key to record table, done when starting up the data store
 void ILibSimpleDataStore_RebuildKeyTable(ILibSimpleDataStore_Root *root)
 {
@@ -368,44 +769,32 @@ void ILibSimpleDataStore_RebuildKeyTable(ILibSimpleDataStore_Root *root)
 
 	if (root == NULL) return;
 
+	ILibHashtable_ClearEx(root->keyTable, ILibSimpleDataStore_TableClear_Sink, root); // Wipe the key table, we will rebulit it
+	fseek(root->dataFile, 0, SEEK_END);
+	root->scanSize = ILibSimpleDataStore_GetPosition(root->dataFile);
+	root->dirtySize = 0;
+	root->indexedSize = 0;
+
+	if (ILibSimpleDataStore_LoadIndex(root) == 0)
+	{
+		// The index matched, so we only need to read the records that were appended after it was written
+		root->fileSize = -1;
+		while ((node = ILibSimpleDataStore_ReadNextRecord(root, 0)) != NULL) { ILibSimpleDataStore_ApplyRecord(root, node); }
+		root->fileSize = ILibSimpleDataStore_GetPosition(root->dataFile);
+		if (root->fileSize != root->indexedSize) { ILibSimpleDataStore_WriteIndex(root); }
+		return;
+	}
+
 	ILibHashtable_ClearEx(root->keyTable, ILibSimpleDataStore_TableClear_Sink, root); // Wipe the key table, we will rebulit it
 	fseek(root->dataFile, 0, SEEK_SET); // See the start of the file
 	root->fileSize = -1; // Indicate we can't write to the data store
-
+	root->dirtySize = 0;
 
 	// First, try NG Format
 	count = 0;
 	while ((node = ILibSimpleDataStore_ReadNextRecord(root, 0)) != NULL)
 	{
-		// Get the entry from the memory table
-		entry = (ILibSimpleDataStore_TableEntry*)ILibHashtable_Get(root->keyTable, NULL, node->key, node->keyLen);
-		if (node->valueLength > 0)
-		{
-			// If the value is not empty, we need to create/overwrite this value in memory
-			if (entry == NULL) 
-			{
-				// Create new entry in table
-				++count;  
-				entry = (ILibSimpleDataStore_TableEntry*)ILibMemory_Allocate(sizeof(ILibSimpleDataStore_TableEntry), 0, NULL, NULL);
-			}
-			else
-			{
-				// Entry already exists in table
-				root->dirtySize += entry->valueLength;
-			}
-			memcpy_s(entry->valueHash, sizeof(entry->valueHash), node->hash, SHA384HASHSIZE);
-			entry->valueLength = node->valueLength;
-			entry->valueOffset = ILibSimpleDataStore_RecordHeader_ValueOffset(node);
-			ILibHashtable_Put(root->keyTable, NULL, node->key, node->keyLen, entry);
-		}
-		else if (entry != NULL)
-		{
-			// If value is empty, remove the in-memory entry.
-			root->dirtySize += entry->valueLength;
-			--count;
-			ILibHashtable_Remove(root->keyTable, NULL, node->key, node->keyLen);
-			free(entry);
-		}
+		count += ILibSimpleDataStore_ApplyRecord(root, node);
 	}
 	
 	if (count == 0)
@@ -476,6 +865,7 @@ void ILibSimpleDataStore_RebuildKeyTable(ILibSimpleDataStore_Root *root)
 	{
 		// No need to convert db format, because we're already NG format
 		root->fileSize = ILibSimpleDataStore_GetPosition(root->dataFile);
+		ILibSimpleDataStore_WriteIndex(root);
 	}
 }
 
@@ -559,14 +949,21 @@ __EXPORT_TYPE ILibSimpleDataStore ILibSimpleDataStore_CreateEx2(char* filePath,
 		}
 	}
 
+	retVal->readonly = readonly;
 	retVal->keyTable = ILibHashtable_Create();
-	if (retVal->dataFile != NULL) { ILibSimpleDataStore_RebuildKeyTable(retVal); }
+	if (retVal->dataFile != NULL) 
+	{
+		ILibSimpleDataStore_RebuildKeyTable(retVal); 
+		ILibSimpleDataStore_Map(retVal);
+	}
 	return retVal;
 }
 void ILibSimpleDataStore_ReOpenReadOnly(ILibSimpleDataStore dataStore, char* filePath)
 {
 	ILibSimpleDataStore_Root *root = (ILibSimpleDataStore_Root*)dataStore;
 
+	ILibSimpleDataStore_Compaction_Cancel(root);
+	ILibSimpleDataStore_Unmap(root);
 	if (root->dataFile != NULL)
 	{
 #ifdef _POSIX
@@ -578,8 +975,13 @@ void ILibSimpleDataStore_ReOpenReadOnly(ILibSimpleDataStore dataStore, char* fil
 	{
 		root->filePath = ILibString_Copy(filePath, strnlen_s(filePath, ILibSimpleDataStore_MaxFilePath));
 	}
+	root->readonly = 1;
 	root->dataFile = ILibSimpleDataStore_OpenFileEx2(root->filePath, 0, 1);
-	if (root->dataFile != NULL) { ILibSimpleDataStore_RebuildKeyTable(root); }
+	if (root->dataFile != NULL) 
+	{
+		ILibSimpleDataStore_RebuildKeyTable(root); 
+		ILibSimpleDataStore_Map(root);
+	}
 }
 void ILibSimpleDataStore_CacheClear_Sink(ILibHashtable sender, void *Key1, char* Key2, int Key2Len, void *Data, void *user)
 {
@@ -598,6 +1000,11 @@ __EXPORT_TYPE void ILibSimpleDataStore_Close(ILibSimpleDataStore dataStore)
 	ILibSimpleDataStore_Root *root = (ILibSimpleDataStore_Root*)dataStore;
 
 	if (root == NULL) return;
+	if (root->batchDepth > 0) { root->batchDepth = 1; ILibSimpleDataStore_CommitBatch(root); }
+	if (root->batchBuffer != NULL) { free(root->batchBuffer); }
+	ILibSimpleDataStore_Compaction_Cancel(root);
+	if (root->dataFile != NULL && root->fileSize != root->indexedSize) { ILibSimpleDataStore_WriteIndex(root); }
+	ILibSimpleDataStore_Unmap(root);
 	ILibHashtable_DestroyEx(root->keyTable, ILibSimpleDataStore_TableClear_Sink, root);
 	if (root->cacheTable != NULL) { ILibHashtable_DestroyEx(root->cacheTable, ILibSimpleDataStore_CacheClear_Sink, NULL); }
 
@@ -640,7 +1047,7 @@ __EXPORT_TYPE int ILibSimpleDataStore_PutEx2(ILibSimpleDataStore dataStore, char
 		entry = (ILibSimpleDataStore_TableEntry*)ILibHashtable_Remove(root->keyTable, NULL, key, (int)keyLen); // No loss of data, capped to INT32_MAX
 		if (entry != NULL)
 		{
-			ILibSimpleDataStore_WriteRecord(root->dataFile, key, (int)keyLen, NULL, 0, NULL); // No dataloss, capped to INT32_MAX
+			ILibSimpleDataStore_AppendRecord(root, key, (int)keyLen, NULL, 0, NULL); // No dataloss, capped to INT32_MAX
 		}
 
 		// Calculate the key to use for the compressed record entry
@@ -670,8 +1077,12 @@ __EXPORT_TYPE int ILibSimpleDataStore_PutEx2(ILibSimpleDataStore dataStore, char
 
 	memcpy_s(entry->valueHash, sizeof(entry->valueHash), hash, SHA384HASHSIZE);
 	entry->valueLength = (int)valueLen; // No dataloss, capped to INT32_MAX
-	entry->valueOffset = ILibSimpleDataStore_WriteRecord(root->dataFile, key, (int)keyLen, value, (int)valueLen, entry->valueHash); // Write the key and value, no dataloss, capped to INT32_MAX
-	root->fileSize = ILibSimpleDataStore_GetPosition(root->dataFile); // Update the size of the data store;
+	entry->verified = 1;
+#ifdef WIN32
+	ILibSimpleDataStore_Unmap(root); // Windows can't undo a failed write, while the file is mapped
+#endif
+	entry->valueOffset = ILibSimpleDataStore_AppendRecord(root, key, (int)keyLen, value, (int)valueLen, entry->valueHash); // Write the key and value, no dataloss, capped to INT32_MAX
+	if (root->batchDepth == 0) { root->fileSize = ILibSimpleDataStore_GetPosition(root->dataFile); } // Update the size of the data store
 
 	if (entry->valueOffset == 0)
 	{
@@ -797,10 +1208,14 @@ __EXPORT_TYPE int ILibSimpleDataStore_GetEx(ILibSimpleDataStore dataStore, char*
 	if (entry == NULL) return 0; // If there is no in-memory entry for this key, return zero now.
 	if ((buffer != NULL) && (bufferLen >= (size_t)entry->valueLength) && isCompressed == 0) // If the buffer is not null and can hold the value, place the value in the buffer.
 	{
-		if (ILibSimpleDataStore_SeekPosition(root->dataFile, entry->valueOffset, SEEK_SET) != 0) return 0; // Seek to the position of the value in the data store
-		if (fread(buffer, 1, entry->valueLength, root->dataFile) == 0) return 0; // Read the value into the buffer
-		util_sha384(buffer, entry->valueLength, hash); // Compute the hash of the read value
-		if (memcmp(hash, entry->valueHash, SHA384HASHSIZE) != 0) return 0; // Check the hash, return 0 if not valid
+		if (ILibSimpleDataStore_ReadValue(root, entry, buffer) == 0) return 0; // Read the value into the buffer
+		if (entry->verified == 0)
+		{
+			// The hash is only checked the first time the value is read
+			util_sha384(buffer, entry->valueLength, hash); // Compute the hash of the read value
+			if (memcmp(hash, entry->valueHash, SHA384HASHSIZE) != 0) return 0; // Check the hash, return 0 if not valid
+			entry->verified = 1;
+		}
 		if (bufferLen > (size_t)entry->valueLength) { buffer[entry->valueLength] = 0; } // Add a zero at the end to be nice, if the buffer can take it.
 	}
 	else if (isCompressed != 0)
@@ -808,17 +1223,17 @@ __EXPORT_TYPE int ILibSimpleDataStore_GetEx(ILibSimpleDataStore dataStore, char*
 		// This is a compressed record
 		char *compressed = ILibMemory_SmartAllocate(entry->valueLength);
 		size_t tmplen = bufferLen;
-		if (ILibSimpleDataStore_SeekPosition(root->dataFile, entry->valueOffset, SEEK_SET) != 0) return 0; // Seek to the position of the value in the data store
-		if (fread(compressed, 1, entry->valueLength, root->dataFile) == 0) return 0; // Read the value into the buffer
+		if (ILibSimpleDataStore_ReadValue(root, entry, compressed) == 0) { ILibMemory_Free(compressed); return 0; } // Read the value into the buffer
 		if (ILibInflate(compressed, entry->valueLength, buffer, &tmplen, 0) == 0)
 		{
 			ILibMemory_Free(compressed);
-			if (buffer == NULL) { return((int)tmplen); }
+			if (buffer == NULL || entry->verified != 0) { return((int)tmplen); }
 
 			// Before we return, we need to check the HASH of the uncompressed data
 			ILibSimpleDataStore_SHA384(buffer, (int)tmplen, hash);
 			if (memcmp(hash, entry->valueHash, SHA384HASHSIZE) == 0)
 			{
+				entry->verified = 1;
 				return((int)tmplen);
 			}
 			else
@@ -893,6 +1308,9 @@ __EXPORT_TYPE int ILibSimpleDataStore_DeleteEx(ILibSimpleDataStore dataStore, ch
 	ILibSimpleDataStore_TableEntry *entry;
 	
 	if (root == NULL) return 0;
+#ifdef WIN32
+	ILibSimpleDataStore_Unmap(root); // Windows can't undo a failed write, while the file is mapped
+#endif
 	entry = (ILibSimpleDataStore_TableEntry*)ILibHashtable_Remove(root->keyTable, NULL, key, (int)keyLen); // no dataloss, capped to INT32_MAX
 	if (entry == NULL)
 	{
@@ -903,7 +1321,7 @@ __EXPORT_TYPE int ILibSimpleDataStore_DeleteEx(ILibSimpleDataStore dataStore, ch
 		entry = (ILibSimpleDataStore_TableEntry*)ILibHashtable_Remove(root->keyTable, NULL, tmpkey, (int)ILibMemory_Size(tmpkey));
 		if (entry != NULL)
 		{
-			if (ILibSimpleDataStore_WriteRecord(root->dataFile, tmpkey, (int)ILibMemory_Size(tmpkey), NULL, 0, NULL) == 0)
+			if (ILibSimpleDataStore_AppendRecord(root, tmpkey, (int)ILibMemory_Size(tmpkey), NULL, 0, NULL) == 0)
 			{
 				if (root->ErrorHandler != NULL) { root->ErrorHandler(root, root->ErrorHandlerUser); }
 			}
@@ -915,7 +1333,7 @@ __EXPORT_TYPE int ILibSimpleDataStore_DeleteEx(ILibSimpleDataStore dataStore, ch
 	}
 	else
 	{
-		if (ILibSimpleDataStore_WriteRecord(root->dataFile, key, (int)keyLen, NULL, 0, NULL) == 0) // no dataloss, capped to INT32_MAX
+		if (ILibSimpleDataStore_AppendRecord(root, key, (int)keyLen, NULL, 0, NULL) == 0) // no dataloss, capped to INT32_MAX
 		{
 			if (root->ErrorHandler != NULL) { root->ErrorHandler(root, root->ErrorHandlerUser); }
 		}
@@ -925,6 +1343,105 @@ __EXPORT_TYPE int ILibSimpleDataStore_DeleteEx(ILibSimpleDataStore dataStore, ch
 	return 0;
 }
 
+// Start a batch. Records are held in memory until the batch is committed, and then written with a single write and flush.
+__EXPORT_TYPE void ILibSimpleDataStore_BeginBatch(ILibSimpleDataStore dataStore)
+{
+	ILibSimpleDataStore_Root *root = (ILibSimpleDataStore_Root*)dataStore;
+	if (root == NULL) return;
+
+	if (root->batchDepth++ == 0 && root->dataFile != NULL)
+	{
+		fseek(root->dataFile, 0, SEEK_END);
+		root->batchOffset = ILibSimpleDataStore_GetPosition(root->dataFile);
+		root->batchLen = 0;
+	}
+}
+
+// Used when a batch could not be written, to keep its records in the cache
+void ILibSimpleDataStore_CommitBatch_Recover(ILibSimpleDataStore_Root *root, char *batch, size_t batchLen)
+{
+	ILibSimpleDataStore_RecordHeader_NG *header;
+	ILibSimpleDataStore_TableEntry *entry;
+	ILibSimpleDataStore_CacheEntry *centry;
+	size_t i = 0;
+	int keyLen, valueLength;
+
+	while (i < batchLen)
+	{
+		header = (ILibSimpleDataStore_RecordHeader_NG*)(batch + i);
+		keyLen = ntohl(header->keyLen);
+		valueLength = ntohl(header->valueLength);
+		if (valueLength > 0)
+		{
+			if (keyLen > (int)sizeof(uint32_t) && crc32c(0, (unsigned char*)header->key, keyLen - sizeof(uint32_t)) == ((uint32_t*)(header->key + keyLen - sizeof(uint32_t)))[0])
+			{
+				// Compressed record
+				ILibSimpleDataStore_CachedEx(root, header->key, keyLen - sizeof(uint32_t), header->key + keyLen, valueLength, header->hash);
+			}
+			else
+			{
+				ILibSimpleDataStore_CachedEx(root, header->key, keyLen, header->key + keyLen, valueLength, NULL);
+			}
+		}
+		else
+		{
+			// Deleted in the batch. The file still has the key, so it must also go from the key table that was read back from the file.
+			if (root->cacheTable != NULL && (centry = (ILibSimpleDataStore_CacheEntry*)ILibHashtable_Remove(root->cacheTable, NULL, header->key, keyLen)) != NULL) { free(centry); }
+			if ((entry = (ILibSimpleDataStore_TableEntry*)ILibHashtable_Remove(root->keyTable, NULL, header->key, keyLen)) != NULL) { free(entry); }
+		}
+		i += ntohl(header->nodeSize);
+	}
+}
+
+// Commit a batch. Nested batches are committed when the outermost batch is committed. Returns 0 on success.
+__EXPORT_TYPE int ILibSimpleDataStore_CommitBatch(ILibSimpleDataStore dataStore)
+{
+	ILibSimpleDataStore_Root *root = (ILibSimpleDataStore_Root*)dataStore;
+	char *batch;
+	size_t batchLen;
+
+	if (root == NULL || root->batchDepth == 0) return 1;
+	if (--root->batchDepth > 0 || root->batchLen == 0) return 0;
+
+#ifdef WIN32
+	ILibSimpleDataStore_Unmap(root); // Windows can't undo a failed write, while the file is mapped
+#endif
+	fseek(root->dataFile, 0, SEEK_END);
+	if (fwrite(root->batchBuffer, 1, root->batchLen, root->dataFile) == root->batchLen && fflush(root->dataFile) == 0)
+	{
+		root->fileSize = ILibSimpleDataStore_GetPosition(root->dataFile); // Update the size of the data store
+		root->batchLen = 0;
+		if (root->warningSize > 0 && root->fileSize > root->warningSize && root->warningSink != NULL)
+		{
+			root->warningSink(root, root->fileSize, root->warningSinkUser);
+		}
+		return 0;
+	}
+
+	//
+	// Unable to write the batch, so undo the write, switch to readonly mode,
+	// and keep the records of the batch in the cache
+	//
+#ifdef WIN32
+	LARGE_INTEGER i;
+	i.QuadPart = root->batchOffset;
+	SetFilePointerEx((HANDLE)_get_osfhandle(_fileno(root->dataFile)), i, NULL, FILE_BEGIN);
+	SetEndOfFile((HANDLE)_get_osfhandle(_fileno(root->dataFile)));
+#else
+	ignore_result(ftruncate(fileno(root->dataFile), root->batchOffset));
+#endif
+	batch = root->batchBuffer;
+	batchLen = root->batchLen;
+	root->batchBuffer = NULL;
+	root->batchLen = root->batchSize = 0;
+
+	ILibSimpleDataStore_ReOpenReadOnly(root, NULL);
+	ILibSimpleDataStore_CommitBatch_Recover(root, batch, batchLen);
+	free(batch);
+	if (root->ErrorHandler != NULL) { root->ErrorHandler(root, root->ErrorHandlerUser); }
+	return 1;
+}
+
 // Lock the data store file
 __EXPORT_TYPE void ILibSimpleDataStore_Lock(ILibSimpleDataStore dataStore)
 {
@@ -1047,6 +1564,118 @@ __EXPORT_TYPE void ILibSimpleDataStore_ConfigCompact(ILibSimpleDataStore dataSto
 	ILibSimpleDataStore_Root *root = (ILibSimpleDataStore_Root*)dataStore;
 	root->minimumDirtySize = minimumDirtySize;
 }
+// Microseconds since start
+uint64_t ILibSimpleDataStore_Compaction_Elapsed(struct timeval *start)
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return((uint64_t)(((int64_t)now.tv_sec - (int64_t)start->tv_sec) * 1000000 + ((int64_t)now.tv_usec - (int64_t)start->tv_usec)));
+}
+// Used by the background compaction, to count and then snapshot the keys
+void ILibSimpleDataStore_Compaction_CountSink(ILibHashtable sender, void *Key1, char* Key2, int Key2Len, void *Data, void *user)
+{
+	UNREFERENCED_PARAMETER(sender);
+	UNREFERENCED_PARAMETER(Key1);
+	UNREFERENCED_PARAMETER(Key2);
+	UNREFERENCED_PARAMETER(Key2Len);
+	UNREFERENCED_PARAMETER(Data);
+	++((int*)user)[0];
+}
+void ILibSimpleDataStore_Compaction_KeySink(ILibHashtable sender, void *Key1, char* Key2, int Key2Len, void *Data, void *user)
+{
+	ILibSimpleDataStore_Compaction *state = (ILibSimpleDataStore_Compaction*)user;
+
+	UNREFERENCED_PARAMETER(sender);
+	UNREFERENCED_PARAMETER(Key1);
+	UNREFERENCED_PARAMETER(Data);
+
+	state->keys[state->keyCount].key = (char*)ILibMemory_SmartAllocate(Key2Len);
+	memcpy_s(state->keys[state->keyCount].key, Key2Len, Key2, Key2Len);
+	state->keys[state->keyCount].keyLen = Key2Len;
+	++state->keyCount;
+}
+// Used by the background compaction, once the compacted data store replaces the data store, to point the entries at the new offsets
+void ILibSimpleDataStore_Compaction_RebaseSink(ILibHashtable sender, void *Key1, char* Key2, int Key2Len, void *Data, void *user)
+{
+	ILibSimpleDataStore_TableEntry *entry = (ILibSimpleDataStore_TableEntry*)Data;
+	uint64_t endOffset = ((uint64_t*)user)[0];
+	uint64_t tailOffset = ((uint64_t*)user)[1];
+
+	UNREFERENCED_PARAMETER(sender);
+	UNREFERENCED_PARAMETER(Key1);
+	UNREFERENCED_PARAMETER(Key2);
+	UNREFERENCED_PARAMETER(Key2Len);
+
+	if (entry->valueOffset >= endOffset)
+	{
+		// Written after the compaction started, so it was copied as part of the tail
+		entry->valueOffset = entry->valueOffset - endOffset + tailOffset;
+	}
+	else
+	{
+		entry->valueOffset = entry->compactOffset;
+	}
+}
+void ILibSimpleDataStore_Compaction_Free(ILibSimpleDataStore_Compaction *state)
+{
+	int i;
+	for (i = 0; i < state->keyCount; ++i) { ILibMemory_Free(state->keys[i].key); }
+	if (state->keys != NULL) { free(state->keys); }
+	if (state->value != NULL) { ILibMemory_Free(state->value); }
+	if (state->tmpPath != NULL) { free(state->tmpPath); }
+	free(state);
+}
+// Stops a background compaction, and removes the temporary data store. The state is freed by the pending slice.
+void ILibSimpleDataStore_Compaction_Cancel(ILibSimpleDataStore_Root *root)
+{
+	ILibSimpleDataStore_Compaction *state = root->compaction;
+	if (state == NULL) { return; }
+
+	fclose(state->compacted);
+#ifdef WIN32
+	DeleteFileW(ILibUTF8ToWide(state->tmpPath, -1));
+#else
+	remove(state->tmpPath);
+#endif
+	state->root = NULL;
+	root->compaction = NULL;
+	root->compactionStats.inProgress = 0;
+}
+// Replace the data store with the compacted temporary data store, and open it. Used by both forms of compaction.
+int ILibSimpleDataStore_Compact_Swap(ILibSimpleDataStore_Root *root, char *tmp, FILE *compacted)
+{
+	int retVal = 0;
+
+	ILibSimpleDataStore_Unmap(root);
+#ifdef _POSIX
+	flock(fileno(root->dataFile), LOCK_UN);
+#endif
+	fclose(root->dataFile); // Close the data store
+	fclose(compacted); // Close the temporary data store
+
+	// Now we copy the temporary data store over the data store, making it the new valid version
+#ifdef WIN32
+	WCHAR tmptmp[4096];
+	MultiByteToWideChar(CP_UTF8, 0, (LPCCH)tmp, -1, (LPWSTR)tmptmp, (int)sizeof(tmptmp) / 2);
+	if (CopyFileW(tmptmp, ILibUTF8ToWide(root->filePath, -1), FALSE) == FALSE) { retVal = 1; }
+	DeleteFileW(tmptmp);
+#else
+	if (rename(tmp, root->filePath) != 0) { retVal = 1; }
+#endif
+
+	// We then open the newly compacted data store
+	if ((root->dataFile = ILibSimpleDataStore_OpenFile(root->filePath)) != NULL)
+	{
+		fseek(root->dataFile, 0, SEEK_END);
+		root->fileSize = ILibSimpleDataStore_GetPosition(root->dataFile);
+	}
+	else
+	{
+		retVal = 1;
+	}
+	return(retVal);
+}
+
 // Compact the data store
 __EXPORT_TYPE int ILibSimpleDataStore_Compact(ILibSimpleDataStore dataStore)
 {
@@ -1055,12 +1684,17 @@ __EXPORT_TYPE int ILibSimpleDataStore_Compact(ILibSimpleDataStore dataStore)
 	FILE* compacted;
 	void* state[2];
 	int retVal = 0;
+	uint64_t sizeBefore;
+	struct timeval start;
 
-	if (root == NULL || root->dirtySize < root->minimumDirtySize || root->filePath == NULL) return 1; // Error
+	if (root == NULL || root->dirtySize < root->minimumDirtySize || root->filePath == NULL || root->batchDepth > 0) return 1; // Error
+	ILibSimpleDataStore_Compaction_Cancel(root); // A synchronous compaction supersedes a background one
 	tmp = ILibString_Cat(root->filePath, -1, ".tmp", -1); // Create the name of the temporary data store
 
 	// Start by opening a temporary .tmp file. Will be used to write the compacted data store.
 	if ((compacted = ILibSimpleDataStore_OpenFileEx(tmp, 1)) == NULL) { free(tmp); return 1; }
+	gettimeofday(&start, NULL);
+	sizeBefore = root->fileSize;
 
 	// Enumerate all keys and write them all into the temporary data store
 	state[0] = root;
@@ -1072,31 +1706,196 @@ __EXPORT_TYPE int ILibSimpleDataStore_Compact(ILibSimpleDataStore dataStore)
 	if (root->error == 0)
 	{
 		// Success in writing new temporary file
-#ifdef _POSIX
-		flock(fileno(root->dataFile), LOCK_UN);
-#endif
-		fclose(root->dataFile); // Close the data store
-		fclose(compacted); // Close the temporary data store
-
-		// Now we copy the temporary data store over the data store, making it the new valid version
-#ifdef WIN32
-		WCHAR tmptmp[4096];
-		MultiByteToWideChar(CP_UTF8, 0, (LPCCH)tmp, -1, (LPWSTR)tmptmp, (int)sizeof(tmptmp) / 2);
-		if (CopyFileW(tmptmp, ILibUTF8ToWide(root->filePath, -1), FALSE) == FALSE) { retVal = 1; }
-		DeleteFileW(tmptmp);
-#else
-		if (rename(tmp, root->filePath) != 0) { retVal = 1; }
-#endif
-
-		// We then open the newly compacted data store
-		if ((root->dataFile = ILibSimpleDataStore_OpenFile(root->filePath)) != NULL) { root->fileSize = ILibSimpleDataStore_GetPosition(root->dataFile); } else { retVal = 1; }
+		retVal = ILibSimpleDataStore_Compact_Swap(root, tmp, compacted);
+		if (root->dataFile != NULL)
+		{
+			if (retVal == 0) { root->dirtySize = 0; }
+			ILibSimpleDataStore_WriteIndex(root);
+			ILibSimpleDataStore_Map(root);
+		}
+		if (retVal == 0)
+		{
+			memset(&(root->compactionStats), 0, sizeof(root->compactionStats));
+			root->compactionStats.sliceCount = 1;
+			root->compactionStats.bytesCopied = root->fileSize;
+			root->compactionStats.bytesReclaimed = sizeBefore > root->fileSize ? (sizeBefore - root->fileSize) : 0;
+			root->compactionStats.lastSliceMicroseconds = root->compactionStats.maxSliceMicroseconds = root->compactionStats.totalMicroseconds = ILibSimpleDataStore_Compaction_Elapsed(&start);
+		}
+	}
+	else
+	{
+		fclose(compacted);
 	}
 
 	free(tmp); // Free the temporary file name
 	return retVal; // Return 1 if we got an error, 0 if everything finished correctly
 }
 
+// Copy the records written after the background compaction started, then swap in the compacted data store
+int ILibSimpleDataStore_Compaction_Finish(ILibSimpleDataStore_Compaction *state)
+{
+	ILibSimpleDataStore_Root *root = state->root;
+	uint64_t offsets[2];
+	uint64_t position = state->endOffset;
+	size_t len;
+
+	fseek(state->compacted, 0, SEEK_END);
+	offsets[0] = state->endOffset;
+	offsets[1] = ILibSimpleDataStore_GetPosition(state->compacted);
+
+	// The tail is a valid sequence of records, so it is copied as is
+	while (position < root->fileSize)
+	{
+		len = (size_t)(root->fileSize - position > sizeof(root->scratchPad) ? sizeof(root->scratchPad) : root->fileSize - position);
+		if (ILibSimpleDataStore_SeekPosition(root->dataFile, position, SEEK_SET) != 0) { return(1); }
+		if (fread(root->scratchPad, 1, len, root->dataFile) != len) { return(1); }
+		if (fwrite(root->scratchPad, 1, len, state->compacted) != len) { return(1); }
+		position += len;
+	}
+	if (fflush(state->compacted) != 0) { return(1); }
+
+	root->compaction = NULL;
+	if (ILibSimpleDataStore_Compact_Swap(root, state->tmpPath, state->compacted) != 0)
+	{
+		// The data store was not replaced, so the key table still describes it
+		if (root->dataFile != NULL) { ILibSimpleDataStore_Map(root); }
+		return(1);
+	}
+
+	ILibHashtable_Enumerate(root->keyTable, ILibSimpleDataStore_Compaction_RebaseSink, offsets);
+	root->dirtySize = root->dirtySize > state->startDirtySize ? (root->dirtySize - state->startDirtySize) : 0;
+	root->compactionStats.bytesReclaimed = state->startSize > root->fileSize ? (state->startSize - root->fileSize) : 0;
+	root->compactionStats.bytesCopied += root->fileSize - offsets[1];
+	ILibSimpleDataStore_WriteIndex(root);
+	ILibSimpleDataStore_Map(root);
+	return(0);
+}
+void ILibSimpleDataStore_Compaction_Abort(void *chain, void *user)
+{
+	ILibSimpleDataStore_Compaction *state = (ILibSimpleDataStore_Compaction*)user;
+	UNREFERENCED_PARAMETER(chain);
+
+	if (state->root != NULL) { ILibSimpleDataStore_Compaction_Cancel(state->root); }
+	ILibSimpleDataStore_Compaction_Free(state);
+}
+void ILibSimpleDataStore_Compaction_Slice(void *chain, void *user);
+// ILibLifeTime handlers, for a slice that is waiting for a batch to be committed
+void ILibSimpleDataStore_Compaction_Wait(void *obj)
+{
+	ILibSimpleDataStore_Compaction_Slice(((ILibSimpleDataStore_Compaction*)obj)->chain, obj);
+}
+void ILibSimpleDataStore_Compaction_WaitAbort(void *obj)
+{
+	ILibSimpleDataStore_Compaction_Abort(((ILibSimpleDataStore_Compaction*)obj)->chain, obj);
+}
+// Copies up to sliceSize bytes of live records into the compacted data store, then yields to the chain
+void ILibSimpleDataStore_Compaction_Slice(void *chain, void *user)
+{
+	ILibSimpleDataStore_Compaction *state = (ILibSimpleDataStore_Compaction*)user;
+	ILibSimpleDataStore_Root *root = state->root;
+	ILibSimpleDataStore_TableEntry *entry;
+	ILibSimpleDataStore_CompactionKey *k;
+	ILibSimpleDataStore_CompactionHandler handler = state->handler;
+	void *handlerUser = state->user;
+	size_t copied = 0;
+	uint64_t elapsed;
+	struct timeval start;
+	int status = -1;
+
+	if (root == NULL) { ILibSimpleDataStore_Compaction_Free(state); return; } // Cancelled
+	if (root->batchDepth > 0)
+	{
+		// Wait for the batch to be committed. The timer owns the state until then, and aborts the compaction if the chain stops first.
+		ILibLifeTime_AddEx(ILibGetBaseTimer(chain), state, ILibSimpleDataStore_CompactionBatchWait, ILibSimpleDataStore_Compaction_Wait, ILibSimpleDataStore_Compaction_WaitAbort);
+		return;
+	}
+	gettimeofday(&start, NULL);
+
+	ILibHashtable_Lock(root->keyTable);
+	while (state->keyIndex < state->keyCount && copied < state->sliceSize)
+	{
+		k = &(state->keys[state->keyIndex++]);
+		entry = (ILibSimpleDataStore_TableEntry*)ILibHashtable_Get(root->keyTable, NULL, k->key, k->keyLen);
+		if (entry == NULL || entry->valueOffset >= state->endOffset) { continue; } // Deleted or rewritten since the compaction started, the tail has it
+
+		if (state->value == NULL || ILibMemory_Size(state->value) < (size_t)entry->valueLength)
+		{
+			if (state->value != NULL) { ILibMemory_Free(state->value); }
+			if ((state->value = (char*)ILibMemory_SmartAllocate(entry->valueLength + 1)) == NULL) { ILIBCRITICALEXIT(254); }
+		}
+		if (ILibSimpleDataStore_ReadValue(root, entry, state->value) != entry->valueLength ||
+			(entry->compactOffset = ILibSimpleDataStore_WriteRecord(state->compacted, k->key, (k->keyLen > 1 && k->key[k->keyLen - 1] == 0) ? (k->keyLen - 1) : k->keyLen, state->value, entry->valueLength, entry->valueHash)) == 0)
+		{
+			status = 1;
+			break;
+		}
+		copied += sizeof(ILibSimpleDataStore_RecordHeader_NG) + k->keyLen + entry->valueLength;
+	}
+	if (status != 1 && state->keyIndex == state->keyCount) { status = ILibSimpleDataStore_Compaction_Finish(state); }
+
+	elapsed = ILibSimpleDataStore_Compaction_Elapsed(&start);
+	root->compactionStats.sliceCount++;
+	root->compactionStats.bytesCopied += copied;
+	root->compactionStats.lastSliceMicroseconds = elapsed;
+	root->compactionStats.totalMicroseconds += elapsed;
+	if (elapsed > root->compactionStats.maxSliceMicroseconds) { root->compactionStats.maxSliceMicroseconds = elapsed; }
+
+	if (status < 0)
+	{
+		ILibHashtable_UnLock(root->keyTable);
+		ILibChain_RunOnMicrostackThreadEx3(chain, ILibSimpleDataStore_Compaction_Slice, ILibSimpleDataStore_Compaction_Abort, state);
+		return;
+	}
+
+	if (root->compaction == state) { ILibSimpleDataStore_Compaction_Cancel(root); }
+	root->compactionStats.inProgress = 0;
+	ILibHashtable_UnLock(root->keyTable);
+	ILibSimpleDataStore_Compaction_Free(state);
+	if (handler != NULL) { handler(root, status, &(root->compactionStats), handlerUser); }
+}
+
+// Compact the data store in the background
+__EXPORT_TYPE int ILibSimpleDataStore_CompactEx(ILibSimpleDataStore dataStore, void *chain, size_t sliceSize, ILibSimpleDataStore_CompactionHandler handler, void *user)
+{
+	ILibSimpleDataStore_Root *root = (ILibSimpleDataStore_Root*)dataStore;
+	ILibSimpleDataStore_Compaction *state;
+
+	if (root == NULL || root->dirtySize < root->minimumDirtySize || root->filePath == NULL || root->dataFile == NULL || root->readonly != 0) return 1; // Error
+	if (root->compaction != NULL) return 0; // Already in progress
+
+	if ((state = (ILibSimpleDataStore_Compaction*)ILibMemory_Allocate(sizeof(ILibSimpleDataStore_Compaction), 0, NULL, NULL)) == NULL) { ILIBCRITICALEXIT(254); }
+	state->tmpPath = ILibString_Cat(root->filePath, -1, ".tmp", -1);
+	if ((state->compacted = ILibSimpleDataStore_OpenFileEx(state->tmpPath, 1)) == NULL) { ILibSimpleDataStore_Compaction_Free(state); return 1; }
+
+	state->root = root;
+	state->chain = chain;
+	state->sliceSize = sliceSize > 0 ? sliceSize : ILibSimpleDataStore_CompactionSlice_Default;
+	state->handler = handler;
+	state->user = user;
+
+	ILibHashtable_Lock(root->keyTable);
+	state->endOffset = state->startSize = root->fileSize;
+	state->startDirtySize = root->dirtySize;
+	ILibHashtable_Enumerate(root->keyTable, ILibSimpleDataStore_Compaction_CountSink, &(state->keyCount));
+	state->keys = (ILibSimpleDataStore_CompactionKey*)ILibMemory_Allocate((int)(sizeof(ILibSimpleDataStore_CompactionKey) * (state->keyCount + 1)), 0, NULL, NULL);
+	state->keyCount = 0;
+	ILibHashtable_Enumerate(root->keyTable, ILibSimpleDataStore_Compaction_KeySink, state);
+	root->compaction = state;
+	memset(&(root->compactionStats), 0, sizeof(root->compactionStats));
+	root->compactionStats.inProgress = 1;
+	ILibHashtable_UnLock(root->keyTable);
+
+	ILibChain_RunOnMicrostackThreadEx3(chain, ILibSimpleDataStore_Compaction_Slice, ILibSimpleDataStore_Compaction_Abort, state);
+	return 0;
+}
+__EXPORT_TYPE void ILibSimpleDataStore_GetCompactionStats(ILibSimpleDataStore dataStore, ILibSimpleDataStore_CompactionStats *stats)
+{
+	ILibSimpleDataStore_Root *root = (ILibSimpleDataStore_Root*)dataStore;
+	if (root == NULL || stats == NULL) { return; }
+	memcpy_s(stats, sizeof(ILibSimpleDataStore_CompactionStats), &(root->compactionStats), sizeof(ILibSimpleDataStore_CompactionStats));
+}
+
 int ILibSimpleDataStore_IsCacheOnly(ILibSimpleDataStore ds)
 {
 	return(((ILibSimpleDataStore_Root*)ds)->dataFile == NULL ? 1 : 0);
-}
\ No newline at end of file
+}
@@ -16,7 +16,8 @@ limitations under the License.
 
 /*
 This is a simple data store that implements a hash table in a file. New keys are appended at the end of the file and the file can be compacted when needed.
-The store will automatically create a hash of each value and store the hash. Upon reading the data, the hash is always checked.
+The store will automatically create a hash of each value and store the hash. The hash is checked the first time the value is read.
+A snapshot of the key table is kept in <filePath>.idx, so the whole file does not need to be read at startup.
 */
 
 #ifndef __ILIBSIMPLEDATASTORE__
@@ -43,6 +44,18 @@ typedef void(*ILibSimpleDataStore_SizeWarningHandler)(ILibSimpleDataStore sender
 typedef void(*ILibSimpleDataStore_WriteErrorHandler)(ILibSimpleDataStore sender, void *user);
 typedef void(*ILibSimpleDataStore_GetValuesHandler)(ILibSimpleDataStore sender, char* Key, size_t KeyLen, char* Value, size_t ValueLen, void *user);
 
+typedef struct ILibSimpleDataStore_CompactionStats
+{
+	int inProgress;						// Non-zero while a background compaction is running
+	unsigned int sliceCount;			// Number of slices the compaction was split into
+	uint64_t bytesCopied;				// Bytes written to the compacted data store
+	uint64_t bytesReclaimed;			// Reduction in the size of the data store, once the compaction completed
+	uint64_t lastSliceMicroseconds;
+	uint64_t maxSliceMicroseconds;
+	uint64_t totalMicroseconds;			// Time spent compacting, not counting the time between slices
+}ILibSimpleDataStore_CompactionStats;
+typedef void(*ILibSimpleDataStore_CompactionHandler)(ILibSimpleDataStore sender, int status, ILibSimpleDataStore_CompactionStats *stats, void *user);
+
 
 // Create the data store.
 __EXPORT_TYPE ILibSimpleDataStore ILibSimpleDataStore_CreateEx2(char* filePath, int userExtraMemorySize, int readonly);
@@ -84,12 +97,24 @@ int ILibSimpleDataStore_GetHashSize();
 __EXPORT_TYPE int ILibSimpleDataStore_DeleteEx(ILibSimpleDataStore dataStore, char* key, size_t keyLen);
 #define ILibSimpleDataStore_Delete(dataStore, key) ILibSimpleDataStore_DeleteEx(dataStore, key, strnlen_s(key, ILibSimpleDataStore_MaxKeyLength))
 
+// Batch writes to the data store. Puts and Deletes made between Begin and Commit are written with a single write and flush.
+__EXPORT_TYPE void ILibSimpleDataStore_BeginBatch(ILibSimpleDataStore dataStore);
+__EXPORT_TYPE int ILibSimpleDataStore_CommitBatch(ILibSimpleDataStore dataStore);
+
 // Enumerate all keys from the data store
 __EXPORT_TYPE void ILibSimpleDataStore_EnumerateKeys(ILibSimpleDataStore dataStore, ILibSimpleDataStore_KeyEnumerationHandler handler, void *user);
 
 // Compacts the data store
 __EXPORT_TYPE int ILibSimpleDataStore_Compact(ILibSimpleDataStore dataStore);
 
+// Compacts the data store in the background, on the chain thread, copying at most sliceSize bytes per chain iteration.
+// Returns 0 if the compaction was started, in which case handler is called when it completes (status 0) or fails. 
+// Reads and writes can continue while the compaction is in progress.
+#define ILibSimpleDataStore_CompactionSlice_Default 262144
+__EXPORT_TYPE int ILibSimpleDataStore_CompactEx(ILibSimpleDataStore dataStore, void *chain, size_t sliceSize, ILibSimpleDataStore_CompactionHandler handler, void *user);
+#define ILibSimpleDataStore_CompactAsync(dataStore, chain) ILibSimpleDataStore_CompactEx(dataStore, chain, ILibSimpleDataStore_CompactionSlice_Default, NULL, NULL)
+__EXPORT_TYPE void ILibSimpleDataStore_GetCompactionStats(ILibSimpleDataStore dataStore, ILibSimpleDataStore_CompactionStats *stats);
+
 // Lock and unlock the data store. This is useful if we need to access this store from many threads.
 __EXPORT_TYPE void ILibSimpleDataStore_Lock(ILibSimpleDataStore dataStore);
 __EXPORT_TYPE void ILibSimpleDataStore_UnLock(ILibSimpleDataStore dataStore);
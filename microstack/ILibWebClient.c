@@ -78,6 +78,20 @@ void WebClient_TrackUnLock(const char* MethodName, int Occurance, void *data)
 #include "ILibRemoteLogging.h"
 #include "ILibCrypto.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+	#include <immintrin.h>
+	#define ILibWebClient_MASK_SSE2
+	#define ILibWebClient_MASK_AVX2
+	#define ILibWebClient_MASK_TARGET(x) __attribute__((target(x)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#include <emmintrin.h>
+	#define ILibWebClient_MASK_SSE2
+	#define ILibWebClient_MASK_TARGET(x)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define ILibWebClient_MASK_NEON
+#endif
+
 extern ILibSpinLock *ILibAsyncSocket_GetSpinLock(ILibAsyncSocket_SocketModule socketModule);
 
 #ifndef MICROSTACK_NOTLS
@@ -1220,14 +1234,150 @@ ILibWebClient_WebSocketState* ILibWebClient_WebSocket_GetState(ILibWebRequest *w
 }
 
 
+//
+// WebSocket payload masking (RFC 6455, Section 5.3). Each kernel XORs whole vectors with a key that has already
+// been rotated to the current payload offset, and returns how many bytes it masked (always a multiple of 4,
+// so the key phase doesn't change). All loads/stores are unaligned, so neither buffer has to be aligned.
+//
+#ifdef ILibWebClient_MASK_AVX2
+ILibWebClient_MASK_TARGET("avx2") size_t ILibWebClient_WebSocket_Mask_AVX2(char *dest, const char *src, size_t length, uint32_t key)
+{
+	__m256i k = _mm256_set1_epi32((int)key);
+	size_t i = 0;
+
+	for (; i + 64 <= length; i += 64)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_xor_si256(a, k));
+		_mm256_storeu_si256((__m256i*)(dest + i + 32), _mm256_xor_si256(b, k));
+	}
+	for (; i + 32 <= length; i += 32)
+	{
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(src + i)), k));
+	}
+	return(i);
+}
+#endif
+#ifdef ILibWebClient_MASK_SSE2
+ILibWebClient_MASK_TARGET("sse2") size_t ILibWebClient_WebSocket_Mask_SSE2(char *dest, const char *src, size_t length, uint32_t key)
+{
+	__m128i k = _mm_set1_epi32((int)key);
+	size_t i = 0;
+
+	for (; i + 64 <= length; i += 64)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(src + i + 16));
+		__m128i c = _mm_loadu_si128((const __m128i*)(src + i + 32));
+		__m128i d = _mm_loadu_si128((const __m128i*)(src + i + 48));
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_xor_si128(a, k));
+		_mm_storeu_si128((__m128i*)(dest + i + 16), _mm_xor_si128(b, k));
+		_mm_storeu_si128((__m128i*)(dest + i + 32), _mm_xor_si128(c, k));
+		_mm_storeu_si128((__m128i*)(dest + i + 48), _mm_xor_si128(d, k));
+	}
+	for (; i + 16 <= length; i += 16)
+	{
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_xor_si128(_mm_loadu_si128((const __m128i*)(src + i)), k));
+	}
+	return(i);
+}
+#endif
+#ifdef ILibWebClient_MASK_NEON
+size_t ILibWebClient_WebSocket_Mask_NEON(char *dest, const char *src, size_t length, uint32_t key)
+{
+	uint8x16_t k = vreinterpretq_u8_u32(vdupq_n_u32(key));
+	size_t i = 0;
+
+	for (; i + 64 <= length; i += 64)
+	{
+		uint8x16_t a = vld1q_u8((const uint8_t*)(src + i));
+		uint8x16_t b = vld1q_u8((const uint8_t*)(src + i + 16));
+		uint8x16_t c = vld1q_u8((const uint8_t*)(src + i + 32));
+		uint8x16_t d = vld1q_u8((const uint8_t*)(src + i + 48));
+		vst1q_u8((uint8_t*)(dest + i), veorq_u8(a, k));
+		vst1q_u8((uint8_t*)(dest + i + 16), veorq_u8(b, k));
+		vst1q_u8((uint8_t*)(dest + i + 32), veorq_u8(c, k));
+		vst1q_u8((uint8_t*)(dest + i + 48), veorq_u8(d, k));
+	}
+	for (; i + 16 <= length; i += 16)
+	{
+		vst1q_u8((uint8_t*)(dest + i), veorq_u8(vld1q_u8((const uint8_t*)(src + i)), k));
+	}
+	return(i);
+}
+#endif
+
+/*! \fn ILibWebClient_WebSocket_Mask(char *dest, const char *src, size_t length, const char *maskKey)
+\brief Masks (or unmasks) a WebSocket payload with a 4 byte masking key
+\par
+\a dest may be the same buffer as \a src, to unmask in place, but the two must not otherwise overlap. Neither has to be aligned.
+\param dest Where to write the masked payload
+\param src The payload to mask
+\param length Length of the payload
+\param maskKey The 4 byte masking key. \a src[0] is masked with \a maskKey[0]
+*/
+void ILibWebClient_WebSocket_Mask(char *dest, const char *src, size_t length, const char *maskKey)
+{
+	char key[4];
+	uint64_t keyLong, v;
+	uint32_t keyInt;
+	size_t i = 0, head;
+
+	if (length < 16)
+	{
+		// Control frames and short text messages. Not worth setting anything up for
+		for (; i < length; ++i) { dest[i] = src[i] ^ maskKey[i & 3]; }
+		return;
+	}
+	if (length >= 64)
+	{
+		// Mask up to the next 32 byte boundary of dest one byte at a time, so the vector stores don't straddle cache lines
+		head = (32 - ((uintptr_t)dest & 31)) & 31;
+		for (; i < head; ++i) { dest[i] = src[i] ^ maskKey[i & 3]; }
+	}
+
+	// Rotate the key so that key[0] lines up with src[i]
+	key[0] = maskKey[i & 3]; key[1] = maskKey[(i + 1) & 3]; key[2] = maskKey[(i + 2) & 3]; key[3] = maskKey[(i + 3) & 3];
+	memcpy(&keyInt, key, 4);
+	keyLong = ((uint64_t)keyInt << 32) | keyInt;
+
+#ifdef ILibWebClient_MASK_AVX2
+	if (length - i >= 64 && __builtin_cpu_supports("avx2")) { i += ILibWebClient_WebSocket_Mask_AVX2(dest + i, src + i, length - i, keyInt); }
+#endif
+#ifdef ILibWebClient_MASK_SSE2
+	#ifdef __GNUC__
+	if (length - i >= 16 && __builtin_cpu_supports("sse2")) { i += ILibWebClient_WebSocket_Mask_SSE2(dest + i, src + i, length - i, keyInt); }
+	#else
+	if (length - i >= 16) { i += ILibWebClient_WebSocket_Mask_SSE2(dest + i, src + i, length - i, keyInt); }
+	#endif
+#endif
+#ifdef ILibWebClient_MASK_NEON
+	if (length - i >= 16) { i += ILibWebClient_WebSocket_Mask_NEON(dest + i, src + i, length - i, keyInt); }
+#endif
+
+	// Whatever the vector kernels didn't cover, 8 bytes at a time. memcpy() keeps the unaligned loads/stores safe at any optimization level
+	for (; i + 8 <= length; i += 8)
+	{
+		memcpy(&v, src + i, 8);
+		v ^= keyLong;
+		memcpy(dest + i, &v, 8);
+	}
+	for (; i < length; ++i) { dest[i] = src[i] ^ maskKey[i & 3]; }
+}
+
+// Releases a frame that was sent with ILibAsyncSocket_SendV()
+void ILibWebClient_WebSocket_FreeFrame(ILibAsyncSocket_SocketModule socketModule, void *user)
+{
+	UNREFERENCED_PARAMETER(socketModule);
+	free(user);
+}
 ILibAsyncSocket_SendStatus ILibWebClient_WebSocket_Send(ILibWebClient_StateObject obj, ILibWebClient_WebSocket_DataTypes bufferType, char* _buffer, int _bufferLen, ILibAsyncSocket_MemoryOwnership _userFree, ILibWebClient_WebSocket_FragmentFlags _bufferFragment)
 {
 	if (!ILibMemory_CanaryOK(obj)) { return(ILibAsyncSocket_SEND_ON_CLOSED_SOCKET_ERROR); }
 	ILibWebClientDataObject *wcdo = (ILibWebClientDataObject*)obj;
-	char dataFrame[WEBSOCKET_MAX_OUTPUT_FRAMESIZE];
+	ILibAsyncSocket_IOVec frame;
 	char header[10];
-	char maskKey[4];
-	int maskKeyInt;
 	int headerLen;
 	unsigned short flags = WEBSOCKET_MASK;
 	ILibAsyncSocket_SendStatus RetVal = ILibAsyncSocket_SEND_ON_CLOSED_SOCKET_ERROR;
@@ -1288,16 +1438,13 @@ ILibAsyncSocket_SendStatus ILibWebClient_WebSocket_Send(ILibWebClient_StateObjec
 		}
 
 		if (flags & WEBSOCKET_MASK) {
-			// Mask the payload
-			util_random(4, maskKey);
-			maskKeyInt = ((int*)maskKey)[0];
-			if (bufferLen > 0) {
-				int x;
-				for (x = 0; x < (bufferLen >> 2); ++x) { ((int*)dataFrame)[x] = ((int*)buffer)[x] ^ (int)maskKeyInt; } // Mask 4 bytes at a time
-				for (x = (x << 2); x < bufferLen; ++x) { dataFrame[x] = buffer[x] ^ maskKey[x % 4]; } // Mask the reminder
-				//for (x = 0; x < bufferLen; ++x) { dataFrame[x] = buffer[x] ^ maskKey[x % 4]; } // This is the slower version
-			}
-			RetVal = ILibAsyncSocket_SendTo_MultiWrite(wcdo->SOCK, NULL, 3 | ILibAsyncSocket_LOCK_OVERRIDE, header, (size_t)headerLen, ILibAsyncSocket_MemoryOwnership_USER, maskKey, (size_t)4, ILibAsyncSocket_MemoryOwnership_USER, dataFrame, (size_t)bufferLen, ILibAsyncSocket_MemoryOwnership_USER);
+			// We have to copy the payload to mask it, so build the whole frame in one buffer, and hand it to the socket
+			frame.length = (size_t)(headerLen + 4 + bufferLen);
+			if ((frame.buffer = (char*)malloc(frame.length)) == NULL) { ILIBCRITICALEXIT(254); }
+			memcpy_s(frame.buffer, frame.length, header, headerLen);
+			util_random(4, frame.buffer + headerLen);
+			if (bufferLen > 0) { ILibWebClient_WebSocket_Mask(frame.buffer + headerLen + 4, buffer, (size_t)bufferLen, frame.buffer + headerLen); }
+			RetVal = ILibAsyncSocket_SendV(wcdo->SOCK, &frame, 1 | ILibAsyncSocket_LOCK_OVERRIDE, ILibWebClient_WebSocket_FreeFrame, frame.buffer);
 		} else {
 			// Send payload without masking
 			RetVal = ILibAsyncSocket_SendTo_MultiWrite(wcdo->SOCK, NULL, 2 | ILibAsyncSocket_LOCK_OVERRIDE, header, (size_t)headerLen, ILibAsyncSocket_MemoryOwnership_USER, buffer, (size_t)bufferLen, ILibAsyncSocket_MemoryOwnership_USER);
@@ -1321,7 +1468,6 @@ void ILibWebClient_WebSocket_SetPingPongHandler(ILibWebClient_StateObject obj, I
 }
 int ILibWebClient_ProcessWebSocketData(char* buffer, int offset, int length, ILibWebClientDataObject *wcdo, int *PAUSE)
 {
-	int x;
 	int i = offset + 2;
 	int plen;
 	unsigned short hdr;
@@ -1388,11 +1534,7 @@ int ILibWebClient_ProcessWebSocketData(char* buffer, int offset, int length, ILi
 	{
 		// Unmask the data
 		i += 4;	// Move ptr to start of data
-
-		for (x = 0; x < plen; ++x)
-		{
-			buffer[i + x] = buffer[i + x] ^ maskingKey[x % 4];
-		}
+		ILibWebClient_WebSocket_Mask(buffer + i, buffer + i, (size_t)plen, maskingKey);
 	}
 	
 	if (OPCODE < 0x8)
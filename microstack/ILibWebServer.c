@@ -561,7 +561,6 @@ void ILibWebServer_OnDisconnect(void *AsyncServerSocketModule, void *ConnectionT
 
 int ILibWebServer_ProcessWebSocketData(struct ILibWebServer_Session *ws, char* buffer, int offset, int length)
 {
-	int x;
 	int i = offset + 2;
 	int plen;
 	unsigned short hdr;
@@ -617,11 +616,7 @@ int ILibWebServer_ProcessWebSocketData(struct ILibWebServer_Session *ws, char* b
 	{
 		// Unmask the data
 		i += 4;	// Move ptr to start of data
-
-		for (x = 0; x < plen; ++x)
-		{
-			buffer[i + x] = buffer[i + x] ^ maskingKey[x % 4];
-		}
+		ILibWebClient_WebSocket_Mask(buffer + i, buffer + i, (size_t)plen, maskingKey);
 	}
 
 	if (ws->OnReceive == NULL) { return (i + plen); } // If there is no receiver, then just return after we consume everything
@@ -1489,10 +1484,25 @@ int ILibWebServer_WebSocket_CreateHeader(char* header, unsigned short FLAGS, uns
 	return retVal;
 }
 
+// A frame header, and the payload it belongs to if the chain owns it, while they are queued on the socket with ILibAsyncSocket_SendV()
+typedef struct ILibWebServer_WebSocket_Frame
+{
+	char *payload;
+	char header[4];
+}ILibWebServer_WebSocket_Frame;
+void ILibWebServer_WebSocket_FreeFrame(ILibAsyncSocket_SocketModule socketModule, void *user)
+{
+	ILibWebServer_WebSocket_Frame *frame = (ILibWebServer_WebSocket_Frame*)user;
+	UNREFERENCED_PARAMETER(socketModule);
+	if (frame->payload != NULL) { free(frame->payload); }
+	free(frame);
+}
 ILibExportMethod enum ILibWebServer_Status ILibWebServer_WebSocket_Send(struct ILibWebServer_Session *session, char* buffer, int bufferLen, ILibWebServer_WebSocket_DataTypes bufferType, enum ILibAsyncSocket_MemoryOwnership userFree, ILibWebServer_WebSocket_FragmentFlags fragmentStatus)
 {
 	char header[4];
 	int headerLen;
+	ILibWebServer_WebSocket_Frame *frame;
+	ILibAsyncSocket_IOVec vec[2];
 	enum ILibWebServer_Status RetVal = ILibWebServer_INVALID_SESSION;
 
 	if (bufferLen > WEBSOCKET_MAX_OUTPUT_FRAMESIZE)
@@ -1540,10 +1550,23 @@ ILibExportMethod enum ILibWebServer_Status ILibWebServer_WebSocket_Send(struct I
 	}
 
 	ILibSpinLock_Lock(&(ILibWebServer_Session_GetSystemData(session)->SessionLock)); // We need to do this, because we need to be able to correctly interleave sends
-	RetVal = (enum ILibWebServer_Status)ILibAsyncServerSocket_Send(ILibWebServer_Session_GetSystemData(session)->AsyncServerSocket, ILibWebServer_Session_GetSystemData(session)->ConnectionToken, header, headerLen, ILibAsyncSocket_MemoryOwnership_USER);
-	if (bufferLen > 0)
+	if (bufferLen > 0 && userFree != ILibAsyncSocket_MemoryOwnership_USER)
+	{
+		// The socket can hold on to the payload, so the header and payload go out together, without copying either
+		if ((frame = (ILibWebServer_WebSocket_Frame*)malloc(sizeof(ILibWebServer_WebSocket_Frame))) == NULL) { ILIBCRITICALEXIT(254); }
+		memcpy_s(frame->header, sizeof(frame->header), header, headerLen);
+		frame->payload = userFree == ILibAsyncSocket_MemoryOwnership_CHAIN ? buffer : NULL;
+		vec[0].buffer = frame->header; vec[0].length = (size_t)headerLen;
+		vec[1].buffer = buffer; vec[1].length = (size_t)bufferLen;
+		RetVal = (enum ILibWebServer_Status)ILibAsyncSocket_SendV(ILibWebServer_Session_GetSystemData(session)->ConnectionToken, vec, 2, ILibWebServer_WebSocket_FreeFrame, frame);
+	}
+	else
 	{
-		RetVal = (enum ILibWebServer_Status)ILibAsyncServerSocket_Send(ILibWebServer_Session_GetSystemData(session)->AsyncServerSocket, ILibWebServer_Session_GetSystemData(session)->ConnectionToken, buffer, bufferLen, userFree);
+		RetVal = (enum ILibWebServer_Status)ILibAsyncServerSocket_Send(ILibWebServer_Session_GetSystemData(session)->AsyncServerSocket, ILibWebServer_Session_GetSystemData(session)->ConnectionToken, header, headerLen, ILibAsyncSocket_MemoryOwnership_USER);
+		if (bufferLen > 0)
+		{
+			RetVal = (enum ILibWebServer_Status)ILibAsyncServerSocket_Send(ILibWebServer_Session_GetSystemData(session)->AsyncServerSocket, ILibWebServer_Session_GetSystemData(session)->ConnectionToken, buffer, bufferLen, userFree);
+		}
 	}
 	ILibSpinLock_UnLock(&(ILibWebServer_Session_GetSystemData(session)->SessionLock));
 	return RetVal;
@@ -80,64 +80,36 @@ function filesearch()
             };
             break;
         default:
-            this.find = function find(root, criteria)
+            this.find = function find(root, criteria, options)
             {
                 var ret = new promise(function (res, rej) { this._res = res; this._rej = rej; });
                 require('events').EventEmitter.call(ret, true)
                     .createEvent('result')
                     .createEvent('end');
-                var searchArgs = ['find', root];
-                if(process.platform == 'linux') 
-                {
-                    searchArgs.push('-type');
-                    searchArgs.push('f');
-                    searchArgs.push('(');
-                }
-                if (Array.isArray(criteria))
-                {
-                    searchArgs.push('-name');
-                    searchArgs.push(criteria.shift());
 
-                    while(criteria.length>0)
-                    {
-                        searchArgs.push('-o');
-                        searchArgs.push('-name');
-                        searchArgs.push(criteria.shift());
-                    }
-                }
-                else
+                // Walked natively on worker threads. options.limit caps the number of results. Matching directories are
+                // returned as well, except on Linux, where this used to run 'find -type f'
+                if (options == null) { options = {}; }
+                if (options.directories == null) { options.directories = (process.platform != 'linux'); }
+                try
                 {
-                    searchArgs.push('-name');
-                    searchArgs.push(criteria);
+                    ret.search = require('fs').search(root, criteria, options);
                 }
-                if (process.platform == 'linux') { searchArgs.push(')'); }
-                ret.child = require('child_process').execFile('/usr/bin/find', searchArgs);
-                if (ret.child == null)
+                catch (e)
                 {
-                    ret._res();
+                    ret._rej(e);
                     return (ret);
                 }
-                ret.child.stdout.str = ''; ret.child.stdout.p = ret;
-                ret.child.stdout.on('data', function (c)
+                ret.search.promise = ret;
+                ret.search.on('result', function (r) { this.promise.emit('result', r); });
+                ret.search.on('end', function ()
                 {
-                    this.str += c.toString();
-                    var lines = this.str.split('\n');
-                    while (lines.length > 1)
-                    {
-                        this.p.emit('result', lines.shift());
-                    }
-                    this.str = lines.pop();
-                });
-                ret.child.stderr.on('data', function (c) { });
-                ret.child.on('exit', function (c)
-                {
-                    if (this.stdout.str.trim() != '') { this.stdout.p.emit('result', this.stdout.str.trim()); }
-                    this.stdout.p.emit('end');
-                    this.stdout.p._res();
+                    this.promise.emit('end');
+                    this.promise._res();
                 });
                 ret.cancel = function cancel()
                 {
-                    this.child.kill();
+                    this.search.cancel();
                 }
                 return (ret);
             };
@@ -14,9 +14,6 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
-var readable = require('stream').Readable;
-
-
 function loadUstarHeader(path, offset)
 {
     var fd = require('fs').openSync(path, 'rb');
@@ -58,11 +55,13 @@ function generateUstarHeader(path, basePath, uidtable, gidtable)
     {
         Buffer.from(stats.size.toString(8), 'binary').copy(ret, 124, 0, 12);
         Object.defineProperty(ret, 'isFile', { value: true });
+        Object.defineProperty(ret, 'fileSize', { value: stats.size });
     }
     else
     {
         Buffer.from('0').copy(ret, 124, 0, 12);
         Object.defineProperty(ret, 'isFile', { value: false });
+        Object.defineProperty(ret, 'fileSize', { value: 0 });
         name += '/';
     }
 
@@ -115,50 +114,21 @@ function generateUstarHeader(path, basePath, uidtable, gidtable)
     return (ret);
 }
 
+//
+// The headers are generated here, and compressed-stream reads the files on a worker thread
+//
 function encodeFiles(files, basePath)
 {
-    var ret = new readable(
-        {
-            read: function read()
-            {
-                var bytesRead;
-                var ok = true;
-                if(this._fd == null)
-                {
-                    if (this.files.length > 0)
-                    {
-                        var name = this.files.shift();
-                        var header = generateUstarHeader(name, this._basePath, this._uidTable, this._gidTable);
-                        if (header.isFile) { this._fd = require('fs').openSync(name, 'rb'); }
-                        ok = this.push(header);
-                    }
-                    else
-                    {
-                        this.pause();
-                        this.push(null);
-                        return;
-                    }
-                }
-                while(this._fd != null && ok)
-                {
-                    bytesRead = require('fs').readSync(this._fd, this._buffer, 0, 512);
-                    this._buffer.fill(0, bytesRead, 512);
-                    if (bytesRead < 512)
-                    {
-                        require('fs').closeSync(this._fd);
-                        this._fd = null;
-                    }
-                    ok = this.push(this._buffer);
-                }
-            }
-        });
-    ret.files = files;
-    ret._basePath = basePath;
-    ret._fd = null;
-    ret._buffer = Buffer.alloc(512);
-    ret._uidTable = {};
-    ret._gidTable = {};
-    return (ret);
+    var entries = [];
+    var uidTable = {};
+    var gidTable = {};
+    var header;
+    for (var i = 0; i < files.length; ++i)
+    {
+        header = generateUstarHeader(files[i], basePath, uidTable, gidTable);
+        entries.push({ path: files[i], size: header.fileSize, header: header });
+    }
+    return (require('compressed-stream').createArchive('tar', entries));
 }
 
 function expandFolderPaths(folderPath, recurse, arr)
@@ -0,0 +1,111 @@
+/*
+Copyright 2019 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+Micro-benchmark for ILibLifeTime. Measures Add, Remove and Fire throughput at 1k, 10k and 100k timers, in operations
+per second. Fire adds timers that expire over the next 100ms, waits for all of them to expire, and then times the
+single check that fires them, so the wait itself isn't measured.
+
+Build (Linux), from the repository root:
+  gcc -O2 -D_POSIX -DMICROSTACK_NOTLS -D_NOILIBSTACKDEBUG -I. -Imicrostack test/ILibLifeTime_bench.c \
+      microstack/ILibParsers.c microstack/ILibCrypto.c \
+      microstack/nossl/md5.c microstack/nossl/sha1.c microstack/nossl/sha224-256.c microstack/nossl/sha384-512.c -o lifetime_bench -lpthread -ldl
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ILibParsers.h"
+
+int ILibLifeTime_Bench_Fired = 0;
+int ILibLifeTime_Bench_Destroyed = 0;
+
+void ILibLifeTime_Bench_OnTimer(void *obj)
+{
+	UNREFERENCED_PARAMETER(obj);
+	++ILibLifeTime_Bench_Fired;
+}
+void ILibLifeTime_Bench_OnDestroy(void *obj)
+{
+	UNREFERENCED_PARAMETER(obj);
+	++ILibLifeTime_Bench_Destroyed;
+}
+
+// Monotonic time in nanoseconds
+long long ILibLifeTime_Bench_Now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return(((long long)ts.tv_sec * 1000000000LL) + ts.tv_nsec);
+}
+
+//
+// Drives the timer directly, instead of through the chain
+//
+void ILibLifeTime_Bench_Check(void *timer)
+{
+	int blocktime = 1000;
+	((ILibChain_Link*)timer)->PreSelectHandler(timer, NULL, NULL, NULL, &blocktime);
+}
+
+// Operations per second, in millions
+double ILibLifeTime_Bench_Rate(int count, long long ns)
+{
+	return(ns > 0 ? ((double)count * 1000.0) / (double)ns : 0.0);
+}
+
+void ILibLifeTime_Bench_Run(void *timer, int count)
+{
+	long long start, add, rem, fire;
+	int i;
+
+	// Add, then Remove in insertion order
+	start = ILibLifeTime_Bench_Now();
+	for (i = 0; i < count; ++i) { ILibLifeTime_AddEx(timer, (void*)(uintptr_t)(i + 1), 60000 + (i % 3600000), ILibLifeTime_Bench_OnTimer, ILibLifeTime_Bench_OnDestroy); }
+	add = ILibLifeTime_Bench_Now() - start;
+
+	start = ILibLifeTime_Bench_Now();
+	for (i = 0; i < count; ++i) { ILibLifeTime_Remove(timer, (void*)(uintptr_t)(i + 1)); }
+	rem = ILibLifeTime_Bench_Now() - start;
+
+	// Add timers spread over the next 100ms, and let all of them expire before firing them
+	ILibLifeTime_Bench_Fired = 0;
+	for (i = 0; i < count; ++i) { ILibLifeTime_AddEx(timer, (void*)(uintptr_t)(i + 1), 1 + (i % 100), ILibLifeTime_Bench_OnTimer, ILibLifeTime_Bench_OnDestroy); }
+	usleep(120000);
+	start = ILibLifeTime_Bench_Now();
+	while (ILibLifeTime_Bench_Fired < count) { ILibLifeTime_Bench_Check(timer); }
+	fire = ILibLifeTime_Bench_Now() - start;
+
+	printf("%7d timers: Add %6.2f M/s, Remove %6.2f M/s, Fire %6.2f M/s, Destroyed: %d\n", count,
+		ILibLifeTime_Bench_Rate(count, add), ILibLifeTime_Bench_Rate(count, rem), ILibLifeTime_Bench_Rate(count, fire), ILibLifeTime_Bench_Destroyed);
+	ILibLifeTime_Bench_Destroyed = 0;
+}
+
+int main(int argc, char **argv)
+{
+	void *chain = ILibCreateChain();
+	void *timer = ILibGetBaseTimer(chain);
+
+	UNREFERENCED_PARAMETER(argc);
+	UNREFERENCED_PARAMETER(argv);
+
+	ILibLifeTime_Bench_Run(timer, 1000);
+	ILibLifeTime_Bench_Run(timer, 10000);
+	ILibLifeTime_Bench_Run(timer, 100000);
+
+	ILibChain_DestroyEx(chain);
+	return(0);
+}
@@ -0,0 +1,136 @@
+/*
+Copyright 2019 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+Micro-benchmark for the ways ILibProcessPipe can start a child: fork(), vfork() and posix_spawn(). Measures spawns/second
+of /bin/true, with stdin/stdout/stderr pipes set up the way ILibProcessPipe_Manager_SpawnProcessEx4 does, while the
+benchmark holds 0MB, 256MB and 1GB of touched heap, to stand in for an agent with a large RSS.
+
+Build (Linux), from the repository root:
+  gcc -O2 -D_POSIX -DMICROSTACK_NOTLS -D_NOILIBSTACKDEBUG -I. -Imicrostack test/ILibProcessPipe_spawn_bench.c \
+      microstack/ILibParsers.c microstack/ILibCrypto.c \
+      microstack/nossl/md5.c microstack/nossl/sha1.c microstack/nossl/sha224-256.c microstack/nossl/sha384-512.c -o spawn_bench -lpthread -ldl
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ILibParsers.h"
+
+extern char **environ;
+
+typedef enum ILibProcessPipe_Bench_Modes
+{
+	ILibProcessPipe_Bench_FORK = 0,
+	ILibProcessPipe_Bench_VFORK = 1,
+	ILibProcessPipe_Bench_POSIX_SPAWN = 2
+}ILibProcessPipe_Bench_Modes;
+char *ILibProcessPipe_Bench_ModeNames[] = { "fork", "vfork", "posix_spawn" };
+
+pid_t ILibProcessPipe_Bench_Spawn(ILibProcessPipe_Bench_Modes mode, char *target, char **args)
+{
+	int in[2], out[2], err[2];
+	pid_t pid = -1;
+	sigset_t sset;
+
+	if (pipe(in) != 0 || pipe(out) != 0 || pipe(err) != 0) { ILIBCRITICALEXIT(254); }
+	if (mode == ILibProcessPipe_Bench_POSIX_SPAWN)
+	{
+		posix_spawn_file_actions_t actions;
+		posix_spawnattr_t attr;
+
+		posix_spawn_file_actions_init(&actions);
+		posix_spawnattr_init(&attr);
+		sigemptyset(&sset); posix_spawnattr_setsigmask(&attr, &sset);
+		sigfillset(&sset); posix_spawnattr_setsigdefault(&attr, &sset);
+		posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+		posix_spawn_file_actions_addclose(&actions, err[0]);
+		posix_spawn_file_actions_addclose(&actions, in[1]);
+		posix_spawn_file_actions_addclose(&actions, out[0]);
+		posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+		posix_spawn_file_actions_addclose(&actions, in[0]);
+		posix_spawn_file_actions_addclose(&actions, out[1]);
+		posix_spawn_file_actions_addclose(&actions, err[1]);
+		if (posix_spawn(&pid, target, &actions, &attr, args, environ) != 0) { pid = -1; }
+		posix_spawnattr_destroy(&attr);
+		posix_spawn_file_actions_destroy(&actions);
+	}
+	else
+	{
+		if (mode == ILibProcessPipe_Bench_VFORK) { ILibVForkPrepareSignals_Parent_Init(&sset); }
+		pid = mode == ILibProcessPipe_Bench_VFORK ? vfork() : fork();
+		if (pid == 0)
+		{
+			if (mode == ILibProcessPipe_Bench_VFORK) { ILibVForkPrepareSignals_Child(); }
+			close(err[0]); dup2(err[1], STDERR_FILENO); close(err[1]);
+			close(in[1]); close(out[0]);
+			dup2(in[0], STDIN_FILENO); dup2(out[1], STDOUT_FILENO);
+			close(in[0]); close(out[1]);
+			execv(target, args);
+			_exit(1);
+		}
+		if (mode == ILibProcessPipe_Bench_VFORK) { ILibVForkPrepareSignals_Parent_Finished(&sset); }
+	}
+	close(in[0]); close(in[1]); close(out[0]); close(out[1]); close(err[0]); close(err[1]);
+	return(pid);
+}
+
+void ILibProcessPipe_Bench_Run(size_t heapMB)
+{
+	char *args[] = { "/bin/true", NULL };
+	char *heap = NULL;
+	long long start, elapsed = 0;
+	int mode, count, status;
+	size_t i;
+	pid_t pid;
+
+	if (heapMB > 0)
+	{
+		// Touch every page, so it is actually mapped, and would have to be copied by fork()
+		if ((heap = (char*)malloc(heapMB << 20)) == NULL) { ILIBCRITICALEXIT(254); }
+		for (i = 0; i < (heapMB << 20); i += 4096) { heap[i] = (char)i; }
+	}
+
+	for (mode = ILibProcessPipe_Bench_FORK; mode <= ILibProcessPipe_Bench_POSIX_SPAWN; ++mode)
+	{
+		count = 0;
+		start = ILibGetUptime();
+		do
+		{
+			if ((pid = ILibProcessPipe_Bench_Spawn((ILibProcessPipe_Bench_Modes)mode, args[0], args)) < 0) { printf("%s failed\n", ILibProcessPipe_Bench_ModeNames[mode]); break; }
+			waitpid(pid, &status, 0);
+			++count;
+		} while ((elapsed = ILibGetUptime() - start) < 2000);
+		printf("%5uMB heap  %-12s %7.1f spawns/s\n", (unsigned int)heapMB, ILibProcessPipe_Bench_ModeNames[mode], (count * 1000.0) / elapsed);
+	}
+	free(heap);
+}
+
+int main(int argc, char **argv)
+{
+	UNREFERENCED_PARAMETER(argc);
+	UNREFERENCED_PARAMETER(argv);
+
+	ILibProcessPipe_Bench_Run(0);
+	ILibProcessPipe_Bench_Run(256);
+	ILibProcessPipe_Bench_Run(1024);
+	return(0);
+}
@@ -0,0 +1,143 @@
+/*
+Copyright 2019 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+Decodes an ILibRemoteLogging binary log dump (ILibRemoteLogging_BinaryLog_Dump / console.dumpBinaryLog), and prints
+each record as text, sorted by time. The dump must be decoded on a machine with the same byte order as the agent.
+
+Usage: ILibRemoteLogging_decode <dump file>
+
+Build (Linux), from the repository root:
+  gcc -O2 -D_POSIX -DMICROSTACK_NOTLS -D_NOILIBSTACKDEBUG -I. -Imicrostack test/ILibRemoteLogging_decode.c \
+      microstack/ILibRemoteLogging.c microstack/ILibParsers.c microstack/ILibCrypto.c \
+      microstack/nossl/md5.c microstack/nossl/sha1.c microstack/nossl/sha224-256.c microstack/nossl/sha384-512.c -o blog_decode -lpthread -ldl
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ILibParsers.h"
+#include "ILibRemoteLogging.h"
+
+typedef struct ILibRemoteLogging_Decode_Entry
+{
+	ILibRemoteLogging_BinaryLog_Record hdr, *record;
+	int order;
+}ILibRemoteLogging_Decode_Entry;
+
+char *ILibRemoteLogging_Decode_ModuleName(unsigned short module)
+{
+	switch (module & 0x3FFF)
+	{
+		case ILibRemoteLogging_Modules_Logger: return("Logger");
+		case ILibRemoteLogging_Modules_WebRTC_STUN_ICE: return("STUN/ICE");
+		case ILibRemoteLogging_Modules_WebRTC_DTLS: return("DTLS");
+		case ILibRemoteLogging_Modules_WebRTC_SCTP: return("SCTP");
+		case ILibRemoteLogging_Modules_Agent_GuardPost: return("GuardPost");
+		case ILibRemoteLogging_Modules_Agent_P2P: return("P2P");
+		case ILibRemoteLogging_Modules_Agent_KVM: return("KVM");
+		case ILibRemoteLogging_Modules_Microstack_AsyncSocket: return("AsyncSocket");
+		case ILibRemoteLogging_Modules_Microstack_Web: return("Web");
+		case ILibRemoteLogging_Modules_Microstack_Pipe: return("Pipe");
+		case ILibRemoteLogging_Modules_Microstack_Generic: return("Generic");
+		default: return("UNKNOWN");
+	}
+}
+int ILibRemoteLogging_Decode_Compare(const void *a, const void *b)
+{
+	const ILibRemoteLogging_Decode_Entry *e1 = (const ILibRemoteLogging_Decode_Entry*)a;
+	const ILibRemoteLogging_Decode_Entry *e2 = (const ILibRemoteLogging_Decode_Entry*)b;
+
+	if (e1->record->timestamp != e2->record->timestamp) { return(e1->record->timestamp < e2->record->timestamp ? -1 : 1); }
+	return(e1->order - e2->order);
+}
+
+int main(int argc, char **argv)
+{
+	char *formats[ILibRemoteLogging_BinaryLog_MaxFormats] = { 0 };
+	ILibRemoteLogging_BinaryLog_FileHeader header;
+	ILibRemoteLogging_Decode_Entry *entries = NULL;
+	ILibRemoteLogging_BinaryLog_Record hdr, *record;
+	unsigned short id, len;
+	char text[4096], ts[32];
+	char *buffer, *format;
+	int bufferLen, pos, i, count = 0, max = 0;
+	time_t seconds;
+
+	if (argc < 2) { printf("Usage: %s <dump file>\n", argv[0]); return(1); }
+	if ((bufferLen = ILibReadFileFromDiskEx(&buffer, argv[1])) < (int)sizeof(header)) { printf("Could not read %s\n", argv[1]); return(1); }
+
+	memcpy_s(&header, sizeof(header), buffer, sizeof(header));
+	if (header.magic != ILibRemoteLogging_BinaryLog_MAGIC) { printf("%s is not a binary log dump, or was written on a machine with a different byte order\n", argv[1]); return(1); }
+	if (header.version != ILibRemoteLogging_BinaryLog_VERSION) { printf("Unsupported binary log version: %u\n", header.version); return(1); }
+	pos = (int)sizeof(header);
+
+	// Format Table
+	for (i = 0; i < header.formatCount && pos + 4 <= bufferLen; ++i)
+	{
+		memcpy_s(&id, sizeof(id), buffer + pos, sizeof(id));
+		memcpy_s(&len, sizeof(len), buffer + pos + 2, sizeof(len));
+		pos += 4;
+		if (id >= ILibRemoteLogging_BinaryLog_MaxFormats || pos + len > bufferLen) { printf("Corrupt format table\n"); return(1); }
+		formats[id] = ILibString_Copy(buffer + pos, len);
+		pos += len;
+	}
+
+	// Records. Each thread's records are in order, but the threads are interleaved, so sort everything by time.
+	while (pos + (int)sizeof(ILibRemoteLogging_BinaryLog_Record) <= bufferLen)
+	{
+		memcpy_s(&hdr, sizeof(hdr), buffer + pos, sizeof(hdr));
+		if (hdr.length < sizeof(hdr) || hdr.formatId >= ILibRemoteLogging_BinaryLog_MaxFormats || pos + hdr.length > bufferLen) { printf("Corrupt record at offset %d\n", pos); break; }
+		if ((record = (ILibRemoteLogging_BinaryLog_Record*)malloc(hdr.length)) == NULL) { ILIBCRITICALEXIT(254); }
+		memcpy_s(record, hdr.length, buffer + pos, hdr.length);
+		pos += record->length;
+
+		if (count == max)
+		{
+			max = max == 0 ? 1024 : max * 2;
+			if ((entries = (ILibRemoteLogging_Decode_Entry*)realloc(entries, max * sizeof(ILibRemoteLogging_Decode_Entry))) == NULL) { ILIBCRITICALEXIT(254); }
+		}
+		entries[count].record = record;
+		entries[count].order = count;
+		++count;
+	}
+	if (count > 0) { qsort(entries, count, sizeof(ILibRemoteLogging_Decode_Entry), ILibRemoteLogging_Decode_Compare); }
+
+	for (i = 0; i < count; ++i)
+	{
+		record = entries[i].record;
+		format = formats[record->formatId];
+		if (format != NULL)
+		{
+			ILibRemoteLogging_BinaryLog_Format(format, (char*)(record + 1), record->length - (int)sizeof(ILibRemoteLogging_BinaryLog_Record), text, (int)sizeof(text));
+		}
+		else
+		{
+			sprintf_s(text, sizeof(text), "<Unknown format id %u>", record->formatId);
+		}
+
+		seconds = (time_t)(record->timestamp / 1000);
+		strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", localtime(&seconds));
+		printf("%s.%03u [%s] V%d: %s\n", ts, (unsigned int)(record->timestamp % 1000), ILibRemoteLogging_Decode_ModuleName(record->module), ILibWhichPowerOfTwo(record->flags), text);
+		free(record);
+	}
+
+	printf("%d records, %u dropped\n", count, header.dropped);
+	for (i = 0; i < ILibRemoteLogging_BinaryLog_MaxFormats; ++i) { if (formats[i] != NULL) { free(formats[i]); } }
+	if (entries != NULL) { free(entries); }
+	free(buffer);
+	return(0);
+}
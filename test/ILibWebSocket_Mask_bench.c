@@ -0,0 +1,130 @@
+/*
+Copyright 2019 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+Micro-benchmark for ILibWebClient_WebSocket_Mask. Measures MB/s for small control/chat sized frames up to
+multi-megabyte frames, against the byte-at-a-time loop it replaced, both copying (send) and in place (receive).
+Before measuring, checks every length up to 300 bytes at every src/dest misalignment against the byte-at-a-time loop.
+The byte-at-a-time loop is inlined here, so at a few bytes the comparison is mostly the cost of the function call.
+
+Build (Linux), from the repository root:
+  gcc -O2 -D_POSIX -DMICROSTACK_NOTLS -D_NOILIBSTACKDEBUG -DMICROSTACK_PROXY -I. -Imicrostack test/ILibWebSocket_Mask_bench.c \
+      microstack/ILibWebClient.c microstack/ILibWebServer.c microstack/ILibAsyncSocket.c microstack/ILibAsyncServerSocket.c \
+      microstack/ILibRemoteLogging.c microstack/ILibParsers.c microstack/ILibCrypto.c \
+      microstack/nossl/md5.c microstack/nossl/sha1.c microstack/nossl/sha224-256.c microstack/nossl/sha384-512.c \
+      -o mask_bench -lpthread -ldl
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ILibParsers.h"
+#include "ILibAsyncSocket.h"
+#include "ILibWebClient.h"
+
+void ILibWebSocket_Mask_Bench_Reference(char *dest, const char *src, size_t length, const char *maskKey)
+{
+	size_t x;
+	for (x = 0; x < length; ++x) { dest[x] = src[x] ^ maskKey[x % 4]; }
+}
+
+int ILibWebSocket_Mask_Bench_Verify(const char *maskKey)
+{
+	char src[400], expected[400], actual[400];
+	size_t len, so, d;
+
+	for (len = 0; len < sizeof(src); ++len) { src[len] = (char)rand(); }
+	for (len = 0; len <= 300; ++len)
+	{
+		for (so = 0; so < 32; ++so)
+		{
+			for (d = 0; d < 32; ++d)
+			{
+				ILibWebSocket_Mask_Bench_Reference(expected, src + so, len, maskKey);
+				memset(actual, 0x55, sizeof(actual));
+				ILibWebClient_WebSocket_Mask(actual + d, src + so, len, maskKey);
+				if (memcmp(actual + d, expected, len) != 0 || actual[d + len] != 0x55) { printf("MISMATCH: length %u, src offset %u, dest offset %u\n", (unsigned int)len, (unsigned int)so, (unsigned int)d); return(1); }
+
+				// In place
+				memcpy(actual + d, src + so, len);
+				ILibWebClient_WebSocket_Mask(actual + d, actual + d, len, maskKey);
+				if (memcmp(actual + d, expected, len) != 0) { printf("MISMATCH (in place): length %u, offset %u\n", (unsigned int)len, (unsigned int)d); return(1); }
+			}
+		}
+	}
+	return(0);
+}
+
+void ILibWebSocket_Mask_Bench_Run(size_t length, const char *maskKey)
+{
+	char *src, *dest;
+	long long start, refElapsed, elapsed, inplaceElapsed;
+	long long ops, refOps, inplaceOps;
+	long long batch = (length < 65536 ? (65536 / length) : 1) * 16;
+	long long b;
+
+	if ((src = (char*)malloc(length + 1)) == NULL || (dest = (char*)malloc(length + 1)) == NULL) { ILIBCRITICALEXIT(254); }
+	for (b = 0; b < (long long)length; ++b) { src[b] = (char)rand(); }
+
+	// src + 1, because payloads follow a 2-14 byte header, so are rarely aligned
+	refOps = 0;
+	start = ILibGetUptime();
+	do
+	{
+		for (b = 0; b < batch; ++b) { ILibWebSocket_Mask_Bench_Reference(dest, src + 1, length, maskKey); }
+		refOps += batch;
+	} while ((refElapsed = ILibGetUptime() - start) < 500);
+
+	ops = 0;
+	start = ILibGetUptime();
+	do
+	{
+		for (b = 0; b < batch; ++b) { ILibWebClient_WebSocket_Mask(dest, src + 1, length, maskKey); }
+		ops += batch;
+	} while ((elapsed = ILibGetUptime() - start) < 500);
+
+	inplaceOps = 0;
+	start = ILibGetUptime();
+	do
+	{
+		for (b = 0; b < batch; ++b) { ILibWebClient_WebSocket_Mask(src + 1, src + 1, length, maskKey); }
+		inplaceOps += batch;
+	} while ((inplaceElapsed = ILibGetUptime() - start) < 500);
+
+	printf("%8u bytes: byte loop %8.1f MB/s   mask %8.1f MB/s (%5.1fx)   in place %8.1f MB/s\n", (unsigned int)length,
+		((double)refOps * length) / (refElapsed * 1000.0),
+		((double)ops * length) / (elapsed * 1000.0),
+		(((double)ops * length) / elapsed) / (((double)refOps * length) / refElapsed),
+		((double)inplaceOps * length) / (inplaceElapsed * 1000.0));
+
+	free(src);
+	free(dest);
+}
+
+int main(int argc, char **argv)
+{
+	char maskKey[4] = { (char)0x37, (char)0xFA, (char)0x21, (char)0x3D };
+	size_t lengths[] = { 2, 16, 125, 1024, 16384, 65536, 1048576, 4194304, 16777216 };
+	size_t i;
+
+	UNREFERENCED_PARAMETER(argc);
+	UNREFERENCED_PARAMETER(argv);
+
+	if (ILibWebSocket_Mask_Bench_Verify(maskKey) != 0) { return(1); }
+	printf("Verified lengths 0-300 at every src/dest alignment\n");
+
+	for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i) { ILibWebSocket_Mask_Bench_Run(lengths[i], maskKey); }
+	return(0);
+}
@@ -0,0 +1,80 @@
+/*
+Copyright 2019 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+//
+// Checks that fs.read()/fs.write() on a regular file move the file offset, when a position is given as well as when
+// it isn't, and that reads queued together on one descriptor complete in order. zip-reader depends on both.
+//
+// Usage: meshagent test/fs_offset_test.js
+//
+
+var fs = require('fs');
+var path = (process.platform == 'win32' ? process.env['TEMP'] + '\\' : '/tmp/') + 'fs_offset_test.bin';
+var failed = 0;
+
+function check(name, ok)
+{
+    console.log((ok ? 'PASS: ' : 'FAIL: ') + name);
+    if (!ok) { ++failed; }
+}
+function finish()
+{
+    fs.closeSync(fd);
+    fs.unlinkSync(path);
+    console.log(failed == 0 ? 'All tests passed' : (failed + ' test(s) failed'));
+    process.exit(failed == 0 ? 0 : 1);
+}
+
+var data = Buffer.alloc(256);
+for (var i = 0; i < data.length; ++i) { data[i] = i; }
+fs.writeFileSync(path, data);
+var fd = fs.openSync(path, fs.constants.O_RDWR);
+
+// Positioned read, then an unpositioned read, which must continue where the first one stopped
+fs.read(fd, { buffer: Buffer.alloc(16), position: 100 }, function (err, bytes, buffer)
+{
+    check('positioned read', err == 0 && bytes == 16 && buffer[0] == 100 && buffer[15] == 115);
+    fs.read(fd, { buffer: Buffer.alloc(16) }, function (err, bytes, buffer)
+    {
+        check('unpositioned read continues after positioned read', err == 0 && bytes == 16 && buffer[0] == 116 && buffer[15] == 131);
+
+        // Positioned write, then an unpositioned write, which must land right after it
+        fs.write(fd, Buffer.alloc(2, 0xAA), 0, 2, 10, function (err, bytes)
+        {
+            fs.write(fd, Buffer.alloc(1, 0xBB), 0, 1, function (err, bytes)
+            {
+                var contents = fs.readFileSync(path);
+                check('unpositioned write continues after positioned write', contents[10] == 0xAA && contents[11] == 0xAA && contents[12] == 0xBB && contents[13] == 13);
+
+                // Unpositioned reads queued together complete in order, each after the last
+                var results = [], count = 8;
+                fs.read(fd, { buffer: Buffer.alloc(1), position: 0 }, function () { });
+                for (var j = 0; j < count; ++j)
+                {
+                    fs.read(fd, { buffer: Buffer.alloc(4) }, function (err, bytes, buffer)
+                    {
+                        results.push(buffer[0]);
+                        if (results.length < count) { return; }
+                        var ordered = true;
+                        for (var k = 0; k < count; ++k) { if (results[k] != 1 + (k * 4)) { ordered = false; } }
+                        check('queued reads on one descriptor run in order', ordered);
+                        finish();
+                    });
+                }
+            }, {});
+        }, {});
+    });
+});
@@ -0,0 +1,122 @@
+/*
+Copyright 2019 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+Micro-benchmark for the Linux KVM tile fingerprint (util_crc). Measures tiles/second for every kernel
+the CPU supports, at 1080p and 4K, and checks that a single changed pixel changes the fingerprint.
+"frame" hashes the whole desktop buffer, so is mostly bound by memory bandwidth. "band" hashes a single
+row of tiles over and over, which is closer to the KVM loop, where a band is hashed right after it is converted.
+
+Build (Linux), from the repository root:
+  gcc -O2 -D_POSIX -DMICROSTACK_NOTLS -D_NOILIBSTACKDEBUG -I. -Imicrostack test/linux_tile_bench.c \
+      meshcore/KVM/Linux/linux_tile.c meshcore/KVM/Linux/linux_compression.c \
+      microstack/ILibParsers.c microstack/ILibCrypto.c \
+      microstack/nossl/md5.c microstack/nossl/sha1.c microstack/nossl/sha224-256.c microstack/nossl/sha384-512.c -o tile_bench -ljpeg -lpthread -ldl
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ILibParsers.h"
+#include "meshcore/KVM/Linux/linux_tile.h"
+
+// Normally provided by linux_kvm.c
+int SCREEN_NUM = 0;
+int SCREEN_WIDTH = 0;
+int SCREEN_HEIGHT = 0;
+int SCREEN_DEPTH = 24;
+int TILE_WIDTH = 32;
+int TILE_HEIGHT = 32;
+int TILE_WIDTH_COUNT = 0;
+int TILE_HEIGHT_COUNT = 0;
+int COMPRESSION_RATIO = 50;
+struct tileInfo_t **g_tileInfo = NULL;
+
+int linux_tile_bench_frame(tile_source *source, int rows)
+{
+	int r, c, ret = 0;
+	for (r = 0; r < rows; ++r)
+	{
+		for (c = 0; c < TILE_WIDTH_COUNT; ++c)
+		{
+			ret ^= util_crc(source, c * TILE_WIDTH, r * TILE_HEIGHT, TILE_WIDTH, TILE_HEIGHT);
+		}
+	}
+	return(ret);
+}
+
+void linux_tile_bench_run(int width, int height)
+{
+	int kernels[] = { UTIL_CRC_SCALAR, UTIL_CRC_SSE42, UTIL_CRC_AVX2 };
+	long long desktopsize, start, elapsed, bandElapsed;
+	int i, k, frames, bands, tiles, h1, h2, sink = 0;
+	tile_source source;
+	char *desktop;
+
+	SCREEN_WIDTH = width;
+	SCREEN_HEIGHT = height;
+	TILE_WIDTH_COUNT = adjust_screen_size(width) / TILE_WIDTH;
+	TILE_HEIGHT_COUNT = adjust_screen_size(height) / TILE_HEIGHT;
+	tiles = TILE_WIDTH_COUNT * TILE_HEIGHT_COUNT;
+	desktopsize = 3LL * adjust_screen_size(width) * adjust_screen_size(height);
+	if ((desktop = (char*)malloc((size_t)desktopsize)) == NULL) { ILIBCRITICALEXIT(254); }
+
+	srand(width);
+	for (i = 0; i < desktopsize; ++i) { desktop[i] = (char)rand(); }
+	tile_source_buffer(&source, desktop);
+
+	for (k = 0; k < (int)(sizeof(kernels) / sizeof(kernels[0])); ++k)
+	{
+		if (util_crc_select(kernels[k]) != kernels[k]) { printf("%4dx%d  %-7s not supported\n", width, height, util_crc_name()); continue; }
+
+		// A single changed pixel must change the fingerprint
+		h1 = util_crc(&source, TILE_WIDTH, TILE_HEIGHT, TILE_WIDTH, TILE_HEIGHT);
+		desktop[(3 * adjust_screen_size(width) * (TILE_HEIGHT + 17)) + (3 * (TILE_WIDTH + 5)) + 1] ^= 0x01;
+		h2 = util_crc(&source, TILE_WIDTH, TILE_HEIGHT, TILE_WIDTH, TILE_HEIGHT);
+		desktop[(3 * adjust_screen_size(width) * (TILE_HEIGHT + 17)) + (3 * (TILE_WIDTH + 5)) + 1] ^= 0x01;
+
+		frames = 0;
+		start = ILibGetUptime();
+		do
+		{
+			sink ^= linux_tile_bench_frame(&source, TILE_HEIGHT_COUNT);
+			++frames;
+		} while ((elapsed = ILibGetUptime() - start) < 1000);
+
+		bands = 0;
+		start = ILibGetUptime();
+		do
+		{
+			sink ^= linux_tile_bench_frame(&source, 1);
+			++bands;
+		} while ((bandElapsed = ILibGetUptime() - start) < 1000);
+
+		printf("%4dx%d  %-7s frame: %5.1f Mtiles/s (%6.1f frames/s)  band: %5.1f Mtiles/s  %s\n", width, height, util_crc_name(),
+			((double)frames * tiles) / (elapsed * 1000.0), (frames * 1000.0) / elapsed, ((double)bands * TILE_WIDTH_COUNT) / (bandElapsed * 1000.0),
+			h1 != h2 ? "pixel change detected" : "PIXEL CHANGE MISSED");
+	}
+	if (sink == 0x7FFFFFFF) { printf("\n"); }
+	free(desktop);
+}
+
+int main(int argc, char **argv)
+{
+	UNREFERENCED_PARAMETER(argc);
+	UNREFERENCED_PARAMETER(argv);
+
+	linux_tile_bench_run(1920, 1080);
+	linux_tile_bench_run(3840, 2160);
+	return(0);
+}
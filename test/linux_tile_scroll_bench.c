@@ -0,0 +1,220 @@
+/*
+Copyright 2019 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+Synthetic scroll benchmark for the Linux KVM move detection (getTileMoves). A document is scrolled inside a window on a
+1080p desktop, and every frame is encoded twice: with tiles only, and with MNG_KVM_COPY for the scrolled area. Prints the
+bytes per frame of each, and the time spent. Each stream is also played back on a simulated viewer, which applies the
+copies and decodes the JPEG tiles, and the mean error against the real desktop is printed, so a bad copy can't hide.
+
+Build (Linux), from the repository root:
+  gcc -O2 -D_POSIX -DMICROSTACK_NOTLS -D_NOILIBSTACKDEBUG -I. -Imicrostack test/linux_tile_scroll_bench.c \
+      meshcore/KVM/Linux/linux_tile.c meshcore/KVM/Linux/linux_compression.c \
+      microstack/ILibParsers.c microstack/ILibCrypto.c \
+      microstack/nossl/md5.c microstack/nossl/sha1.c microstack/nossl/sha224-256.c microstack/nossl/sha384-512.c -o tile_scroll_bench -ljpeg -lpthread -ldl
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <jpeglib.h>
+#include "ILibParsers.h"
+#include "meshcore/meshdefines.h"
+#include "meshcore/KVM/Linux/linux_tile.h"
+
+// Normally provided by linux_kvm.c
+int SCREEN_NUM = 0;
+int SCREEN_WIDTH = 0;
+int SCREEN_HEIGHT = 0;
+int SCREEN_DEPTH = 24;
+int TILE_WIDTH = 32;
+int TILE_HEIGHT = 32;
+int TILE_WIDTH_COUNT = 0;
+int TILE_HEIGHT_COUNT = 0;
+int COMPRESSION_RATIO = 50;
+struct tileInfo_t **g_tileInfo = NULL;
+
+#define SCROLL_BENCH_FRAMES 60
+#define SCROLL_BENCH_STEP 37					// Pixels scrolled per frame
+#define SCROLL_BENCH_WINDOW_X 250
+#define SCROLL_BENCH_WINDOW_Y 120
+#define SCROLL_BENCH_WINDOW_W 1400
+#define SCROLL_BENCH_WINDOW_H 860
+
+typedef struct scroll_bench_viewer
+{
+	unsigned char *screen;
+	int stride, width, height;
+	long long bytes, copies, pictures;
+}scroll_bench_viewer;
+
+// Text-like document: lines of "words" on a white page, each line different
+void scroll_bench_document(unsigned char *doc, int width, int height)
+{
+	int x, y, line, word, len;
+	memset(doc, 0xFF, (size_t)width * height * 3);
+	srand(1234);
+	for (line = 0; line * 20 + 16 < height; ++line)
+	{
+		for (x = 20; x < width - 20; x += len + 8)
+		{
+			len = 10 + (rand() % 60);
+			word = rand();
+			for (y = line * 20 + 4; y < line * 20 + 16; ++y)
+			{
+				int i;
+				for (i = x; i < x + len && i < width - 20; ++i)
+				{
+					if (((i * 7 + y * 3 + word) % 5) < 2)
+					{
+						doc[(y * width + i) * 3] = (unsigned char)(word & 0x3F);
+						doc[(y * width + i) * 3 + 1] = (unsigned char)((word >> 8) & 0x3F);
+						doc[(y * width + i) * 3 + 2] = (unsigned char)((word >> 16) & 0x7F);
+					}
+				}
+			}
+		}
+	}
+}
+
+// Desktop: a gradient background, and the window showing the document from the given offset
+void scroll_bench_render(char *desktop, int stride, unsigned char *doc, int offset)
+{
+	int y, x;
+	for (y = 0; y < SCREEN_HEIGHT; ++y)
+	{
+		for (x = 0; x < SCREEN_WIDTH; ++x)
+		{
+			desktop[y * stride + x * 3] = (char)(x / 8);
+			desktop[y * stride + x * 3 + 1] = (char)(y / 5);
+			desktop[y * stride + x * 3 + 2] = (char)0x60;
+		}
+	}
+	for (y = 0; y < SCROLL_BENCH_WINDOW_H; ++y)
+	{
+		memcpy(desktop + (SCROLL_BENCH_WINDOW_Y + y) * stride + SCROLL_BENCH_WINDOW_X * 3, doc + (size_t)(offset + y) * SCROLL_BENCH_WINDOW_W * 3, SCROLL_BENCH_WINDOW_W * 3);
+	}
+}
+
+// Applies a packet on the simulated viewer
+int scroll_bench_write(void *buffer, long long bufferSize, void *user)
+{
+	scroll_bench_viewer *viewer = (scroll_bench_viewer*)user;
+	unsigned short *packet = (unsigned short*)buffer;
+	struct jpeg_decompress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	unsigned char *row;
+	int x, y, w, h, sx, sy, i, header = 8;
+
+	viewer->bytes += bufferSize;
+	if (ntohs(packet[0]) == MNG_JUMBO) { packet += 4; header += 8; }
+
+	switch (ntohs(packet[0]))
+	{
+		case MNG_KVM_COPY:
+			x = ntohs(packet[2]); y = ntohs(packet[3]); sx = ntohs(packet[4]); sy = ntohs(packet[5]); w = ntohs(packet[6]); h = ntohs(packet[7]);
+			if (sy > y)
+			{
+				for (i = 0; i < h; ++i) { memmove(viewer->screen + (y + i) * viewer->stride + x * 3, viewer->screen + (sy + i) * viewer->stride + sx * 3, w * 3); }
+			}
+			else
+			{
+				for (i = h - 1; i >= 0; --i) { memmove(viewer->screen + (y + i) * viewer->stride + x * 3, viewer->screen + (sy + i) * viewer->stride + sx * 3, w * 3); }
+			}
+			++viewer->copies;
+			break;
+		case MNG_KVM_PICTURE:
+			x = ntohs(packet[2]); y = ntohs(packet[3]);
+			cinfo.err = jpeg_std_error(&jerr);
+			jpeg_create_decompress(&cinfo);
+			jpeg_mem_src(&cinfo, (unsigned char*)buffer + header, (unsigned long)(bufferSize - header));
+			jpeg_read_header(&cinfo, TRUE);
+			cinfo.out_color_space = JCS_RGB;
+			jpeg_start_decompress(&cinfo);
+			while (cinfo.output_scanline < cinfo.output_height)
+			{
+				row = viewer->screen + (y + cinfo.output_scanline) * viewer->stride + x * 3;
+				jpeg_read_scanlines(&cinfo, &row, 1);
+			}
+			jpeg_finish_decompress(&cinfo);
+			jpeg_destroy_decompress(&cinfo);
+			++viewer->pictures;
+			break;
+	}
+	return(0);
+}
+
+double scroll_bench_error(scroll_bench_viewer *viewer, char *desktop)
+{
+	long long sum = 0, i, len = (long long)viewer->stride * viewer->height;
+	for (i = 0; i < len; ++i) { sum += abs((int)viewer->screen[i] - (int)(unsigned char)desktop[i]); }
+	return((double)sum / len);
+}
+
+void scroll_bench_run(int moves)
+{
+	scroll_bench_viewer viewer = { 0 };
+	unsigned char *doc;
+	char *desktop;
+	tile_source source;
+	long long start, elapsed = 0, firstBytes = 0;
+	int f, r, c, docHeight = SCROLL_BENCH_WINDOW_H + SCROLL_BENCH_FRAMES * SCROLL_BENCH_STEP + 1;
+	double error = 0;
+
+	reset_tile_info(TILE_HEIGHT_COUNT);
+	viewer.width = adjust_screen_size(SCREEN_WIDTH);
+	viewer.height = adjust_screen_size(SCREEN_HEIGHT);
+	viewer.stride = viewer.width * 3;
+	if ((viewer.screen = (unsigned char*)calloc((size_t)viewer.stride, viewer.height)) == NULL) { ILIBCRITICALEXIT(254); }
+	if ((desktop = (char*)calloc((size_t)viewer.stride, viewer.height)) == NULL) { ILIBCRITICALEXIT(254); }
+	if ((doc = (unsigned char*)malloc((size_t)SCROLL_BENCH_WINDOW_W * docHeight * 3)) == NULL) { ILIBCRITICALEXIT(254); }
+	scroll_bench_document(doc, SCROLL_BENCH_WINDOW_W, docHeight);
+	tile_source_buffer(&source, desktop);
+
+	for (f = 0; f <= SCROLL_BENCH_FRAMES; ++f)
+	{
+		scroll_bench_render(desktop, viewer.stride, doc, f * SCROLL_BENCH_STEP);
+		for (r = 0; r < TILE_HEIGHT_COUNT; r++) { for (c = 0; c < TILE_WIDTH_COUNT; c++) { g_tileInfo[r][c].flag = TILE_TODO; } }
+
+		start = ILibGetUptime();
+		if (moves != 0) { getTileMoves(&source, scroll_bench_write, &viewer); }
+		getTiles(&source, scroll_bench_write, &viewer);
+		if (f == 0) { firstBytes = viewer.bytes; continue; }	// The first frame is the whole screen either way
+		elapsed += ILibGetUptime() - start;
+		error += scroll_bench_error(&viewer, desktop);
+	}
+
+	printf("%-12s %8lld bytes/frame  %5.1f ms/frame  %6lld pictures  %4lld copies  mean error %.2f\n", moves != 0 ? "tiles+copy:" : "tiles only:",
+		(viewer.bytes - firstBytes) / SCROLL_BENCH_FRAMES, (double)elapsed / SCROLL_BENCH_FRAMES, viewer.pictures, viewer.copies, error / SCROLL_BENCH_FRAMES);
+	free(doc);
+	free(desktop);
+	free(viewer.screen);
+}
+
+int main(int argc, char **argv)
+{
+	UNREFERENCED_PARAMETER(argc);
+	UNREFERENCED_PARAMETER(argv);
+
+	SCREEN_WIDTH = 1920;
+	SCREEN_HEIGHT = 1080;
+	TILE_WIDTH_COUNT = adjust_screen_size(SCREEN_WIDTH) / TILE_WIDTH;
+	TILE_HEIGHT_COUNT = adjust_screen_size(SCREEN_HEIGHT) / TILE_HEIGHT;
+
+	printf("%dx%d, %d frames, window %dx%d scrolled by %d pixels per frame\n", SCREEN_WIDTH, SCREEN_HEIGHT, SCROLL_BENCH_FRAMES, SCROLL_BENCH_WINDOW_W, SCROLL_BENCH_WINDOW_H, SCROLL_BENCH_STEP);
+	scroll_bench_run(0);
+	scroll_bench_run(1);
+	return(0);
+}